@@ -0,0 +1,156 @@
+# Per-Microarchitecture Build Variants
+# ====================================
+#
+# The default example binaries are built without -march so a single copy on
+# BeeGFS runs on every node. slurm_jobs_add_variants() adds extra binaries
+# named <name>-<variant> (e.g. matrix-mult-x86-64-v4) compiled with
+# -march=<variant>, optional LTO and optional profile-guided optimization
+# (PGO), plus example-specific compile-time constants per variant (e.g.
+# GEMM tile sizes). The sbatch scripts run the most specific variant every
+# allocated node supports via select-variant.sh (common/).
+#
+# Cache options:
+#   SLURM_JOBS_ARCH_VARIANTS  -march levels to build (default on x86-64:
+#                             x86-64-v3;x86-64-v4; levels the compiler
+#                             rejects are skipped)
+#   SLURM_JOBS_LTO            Link-time optimization for the variants (ON)
+#   SLURM_JOBS_PGO            Train each variant with a run of the example
+#                             and rebuild it with the profile (OFF). Only
+#                             variants the build host can execute are trained.
+#   SLURM_JOBS_PGO_LAUNCHER   Command prefix for the training run (default:
+#                             none, a single-rank MPI singleton)
+#
+# Each variant binary reports its build (e.g. "x86-64-v4+lto+pgo") through
+# BENCH_BUILD_VARIANT (bench-report.h) in its banner and JSON record.
+
+include(CheckCCompilerFlag)
+include(CheckCSourceRuns)
+
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$")
+    set(SLURM_JOBS_DEFAULT_VARIANTS "x86-64-v3;x86-64-v4")
+else()
+    set(SLURM_JOBS_DEFAULT_VARIANTS "")
+endif()
+set(SLURM_JOBS_ARCH_VARIANTS "${SLURM_JOBS_DEFAULT_VARIANTS}" CACHE STRING
+    "-march levels built by the build-*-variants targets")
+option(SLURM_JOBS_LTO "Link-time optimization for the per-microarchitecture variants" ON)
+option(SLURM_JOBS_PGO "Profile-guided optimization for the per-microarchitecture variants" OFF)
+set(SLURM_JOBS_PGO_LAUNCHER "" CACHE STRING
+    "Command prefix for PGO training runs (empty: run the binary directly)")
+
+# CPU features each level needs at run time (for deciding what can be trained)
+set(SLURM_JOBS_FEATURES_x86-64-v2 "sse4.2;popcnt;ssse3")
+set(SLURM_JOBS_FEATURES_x86-64-v3 "avx2;fma;bmi;bmi2;f16c;movbe")
+set(SLURM_JOBS_FEATURES_x86-64-v4 "avx512f;avx512bw;avx512cd;avx512dq;avx512vl")
+
+set(SLURM_JOBS_VARIANTS "")
+foreach(variant IN LISTS SLURM_JOBS_ARCH_VARIANTS)
+    string(MAKE_C_IDENTIFIER "${variant}" id)
+    check_c_compiler_flag("-march=${variant}" SLURM_JOBS_HAVE_MARCH_${id})
+    if(SLURM_JOBS_HAVE_MARCH_${id})
+        list(APPEND SLURM_JOBS_VARIANTS "${variant}")
+    else()
+        message(STATUS "Compiler does not accept -march=${variant}; skipping that variant")
+    endif()
+endforeach()
+
+set(SLURM_JOBS_LTO_FLAGS "")
+if(SLURM_JOBS_LTO)
+    check_c_compiler_flag("-flto=auto" SLURM_JOBS_HAVE_LTO_AUTO)
+    check_c_compiler_flag("-flto" SLURM_JOBS_HAVE_LTO)
+    if(SLURM_JOBS_HAVE_LTO_AUTO)
+        set(SLURM_JOBS_LTO_FLAGS "-flto=auto")
+    elseif(SLURM_JOBS_HAVE_LTO)
+        set(SLURM_JOBS_LTO_FLAGS "-flto")
+    endif()
+endif()
+
+# Whether the build host can run code for `variant` (result in out_var)
+function(slurm_jobs_host_runs variant out_var)
+    string(MAKE_C_IDENTIFIER "${variant}" id)
+    set(checks "")
+    foreach(feature IN LISTS SLURM_JOBS_FEATURES_${variant})
+        string(APPEND checks " && __builtin_cpu_supports(\"${feature}\")")
+    endforeach()
+    set(CMAKE_REQUIRED_QUIET ON)
+    check_c_source_runs("int main(void) { __builtin_cpu_init(); return !(1${checks}); }"
+                        SLURM_JOBS_HOST_RUNS_${id})
+    set(${out_var} ${SLURM_JOBS_HOST_RUNS_${id}} PARENT_SCOPE)
+endfunction()
+
+# slurm_jobs_add_variants(<target>
+#     NAME <binary>                 Variant binaries are <binary>-<variant>
+#     OUTPUT_DIR <dir>
+#     SOURCES <file>...             All C sources, compiled in one step
+#     DEPENDS <file>...             Headers and other inputs
+#     DEFINES_PREFIX <prefix>       -D flags per variant from ${<prefix><variant>}
+#     TRAINING_ARGS <arg>...)       Arguments of the PGO training run
+function(slurm_jobs_add_variants target)
+    cmake_parse_arguments(ARG "" "NAME;OUTPUT_DIR;DEFINES_PREFIX"
+                          "SOURCES;DEPENDS;TRAINING_ARGS" ${ARGN})
+    set(outputs "")
+
+    foreach(variant IN LISTS SLURM_JOBS_VARIANTS)
+        set(binary "${ARG_OUTPUT_DIR}/${ARG_NAME}-${variant}")
+        set(label "${variant}")
+        if(SLURM_JOBS_LTO_FLAGS)
+            string(APPEND label "+lto")
+        endif()
+
+        set(train OFF)
+        if(SLURM_JOBS_PGO)
+            slurm_jobs_host_runs("${variant}" train)
+            if(train)
+                string(APPEND label "+pgo")
+            else()
+                message(STATUS "${ARG_NAME}-${variant}: build host cannot run ${variant}, building without PGO")
+            endif()
+        endif()
+
+        set(defines "")
+        if(ARG_DEFINES_PREFIX)
+            set(defines ${${ARG_DEFINES_PREFIX}${variant}})
+        endif()
+        set(flags -O3 -Wall ${SLURM_JOBS_OPENMP_FLAGS} -march=${variant} ${SLURM_JOBS_LTO_FLAGS}
+                  ${defines} -DBENCH_BUILD_VARIANT="${label}"
+                  -I${SLURM_JOBS_COMMON_DIR})
+        set(compile ${MPI_C_COMPILER} ${flags} -o ${binary} ${ARG_SOURCES} -lm)
+
+        if(train)
+            string(REPLACE ";" " " training "${ARG_TRAINING_ARGS}")
+            # Instrumented build, training run, then the final build from the
+            # profile. Both builds use the same output path, which names the
+            # .gcda files.
+            set(profile_dir "${CMAKE_CURRENT_BINARY_DIR}/pgo-${ARG_NAME}-${variant}")
+            add_custom_command(
+                OUTPUT ${binary}
+                COMMAND ${CMAKE_COMMAND} -E make_directory "${ARG_OUTPUT_DIR}"
+                COMMAND ${CMAKE_COMMAND} -E rm -rf "${profile_dir}"
+                COMMAND ${compile} -fprofile-generate -fprofile-update=prefer-atomic
+                        -fprofile-dir=${profile_dir}
+                COMMAND ${SLURM_JOBS_PGO_LAUNCHER} ${binary} ${ARG_TRAINING_ARGS}
+                COMMAND ${compile} -fprofile-use -fprofile-partial-training -Wno-missing-profile
+                        -fprofile-dir=${profile_dir}
+                DEPENDS ${ARG_SOURCES} ${ARG_DEPENDS}
+                COMMENT "Building ${ARG_NAME}-${variant} with PGO (training: ${training})..."
+                VERBATIM
+            )
+        else()
+            add_custom_command(
+                OUTPUT ${binary}
+                COMMAND ${CMAKE_COMMAND} -E make_directory "${ARG_OUTPUT_DIR}"
+                COMMAND ${compile}
+                DEPENDS ${ARG_SOURCES} ${ARG_DEPENDS}
+                COMMENT "Building ${ARG_NAME}-${variant}..."
+                VERBATIM
+            )
+        endif()
+        list(APPEND outputs ${binary})
+    endforeach()
+
+    add_custom_target(
+        ${target}
+        DEPENDS ${outputs}
+        COMMENT "Per-microarchitecture variants of ${ARG_NAME}: ${SLURM_JOBS_VARIANTS}"
+    )
+endfunction()
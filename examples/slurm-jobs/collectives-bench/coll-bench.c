@@ -0,0 +1,541 @@
+/*
+ * MPI Collectives Microbenchmark
+ *
+ * Times the collectives the examples and the DDP templates rely on
+ * (barrier, bcast, reduce, allreduce, gather, scatter, allgather, alltoall)
+ * over doubling message sizes and over several rank counts within one job,
+ * so the results can drive Open MPI coll_tuned decisions for this cluster.
+ *
+ * Each measurement starts with warm-up iterations, then times every
+ * iteration separately after a barrier. An iteration's latency is the time
+ * of its slowest rank; min/p50/p90/p99/max are reported over iterations.
+ * Nonblocking variants are timed twice: start + wait back to back (pure
+ * latency), then with the start followed by busy compute as long as the
+ * pure p50 before the wait. Overlap is the share of the pure latency hidden
+ * behind that compute (100% = fully asynchronous progress).
+ *
+ * OMPI_MCA_coll_* environment variables are echoed in the banner and the
+ * JSON record, so runs with forced coll_tuned algorithms can be compared
+ * (see coll-bench.sbatch).
+ *
+ * Options:
+ *   --collectives=LIST  Comma-separated operations (default: all)
+ *   --min-bytes=N       Smallest message, K/M/G suffixes allowed (default: 8)
+ *   --max-bytes=N       Largest message (default: 1M)
+ *   --ranks=LIST        Communicator sizes to test (default: 2, 4, 8, ...
+ *                       up to and including all ranks)
+ *   --iterations=N      Timed iterations for messages up to 64K; fewer for
+ *                       larger ones, at least 10 (default: 100)
+ *   --warmup=N          Untimed iterations before each measurement (default: 10)
+ *   --mode=both|blocking|nonblocking   Variants to time (default: both)
+ *   --hugepages=none|thp|2m|1g   Page size for the message buffers
+ *                       (default: thp, or BENCH_HUGEPAGES; see bench-alloc.h)
+ *   --json[=PATH]       Also write a JSON record to stdout or PATH
+ *
+ * Compile: mpicc -O2 -I../common -o coll-bench coll-bench.c coll-ops.c \
+ *          ../common/bench-report.c ../common/bench-alloc.c -lm
+ * Run: mpirun -np 4 ./coll-bench --collectives=allreduce,bcast
+ */
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-report.h"
+#include "coll-ops.h"
+
+extern char **environ;
+
+#define DEFAULT_MIN_BYTES 8
+#define DEFAULT_MAX_BYTES (1u << 20)
+#define DEFAULT_ITERATIONS 100
+#define DEFAULT_WARMUP 10
+
+// Messages above this size get proportionally fewer timed iterations
+#define LARGE_MESSAGE_BYTES (64u << 10)
+#define MIN_ITERATIONS 10
+
+// Largest message per rank (keeps counts and buffers in range)
+#define MAX_MESSAGE_BYTES (256u << 20)
+
+#define MAX_RANK_COUNTS 32
+
+enum { MODE_BLOCKING = 1, MODE_NONBLOCKING = 2, MODE_BOTH = 3 };
+
+// Command-line configuration
+typedef struct {
+    int ops[COLL_COUNT];            // 1 if the operation is selected
+    size_t min_bytes;
+    size_t max_bytes;
+    int rank_counts[MAX_RANK_COUNTS];
+    int num_rank_counts;
+    int iterations;
+    int warmup;
+    int mode;                       // MODE_* bit set
+    int json;                       // Write a JSON record
+    const char *json_path;          // JSON destination (NULL = stdout)
+} coll_config_t;
+
+// One row of the results (rank 0)
+typedef struct {
+    coll_op_t op;
+    int ranks;
+    size_t bytes;
+    int iterations;
+    bench_percentiles_t blocking;       // Seconds; count 0 if not timed
+    bench_percentiles_t nonblocking;
+    double overlap;                     // Percent, < 0 if not measured
+} coll_result_t;
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [--collectives=LIST] [--min-bytes=N] [--max-bytes=N] [--ranks=LIST]\n"
+           "       [--iterations=N] [--warmup=N] [--mode=both|blocking|nonblocking]\n"
+           "       [--hugepages=none|thp|2m|1g] [--json[=PATH]]\n", prog);
+}
+
+// Parse "allreduce,bcast"; returns 0 on success
+int parse_collectives(const char *value, coll_config_t *config, int rank) {
+    char list[256];
+    coll_op_t op;
+
+    memset(config->ops, 0, sizeof(config->ops));
+    snprintf(list, sizeof(list), "%s", value);
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        if (coll_op_from_name(name, &op) != 0) {
+            if (rank == 0) {
+                printf("Error: Unknown collective '%s'\n", name);
+            }
+            return -1;
+        }
+        config->ops[op] = 1;
+    }
+    return 0;
+}
+
+// Parse "2,4,8"; returns 0 on success
+int parse_rank_counts(const char *value, coll_config_t *config, int world_size, int rank) {
+    char list[256];
+
+    config->num_rank_counts = 0;
+    snprintf(list, sizeof(list), "%s", value);
+    for (char *item = strtok(list, ","); item; item = strtok(NULL, ",")) {
+        int ranks = atoi(item);
+        if (ranks < 1 || ranks > world_size || config->num_rank_counts == MAX_RANK_COUNTS) {
+            if (rank == 0) {
+                printf("Error: Rank counts must be between 1 and %d (at most %d of them)\n",
+                       world_size, MAX_RANK_COUNTS);
+            }
+            return -1;
+        }
+        config->rank_counts[config->num_rank_counts++] = ranks;
+    }
+    return config->num_rank_counts > 0 ? 0 : -1;
+}
+
+// Parse command line; returns 0 on success, -1 on invalid arguments.
+// Every rank parses the arguments; only rank 0 reports errors.
+int parse_args(int argc, char **argv, coll_config_t *config, int world_size, int rank) {
+    const char *value;
+
+    for (int i = 0; i < COLL_COUNT; i++) {
+        config->ops[i] = 1;
+    }
+    config->min_bytes = DEFAULT_MIN_BYTES;
+    config->max_bytes = DEFAULT_MAX_BYTES;
+    config->num_rank_counts = 0;
+    for (int n = 2; n < world_size && config->num_rank_counts < MAX_RANK_COUNTS - 1; n *= 2) {
+        config->rank_counts[config->num_rank_counts++] = n;
+    }
+    config->rank_counts[config->num_rank_counts++] = world_size;
+    config->iterations = DEFAULT_ITERATIONS;
+    config->warmup = DEFAULT_WARMUP;
+    config->mode = MODE_BOTH;
+    config->json = 0;
+    config->json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        int pages_option = bench_alloc_option(arg);
+        if (pages_option < 0) {
+            if (rank == 0) {
+                printf("Error: Unknown huge page mode '%s'\n", arg + strlen("--hugepages="));
+            }
+            return -1;
+        } else if (pages_option > 0) {
+            continue;
+        }
+        if ((value = bench_option_value(arg, "--collectives="))) {
+            if (parse_collectives(value, config, rank) != 0) {
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--min-bytes="))) {
+            config->min_bytes = (size_t)bench_parse_size(value);
+        } else if ((value = bench_option_value(arg, "--max-bytes="))) {
+            config->max_bytes = (size_t)bench_parse_size(value);
+        } else if ((value = bench_option_value(arg, "--ranks="))) {
+            if (parse_rank_counts(value, config, world_size, rank) != 0) {
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--iterations="))) {
+            config->iterations = atoi(value);
+        } else if ((value = bench_option_value(arg, "--warmup="))) {
+            config->warmup = atoi(value);
+        } else if ((value = bench_option_value(arg, "--mode="))) {
+            if (strcmp(value, "both") == 0) {
+                config->mode = MODE_BOTH;
+            } else if (strcmp(value, "blocking") == 0) {
+                config->mode = MODE_BLOCKING;
+            } else if (strcmp(value, "nonblocking") == 0) {
+                config->mode = MODE_NONBLOCKING;
+            } else {
+                if (rank == 0) {
+                    printf("Error: Unknown mode '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if (bench_json_option(arg, &config->json_path)) {
+            config->json = 1;
+        } else {
+            if (rank == 0) {
+                printf("Error: Unknown option '%s'\n", arg);
+            }
+            return -1;
+        }
+    }
+
+    // Reductions need at least one float
+    if (config->min_bytes < sizeof(float) || config->max_bytes < config->min_bytes
+        || config->max_bytes > MAX_MESSAGE_BYTES) {
+        if (rank == 0) {
+            printf("Error: Message sizes must satisfy 4 <= min-bytes <= max-bytes <= 256M\n");
+        }
+        return -1;
+    }
+    if (config->iterations < 1 || config->warmup < 0) {
+        if (rank == 0) {
+            printf("Error: Iterations must be positive and warm-up non-negative\n");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Timed iterations for one message size
+int iterations_for(const coll_config_t *config, size_t bytes) {
+    if (bytes <= LARGE_MESSAGE_BYTES) {
+        return config->iterations;
+    }
+    int iters = (int)(config->iterations * (double)LARGE_MESSAGE_BYTES / bytes);
+    if (iters < MIN_ITERATIONS) {
+        iters = MIN_ITERATIONS;
+    }
+    return iters < config->iterations ? iters : config->iterations;
+}
+
+// Spin for `seconds` without calling into MPI (no progress help)
+void busy_compute(double seconds) {
+    double t0 = MPI_Wtime();
+    while (MPI_Wtime() - t0 < seconds) {
+    }
+}
+
+// Time iters runs of op; per-iteration slowest-rank times land in times
+// on the communicator's rank 0. compute < 0 times the blocking form,
+// otherwise the nonblocking form with `compute` seconds between start and wait.
+void time_op(coll_op_t op, const coll_buffers_t *buf, size_t bytes, int warmup, int iters,
+             double compute, double *local, double *times) {
+    MPI_Request request;
+
+    for (int it = -warmup; it < iters; it++) {
+        MPI_Barrier(buf->comm);
+        double t0 = MPI_Wtime();
+        if (compute < 0.0) {
+            coll_op_run(op, buf, bytes, NULL);
+        } else {
+            coll_op_run(op, buf, bytes, &request);
+            if (compute > 0.0) {
+                busy_compute(compute);
+            }
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+        double t = MPI_Wtime() - t0;
+        if (it >= 0) {
+            local[it] = t;
+        }
+    }
+    MPI_Reduce(local, times, iters, MPI_DOUBLE, MPI_MAX, 0, buf->comm);
+}
+
+// Measure one operation at one size on buf->comm; result valid on its rank 0
+void measure(const coll_config_t *config, coll_op_t op, const coll_buffers_t *buf,
+             size_t bytes, double *local, double *times, coll_result_t *result) {
+    int comm_rank;
+    int iters = iterations_for(config, bytes);
+
+    MPI_Comm_rank(buf->comm, &comm_rank);
+    memset(result, 0, sizeof(*result));
+    MPI_Comm_size(buf->comm, &result->ranks);
+    result->op = op;
+    result->bytes = bytes;
+    result->iterations = iters;
+    result->overlap = -1.0;
+
+    if (config->mode & MODE_BLOCKING) {
+        time_op(op, buf, bytes, config->warmup, iters, -1.0, local, times);
+        if (comm_rank == 0) {
+            result->blocking = bench_percentiles(times, iters);
+        }
+    }
+    if (config->mode & MODE_NONBLOCKING) {
+        time_op(op, buf, bytes, config->warmup, iters, 0.0, local, times);
+        double pure = 0.0;
+        if (comm_rank == 0) {
+            result->nonblocking = bench_percentiles(times, iters);
+            pure = result->nonblocking.p50;
+        }
+        // Every rank computes for the same time
+        MPI_Bcast(&pure, 1, MPI_DOUBLE, 0, buf->comm);
+        time_op(op, buf, bytes, config->warmup, iters, pure, local, times);
+        if (comm_rank == 0 && pure > 0.0) {
+            bench_percentiles_t overlapped = bench_percentiles(times, iters);
+            double hidden = 1.0 - (overlapped.p50 - pure) / pure;
+            result->overlap = 100.0 * (hidden < 0.0 ? 0.0 : hidden > 1.0 ? 1.0 : hidden);
+        }
+    }
+}
+
+void print_table_header(coll_op_t op, int ranks) {
+    printf("\n# %s, %d ranks (latency in us, slowest rank per iteration)\n",
+           coll_op_name(op), ranks);
+    printf("%10s %6s | %9s %9s %9s | %9s %9s %9s %8s\n",
+           "Bytes", "Iters", "p50", "p90", "p99", "nb p50", "nb p90", "nb p99", "Overlap");
+}
+
+void print_result(const coll_result_t *result) {
+    printf("%10zu %6d |", result->bytes, result->iterations);
+    if (result->blocking.count > 0) {
+        printf(" %9.2f %9.2f %9.2f |", result->blocking.p50 * 1e6,
+               result->blocking.p90 * 1e6, result->blocking.p99 * 1e6);
+    } else {
+        printf(" %9s %9s %9s |", "-", "-", "-");
+    }
+    if (result->nonblocking.count > 0) {
+        printf(" %9.2f %9.2f %9.2f", result->nonblocking.p50 * 1e6,
+               result->nonblocking.p90 * 1e6, result->nonblocking.p99 * 1e6);
+    } else {
+        printf(" %9s %9s %9s", "-", "-", "-");
+    }
+    if (result->overlap >= 0.0) {
+        printf(" %7.0f%%\n", result->overlap);
+    } else {
+        printf(" %8s\n", "-");
+    }
+}
+
+// Add a latency distribution in microseconds
+void json_percentiles_us(bench_json_t *json, const char *key, const bench_percentiles_t *pct) {
+    bench_percentiles_t us = *pct;
+    us.min *= 1e6;
+    us.p50 *= 1e6;
+    us.p90 *= 1e6;
+    us.p99 *= 1e6;
+    us.max *= 1e6;
+    us.avg *= 1e6;
+    bench_json_percentiles(json, key, &us);
+}
+
+// Write the JSON record of this run (rank 0 only)
+void write_json_record(const coll_config_t *config, int world_size, const char *hosts,
+                       const coll_result_t *results, int num_results) {
+    bench_json_t json;
+
+    if (bench_json_open(&json, config->json_path) != 0) {
+        printf("Warning: could not write JSON record\n");
+        return;
+    }
+    bench_json_begin_object(&json, NULL);
+    bench_json_header(&json, "mpi-collectives", world_size, 1, hosts);
+
+    bench_json_begin_object(&json, "config");
+    bench_json_begin_array(&json, "collectives");
+    for (int i = 0; i < COLL_COUNT; i++) {
+        if (config->ops[i]) {
+            bench_json_string(&json, NULL, coll_op_name((coll_op_t)i));
+        }
+    }
+    bench_json_end_array(&json);
+    bench_json_int(&json, "min_bytes", (long long)config->min_bytes);
+    bench_json_int(&json, "max_bytes", (long long)config->max_bytes);
+    bench_json_begin_array(&json, "rank_counts");
+    for (int i = 0; i < config->num_rank_counts; i++) {
+        bench_json_int(&json, NULL, config->rank_counts[i]);
+    }
+    bench_json_end_array(&json);
+    bench_json_int(&json, "iterations", config->iterations);
+    bench_json_int(&json, "warmup", config->warmup);
+    bench_json_string(&json, "mode", config->mode == MODE_BOTH ? "both"
+                      : config->mode == MODE_BLOCKING ? "blocking" : "nonblocking");
+    bench_json_string(&json, "hugepages", bench_pages_name(bench_alloc_policy()));
+    bench_json_begin_object(&json, "mca");
+    for (char **env = environ; *env; env++) {
+        if (strncmp(*env, "OMPI_MCA_coll", 13) == 0) {
+            char name[256];
+            const char *eq = strchr(*env, '=');
+            snprintf(name, sizeof(name), "%.*s", (int)(eq - *env), *env);
+            bench_json_string(&json, name, eq + 1);
+        }
+    }
+    bench_json_end_object(&json);
+    bench_json_end_object(&json);
+
+    bench_json_begin_array(&json, "results");
+    for (int i = 0; i < num_results; i++) {
+        const coll_result_t *r = &results[i];
+        bench_json_begin_object(&json, NULL);
+        bench_json_string(&json, "collective", coll_op_name(r->op));
+        bench_json_int(&json, "ranks", r->ranks);
+        bench_json_int(&json, "bytes", (long long)r->bytes);
+        if (r->blocking.count > 0) {
+            json_percentiles_us(&json, "blocking_us", &r->blocking);
+        }
+        if (r->nonblocking.count > 0) {
+            json_percentiles_us(&json, "nonblocking_us", &r->nonblocking);
+        }
+        if (r->overlap >= 0.0) {
+            bench_json_double(&json, "overlap_pct", r->overlap);
+        }
+        bench_json_end_object(&json);
+    }
+    bench_json_end_array(&json);
+    bench_json_end_object(&json);
+
+    if (bench_json_close(&json) != 0) {
+        printf("Warning: error writing JSON record\n");
+    } else if (config->json_path) {
+        printf("JSON record written to %s\n", config->json_path);
+    }
+}
+
+int main(int argc, char **argv) {
+    int world_rank, world_size;
+    coll_config_t config;
+    coll_result_t *results = NULL;
+    int num_results = 0, max_results = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    if (parse_args(argc, argv, &config, world_size, world_rank) != 0) {
+        if (world_rank == 0) {
+            print_usage(argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    size_t buffer_bytes = coll_buffer_bytes(config.max_bytes, world_size);
+    coll_buffers_t buf;
+    buf.send = bench_alloc(buffer_bytes);
+    buf.recv = bench_alloc(buffer_bytes);
+    int max_iters = config.iterations;
+    double *local = malloc(max_iters * sizeof(double));
+    double *times = malloc(max_iters * sizeof(double));
+    if (!buf.send || !buf.recv || !local || !times) {
+        printf("Rank %d: Memory allocation failed (%zu bytes per buffer)\n",
+               world_rank, buffer_bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // Touch the pages once so first-iteration page faults stay out of the timings
+    memset(buf.send, 1, buffer_bytes);
+    memset(buf.recv, 0, buffer_bytes);
+    char backing[32];
+    bench_alloc_describe(buf.send, backing, sizeof(backing));
+
+    if (world_rank == 0) {
+        printf("========================================\n");
+        printf("MPI Collectives Microbenchmark\n");
+        printf("========================================\n");
+        printf("Processes: %d\n", world_size);
+        printf("Message sizes: %zu to %zu bytes (doubling)\n", config.min_bytes, config.max_bytes);
+        printf("Rank counts:");
+        for (int i = 0; i < config.num_rank_counts; i++) {
+            printf(" %d", config.rank_counts[i]);
+        }
+        printf("\nIterations: %d (fewer above %u bytes, at least %d), warm-up: %d\n",
+               config.iterations, LARGE_MESSAGE_BYTES, MIN_ITERATIONS, config.warmup);
+        printf("Buffer pages: %s (%s requested, %zu bytes per buffer on rank 0)\n", backing,
+               bench_pages_name(bench_alloc_policy()), buffer_bytes);
+        for (char **env = environ; *env; env++) {
+            if (strncmp(*env, "OMPI_MCA_coll", 13) == 0) {
+                printf("MCA: %s\n", *env);
+            }
+        }
+        printf("========================================\n");
+    }
+
+    double start_time = MPI_Wtime();
+    for (int c = 0; c < config.num_rank_counts; c++) {
+        int ranks = config.rank_counts[c];
+        MPI_Comm_split(MPI_COMM_WORLD, world_rank < ranks ? 0 : MPI_UNDEFINED, world_rank,
+                       &buf.comm);
+
+        // Ranks outside the communicator wait at the world barrier
+        if (buf.comm != MPI_COMM_NULL) {
+            for (int i = 0; i < COLL_COUNT; i++) {
+                if (!config.ops[i]) {
+                    continue;
+                }
+                coll_op_t op = (coll_op_t)i;
+                if (world_rank == 0) {
+                    print_table_header(op, ranks);
+                }
+                for (size_t bytes = config.min_bytes; bytes <= config.max_bytes; bytes *= 2) {
+                    coll_result_t result;
+                    measure(&config, op, &buf, op == COLL_BARRIER ? 0 : bytes, local, times,
+                            &result);
+                    if (world_rank == 0) {
+                        print_result(&result);
+                        fflush(stdout);
+                        if (num_results == max_results) {
+                            max_results = max_results ? 2 * max_results : 64;
+                            results = realloc(results, max_results * sizeof(coll_result_t));
+                            if (!results) {
+                                printf("Memory allocation failed for results\n");
+                                MPI_Abort(MPI_COMM_WORLD, 1);
+                            }
+                        }
+                        results[num_results++] = result;
+                    }
+                    if (op == COLL_BARRIER) {
+                        break;      // Size does not apply
+                    }
+                }
+            }
+            MPI_Comm_free(&buf.comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+    double elapsed = MPI_Wtime() - start_time;
+
+    char *hosts = config.json ? bench_gather_hosts() : NULL;
+    if (world_rank == 0) {
+        printf("\n========================================\n");
+        printf("Measurements: %d in %.2f seconds\n", num_results, elapsed);
+        printf("========================================\n");
+        if (config.json) {
+            write_json_record(&config, world_size, hosts, results, num_results);
+        }
+    }
+
+    free(hosts);
+    free(results);
+    free(local);
+    free(times);
+    bench_free(buf.send);
+    bench_free(buf.recv);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Collective operations timed by the MPI collectives benchmark
+ */
+
+#include "coll-ops.h"
+
+#include <string.h>
+
+static const char *const coll_names[COLL_COUNT] = {
+    "barrier", "bcast", "reduce", "allreduce", "gather", "scatter", "allgather", "alltoall",
+};
+
+int coll_op_from_name(const char *name, coll_op_t *op) {
+    for (int i = 0; i < COLL_COUNT; i++) {
+        if (strcmp(name, coll_names[i]) == 0) {
+            *op = (coll_op_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *coll_op_name(coll_op_t op) {
+    return op >= 0 && op < COLL_COUNT ? coll_names[op] : "unknown";
+}
+
+size_t coll_buffer_bytes(size_t max_bytes, int ranks) {
+    return max_bytes * (size_t)ranks;
+}
+
+void coll_op_run(coll_op_t op, const coll_buffers_t *buf, size_t bytes, MPI_Request *request) {
+    MPI_Comm comm = buf->comm;
+    int count = (int)bytes;
+    int floats = (int)(bytes / sizeof(float));
+
+    switch (op) {
+    case COLL_BARRIER:
+        if (request) {
+            MPI_Ibarrier(comm, request);
+        } else {
+            MPI_Barrier(comm);
+        }
+        break;
+    case COLL_BCAST:
+        if (request) {
+            MPI_Ibcast(buf->send, count, MPI_BYTE, 0, comm, request);
+        } else {
+            MPI_Bcast(buf->send, count, MPI_BYTE, 0, comm);
+        }
+        break;
+    case COLL_REDUCE:
+        if (request) {
+            MPI_Ireduce(buf->send, buf->recv, floats, MPI_FLOAT, MPI_SUM, 0, comm, request);
+        } else {
+            MPI_Reduce(buf->send, buf->recv, floats, MPI_FLOAT, MPI_SUM, 0, comm);
+        }
+        break;
+    case COLL_ALLREDUCE:
+        if (request) {
+            MPI_Iallreduce(buf->send, buf->recv, floats, MPI_FLOAT, MPI_SUM, comm, request);
+        } else {
+            MPI_Allreduce(buf->send, buf->recv, floats, MPI_FLOAT, MPI_SUM, comm);
+        }
+        break;
+    case COLL_GATHER:
+        if (request) {
+            MPI_Igather(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, 0, comm, request);
+        } else {
+            MPI_Gather(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, 0, comm);
+        }
+        break;
+    case COLL_SCATTER:
+        if (request) {
+            MPI_Iscatter(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, 0, comm, request);
+        } else {
+            MPI_Scatter(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, 0, comm);
+        }
+        break;
+    case COLL_ALLGATHER:
+        if (request) {
+            MPI_Iallgather(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, comm, request);
+        } else {
+            MPI_Allgather(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, comm);
+        }
+        break;
+    case COLL_ALLTOALL:
+        if (request) {
+            MPI_Ialltoall(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, comm, request);
+        } else {
+            MPI_Alltoall(buf->send, count, MPI_BYTE, buf->recv, count, MPI_BYTE, comm);
+        }
+        break;
+    default:
+        break;
+    }
+}
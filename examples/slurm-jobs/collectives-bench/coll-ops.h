@@ -0,0 +1,48 @@
+/*
+ * Collective operations timed by the MPI collectives benchmark
+ *
+ * Each operation has a blocking and a nonblocking (MPI-3 I*) form with the
+ * same arguments. Message size conventions follow the OSU benchmarks:
+ * bcast/reduce/allreduce move `bytes` in total, gather/scatter/allgather
+ * move `bytes` per rank and alltoall `bytes` per rank pair (so the send and
+ * receive buffers hold bytes * ranks). Reductions sum floats; barrier
+ * ignores the size.
+ */
+
+#ifndef COLL_OPS_H
+#define COLL_OPS_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+typedef enum {
+    COLL_BARRIER,
+    COLL_BCAST,
+    COLL_REDUCE,
+    COLL_ALLREDUCE,
+    COLL_GATHER,
+    COLL_SCATTER,
+    COLL_ALLGATHER,
+    COLL_ALLTOALL,
+    COLL_COUNT
+} coll_op_t;
+
+// Send/receive buffers sized for the largest message (see coll_buffer_bytes)
+typedef struct {
+    MPI_Comm comm;
+    void *send;
+    void *recv;
+} coll_buffers_t;
+
+// Parse/print an operation name ("allreduce", ...); returns 0 on success
+int coll_op_from_name(const char *name, coll_op_t *op);
+const char *coll_op_name(coll_op_t op);
+
+// Bytes each of send/recv must hold for messages up to max_bytes on ranks
+size_t coll_buffer_bytes(size_t max_bytes, int ranks);
+
+// Run op once: blocking when request is NULL, otherwise start it and
+// return the request in *request (root is rank 0)
+void coll_op_run(coll_op_t op, const coll_buffers_t *buf, size_t bytes, MPI_Request *request);
+
+#endif /* COLL_OPS_H */
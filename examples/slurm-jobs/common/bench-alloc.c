@@ -0,0 +1,331 @@
+/*
+ * Aligned and huge-page backed buffers shared by the MPI examples
+ */
+
+#define _GNU_SOURCE
+#include "bench-alloc.h"
+
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bench-report.h"
+
+#define SIZE_2M ((size_t)2 << 20)
+#define SIZE_1G ((size_t)1 << 30)
+
+// Older headers lack the size flags (log2(page size) << MAP_HUGE_SHIFT)
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_2MB)
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_1GB)
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+// One mmap-backed buffer; small buffers come from posix_memalign and are
+// not recorded
+typedef struct alloc_record {
+    void *ptr;
+    size_t len;             // Mapped length
+    bench_pages_t pages;    // Backing obtained
+    struct alloc_record *next;
+} alloc_record_t;
+
+static alloc_record_t *records = NULL;
+static int policy_set = 0;
+static bench_pages_t policy = BENCH_PAGES_THP;
+
+static const char *const pages_names[] = {"none", "thp", "2m", "1g"};
+
+int bench_pages_from_name(const char *name, bench_pages_t *pages) {
+    for (int i = 0; i <= BENCH_PAGES_1G; i++) {
+        if (strcmp(name, pages_names[i]) == 0) {
+            *pages = (bench_pages_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *bench_pages_name(bench_pages_t pages) {
+    return pages >= BENCH_PAGES_NONE && pages <= BENCH_PAGES_1G ? pages_names[pages] : "unknown";
+}
+
+int bench_alloc_option(const char *arg) {
+    if (strncmp(arg, "--hugepages=", 12) != 0) {
+        return 0;
+    }
+    if (bench_pages_from_name(arg + 12, &policy) != 0) {
+        return -1;
+    }
+    policy_set = 1;
+    return 1;
+}
+
+bench_pages_t bench_alloc_policy(void) {
+    if (!policy_set) {
+        const char *env = getenv("BENCH_HUGEPAGES");
+        if (env && *env && bench_pages_from_name(env, &policy) != 0) {
+            fprintf(stderr, "Warning: unknown BENCH_HUGEPAGES '%s', using thp\n", env);
+            policy = BENCH_PAGES_THP;
+        }
+        policy_set = 1;
+    }
+    return policy;
+}
+
+static size_t round_up(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+#ifdef MAP_HUGETLB
+static void *map_hugetlb(size_t len, int size_flag) {
+    void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+#endif
+
+// Anonymous mapping of len bytes starting on a 2 MB boundary
+static void *map_aligned(size_t len) {
+    size_t span = len + SIZE_2M;
+    char *raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    char *start = (char *)round_up((uintptr_t)raw, SIZE_2M);
+    size_t head = (size_t)(start - raw);
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (span - head > len) {
+        munmap(start + len, span - head - len);
+    }
+    return start;
+}
+
+void *bench_alloc(size_t bytes) {
+    bench_pages_t want = bench_alloc_policy();
+    bench_pages_t got = BENCH_PAGES_NONE;
+    void *ptr = NULL;
+    size_t len = 0;
+
+    if (bytes < BENCH_ALLOC_HUGE_MIN) {
+        if (posix_memalign(&ptr, BENCH_ALLOC_ALIGNMENT, bytes > 0 ? bytes : 1) != 0) {
+            return NULL;
+        }
+        return ptr;
+    }
+
+#ifdef MAP_HUGETLB
+    if (want == BENCH_PAGES_1G) {
+        len = round_up(bytes, SIZE_1G);
+        ptr = map_hugetlb(len, MAP_HUGE_1GB);
+        got = BENCH_PAGES_1G;
+    }
+    if (!ptr && want >= BENCH_PAGES_2M) {
+        len = round_up(bytes, SIZE_2M);
+        ptr = map_hugetlb(len, MAP_HUGE_2MB);
+        got = BENCH_PAGES_2M;
+    }
+#endif
+    if (!ptr) {
+        // No reserved hugetlbfs pages left: transparent huge pages, or
+        // ordinary pages kept out of THP so "none" really measures 4 KB
+        len = round_up(bytes, SIZE_2M);
+        ptr = map_aligned(len);
+        if (!ptr) {
+            return NULL;
+        }
+        got = want == BENCH_PAGES_NONE ? BENCH_PAGES_NONE : BENCH_PAGES_THP;
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, len, got == BENCH_PAGES_THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
+    }
+
+    alloc_record_t *record = malloc(sizeof(*record));
+    if (!record) {
+        munmap(ptr, len);
+        return NULL;
+    }
+    record->ptr = ptr;
+    record->len = len;
+    record->pages = got;
+    record->next = records;
+    records = record;
+    return ptr;
+}
+
+static alloc_record_t *find_record(const void *ptr, alloc_record_t ***link) {
+    alloc_record_t **prev = &records;
+    for (alloc_record_t *r = records; r; prev = &r->next, r = r->next) {
+        if (r->ptr == ptr) {
+            if (link) {
+                *link = prev;
+            }
+            return r;
+        }
+    }
+    return NULL;
+}
+
+void bench_free(void *ptr) {
+    alloc_record_t **link;
+    alloc_record_t *record;
+
+    if (!ptr) {
+        return;
+    }
+    record = find_record(ptr, &link);
+    if (!record) {
+        free(ptr);
+        return;
+    }
+    *link = record->next;
+    munmap(record->ptr, record->len);
+    free(record);
+}
+
+bench_pages_t bench_alloc_pages(const void *ptr) {
+    alloc_record_t *record = find_record(ptr, NULL);
+    return record ? record->pages : BENCH_PAGES_NONE;
+}
+
+// AnonHugePages of the mappings overlapping [start, end), in bytes
+static size_t thp_bytes(uintptr_t start, uintptr_t end) {
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    char line[256];
+    int inside = 0;
+    size_t total = 0;
+
+    if (!fp) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long lo, hi, kb;
+        if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+            inside = lo < end && hi > start;
+        } else if (inside && sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) {
+            total += (size_t)kb << 10;
+        }
+    }
+    fclose(fp);
+    return total;
+}
+
+size_t bench_alloc_huge_bytes(const void *ptr) {
+    alloc_record_t *record = find_record(ptr, NULL);
+    if (!record || record->pages == BENCH_PAGES_NONE) {
+        return 0;
+    }
+    if (record->pages == BENCH_PAGES_THP) {
+        return thp_bytes((uintptr_t)record->ptr, (uintptr_t)record->ptr + record->len);
+    }
+    return record->len;
+}
+
+// Description from the backing kind and the share of huge-page bytes
+static void format_backing(bench_pages_t pages, double huge_share, char *out, size_t len) {
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+
+    if (pages == BENCH_PAGES_NONE) {
+        snprintf(out, len, "%ldK", page_kb > 0 ? page_kb : 4);
+    } else if (pages == BENCH_PAGES_THP) {
+        snprintf(out, len, "thp %.0f%%", 100.0 * huge_share);
+    } else {
+        snprintf(out, len, "hugetlb %s", pages == BENCH_PAGES_1G ? "1G" : "2M");
+    }
+}
+
+void bench_alloc_describe(const void *ptr, char *out, size_t len) {
+    alloc_record_t *record = find_record(ptr, NULL);
+
+    if (!record) {
+        format_backing(BENCH_PAGES_NONE, 0.0, out, len);
+    } else {
+        format_backing(record->pages, (double)bench_alloc_huge_bytes(ptr) / record->len,
+                       out, len);
+    }
+}
+
+double bench_alloc_report(const bench_numa_buffer_t *buffers, int count,
+                          long long dtlb_misses) {
+    int world_size, world_rank;
+    // Per rank: dTLB misses, then backing kind, bytes and huge bytes per buffer
+    int fields = 1 + 3 * BENCH_NUMA_MAX_BUFFERS;
+    long long record[1 + 3 * BENCH_NUMA_MAX_BUFFERS];
+    long long *all = NULL;
+    double min_huge = -1.0;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    if (count > BENCH_NUMA_MAX_BUFFERS) {
+        count = BENCH_NUMA_MAX_BUFFERS;
+    }
+
+    memset(record, 0, sizeof(record));
+    record[0] = dtlb_misses;
+    for (int b = 0; b < count; b++) {
+        size_t huge = bench_alloc_huge_bytes(buffers[b].ptr);
+        record[1 + 3 * b] = bench_alloc_pages(buffers[b].ptr);
+        record[2 + 3 * b] = (long long)buffers[b].bytes;
+        record[3 + 3 * b] = (long long)(huge < buffers[b].bytes ? huge : buffers[b].bytes);
+    }
+
+    char *hosts = bench_gather_hosts();
+    if (world_rank == 0) {
+        all = malloc((size_t)world_size * fields * sizeof(long long));
+        if (!all) {
+            printf("Memory allocation failed for page backing report\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(record, fields, MPI_LONG_LONG, all, fields, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    if (world_rank == 0) {
+        printf("\n========================================\n");
+        printf("Page Backing (policy: %s)\n", bench_pages_name(bench_alloc_policy()));
+        printf("========================================\n");
+        printf("%6s  %-16s", "Rank", "Host");
+        for (int b = 0; b < count; b++) {
+            printf(" %-12s", buffers[b].name);
+        }
+        printf(" %6s %16s\n", "Huge", "dTLB misses");
+
+        for (int r = 0; r < world_size; r++) {
+            const long long *rec = all + (size_t)r * fields;
+            double huge = 0.0, total = 0.0;
+
+            printf("%6d  %-16.16s", r, hosts + (size_t)r * MPI_MAX_PROCESSOR_NAME);
+            for (int b = 0; b < count; b++) {
+                char backing[32];
+                double bytes = (double)rec[2 + 3 * b];
+                format_backing((bench_pages_t)rec[1 + 3 * b],
+                               bytes > 0.0 ? rec[3 + 3 * b] / bytes : 0.0,
+                               backing, sizeof(backing));
+                printf(" %-12s", backing);
+                huge += (double)rec[3 + 3 * b];
+                total += bytes;
+            }
+            double share = total > 0.0 ? huge / total : 0.0;
+            min_huge = (min_huge < 0.0 || share < min_huge) ? share : min_huge;
+            printf(" %5.0f%%", 100.0 * share);
+            if (rec[0] >= 0) {
+                printf(" %16lld\n", rec[0]);
+            } else {
+                printf(" %16s\n", "n/a");
+            }
+        }
+        printf("========================================\n");
+        free(all);
+        free(hosts);
+    }
+    return min_huge;
+}
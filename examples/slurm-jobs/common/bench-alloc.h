@@ -0,0 +1,79 @@
+/*
+ * Aligned and huge-page backed buffers shared by the MPI examples
+ *
+ * Large matrices on 4 KB pages need one TLB entry per 4 KB; an n = 8000
+ * double matrix is 125k pages, far beyond any TLB. Backing it with 2 MB
+ * (or 1 GB) pages cuts that by 512x (or 262144x). bench_alloc() returns
+ * memory for one of these policies, falling back to the next one down when
+ * the system cannot provide it:
+ *
+ *   1g    hugetlbfs 1 GB pages (MAP_HUGETLB | MAP_HUGE_1GB)
+ *   2m    hugetlbfs 2 MB pages (MAP_HUGETLB | MAP_HUGE_2MB)
+ *   thp   2 MB-aligned anonymous mapping with madvise(MADV_HUGEPAGE)
+ *         (the default; works whenever THP is "always" or "madvise")
+ *   none  ordinary pages
+ *
+ * Every buffer is at least BENCH_ALLOC_ALIGNMENT-byte aligned (cache line
+ * and AVX-512 vector width) and page aligned once it reaches
+ * BENCH_ALLOC_HUGE_MIN, which is also the smallest size given huge pages.
+ * hugetlbfs pages must be reserved by the administrator
+ * (vm.nr_hugepages, or hugepagesz=1G hugepages=N on the kernel command line).
+ *
+ * The policy comes from --hugepages=MODE (bench_alloc_option) or the
+ * BENCH_HUGEPAGES environment variable. Pages are not touched, so NUMA
+ * first touch (bench-numa.h) still decides placement. Pair the report with
+ * a dTLB-miss count (bench-perf.h) to see what the page size bought.
+ */
+
+#ifndef BENCH_ALLOC_H
+#define BENCH_ALLOC_H
+
+#include <stddef.h>
+
+#include "bench-numa.h"
+
+#define BENCH_ALLOC_ALIGNMENT 64
+#define BENCH_ALLOC_HUGE_MIN (2u << 20)
+
+typedef enum {
+    BENCH_PAGES_NONE = 0,
+    BENCH_PAGES_THP,
+    BENCH_PAGES_2M,
+    BENCH_PAGES_1G
+} bench_pages_t;
+
+// Parse/print a policy name ("none", "thp", "2m", "1g"); returns 0 on success
+int bench_pages_from_name(const char *name, bench_pages_t *pages);
+const char *bench_pages_name(bench_pages_t pages);
+
+// Handle "--hugepages=MODE": returns 1 if consumed, -1 if the mode is
+// invalid, 0 if arg is another option
+int bench_alloc_option(const char *arg);
+
+// Policy in effect (option, else BENCH_HUGEPAGES, else thp)
+bench_pages_t bench_alloc_policy(void);
+
+// Allocate `bytes` under the policy (NULL on failure); release with
+// bench_free(). Not thread-safe: allocate from the main thread.
+void *bench_alloc(size_t bytes);
+void bench_free(void *ptr);
+
+// Page size a buffer actually got: hugetlb kinds map whole buffers; for
+// thp and none this is BENCH_PAGES_THP/NONE as requested, and
+// bench_alloc_huge_bytes() tells how much the kernel really promoted
+bench_pages_t bench_alloc_pages(const void *ptr);
+
+// Bytes of the buffer resident on huge pages (hugetlb: the whole mapping;
+// thp: AnonHugePages from /proc/self/smaps); 0 if none or unknown
+size_t bench_alloc_huge_bytes(const void *ptr);
+
+// Short description of the backing, e.g. "hugetlb 2M", "thp 96%", "4K"
+void bench_alloc_describe(const void *ptr, char *out, size_t len);
+
+// Print a per-rank "Page Backing" table of the buffers (the same list as
+// the NUMA report) plus dtlb_misses (< 0 prints n/a) on rank 0. Returns (on
+// rank 0) the lowest share of a rank's buffer bytes on huge pages. Collective.
+double bench_alloc_report(const bench_numa_buffer_t *buffers, int count,
+                          long long dtlb_misses);
+
+#endif /* BENCH_ALLOC_H */
@@ -0,0 +1,238 @@
+/*
+ * Asynchronous checkpoints on shared storage shared by the MPI examples
+ */
+
+#include "bench-checkpoint.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_CKPT_MAGIC "BENCKPT1"
+
+// Print an MPI-IO error for the checkpoint file
+static void io_error(const char *what, const char *path, int err) {
+    char message[MPI_MAX_ERROR_STRING];
+    int length, rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Error_string(err, message, &length);
+    printf("Rank %d: %s checkpoint %s failed: %s\n", rank, what, path, message);
+}
+
+void bench_ckpt_header_init(bench_ckpt_header_t *header, const char *benchmark) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, BENCH_CKPT_MAGIC, sizeof(header->magic));
+    strncpy(header->benchmark, benchmark, sizeof(header->benchmark) - 1);
+}
+
+int bench_ckpt_open(bench_ckpt_t *ckpt, const char *dir, const char *name, double interval,
+                    const bench_ckpt_header_t *header) {
+    int rank, err;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    memset(ckpt, 0, sizeof(*ckpt));
+    snprintf(ckpt->path, sizeof(ckpt->path), "%s/%s", dir, name);
+    ckpt->interval = interval;
+
+    err = MPI_File_open(MPI_COMM_WORLD, ckpt->path, MPI_MODE_CREATE | MPI_MODE_RDWR,
+                        MPI_INFO_NULL, &ckpt->fh);
+    if (err != MPI_SUCCESS) {
+        io_error("Opening", ckpt->path, err);
+        return -1;
+    }
+
+    // Rank 0 compares the header; a partial or foreign file starts over
+    if (rank == 0) {
+        bench_ckpt_header_t found;
+        MPI_Status status;
+        int count = 0;
+        if (MPI_File_read_at(ckpt->fh, 0, &found, sizeof(found), MPI_BYTE, &status)
+            == MPI_SUCCESS) {
+            MPI_Get_count(&status, MPI_BYTE, &count);
+        }
+        ckpt->resumed = count == (int)sizeof(found)
+                        && memcmp(&found, header, sizeof(found)) == 0;
+    }
+    MPI_Bcast(&ckpt->resumed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    if (!ckpt->resumed) {
+        err = MPI_File_set_size(ckpt->fh, 0);
+        if (err == MPI_SUCCESS && rank == 0) {
+            err = MPI_File_write_at(ckpt->fh, 0, header, sizeof(*header), MPI_BYTE,
+                                    MPI_STATUS_IGNORE);
+        }
+        if (err != MPI_SUCCESS) {
+            io_error("Initializing", ckpt->path, err);
+            MPI_File_close(&ckpt->fh);
+            return -1;
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    ckpt->last = MPI_Wtime();
+    return 0;
+}
+
+int bench_ckpt_read(bench_ckpt_t *ckpt, MPI_Offset offset, void *buf, int count,
+                    MPI_Datatype type) {
+    MPI_Status status;
+    int read = 0;
+
+    double t0 = MPI_Wtime();
+    int err = MPI_File_read_at(ckpt->fh, offset, buf, count, type, &status);
+    if (err != MPI_SUCCESS) {
+        io_error("Reading", ckpt->path, err);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Get_count(&status, type, &read);
+    ckpt->stats.restore += MPI_Wtime() - t0;
+    return read == MPI_UNDEFINED ? 0 : read;
+}
+
+int bench_ckpt_due(const bench_ckpt_t *ckpt) {
+    return MPI_Wtime() - ckpt->last >= ckpt->interval;
+}
+
+// The writes in flight completed at `now`
+static void writes_done(bench_ckpt_t *ckpt, double now) {
+    if (ckpt->pending > 0) {
+        ckpt->stats.flight += now - ckpt->started;
+        ckpt->pending = 0;
+    }
+}
+
+void bench_ckpt_wait(bench_ckpt_t *ckpt) {
+    if (ckpt->pending == 0) {
+        return;
+    }
+    double t0 = MPI_Wtime();
+    int err = MPI_Waitall(ckpt->pending, ckpt->requests, MPI_STATUSES_IGNORE);
+    if (err != MPI_SUCCESS) {
+        io_error("Writing", ckpt->path, err);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    double t1 = MPI_Wtime();
+    writes_done(ckpt, t1);
+    ckpt->stats.overhead += t1 - t0;
+}
+
+int bench_ckpt_test(bench_ckpt_t *ckpt) {
+    int done;
+
+    if (ckpt->pending == 0) {
+        return 1;
+    }
+    double t0 = MPI_Wtime();
+    int err = MPI_Testall(ckpt->pending, ckpt->requests, &done, MPI_STATUSES_IGNORE);
+    if (err != MPI_SUCCESS) {
+        io_error("Writing", ckpt->path, err);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    double t1 = MPI_Wtime();
+    if (done) {
+        writes_done(ckpt, t1);
+    }
+    ckpt->stats.overhead += t1 - t0;
+    return done;
+}
+
+void bench_ckpt_begin(bench_ckpt_t *ckpt) {
+    bench_ckpt_wait(ckpt);
+    ckpt->stats.checkpoints++;
+    ckpt->last = MPI_Wtime();
+}
+
+void bench_ckpt_write(bench_ckpt_t *ckpt, MPI_Offset offset, const void *buf, int count,
+                      MPI_Datatype type) {
+    int type_size;
+
+    if (ckpt->pending == BENCH_CKPT_MAX_WRITES) {
+        bench_ckpt_wait(ckpt);
+    }
+    double t0 = MPI_Wtime();
+    if (ckpt->pending == 0) {
+        ckpt->started = t0;
+    }
+    int err = MPI_File_iwrite_at(ckpt->fh, offset, buf, count, type,
+                                 &ckpt->requests[ckpt->pending]);
+    if (err != MPI_SUCCESS) {
+        io_error("Writing", ckpt->path, err);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    ckpt->pending++;
+    MPI_Type_size(type, &type_size);
+    ckpt->stats.bytes += (double)count * type_size;
+    ckpt->stats.overhead += MPI_Wtime() - t0;
+}
+
+void bench_ckpt_close(bench_ckpt_t *ckpt, int remove) {
+    int rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    bench_ckpt_wait(ckpt);
+    MPI_File_close(&ckpt->fh);
+    if (remove) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0) {
+            MPI_File_delete(ckpt->path, MPI_INFO_NULL);
+        }
+    }
+}
+
+bench_ckpt_summary_t bench_ckpt_summarize(const bench_ckpt_t *ckpt) {
+    bench_ckpt_summary_t summary;
+    const bench_ckpt_stats_t *st = &ckpt->stats;
+    double sums[4] = {st->bytes, st->restored, st->flight, st->checkpoints};
+    double totals[4];
+
+    // Ranks without writes (pi with --target-error: all but rank 0) drop
+    // out of the write rates
+    MPI_Reduce(sums, totals, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    summary.interval = ckpt->interval;
+    summary.resumed = ckpt->resumed;
+    summary.total_bytes = totals[0];
+    summary.total_restored = totals[1];
+    summary.write_time = totals[3] > 0.0 ? totals[2] / totals[3] : 0.0;
+    summary.write_mbps = totals[2] > 0.0 ? totals[0] / totals[2] / 1e6 : 0.0;
+    summary.checkpoints = bench_reduce_stats(st->checkpoints);
+    summary.overhead = bench_reduce_stats(st->overhead);
+    summary.restore = bench_reduce_stats(st->restore);
+    return summary;
+}
+
+void bench_ckpt_print(const bench_ckpt_summary_t *summary, const char *path,
+                      const char *restored_unit, double compute) {
+    printf("Checkpoints: %.0f per rank (max, every %g s), %.3g MB written to %s\n",
+           summary->checkpoints.max, summary->interval, summary->total_bytes / 1e6, path);
+    if (compute > 0.0) {
+        printf("Checkpoint overhead: %.3f seconds (slowest rank, %.2f%% of compute)\n",
+               summary->overhead.max, 100.0 * summary->overhead.max / compute);
+    } else {
+        printf("Checkpoint overhead: %.3f seconds (slowest rank)\n", summary->overhead.max);
+    }
+    if (summary->checkpoints.max > 0.0) {
+        printf("Checkpoint write time: %.3f seconds per checkpoint, %.3g MB/s per writing"
+               " rank (lower bounds)\n", summary->write_time, summary->write_mbps);
+    }
+    if (summary->resumed) {
+        printf("Restart: resumed %.0f %s from the checkpoint (%.3f seconds to read)\n",
+               summary->total_restored, restored_unit, summary->restore.max);
+    } else {
+        printf("Restart: none (new checkpoint)\n");
+    }
+}
+
+void bench_ckpt_json(bench_json_t *json, const bench_ckpt_summary_t *summary,
+                     const char *path) {
+    bench_json_begin_object(json, "checkpoint");
+    bench_json_string(json, "path", path);
+    bench_json_double(json, "interval", summary->interval);
+    bench_json_bool(json, "resumed", summary->resumed);
+    bench_json_double(json, "restored", summary->total_restored);
+    bench_json_stats(json, "restore", &summary->restore);
+    bench_json_stats(json, "checkpoints", &summary->checkpoints);
+    bench_json_double(json, "bytes", summary->total_bytes);
+    bench_json_stats(json, "overhead", &summary->overhead);
+    bench_json_double(json, "write_time", summary->write_time);
+    bench_json_double(json, "write_mbps", summary->write_mbps);
+    bench_json_end_object(json);
+}
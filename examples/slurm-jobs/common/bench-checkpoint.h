@@ -0,0 +1,124 @@
+/*
+ * Asynchronous checkpoints on shared storage (--checkpoint=DIR)
+ *
+ * One checkpoint file per run on the parallel file system (BeeGFS under
+ * /mnt/beegfs in the cluster), written with non-blocking MPI-IO: each rank
+ * starts its writes with MPI_File_iwrite_at and keeps computing while they
+ * complete. A header identifies the run; when a job restarts (after a
+ * time limit or preemption and requeue) with the same parameters, the
+ * example reads its records back and resumes, otherwise the file starts
+ * over. The file is removed once the run completes. The examples lay out
+ * their own records after BENCH_CKPT_DATA_OFFSET and decide what is safe to
+ * resume from.
+ *
+ * Overhead is the time a rank lost to checkpointing: starting writes,
+ * testing for their completion and waiting for writes still in flight at
+ * the next checkpoint or the end of the run. The write time runs from
+ * starting writes to seeing them complete; completion is only checked
+ * between compute steps, so the write bandwidth derived from it is a lower
+ * bound. A checkpoint interval well above the write time keeps writes from
+ * piling up.
+ */
+
+#ifndef BENCH_CHECKPOINT_H
+#define BENCH_CHECKPOINT_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "bench-report.h"
+
+#define BENCH_CKPT_DEFAULT_INTERVAL 60.0    // Seconds between checkpoints
+#define BENCH_CKPT_MAX_WRITES 4             // Writes in flight per rank
+#define BENCH_CKPT_DATA_OFFSET 4096         // Records start after the header
+#define BENCH_CKPT_PARAMS 8
+
+// Identifies the run a checkpoint belongs to; every byte must match to resume
+typedef struct {
+    char magic[8];
+    char benchmark[24];
+    int64_t params[BENCH_CKPT_PARAMS];  // Run parameters (example-defined)
+} bench_ckpt_header_t;
+
+// Per-rank checkpoint accounting
+typedef struct {
+    double checkpoints;     // Checkpoints taken
+    double bytes;           // Bytes written
+    double overhead;        // Seconds lost starting, testing and waiting for writes
+    double flight;          // Seconds from starting writes to their completion
+    double restore;         // Seconds reading the checkpoint back on restart
+    double restored;        // Work taken from the checkpoint (example units)
+} bench_ckpt_stats_t;
+
+typedef struct {
+    MPI_File fh;
+    char path[4096];
+    int resumed;            // The file held a checkpoint of this run
+    double interval;        // Seconds between checkpoints (0 = every step)
+    double last;            // Time of the last checkpoint
+    MPI_Request requests[BENCH_CKPT_MAX_WRITES];
+    int pending;            // Writes in flight
+    double started;         // When the first of them was started
+    bench_ckpt_stats_t stats;
+} bench_ckpt_t;
+
+// Checkpoint accounting of the ranks (valid on rank 0)
+typedef struct {
+    double interval;
+    int resumed;
+    double total_bytes;
+    double total_restored;
+    double write_time;          // Seconds to write one checkpoint (average)
+    double write_mbps;          // Per writing rank (lower bound)
+    bench_stats_t checkpoints;
+    bench_stats_t overhead;
+    bench_stats_t restore;
+} bench_ckpt_summary_t;
+
+// Zeroed header with the magic and benchmark name set
+void bench_ckpt_header_init(bench_ckpt_header_t *header, const char *benchmark);
+
+// Open (or create) dir/name on MPI_COMM_WORLD. If it holds the same header
+// the checkpoint is kept (ckpt->resumed = 1), otherwise it is truncated and
+// the header written. Returns 0 on success, -1 after printing the MPI-IO
+// error. Collective.
+int bench_ckpt_open(bench_ckpt_t *ckpt, const char *dir, const char *name, double interval,
+                    const bench_ckpt_header_t *header);
+
+// Read count elements at offset (this rank only, blocking, counted as
+// restore time); returns the number of elements read, 0 past the end of file
+int bench_ckpt_read(bench_ckpt_t *ckpt, MPI_Offset offset, void *buf, int count,
+                    MPI_Datatype type);
+
+// Nonzero once the interval has passed since the last checkpoint
+int bench_ckpt_due(const bench_ckpt_t *ckpt);
+
+// Start a checkpoint: waits for the writes of the previous one
+void bench_ckpt_begin(bench_ckpt_t *ckpt);
+
+// Start writing count elements of buf at offset; buf must stay unchanged
+// until the write completes (bench_ckpt_test/wait/begin). Aborts on error.
+void bench_ckpt_write(bench_ckpt_t *ckpt, MPI_Offset offset, const void *buf, int count,
+                      MPI_Datatype type);
+
+// Nonzero if no write is in flight any more
+int bench_ckpt_test(bench_ckpt_t *ckpt);
+void bench_ckpt_wait(bench_ckpt_t *ckpt);
+
+// Wait for the writes and close; with remove the file is deleted (the run
+// completed). Collective.
+void bench_ckpt_close(bench_ckpt_t *ckpt, int remove);
+
+// Reduce the accounting of every rank over MPI_COMM_WORLD. Collective.
+bench_ckpt_summary_t bench_ckpt_summarize(const bench_ckpt_t *ckpt);
+
+// Report lines for rank 0; restored_unit names the example's work units
+// (e.g. "rows of C"), compute is the compute time the overhead compares to
+void bench_ckpt_print(const bench_ckpt_summary_t *summary, const char *path,
+                      const char *restored_unit, double compute);
+
+// "checkpoint" member of a JSON record
+void bench_ckpt_json(bench_json_t *json, const bench_ckpt_summary_t *summary,
+                     const char *path);
+
+#endif /* BENCH_CHECKPOINT_H */
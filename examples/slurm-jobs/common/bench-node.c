@@ -0,0 +1,101 @@
+/*
+ * Node-aware communication shared by the MPI examples
+ */
+
+#include "bench-node.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void bench_node_init(bench_node_t *node, MPI_Comm comm) {
+    int rank;
+
+    MPI_Comm_rank(comm, &rank);
+    // Keys keep the parent order, so parent rank 0 leads its node and the
+    // leaders' communicator
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node->node);
+    MPI_Comm_rank(node->node, &node->node_rank);
+    MPI_Comm_size(node->node, &node->node_size);
+    MPI_Comm_split(comm, node->node_rank == 0 ? 0 : MPI_UNDEFINED, rank, &node->leaders);
+
+    if (node->leaders != MPI_COMM_NULL) {
+        MPI_Comm_rank(node->leaders, &node->node_index);
+        MPI_Comm_size(node->leaders, &node->num_nodes);
+    }
+    MPI_Bcast(&node->node_index, 1, MPI_INT, 0, node->node);
+    MPI_Bcast(&node->num_nodes, 1, MPI_INT, 0, node->node);
+    MPI_Allreduce(&node->node_size, &node->max_node_size, 1, MPI_INT, MPI_MAX, comm);
+}
+
+void bench_node_free(bench_node_t *node) {
+    if (node->leaders != MPI_COMM_NULL) {
+        MPI_Comm_free(&node->leaders);
+    }
+    MPI_Comm_free(&node->node);
+}
+
+int *bench_node_map(const bench_node_t *node, MPI_Comm comm) {
+    int size;
+
+    MPI_Comm_size(comm, &size);
+    int *map = malloc((size_t)size * sizeof(int));
+    if (!map) {
+        printf("Memory allocation failed for the node map\n");
+        MPI_Abort(comm, 1);
+    }
+    MPI_Allgather(&node->node_index, 1, MPI_INT, map, 1, MPI_INT, comm);
+    return map;
+}
+
+void *bench_node_shared_alloc(const bench_node_t *node, size_t bytes,
+                              bench_node_shared_t *shared) {
+    MPI_Aint size;
+    int disp_unit;
+    void *local;
+
+    // The leader holds all of it; the others map the leader's segment
+    shared->bytes = bytes;
+    if (MPI_Win_allocate_shared(node->node_rank == 0 ? (MPI_Aint)bytes : 0, 1,
+                                MPI_INFO_NULL, node->node, &local, &shared->win)
+        != MPI_SUCCESS) {
+        printf("Shared window allocation failed (%zu bytes)\n", bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Win_shared_query(shared->win, 0, &size, &disp_unit, &shared->base);
+    // One passive-target epoch for the window's lifetime; syncs order the
+    // load/store accesses
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, shared->win);
+    return shared->base;
+}
+
+void bench_node_shared_sync(const bench_node_t *node, bench_node_shared_t *shared) {
+    MPI_Win_sync(shared->win);
+    MPI_Barrier(node->node);
+    MPI_Win_sync(shared->win);
+}
+
+void bench_node_shared_free(bench_node_shared_t *shared) {
+    MPI_Win_unlock_all(shared->win);
+    MPI_Win_free(&shared->win);
+    shared->base = NULL;
+}
+
+void bench_node_reduce(const bench_node_t *node, const void *sendbuf, void *recvbuf,
+                       int count, MPI_Datatype type, MPI_Op op) {
+    int type_size;
+    void *partial = NULL;
+
+    MPI_Type_size(type, &type_size);
+    if (node->node_rank == 0) {
+        partial = malloc((size_t)count * type_size);
+        if (!partial) {
+            printf("Memory allocation failed for the node reduction\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Reduce(sendbuf, partial, count, type, op, 0, node->node);
+    if (node->leaders != MPI_COMM_NULL) {
+        MPI_Reduce(partial, recvbuf, count, type, op, 0, node->leaders);
+    }
+    free(partial);
+}
@@ -0,0 +1,64 @@
+/*
+ * Node-aware communication shared by the MPI examples (--node-aware)
+ *
+ * bench_node_init() splits a communicator into the ranks of each node
+ * (MPI_Comm_split_type, MPI_COMM_TYPE_SHARED) and a communicator of one
+ * leader per node, the node's lowest rank. Data then crosses the network
+ * once per node, between leaders, and is shared or combined inside the node
+ * through memory:
+ *
+ *   shared buffers: one copy per node in an MPI_Win_allocate_shared window,
+ *                   held by the leader and mapped by every rank of the node
+ *   reductions:     ranks reduce to their leader, the leaders to rank 0
+ *
+ * Rank 0 of the parent communicator is always a leader and rank 0 among
+ * the leaders, so results reduced to it stay where flat collectives put
+ * them.
+ */
+
+#ifndef BENCH_NODE_H
+#define BENCH_NODE_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+typedef struct {
+    MPI_Comm node;          // Ranks on this node
+    MPI_Comm leaders;       // One rank per node (MPI_COMM_NULL on the others)
+    int node_rank;          // Rank within the node (0 = leader)
+    int node_size;          // Ranks on this node
+    int node_index;         // Position of this node among the leaders
+    int num_nodes;
+    int max_node_size;      // Ranks on the most populated node
+} bench_node_t;
+
+// Buffer shared by the ranks of a node
+typedef struct {
+    MPI_Win win;
+    void *base;
+    size_t bytes;
+} bench_node_shared_t;
+
+// Split comm by node; collective over comm
+void bench_node_init(bench_node_t *node, MPI_Comm comm);
+void bench_node_free(bench_node_t *node);
+
+// Node index of every rank of the parent communicator (comm_size ints,
+// caller frees); collective over comm
+int *bench_node_map(const bench_node_t *node, MPI_Comm comm);
+
+// `bytes` allocated once per node and mapped by all its ranks; returns the
+// base (same contents on every rank of the node), aborting on failure.
+// Collective over the node. Writes become visible to the other ranks of the
+// node at the next bench_node_shared_sync().
+void *bench_node_shared_alloc(const bench_node_t *node, size_t bytes,
+                              bench_node_shared_t *shared);
+void bench_node_shared_sync(const bench_node_t *node, bench_node_shared_t *shared);
+void bench_node_shared_free(bench_node_shared_t *shared);
+
+// MPI_Reduce to rank 0 of the parent communicator in two levels: to the
+// node leader, then across the leaders. Collective over the parent.
+void bench_node_reduce(const bench_node_t *node, const void *sendbuf, void *recvbuf,
+                       int count, MPI_Datatype type, MPI_Op op);
+
+#endif /* BENCH_NODE_H */
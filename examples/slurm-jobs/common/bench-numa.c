@@ -0,0 +1,216 @@
+/*
+ * NUMA-aware buffers shared by the MPI examples
+ */
+
+#define _GNU_SOURCE
+#include "bench-numa.h"
+
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "bench-report.h"
+
+// Pages queried per move_pages() call
+#define PAGE_BATCH 1024
+
+static size_t page_size(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+}
+
+void bench_numa_touch_rows(double *buf, int rows, int cols) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        memset(buf + (size_t)i * cols, 0, (size_t)cols * sizeof(double));
+    }
+}
+
+void bench_numa_copy_rows(double *dst, const double *src, int rows, int cols) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        memcpy(dst + (size_t)i * cols, src + (size_t)i * cols, (size_t)cols * sizeof(double));
+    }
+}
+
+// NUMA node of the CPU the calling thread runs on, -1 if unknown
+static int current_node(void) {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return (int)node;
+    }
+#endif
+    return -1;
+}
+
+unsigned long bench_numa_thread_nodes(void) {
+    unsigned long mask = 0;
+
+    #pragma omp parallel reduction(|:mask)
+    {
+        int node = current_node();
+        if (node >= 0 && node < (int)(8 * sizeof(mask))) {
+            mask |= 1UL << node;
+        }
+    }
+    return mask;
+}
+
+long bench_numa_pages(const void *ptr, size_t bytes, long *counts, int max_nodes) {
+    memset(counts, 0, (size_t)max_nodes * sizeof(long));
+#if defined(__linux__) && defined(SYS_move_pages)
+    size_t psize = page_size();
+    uintptr_t first = (uintptr_t)ptr & ~(uintptr_t)(psize - 1);
+    uintptr_t end = (uintptr_t)ptr + bytes;
+    void *pages[PAGE_BATCH];
+    int status[PAGE_BATCH];
+    long resident = 0;
+
+    for (uintptr_t addr = first; addr < end;) {
+        unsigned long batch = 0;
+        for (; batch < PAGE_BATCH && addr < end; batch++, addr += psize) {
+            pages[batch] = (void *)addr;
+        }
+        // nodes == NULL only queries; status is the node or -errno
+        // (-ENOENT for pages never touched)
+        if (syscall(SYS_move_pages, 0, batch, pages, NULL, status, 0) != 0) {
+            return -1;
+        }
+        for (unsigned long i = 0; i < batch; i++) {
+            if (status[i] >= 0 && status[i] < max_nodes) {
+                counts[status[i]]++;
+                resident++;
+            }
+        }
+    }
+    return resident;
+#else
+    (void)ptr;
+    (void)bytes;
+    return -1;
+#endif
+}
+
+// "n0 52% n1 48%" for one buffer's per-node page counts
+static void format_placement(const long *counts, unsigned long local_nodes, char *out,
+                             size_t len) {
+    long total = 0;
+    size_t used = 0;
+
+    for (int node = 0; node < BENCH_NUMA_MAX_NODES; node++) {
+        total += counts[node];
+    }
+    if (total == 0) {
+        snprintf(out, len, "untouched");
+        return;
+    }
+    out[0] = '\0';
+    for (int node = 0; node < BENCH_NUMA_MAX_NODES && used < len; node++) {
+        if (counts[node] > 0) {
+            used += snprintf(out + used, len - used, "%sn%d%s %.0f%%", used ? " " : "", node,
+                             (local_nodes >> node) & 1 ? "" : "!",
+                             100.0 * counts[node] / total);
+        }
+    }
+}
+
+double bench_numa_report(const bench_numa_buffer_t *buffers, int count) {
+    int world_size, world_rank;
+    // Per rank: thread node mask, supported flag, then counts per buffer/node
+    int fields = 2 + BENCH_NUMA_MAX_BUFFERS * BENCH_NUMA_MAX_NODES;
+    long record[2 + BENCH_NUMA_MAX_BUFFERS * BENCH_NUMA_MAX_NODES];
+    long *records = NULL;
+    double min_local = -1.0;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    if (count > BENCH_NUMA_MAX_BUFFERS) {
+        count = BENCH_NUMA_MAX_BUFFERS;
+    }
+
+    memset(record, 0, sizeof(record));
+    record[0] = (long)bench_numa_thread_nodes();
+    record[1] = record[0] != 0;
+    for (int b = 0; b < count; b++) {
+        if (bench_numa_pages(buffers[b].ptr, buffers[b].bytes,
+                             record + 2 + b * BENCH_NUMA_MAX_NODES, BENCH_NUMA_MAX_NODES) < 0) {
+            record[1] = 0;
+        }
+    }
+
+    char *hosts = bench_gather_hosts();
+    if (world_rank == 0) {
+        records = malloc((size_t)world_size * fields * sizeof(long));
+        if (!records) {
+            printf("Memory allocation failed for NUMA report\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(record, fields, MPI_LONG, records, fields, MPI_LONG, 0, MPI_COMM_WORLD);
+
+    if (world_rank == 0) {
+        printf("\n========================================\n");
+        printf("NUMA Placement (pages per node, ! = not a node of the rank's threads)\n");
+        printf("========================================\n");
+        printf("%6s  %-16s %-10s", "Rank", "Host", "Threads");
+        for (int b = 0; b < count; b++) {
+            printf(" %-18s", buffers[b].name);
+        }
+        printf(" %6s\n", "Local");
+
+        for (int r = 0; r < world_size; r++) {
+            const long *rec = records + (size_t)r * fields;
+            unsigned long mask = (unsigned long)rec[0];
+            char nodes[64] = "";
+            size_t used = 0;
+
+            printf("%6d  %-16.16s", r, hosts + (size_t)r * MPI_MAX_PROCESSOR_NAME);
+            if (!rec[1]) {
+                printf(" %-10s", "n/a");
+                for (int b = 0; b < count; b++) {
+                    printf(" %-18s", "n/a");
+                }
+                printf(" %6s\n", "n/a");
+                continue;
+            }
+            for (int node = 0; node < (int)(8 * sizeof(mask)) && used < sizeof(nodes); node++) {
+                if ((mask >> node) & 1) {
+                    used += snprintf(nodes + used, sizeof(nodes) - used, "%sn%d",
+                                     used ? "," : "", node);
+                }
+            }
+            printf(" %-10s", nodes);
+
+            long local = 0, total = 0;
+            for (int b = 0; b < count; b++) {
+                const long *counts = rec + 2 + b * BENCH_NUMA_MAX_NODES;
+                char placement[64];
+                format_placement(counts, mask, placement, sizeof(placement));
+                printf(" %-18s", placement);
+                for (int node = 0; node < BENCH_NUMA_MAX_NODES; node++) {
+                    total += counts[node];
+                    local += (mask >> node) & 1 ? counts[node] : 0;
+                }
+            }
+            if (total > 0) {
+                double share = (double)local / total;
+                printf(" %5.0f%%\n", 100.0 * share);
+                min_local = (min_local < 0.0 || share < min_local) ? share : min_local;
+            } else {
+                printf(" %6s\n", "-");
+            }
+        }
+        printf("========================================\n");
+        free(records);
+        free(hosts);
+    }
+    return min_local;
+}
@@ -0,0 +1,54 @@
+/*
+ * NUMA-aware buffers shared by the MPI examples
+ *
+ * Linux places a page on the NUMA node of the thread that first writes it
+ * (first touch). A buffer filled by one thread, or written first by
+ * MPI_Scatterv/MPI_Bcast on the main thread, ends up on a single node even
+ * when the rank's OpenMP threads span both sockets, and every other thread
+ * then reads it across the socket interconnect. Allocate the buffers with
+ * bench_alloc() (bench-alloc.h), which never touches them; the helpers below:
+ *   - touch (zero) rows with the same static OpenMP split the compute loops
+ *     use, so each row block lands next to the thread that works on it
+ *   - report which node every page of a buffer ended up on (move_pages)
+ *
+ * Placement only follows the threads if they stay put: bind ranks to cores
+ * or sockets (mpirun --bind-to, srun --cpu-bind) and threads to places
+ * (OMP_PLACES/OMP_PROC_BIND). Without Linux NUMA support the report prints
+ * n/a.
+ */
+
+#ifndef BENCH_NUMA_H
+#define BENCH_NUMA_H
+
+#include <stddef.h>
+
+#define BENCH_NUMA_MAX_NODES 16
+#define BENCH_NUMA_MAX_BUFFERS 4
+
+// One rank-local buffer to include in the placement report
+typedef struct {
+    const char *name;
+    const void *ptr;
+    size_t bytes;
+} bench_numa_buffer_t;
+
+// Zero buf[rows×cols] with rows split across threads (schedule(static)).
+// Called on fresh memory this is the first touch that decides placement.
+void bench_numa_touch_rows(double *buf, int rows, int cols);
+
+// dst[rows×cols] = src, rows split across threads the same way
+void bench_numa_copy_rows(double *dst, const double *src, int rows, int cols);
+
+// Bitmask of the NUMA nodes this rank's OpenMP threads run on (0 if unknown)
+unsigned long bench_numa_thread_nodes(void);
+
+// Count the pages of [ptr, ptr+bytes) on each node into counts[max_nodes];
+// returns the number of resident pages counted, or -1 if unsupported
+long bench_numa_pages(const void *ptr, size_t bytes, long *counts, int max_nodes);
+
+// Print a per-rank table of thread nodes and buffer placement on rank 0.
+// Returns (on rank 0) the lowest share of a rank's pages that sit on its
+// threads' nodes, or -1 if placement is unknown. Collective.
+double bench_numa_report(const bench_numa_buffer_t *buffers, int count);
+
+#endif /* BENCH_NUMA_H */
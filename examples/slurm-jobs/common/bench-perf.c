@@ -0,0 +1,489 @@
+/*
+ * Hardware event counters shared by the MPI examples
+ */
+
+#include "bench-perf.h"
+
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Bytes moved per last-level cache miss (one cache line)
+#define BENCH_PERF_LINE_BYTES 64.0
+
+const char *bench_perf_event_name(bench_perf_event_t event) {
+    switch (event) {
+    case BENCH_PERF_DTLB_LOAD_MISSES:
+        return "dtlb_load_misses";
+    case BENCH_PERF_CYCLES:
+        return "cycles";
+    case BENCH_PERF_INSTRUCTIONS:
+        return "instructions";
+    case BENCH_PERF_LLC_MISSES:
+        return "llc_misses";
+    case BENCH_PERF_FP_SCALAR_DOUBLE:
+        return "fp_scalar_double";
+    case BENCH_PERF_FP_128B_DOUBLE:
+        return "fp_128b_double";
+    case BENCH_PERF_FP_256B_DOUBLE:
+        return "fp_256b_double";
+    case BENCH_PERF_FP_512B_DOUBLE:
+        return "fp_512b_double";
+    case BENCH_PERF_FP_SCALAR_SINGLE:
+        return "fp_scalar_single";
+    case BENCH_PERF_FP_128B_SINGLE:
+        return "fp_128b_single";
+    case BENCH_PERF_FP_256B_SINGLE:
+        return "fp_256b_single";
+    case BENCH_PERF_FP_512B_SINGLE:
+        return "fp_512b_single";
+    default:
+        return "unknown";
+    }
+}
+
+// Floating-point operations per count of an FP event (0: not an FP event)
+static double fp_weight(bench_perf_event_t event) {
+    switch (event) {
+    case BENCH_PERF_FP_SCALAR_DOUBLE:
+        return 1.0;
+    case BENCH_PERF_FP_128B_DOUBLE:
+        return 2.0;
+    case BENCH_PERF_FP_256B_DOUBLE:
+        return 4.0;
+    case BENCH_PERF_FP_512B_DOUBLE:
+        return 8.0;
+    case BENCH_PERF_FP_SCALAR_SINGLE:
+        return 1.0;
+    case BENCH_PERF_FP_128B_SINGLE:
+        return 4.0;
+    case BENCH_PERF_FP_256B_SINGLE:
+        return 8.0;
+    case BENCH_PERF_FP_512B_SINGLE:
+        return 16.0;
+    default:
+        return 0.0;
+    }
+}
+
+// Precision of an FP event (meaningful only where fp_weight() > 0)
+static bench_perf_fp_t fp_precision(bench_perf_event_t event) {
+    return event >= BENCH_PERF_FP_SCALAR_SINGLE ? BENCH_PERF_FP_SINGLE : BENCH_PERF_FP_DOUBLE;
+}
+
+// FP_ARITH_INST_RETIRED (event 0xc7) exists on Intel cores since Broadwell;
+// other vendors encode their FP events differently
+static int intel_cpu(void) {
+    char line[256];
+    int intel = 0;
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+
+    if (!fp) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "vendor_id", 9) == 0) {
+            intel = strstr(line, "GenuineIntel") != NULL;
+            break;
+        }
+    }
+    fclose(fp);
+    return intel;
+}
+
+// Processor model of this node ("unknown" if /proc/cpuinfo has none)
+static void cpu_model(char *model, size_t len) {
+    char line[256];
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+
+    snprintf(model, len, "unknown");
+    if (!fp) {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        char *colon = strchr(line, ':');
+        if (strncmp(line, "model name", 10) == 0 && colon) {
+            colon += 1 + (colon[1] == ' ');
+            colon[strcspn(colon, "\n")] = '\0';
+            snprintf(model, len, "%s", colon);
+            break;
+        }
+    }
+    fclose(fp);
+}
+
+#if defined(__linux__) && defined(SYS_perf_event_open)
+// Counter for the calling thread on any CPU, user space only
+static int open_thread_counter(bench_perf_event_t event) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (event) {
+    case BENCH_PERF_DTLB_LOAD_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB
+                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case BENCH_PERF_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case BENCH_PERF_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case BENCH_PERF_LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    // FP_ARITH_INST_RETIRED umasks: scalar 0x01, 128-bit 0x04, 256-bit
+    // 0x10, 512-bit 0x40 (packed double)
+    case BENCH_PERF_FP_SCALAR_DOUBLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x01c7;
+        break;
+    case BENCH_PERF_FP_128B_DOUBLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x04c7;
+        break;
+    case BENCH_PERF_FP_256B_DOUBLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x10c7;
+        break;
+    case BENCH_PERF_FP_512B_DOUBLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x40c7;
+        break;
+    // Packed single umasks are the double ones shifted left by one
+    case BENCH_PERF_FP_SCALAR_SINGLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x02c7;
+        break;
+    case BENCH_PERF_FP_128B_SINGLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x08c7;
+        break;
+    case BENCH_PERF_FP_256B_SINGLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x20c7;
+        break;
+    case BENCH_PERF_FP_512B_SINGLE:
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x80c7;
+        break;
+    default:
+        return -1;
+    }
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+int bench_perf_open(bench_perf_counter_t *counter, bench_perf_event_t event) {
+    counter->event = event;
+    counter->count = 0;
+#if defined(__linux__) && defined(SYS_perf_event_open)
+    int threads = 1;
+    int failed = 0;
+
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    if (threads > BENCH_PERF_MAX_THREADS) {
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        counter->fds[t] = -1;
+    }
+
+    #pragma omp parallel reduction(+:failed)
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        counter->fds[t] = open_thread_counter(event);
+        failed += counter->fds[t] < 0;
+    }
+
+    counter->count = threads;
+    if (failed) {
+        bench_perf_close(counter);
+        return -1;
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+#ifdef __linux__
+static void counter_ioctl(const bench_perf_counter_t *counter, unsigned long request) {
+    for (int t = 0; t < counter->count; t++) {
+        ioctl(counter->fds[t], request, 0);
+    }
+}
+#endif
+
+// Sum over threads, each scaled up for the time it was multiplexed out;
+// -1 if unavailable
+static long long counter_read(const bench_perf_counter_t *counter) {
+    double total = 0.0;
+
+    if (counter->count == 0) {
+        return -1;
+    }
+#ifdef __linux__
+    for (int t = 0; t < counter->count; t++) {
+        uint64_t value[3];      // Count, time enabled, time running
+        if (read(counter->fds[t], value, sizeof(value)) != sizeof(value)) {
+            return -1;
+        }
+        if (value[2] > 0 && value[2] < value[1]) {
+            total += (double)value[0] * ((double)value[1] / value[2]);
+        } else if (value[2] > 0 || value[1] == 0) {
+            total += (double)value[0];
+        } else {
+            return -1;          // Enabled but never scheduled
+        }
+    }
+#endif
+    return (long long)total;
+}
+
+void bench_perf_start(bench_perf_counter_t *counter) {
+#ifdef __linux__
+    counter_ioctl(counter, PERF_EVENT_IOC_RESET);
+    counter_ioctl(counter, PERF_EVENT_IOC_ENABLE);
+#else
+    (void)counter;
+#endif
+}
+
+long long bench_perf_stop(bench_perf_counter_t *counter) {
+#ifdef __linux__
+    counter_ioctl(counter, PERF_EVENT_IOC_DISABLE);
+#endif
+    return counter_read(counter);
+}
+
+void bench_perf_close(bench_perf_counter_t *counter) {
+#ifdef __linux__
+    for (int t = 0; t < counter->count; t++) {
+        if (counter->fds[t] >= 0) {
+            close(counter->fds[t]);
+        }
+    }
+#endif
+    counter->count = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Compute profile
+
+int bench_perf_profile_open(bench_perf_profile_t *profile) {
+    return bench_perf_profile_open_fp(profile, BENCH_PERF_FP_DOUBLE);
+}
+
+int bench_perf_profile_open_fp(bench_perf_profile_t *profile, bench_perf_fp_t fp) {
+    int intel = intel_cpu();
+
+    profile->enabled = 0;
+    for (int i = 0; i < BENCH_PERF_PROFILE_EVENTS; i++) {
+        bench_perf_event_t event = (bench_perf_event_t)(BENCH_PERF_PROFILE_FIRST + i);
+        profile->counters[i].count = 0;
+        if (fp_weight(event) > 0.0 && (!intel || fp_precision(event) != fp)) {
+            continue;
+        }
+        bench_perf_open(&profile->counters[i], event);
+    }
+    if (profile->counters[BENCH_PERF_CYCLES - BENCH_PERF_PROFILE_FIRST].count == 0
+        || profile->counters[BENCH_PERF_INSTRUCTIONS - BENCH_PERF_PROFILE_FIRST].count == 0) {
+        bench_perf_profile_close(profile);
+        return -1;
+    }
+    profile->enabled = 1;
+    return 0;
+}
+
+void bench_perf_profile_close(bench_perf_profile_t *profile) {
+    for (int i = 0; i < BENCH_PERF_PROFILE_EVENTS; i++) {
+        bench_perf_close(&profile->counters[i]);
+    }
+    profile->enabled = 0;
+}
+
+#ifdef __linux__
+static void profile_ioctl(bench_perf_profile_t *profile, unsigned long request) {
+    if (!profile->enabled) {
+        return;
+    }
+    for (int i = 0; i < BENCH_PERF_PROFILE_EVENTS; i++) {
+        counter_ioctl(&profile->counters[i], request);
+    }
+}
+#endif
+
+void bench_perf_profile_reset(bench_perf_profile_t *profile) {
+#ifdef __linux__
+    profile_ioctl(profile, PERF_EVENT_IOC_RESET);
+#else
+    (void)profile;
+#endif
+}
+
+void bench_perf_profile_resume(bench_perf_profile_t *profile) {
+#ifdef __linux__
+    profile_ioctl(profile, PERF_EVENT_IOC_ENABLE);
+#else
+    (void)profile;
+#endif
+}
+
+void bench_perf_profile_pause(bench_perf_profile_t *profile) {
+#ifdef __linux__
+    profile_ioctl(profile, PERF_EVENT_IOC_DISABLE);
+#else
+    (void)profile;
+#endif
+}
+
+bench_perf_sample_t bench_perf_profile_read(const bench_perf_profile_t *profile) {
+    bench_perf_sample_t sample = {-1.0, -1.0, -1.0, -1.0};
+    double fp = 0.0;
+    int fp_events = 0;
+
+    if (!profile->enabled) {
+        return sample;
+    }
+    for (int i = 0; i < BENCH_PERF_PROFILE_EVENTS; i++) {
+        bench_perf_event_t event = (bench_perf_event_t)(BENCH_PERF_PROFILE_FIRST + i);
+        long long value = counter_read(&profile->counters[i]);
+        if (value < 0) {
+            continue;
+        }
+        if (event == BENCH_PERF_CYCLES) {
+            sample.cycles = (double)value;
+        } else if (event == BENCH_PERF_INSTRUCTIONS) {
+            sample.instructions = (double)value;
+        } else if (event == BENCH_PERF_LLC_MISSES) {
+            sample.llc_misses = (double)value;
+        } else {
+            fp += fp_weight(event) * value;
+            fp_events++;
+        }
+    }
+    // Hypervisors that do not virtualize raw events report zeros
+    if (fp_events == 4 && fp > 0.0) {
+        sample.fp_ops = fp;
+    }
+    return sample;
+}
+
+bench_perf_summary_t bench_perf_summarize(const bench_perf_sample_t *sample, double seconds,
+                                          int threads, double flops) {
+    bench_perf_summary_t summary;
+    int fp_counted = sample->fp_ops > 0.0;
+    double ghz = -1.0, ipc = -1.0, dram_gbps = -1.0, gflops = -1.0, intensity = -1.0;
+
+    MPI_Allreduce(&fp_counted, &summary.fp_counted, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    if (summary.fp_counted) {
+        flops = sample->fp_ops;
+    }
+    if (sample->cycles > 0.0 && seconds > 0.0) {
+        ghz = sample->cycles / ((double)threads * seconds) / 1e9;
+        ipc = sample->instructions >= 0.0 ? sample->instructions / sample->cycles : -1.0;
+    }
+    if (sample->llc_misses >= 0.0 && seconds > 0.0) {
+        dram_gbps = sample->llc_misses * BENCH_PERF_LINE_BYTES / seconds / 1e9;
+    }
+    if (flops >= 0.0 && seconds > 0.0) {
+        gflops = flops / seconds / 1e9;
+    }
+    if (flops >= 0.0 && sample->llc_misses > 0.0) {
+        intensity = flops / (sample->llc_misses * BENCH_PERF_LINE_BYTES);
+    }
+
+    summary.ghz = bench_reduce_stats(ghz);
+    summary.ipc = bench_reduce_stats(ipc);
+    summary.llc_misses = bench_reduce_stats(sample->llc_misses);
+    summary.dram_gbps = bench_reduce_stats(dram_gbps);
+    summary.gflops = bench_reduce_stats(gflops);
+    summary.intensity = bench_reduce_stats(intensity);
+    cpu_model(summary.cpu_model, sizeof(summary.cpu_model));
+    return summary;
+}
+
+static void print_stats(const char *label, const bench_stats_t *stats, const char *unit,
+                        const char *format) {
+    char line[160];
+
+    if (stats->min < 0.0) {
+        printf("  %s: n/a\n", label);
+        return;
+    }
+    // format is the numeric conversion, used for min, avg and max
+    int len = snprintf(line, sizeof(line), "  %s: ", label);
+    len += snprintf(line + len, sizeof(line) - len, format, stats->min);
+    len += snprintf(line + len, sizeof(line) - len, " / ");
+    len += snprintf(line + len, sizeof(line) - len, format, stats->avg);
+    len += snprintf(line + len, sizeof(line) - len, " / ");
+    len += snprintf(line + len, sizeof(line) - len, format, stats->max);
+    printf("%s%s\n", line, unit);
+}
+
+void bench_perf_print(const bench_perf_summary_t *summary, const char *region) {
+    if (summary->ghz.min < 0.0) {
+        return;
+    }
+    printf("Hardware counters (%s, min / avg / max over ranks; %s):\n", region,
+           summary->cpu_model);
+    print_stats("Clock", &summary->ghz, " GHz", "%.2f");
+    print_stats("IPC", &summary->ipc, "", "%.2f");
+    print_stats("LLC misses", &summary->llc_misses, "", "%.3g");
+    print_stats("DRAM traffic (LLC misses x 64 B)", &summary->dram_gbps, " GB/s", "%.2f");
+    print_stats(summary->fp_counted ? "FP rate (counted)" : "FP rate (operation count)",
+                &summary->gflops, " GFLOPS", "%.2f");
+    print_stats("Arithmetic intensity", &summary->intensity, " FLOP/byte", "%.2f");
+}
+
+void bench_perf_json(bench_json_t *json, const bench_perf_summary_t *summary,
+                     const char *region) {
+    if (summary->ghz.min < 0.0) {
+        return;
+    }
+    bench_json_begin_object(json, "counters");
+    bench_json_string(json, "region", region);
+    bench_json_string(json, "cpu_model", summary->cpu_model);
+    bench_json_stats(json, "ghz", &summary->ghz);
+    bench_json_stats(json, "ipc", &summary->ipc);
+    if (summary->llc_misses.min >= 0.0) {
+        bench_json_stats(json, "llc_misses", &summary->llc_misses);
+        bench_json_stats(json, "dram_gbps", &summary->dram_gbps);
+    }
+    if (summary->gflops.min >= 0.0) {
+        bench_json_string(json, "flops_source", summary->fp_counted ? "counters" : "model");
+        bench_json_stats(json, "gflops", &summary->gflops);
+    }
+    if (summary->intensity.min >= 0.0) {
+        bench_json_stats(json, "flop_per_byte", &summary->intensity);
+    }
+    bench_json_end_object(json);
+}
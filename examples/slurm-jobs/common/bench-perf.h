@@ -0,0 +1,141 @@
+/*
+ * Hardware event counters shared by the MPI examples
+ *
+ * Counts events over a region on every OpenMP thread of the rank with
+ * perf_event_open(2). Counters are opened once per thread inside a parallel
+ * region, so call bench_perf_open() after bench_threads_init() and keep the
+ * thread count fixed afterwards; start and stop can then be called from the
+ * main thread.
+ *
+ * A single counter (bench_perf_counter_t) covers one event, e.g. the dTLB
+ * misses of a timed region. The compute profile (bench_perf_profile_t,
+ * --counters in the examples) groups cycles, instructions, last-level cache
+ * misses and, on Intel cores, the FP_ARITH_INST_RETIRED events of one
+ * precision (double by default, single for FP32 kernels) by vector width;
+ * it is paused and resumed around every call of a kernel so MPI waits stay
+ * out of it. From those the examples report the
+ * effective clock, IPC, an estimate of DRAM traffic (LLC misses x 64 bytes)
+ * and the arithmetic intensity of the kernel, i.e. its position on a
+ * roofline of the node.
+ *
+ * Counters are unavailable in many VMs and containers, without Linux, or
+ * when kernel.perf_event_paranoid forbids user-space counting (> 2);
+ * opening then fails and results are reported as n/a. When the kernel
+ * multiplexes more events than the core has counters, counts are scaled by
+ * the share of time each event was scheduled.
+ */
+
+#ifndef BENCH_PERF_H
+#define BENCH_PERF_H
+
+#include "bench-report.h"
+
+#define BENCH_PERF_MAX_THREADS 256
+
+typedef enum {
+    BENCH_PERF_DTLB_LOAD_MISSES = 0,
+    BENCH_PERF_CYCLES,
+    BENCH_PERF_INSTRUCTIONS,
+    BENCH_PERF_LLC_MISSES,
+    BENCH_PERF_FP_SCALAR_DOUBLE,    // Intel FP_ARITH_INST_RETIRED (FMA = 2)
+    BENCH_PERF_FP_128B_DOUBLE,
+    BENCH_PERF_FP_256B_DOUBLE,
+    BENCH_PERF_FP_512B_DOUBLE,
+    BENCH_PERF_FP_SCALAR_SINGLE,    // Same events, packed single umasks
+    BENCH_PERF_FP_128B_SINGLE,
+    BENCH_PERF_FP_256B_SINGLE,
+    BENCH_PERF_FP_512B_SINGLE,
+    BENCH_PERF_EVENT_COUNT
+} bench_perf_event_t;
+
+// One event on every thread of the rank
+typedef struct {
+    bench_perf_event_t event;
+    int fds[BENCH_PERF_MAX_THREADS];
+    int count;              // Open counters (0 = unavailable)
+} bench_perf_counter_t;
+
+// Events of the compute profile (cycles .. 512-bit FP); only the FP events
+// of the profile's precision are opened
+#define BENCH_PERF_PROFILE_FIRST BENCH_PERF_CYCLES
+#define BENCH_PERF_PROFILE_EVENTS (BENCH_PERF_EVENT_COUNT - BENCH_PERF_PROFILE_FIRST)
+
+// Precision whose FP operations the profile counts
+typedef enum {
+    BENCH_PERF_FP_DOUBLE = 0,
+    BENCH_PERF_FP_SINGLE,
+    BENCH_PERF_FP_NONE      // No FP events (e.g. BF16 dot products, which
+                            // FP_ARITH_INST_RETIRED does not count)
+} bench_perf_fp_t;
+
+typedef struct {
+    bench_perf_counter_t counters[BENCH_PERF_PROFILE_EVENTS];
+    int enabled;            // bench_perf_profile_open() succeeded
+} bench_perf_profile_t;
+
+// Profile counts summed over threads (< 0 if unavailable)
+typedef struct {
+    double cycles;
+    double instructions;
+    double llc_misses;
+    double fp_ops;          // Floating-point operations of the profile's precision
+} bench_perf_sample_t;
+
+// Profile rates of the ranks (valid on rank 0); a field whose min is < 0
+// was not available on every rank
+typedef struct {
+    bench_stats_t ghz;          // Cycles per thread per counted second
+    bench_stats_t ipc;          // Instructions per cycle
+    bench_stats_t llc_misses;
+    bench_stats_t dram_gbps;    // LLC misses x 64 bytes per counted second
+    bench_stats_t gflops;       // FP operations per counted second
+    bench_stats_t intensity;    // FP operations per DRAM byte
+    int fp_counted;             // FP operations from counters on every rank
+                                // (else the caller's operation count)
+    char cpu_model[128];        // Rank 0's processor model
+} bench_perf_summary_t;
+
+// Short name of an event, e.g. "dtlb_load_misses"
+const char *bench_perf_event_name(bench_perf_event_t event);
+
+// Open the event on every thread; returns 0 on success, -1 if unavailable
+int bench_perf_open(bench_perf_counter_t *counter, bench_perf_event_t event);
+
+// Reset and enable / disable and read; stop returns the sum over threads,
+// or -1 if the counter is unavailable
+void bench_perf_start(bench_perf_counter_t *counter);
+long long bench_perf_stop(bench_perf_counter_t *counter);
+
+void bench_perf_close(bench_perf_counter_t *counter);
+
+// Open the profile events the core provides; returns 0 if at least cycles
+// and instructions could be counted, -1 otherwise (the profile is then
+// disabled and every call below is a no-op)
+int bench_perf_profile_open(bench_perf_profile_t *profile);
+
+// Same, counting the FP operations of another precision
+int bench_perf_profile_open_fp(bench_perf_profile_t *profile, bench_perf_fp_t fp);
+void bench_perf_profile_close(bench_perf_profile_t *profile);
+
+// Zero the counts; resume / pause bracket each counted region
+void bench_perf_profile_reset(bench_perf_profile_t *profile);
+void bench_perf_profile_resume(bench_perf_profile_t *profile);
+void bench_perf_profile_pause(bench_perf_profile_t *profile);
+
+// Counts accumulated since the last reset
+bench_perf_sample_t bench_perf_profile_read(const bench_perf_profile_t *profile);
+
+// Reduce one sample per rank over MPI_COMM_WORLD, taken over `seconds` of
+// counted time on `threads` threads; flops is the rank's operation count
+// used when FP events are unavailable (< 0: unknown). Collective.
+bench_perf_summary_t bench_perf_summarize(const bench_perf_sample_t *sample, double seconds,
+                                          int threads, double flops);
+
+// Report lines for rank 0 (nothing if the profile was off on some rank)
+void bench_perf_print(const bench_perf_summary_t *summary, const char *region);
+
+// "counters" member of a JSON record
+void bench_perf_json(bench_json_t *json, const bench_perf_summary_t *summary,
+                     const char *region);
+
+#endif /* BENCH_PERF_H */
@@ -0,0 +1,50 @@
+/*
+ * Philox4x32-10 counter-based generator shared by the MPI examples
+ *
+ * Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC'11): a
+ * keyed bijection of a 128-bit counter (c0, c1, c2, c3) under a 64-bit key
+ * (k0, k1). The examples key it with the run seed and use a global index
+ * as the counter, so a value depends only on the seed and its position,
+ * never on which rank or thread draws it. pi-calculation draws its points
+ * and matrix-multiply its inputs and Freivalds probes from it.
+ *
+ * Header-only: the round is inlined into the callers' loops, where the
+ * compiler vectorizes it across counters (32×32→64-bit multiplies map
+ * onto pmuludq/vpmuludq).
+ */
+
+#ifndef BENCH_PHILOX_H
+#define BENCH_PHILOX_H
+
+#include <stdint.h>
+
+// Multipliers and Weyl key increments
+#define BENCH_PHILOX_M0 0xD2511F53u
+#define BENCH_PHILOX_M1 0xCD9E8D57u
+#define BENCH_PHILOX_W0 0x9E3779B9u
+#define BENCH_PHILOX_W1 0xBB67AE85u
+#define BENCH_PHILOX_ROUNDS 10
+
+// One round on the counter words under round key (k0, k1); the key of
+// round r is (k0 + r·W0, k1 + r·W1)
+static inline void bench_philox_round(uint32_t *c0, uint32_t *c1, uint32_t *c2, uint32_t *c3,
+                                      uint32_t k0, uint32_t k1) {
+    uint64_t p0 = (uint64_t)BENCH_PHILOX_M0 * *c0;
+    uint64_t p1 = (uint64_t)BENCH_PHILOX_M1 * *c2;
+    uint32_t n0 = (uint32_t)(p1 >> 32) ^ *c1 ^ k0;
+    uint32_t n2 = (uint32_t)(p0 >> 32) ^ *c3 ^ k1;
+    *c1 = (uint32_t)p1;
+    *c3 = (uint32_t)p0;
+    *c0 = n0;
+    *c2 = n2;
+}
+
+// All rounds on ctr in place under key (k0, k1)
+static inline void bench_philox4x32(uint32_t ctr[4], uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < BENCH_PHILOX_ROUNDS; r++) {
+        bench_philox_round(&ctr[0], &ctr[1], &ctr[2], &ctr[3],
+                           k0 + (uint32_t)r * BENCH_PHILOX_W0, k1 + (uint32_t)r * BENCH_PHILOX_W1);
+    }
+}
+
+#endif /* BENCH_PHILOX_H */
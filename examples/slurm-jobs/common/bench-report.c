@@ -0,0 +1,296 @@
+/*
+ * Machine-readable benchmark records shared by the MPI examples
+ */
+
+#include "bench-report.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int bench_json_option(const char *arg, const char **path) {
+    if (strcmp(arg, "--json") == 0) {
+        *path = NULL;
+        return 1;
+    }
+    if (strncmp(arg, "--json=", 7) == 0) {
+        *path = arg + 7;
+        return 1;
+    }
+    return 0;
+}
+
+const char *bench_option_value(const char *arg, const char *prefix) {
+    size_t len = strlen(prefix);
+    return strncmp(arg, prefix, len) == 0 ? arg + len : NULL;
+}
+
+long long bench_parse_size(const char *value) {
+    char *end;
+    int shift = 0;
+    long long size;
+
+    errno = 0;
+    size = strtoll(value, &end, 10);
+    if (end == value || size < 0 || errno == ERANGE) {
+        return 0;
+    }
+    if (*end == 'K' || *end == 'k') {
+        shift = 10;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        shift = 20;
+        end++;
+    } else if (*end == 'G' || *end == 'g') {
+        shift = 30;
+        end++;
+    }
+    if (*end != '\0' || size > (LLONG_MAX >> shift)) {
+        return 0;
+    }
+    return size << shift;
+}
+
+int bench_json_open(bench_json_t *json, const char *path) {
+    memset(json, 0, sizeof(*json));
+    if (path == NULL || strcmp(path, "-") == 0) {
+        json->fp = stdout;
+        json->to_stdout = 1;
+    } else {
+        json->fp = fopen(path, "w");
+        if (!json->fp) {
+            perror(path);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int bench_json_close(bench_json_t *json) {
+    fputc('\n', json->fp);
+    if (json->to_stdout) {
+        return fflush(json->fp) == 0 ? 0 : -1;
+    }
+    return fclose(json->fp) == 0 ? 0 : -1;
+}
+
+static void write_escaped(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', fp);
+            fputc(c, fp);
+        } else if (c == '\n') {
+            fputs("\\n", fp);
+        } else if (c == '\t') {
+            fputs("\\t", fp);
+        } else if (c < 0x20) {
+            fprintf(fp, "\\u%04x", c);
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+// Separator and key before the next member at the current level
+static void begin_member(bench_json_t *json, const char *key) {
+    if (json->count[json->depth]++ > 0) {
+        fputs(", ", json->fp);
+    }
+    if (key) {
+        write_escaped(json->fp, key);
+        fputs(": ", json->fp);
+    }
+}
+
+static void open_level(bench_json_t *json, const char *key, char bracket) {
+    begin_member(json, key);
+    fputc(bracket, json->fp);
+    if (json->depth + 1 < BENCH_JSON_MAX_DEPTH) {
+        json->depth++;
+        json->count[json->depth] = 0;
+    }
+}
+
+static void close_level(bench_json_t *json, char bracket) {
+    fputc(bracket, json->fp);
+    if (json->depth > 0) {
+        json->depth--;
+    }
+}
+
+void bench_json_begin_object(bench_json_t *json, const char *key) {
+    open_level(json, key, '{');
+}
+
+void bench_json_end_object(bench_json_t *json) {
+    close_level(json, '}');
+}
+
+void bench_json_begin_array(bench_json_t *json, const char *key) {
+    open_level(json, key, '[');
+}
+
+void bench_json_end_array(bench_json_t *json) {
+    close_level(json, ']');
+}
+
+void bench_json_string(bench_json_t *json, const char *key, const char *value) {
+    begin_member(json, key);
+    if (value) {
+        write_escaped(json->fp, value);
+    } else {
+        fputs("null", json->fp);
+    }
+}
+
+void bench_json_int(bench_json_t *json, const char *key, long long value) {
+    begin_member(json, key);
+    fprintf(json->fp, "%lld", value);
+}
+
+void bench_json_double(bench_json_t *json, const char *key, double value) {
+    begin_member(json, key);
+    // JSON has no NaN/Inf
+    if (isfinite(value)) {
+        fprintf(json->fp, "%.9g", value);
+    } else {
+        fputs("null", json->fp);
+    }
+}
+
+void bench_json_bool(bench_json_t *json, const char *key, int value) {
+    begin_member(json, key);
+    fputs(value ? "true" : "false", json->fp);
+}
+
+void bench_json_stats(bench_json_t *json, const char *key, const bench_stats_t *stats) {
+    bench_json_begin_object(json, key);
+    bench_json_double(json, "min", stats->min);
+    bench_json_double(json, "max", stats->max);
+    bench_json_double(json, "avg", stats->avg);
+    bench_json_end_object(json);
+}
+
+void bench_json_percentiles(bench_json_t *json, const char *key,
+                            const bench_percentiles_t *pct) {
+    bench_json_begin_object(json, key);
+    bench_json_int(json, "count", pct->count);
+    bench_json_double(json, "min", pct->min);
+    bench_json_double(json, "p50", pct->p50);
+    bench_json_double(json, "p90", pct->p90);
+    bench_json_double(json, "p99", pct->p99);
+    bench_json_double(json, "max", pct->max);
+    bench_json_double(json, "avg", pct->avg);
+    bench_json_end_object(json);
+}
+
+static int compare_doubles(const void *x, const void *y) {
+    double a = *(const double *)x;
+    double b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+// Nearest-rank percentile q (0-100] of sorted values
+static double nearest_rank(const double *sorted, int count, double q) {
+    int rank = (int)ceil(q / 100.0 * count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[(rank > count ? count : rank) - 1];
+}
+
+bench_percentiles_t bench_percentiles(double *values, int count) {
+    bench_percentiles_t pct;
+    double sum = 0.0;
+
+    memset(&pct, 0, sizeof(pct));
+    if (count <= 0) {
+        return pct;
+    }
+    qsort(values, count, sizeof(double), compare_doubles);
+    for (int i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    pct.count = count;
+    pct.min = values[0];
+    pct.p50 = nearest_rank(values, count, 50.0);
+    pct.p90 = nearest_rank(values, count, 90.0);
+    pct.p99 = nearest_rank(values, count, 99.0);
+    pct.max = values[count - 1];
+    pct.avg = sum / count;
+    return pct;
+}
+
+bench_stats_t bench_reduce_stats(double value) {
+    return bench_reduce_stats_comm(value, MPI_COMM_WORLD);
+}
+
+bench_stats_t bench_reduce_stats_comm(double value, MPI_Comm comm) {
+    bench_stats_t stats;
+    double sum = 0.0;
+    int size;
+
+    MPI_Comm_size(comm, &size);
+    MPI_Reduce(&value, &stats.min, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(&value, &stats.max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&value, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    stats.avg = sum / size;
+    return stats;
+}
+
+char *bench_gather_hosts(void) {
+    return bench_gather_hosts_comm(MPI_COMM_WORLD);
+}
+
+char *bench_gather_hosts_comm(MPI_Comm comm) {
+    char host[MPI_MAX_PROCESSOR_NAME] = {0};
+    char *hosts = NULL;
+    int size, rank, len;
+
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
+    MPI_Get_processor_name(host, &len);
+    if (rank == 0) {
+        hosts = malloc((size_t)size * MPI_MAX_PROCESSOR_NAME);
+        if (!hosts) {
+            printf("Memory allocation failed for host list\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, hosts, MPI_MAX_PROCESSOR_NAME,
+               MPI_CHAR, 0, comm);
+    return hosts;
+}
+
+void bench_json_header(bench_json_t *json, const char *benchmark, int ranks,
+                       int threads_per_rank, const char *hosts) {
+    char timestamp[32];
+    char library[MPI_MAX_LIBRARY_VERSION_STRING];
+    int len;
+    time_t now = time(NULL);
+
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    MPI_Get_library_version(library, &len);
+    library[strcspn(library, "\n,")] = '\0';   // First line/clause only
+
+    bench_json_string(json, "benchmark", benchmark);
+    bench_json_int(json, "schema", BENCH_JSON_SCHEMA);
+    bench_json_string(json, "timestamp", timestamp);
+    bench_json_string(json, "job_id", getenv("SLURM_JOB_ID"));
+    bench_json_string(json, "build", BENCH_BUILD_VARIANT);
+    bench_json_int(json, "ranks", ranks);
+    bench_json_int(json, "threads_per_rank", threads_per_rank);
+    bench_json_string(json, "mpi_library", library);
+    bench_json_begin_array(json, "hosts");
+    for (int r = 0; r < ranks; r++) {
+        bench_json_string(json, NULL, hosts + (size_t)r * MPI_MAX_PROCESSOR_NAME);
+    }
+    bench_json_end_array(json);
+}
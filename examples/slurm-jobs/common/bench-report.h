@@ -0,0 +1,109 @@
+/*
+ * Machine-readable benchmark records shared by the MPI examples
+ *
+ * With --json (stdout) or --json=PATH each example writes one JSON object
+ * describing the run, next to the human-readable banner:
+ *
+ *   {"benchmark": "matrix-mult", "schema": 1, "timestamp": "...",
+ *    "job_id": "1234", "ranks": 4, "threads_per_rank": 1,
+ *    "mpi_library": "...", "hosts": ["compute-01", ...],
+ *    "config": {...}, "phases": {"compute": {"min": ..., "max": ...,
+ *    "avg": ...}, ...}, "metrics": {...}}
+ *
+ * On stdout the record is a single line starting with {"benchmark": so it
+ * can be pulled out of slurm-*.out with grep. Phase statistics are reduced
+ * over MPI_COMM_WORLD; only rank 0 writes.
+ */
+
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+#define BENCH_JSON_SCHEMA 1
+
+// Build of the running binary: "generic" for the portable default, or the
+// -march level and optimizations of a per-microarchitecture variant (e.g.
+// "x86-64-v4+lto+pgo"), set by arch-variants.cmake
+#ifndef BENCH_BUILD_VARIANT
+#define BENCH_BUILD_VARIANT "generic"
+#endif
+#define BENCH_JSON_MAX_DEPTH 16
+
+// Streaming JSON writer (objects, arrays, scalars)
+typedef struct {
+    FILE *fp;
+    int to_stdout;
+    int depth;
+    int count[BENCH_JSON_MAX_DEPTH];    // Members written at each level
+} bench_json_t;
+
+// Min/max/avg of one value across ranks
+typedef struct {
+    double min;
+    double max;
+    double avg;
+} bench_stats_t;
+
+// Distribution of repeated timings of one measurement
+typedef struct {
+    int count;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double avg;
+} bench_percentiles_t;
+
+// Parse "--json" / "--json=PATH"; returns 1 and sets *path (NULL means
+// stdout) if arg is a JSON option, 0 otherwise
+int bench_json_option(const char *arg, const char **path);
+
+// Return the value of "--name=value" if arg starts with prefix ("--name="),
+// NULL otherwise
+const char *bench_option_value(const char *arg, const char *prefix);
+
+// Parse a size or count with an optional K, M or G suffix (powers of 1024);
+// returns 0 if value is empty, malformed, negative or overflows
+long long bench_parse_size(const char *value);
+
+// Open a record for writing (path NULL or "-" = stdout); returns 0 on success
+int bench_json_open(bench_json_t *json, const char *path);
+// Finish the record; returns 0 on success
+int bench_json_close(bench_json_t *json);
+
+// key is NULL for array elements, a member name inside objects
+void bench_json_begin_object(bench_json_t *json, const char *key);
+void bench_json_end_object(bench_json_t *json);
+void bench_json_begin_array(bench_json_t *json, const char *key);
+void bench_json_end_array(bench_json_t *json);
+void bench_json_string(bench_json_t *json, const char *key, const char *value);
+void bench_json_int(bench_json_t *json, const char *key, long long value);
+void bench_json_double(bench_json_t *json, const char *key, double value);
+void bench_json_bool(bench_json_t *json, const char *key, int value);
+void bench_json_stats(bench_json_t *json, const char *key, const bench_stats_t *stats);
+
+void bench_json_percentiles(bench_json_t *json, const char *key,
+                            const bench_percentiles_t *pct);
+
+// Min/max/avg of value over MPI_COMM_WORLD (valid on rank 0). Collective.
+bench_stats_t bench_reduce_stats(double value);
+// The same over comm (valid on its rank 0)
+bench_stats_t bench_reduce_stats_comm(double value, MPI_Comm comm);
+
+// Percentiles (nearest rank) of count values; sorts values in place
+bench_percentiles_t bench_percentiles(double *values, int count);
+
+// Processor names of all ranks, MPI_MAX_PROCESSOR_NAME bytes apart, on
+// rank 0 (NULL elsewhere; caller frees). Collective.
+char *bench_gather_hosts(void);
+char *bench_gather_hosts_comm(MPI_Comm comm);
+
+// Opening members shared by every record: benchmark, schema, timestamp,
+// job_id, build, ranks, threads_per_rank, mpi_library, hosts (rank 0 only)
+void bench_json_header(bench_json_t *json, const char *benchmark, int ranks,
+                       int threads_per_rank, const char *hosts);
+
+#endif /* BENCH_REPORT_H */
@@ -0,0 +1,76 @@
+/*
+ * Startup time of the MPI examples
+ */
+
+#include "bench-startup.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Seconds since the epoch; MPI_Wtime is not available before MPI_Init
+static double wall_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+void bench_startup_begin(bench_startup_t *startup) {
+    const char *value = getenv("BENCH_LAUNCH_TIME");
+    char *end;
+
+    startup->entered = wall_clock();
+    startup->launch = -1.0;
+    startup->initialized = startup->entered;
+    if (value && *value) {
+        double launch = strtod(value, &end);
+        // Ignore a mark from the future (unsynchronized clocks) or garbage
+        if (*end == '\0' && launch > 0.0 && launch <= startup->entered) {
+            startup->launch = launch;
+        }
+    }
+}
+
+void bench_startup_end(bench_startup_t *startup) {
+    startup->initialized = wall_clock();
+}
+
+bench_startup_summary_t bench_startup_summarize(const bench_startup_t *startup) {
+    bench_startup_summary_t summary;
+    int has_launch = startup->launch >= 0.0;
+    // Latest MPI_Init exit, earliest launch and entry, ranks without a launch mark
+    double marks[4] = {startup->initialized, -startup->launch, -startup->entered,
+                       has_launch ? 0.0 : 1.0};
+    double extremes[4];
+
+    MPI_Reduce(marks, extremes, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    summary.has_launch = extremes[3] == 0.0;
+    summary.launch = bench_reduce_stats(has_launch ? startup->entered - startup->launch : 0.0);
+    summary.init = bench_reduce_stats(startup->initialized - startup->entered);
+    summary.ready = extremes[0] + (summary.has_launch ? extremes[1] : extremes[2]);
+    return summary;
+}
+
+void bench_startup_print(const bench_startup_summary_t *summary) {
+    printf("MPI_Init: %.3f seconds (slowest rank) / %.3f (fastest)\n",
+           summary->init.max, summary->init.min);
+    if (summary->has_launch) {
+        printf("Launch to main: %.3f seconds (slowest rank) / %.3f (fastest)\n",
+               summary->launch.max, summary->launch.min);
+        printf("Launch to all ranks initialized: %.3f seconds\n", summary->ready);
+    } else {
+        printf("First rank started to all ranks initialized: %.3f seconds"
+               " (set BENCH_LAUNCH_TIME to include the launch)\n", summary->ready);
+    }
+}
+
+void bench_startup_json(bench_json_t *json, const bench_startup_summary_t *summary) {
+    bench_json_begin_object(json, "startup");
+    bench_json_bool(json, "launch_time_given", summary->has_launch);
+    bench_json_stats(json, "init", &summary->init);
+    if (summary->has_launch) {
+        bench_json_stats(json, "launch", &summary->launch);
+    }
+    bench_json_double(json, "ready", summary->ready);
+    bench_json_end_object(json);
+}
@@ -0,0 +1,55 @@
+/*
+ * Startup time of the MPI examples
+ *
+ * Every rank reads the wall clock on entering main (before MPI_Init) and
+ * again when MPI_Init returns. The launcher may add the time it started
+ * the job step in BENCH_LAUNCH_TIME (seconds since the epoch, e.g.
+ * `date +%s.%N`, exported to the ranks), which splits startup into:
+ *
+ *   launch   BENCH_LAUNCH_TIME to entering main: process start, and for a
+ *            container the image mount and runtime setup
+ *   init     MPI_Init itself: wire-up, shared memory, fabric endpoints
+ *   ready    BENCH_LAUNCH_TIME (without it, the earliest entry into main)
+ *            to the last rank leaving MPI_Init, the time before the first
+ *            collective can start
+ *
+ * launch and ready compare clocks of different nodes and are only as
+ * exact as their synchronization (NTP/chrony, typically well below a
+ * millisecond); init is measured on one clock.
+ */
+
+#ifndef BENCH_STARTUP_H
+#define BENCH_STARTUP_H
+
+#include "bench-report.h"
+
+// Wall-clock marks of one rank (seconds since the epoch)
+typedef struct {
+    double launch;          // BENCH_LAUNCH_TIME, < 0 if unset or invalid
+    double entered;         // Before MPI_Init
+    double initialized;     // After MPI_Init
+} bench_startup_t;
+
+// Statistics across ranks (valid on rank 0)
+typedef struct {
+    int has_launch;         // Every rank had BENCH_LAUNCH_TIME
+    bench_stats_t launch;   // Seconds from launch to main, per rank
+    bench_stats_t init;     // Seconds in MPI_Init, per rank
+    double ready;           // Seconds from launch to the last rank out of MPI_Init
+} bench_startup_summary_t;
+
+// Call right before MPI_Init / MPI_Init_thread
+void bench_startup_begin(bench_startup_t *startup);
+// Call right after it returns
+void bench_startup_end(bench_startup_t *startup);
+
+// Reduce the marks of all ranks over MPI_COMM_WORLD. Collective.
+bench_startup_summary_t bench_startup_summarize(const bench_startup_t *startup);
+
+// Print the startup lines of the performance summary
+void bench_startup_print(const bench_startup_summary_t *summary);
+
+// Add a "startup" object to a record
+void bench_startup_json(bench_json_t *json, const bench_startup_summary_t *summary);
+
+#endif /* BENCH_STARTUP_H */
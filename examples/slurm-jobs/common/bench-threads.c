@@ -0,0 +1,41 @@
+/*
+ * OpenMP thread configuration shared by the MPI examples
+ */
+
+#include "bench-threads.h"
+
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static int thread_count = 1;
+
+int bench_threads_init(const char **source) {
+    const char *where = "serial build";
+
+#ifdef _OPENMP
+    const char *omp_env = getenv("OMP_NUM_THREADS");
+    const char *slurm_env = getenv("SLURM_CPUS_PER_TASK");
+
+    if (omp_env && atoi(omp_env) > 0) {
+        where = "OMP_NUM_THREADS";
+    } else if (slurm_env && atoi(slurm_env) > 0) {
+        omp_set_num_threads(atoi(slurm_env));
+        where = "SLURM_CPUS_PER_TASK";
+    } else {
+        where = "OpenMP default";
+    }
+    thread_count = omp_get_max_threads();
+#endif
+
+    if (source) {
+        *source = where;
+    }
+    return thread_count;
+}
+
+int bench_threads_count(void) {
+    return thread_count;
+}
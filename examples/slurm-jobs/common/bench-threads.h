@@ -0,0 +1,23 @@
+/*
+ * OpenMP thread configuration shared by the MPI examples
+ *
+ * Hybrid MPI+OpenMP runs use one rank per node (or per socket) and one
+ * thread per allocated core. The thread count comes from, in order:
+ *   1. OMP_NUM_THREADS (explicit user setting, honored by the runtime)
+ *   2. SLURM_CPUS_PER_TASK (cores SLURM allocated to each rank)
+ *   3. the OpenMP runtime default
+ *
+ * Builds without OpenMP report a single thread.
+ */
+
+#ifndef BENCH_THREADS_H
+#define BENCH_THREADS_H
+
+// Apply the policy above; returns the number of threads per rank and sets
+// *source (if non-NULL) to a short description of where it came from
+int bench_threads_init(const char **source);
+
+// Threads per rank after bench_threads_init()
+int bench_threads_count(void);
+
+#endif /* BENCH_THREADS_H */
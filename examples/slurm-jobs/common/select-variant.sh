@@ -0,0 +1,80 @@
+#!/bin/bash
+# ========================================
+# Pick the binary variant for this job
+# ========================================
+# The build-*-variants targets add binaries compiled for one x86-64
+# microarchitecture level next to the portable one (see arch-variants.cmake):
+#   ./NAME              portable build, runs everywhere
+#   ./NAME-x86-64-v3    AVX2/FMA (Haswell, Zen and newer)
+#   ./NAME-x86-64-v4    AVX-512 (Skylake-SP, Ice Lake, Zen 4 and newer)
+# A variant only runs on CPUs of its level, so inside a Slurm job the level
+# is the lowest one over all allocated nodes.
+#
+# Usage: select-variant.sh NAME [auto|generic|x86-64-v3|x86-64-v4]
+#   Prints the path to run (e.g. ./matrix-mult-x86-64-v4); notes go to stderr.
+#   auto (default) picks the most specific variant that was built and that
+#   every node supports.
+# select-variant.sh --level prints this node's level (1-4).
+
+# x86-64 microarchitecture level of this CPU from /proc/cpuinfo (1 = baseline)
+cpu_level() {
+    local flags level=1
+    flags=" $(grep -m1 '^flags' /proc/cpuinfo 2>/dev/null | cut -d: -f2) "
+    has() {
+        local f
+        for f in "$@"; do
+            [[ "$flags" == *" $f "* ]] || return 1
+        done
+    }
+    has cx16 lahf_lm popcnt sse4_1 sse4_2 ssse3 && level=2
+    [ "$level" -eq 2 ] && has avx avx2 bmi1 bmi2 f16c fma abm movbe xsave && level=3
+    [ "$level" -eq 3 ] && has avx512f avx512bw avx512cd avx512dq avx512vl && level=4
+    echo "$level"
+}
+
+if [ "$1" = "--level" ]; then
+    cpu_level
+    exit 0
+fi
+
+NAME=$1
+VARIANT=${2:-auto}
+if [ -z "$NAME" ]; then
+    echo "Usage: $0 NAME [auto|generic|x86-64-v3|x86-64-v4]" >&2
+    exit 1
+fi
+
+case "$VARIANT" in
+    generic)
+        echo "./$NAME"
+        exit 0
+        ;;
+    auto) ;;
+    *)
+        if [ ! -x "./$NAME-$VARIANT" ]; then
+            echo "ERROR: variant ./$NAME-$VARIANT not built (build-*-variants target)" >&2
+            exit 1
+        fi
+        echo "./$NAME-$VARIANT"
+        exit 0
+        ;;
+esac
+
+# Lowest level over the allocated nodes (one probe task per node), or this
+# node's level outside Slurm or if the probe step fails
+level=""
+if [ -n "${SLURM_JOB_ID:-}" ] && [ -n "${SLURM_JOB_NUM_NODES:-}" ] && command -v srun >/dev/null; then
+    level=$(srun --nodes="$SLURM_JOB_NUM_NODES" --ntasks="$SLURM_JOB_NUM_NODES" \
+                 --ntasks-per-node=1 "$0" --level 2>/dev/null | sort -n | head -1)
+fi
+if [ -z "$level" ]; then
+    level=$(cpu_level)
+fi
+
+for ((l = level; l >= 3; l--)); do
+    if [ -x "./$NAME-x86-64-v$l" ]; then
+        echo "./$NAME-x86-64-v$l"
+        exit 0
+    fi
+done
+echo "./$NAME"
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Container overhead: compare host, bind and hybrid runs of the same binaries.
+
+Reads the records container-bench.sbatch wrote (<example>-<mode>-r<rep>.json)
+and prints one table per example, one row per mode, medians over the
+repetitions:
+
+  ready     launch (BENCH_LAUNCH_TIME) to the last rank out of MPI_Init
+  cold      ready of the first repetition (image not yet in the page cache)
+  to main   launch to entering main, slowest rank: process and container start
+  init      MPI_Init, slowest rank
+  figure    hello: probe latency (us, inter-node pairs if any) and bandwidth
+            (MB/s) at the largest message; matrix: GFLOPS; pi: samples/s
+
+and next to each the change against the host mode. Positive changes are
+overhead: longer startup, higher latency, lower throughput.
+
+Usage: container-report.py [--csv=PATH] DIR...
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import statistics
+import sys
+
+RECORD_NAME = re.compile(r"^(?P<example>[a-z]+)-(?P<mode>[a-z]+)-r(?P<rep>\d+)\.json$")
+MODES = ["host", "bind", "hybrid"]
+
+
+def startup_figures(record):
+    """(ready, to main, init) in seconds from a record's startup object."""
+    startup = record.get("startup", {})
+    launch = startup.get("launch", {}).get("max") if startup.get("launch_time_given") else None
+    return startup.get("ready"), launch, startup.get("init", {}).get("max")
+
+
+def example_figures(example, record):
+    """[(name, value, higher_is_better)] of the example's throughput/latency."""
+    metrics = record.get("metrics", {})
+    if example == "matrix":
+        return [("GFLOPS", metrics.get("gflops"), True)]
+    if example == "pi":
+        return [("samples/s", metrics.get("samples_per_second"), True)]
+    probe = record.get("probe", {})
+    inter = probe.get("median_inter_latency_us", 0) > 0
+    kind = "inter" if inter else "intra"
+    return [(f"{kind} latency us", probe.get(f"median_{kind}_latency_us"), False),
+            (f"{kind} MB/s", probe.get(f"median_{kind}_bandwidth_mbs"), True)]
+
+
+def load_runs(directories):
+    """runs[example][mode] = list of (rep, record), sorted by repetition."""
+    runs = {}
+    for directory in directories:
+        for name in sorted(os.listdir(directory)):
+            match = RECORD_NAME.match(name)
+            if not match:
+                continue
+            try:
+                with open(os.path.join(directory, name)) as f:
+                    record = json.load(f)
+            except (OSError, ValueError) as err:
+                print(f"Warning: skipping {name}: {err}", file=sys.stderr)
+                continue
+            runs.setdefault(match["example"], {}).setdefault(match["mode"], []).append(
+                (int(match["rep"]), record))
+    for modes in runs.values():
+        for entries in modes.values():
+            entries.sort(key=lambda entry: entry[0])
+    return runs
+
+
+def median(values):
+    values = [v for v in values if isinstance(v, (int, float))]
+    return statistics.median(values) if values else None
+
+
+def overhead(value, base, higher_is_better=False):
+    """Relative cost against the host figure (positive = worse)."""
+    if value is None or not base:
+        return None
+    return (base - value) / base if higher_is_better else (value - base) / base
+
+
+def fmt(value, scale=1.0, digits=3):
+    return "-" if value is None else f"{value * scale:.{digits}g}"
+
+
+def fmt_change(change):
+    return "" if change is None else f" ({100 * change:+.1f}%)"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("directories", nargs="+", help="container-bench results directories")
+    parser.add_argument("--csv", help="also write the rows to this CSV file")
+    args = parser.parse_args()
+
+    runs = load_runs(args.directories)
+    if not runs:
+        print("Error: no container-bench records found", file=sys.stderr)
+        return 1
+
+    rows = []
+    for example in sorted(runs):
+        modes = runs[example]
+        order = [m for m in MODES if m in modes] + sorted(set(modes) - set(MODES))
+        summary = {}
+        for mode in order:
+            records = [record for _, record in modes[mode]]
+            startups = [startup_figures(r) for r in records]
+            figures = [example_figures(example, r) for r in records]
+            summary[mode] = {
+                "runs": len(records),
+                "ready": median(s[0] for s in startups),
+                "cold": startups[0][0],
+                "to_main": median(s[1] for s in startups),
+                "init": median(s[2] for s in startups),
+                "figures": [(name, median(f[i][1] for f in figures), better)
+                            for i, (name, _, better) in enumerate(figures[0])],
+            }
+        host = summary.get("host")
+
+        first = modes[order[0]][0][1]
+        print(f"\n{example} ({first.get('ranks')} ranks, "
+              f"{len(set(first.get('hosts', [])))} nodes)")
+        names = [name for name, _, _ in summary[order[0]]["figures"]]
+        print(f"{'Mode':<8} {'Runs':>4}  {'Ready ms':>18} {'Cold ms':>18} {'To main ms':>18}"
+              f" {'MPI_Init ms':>18}  " + "  ".join(f"{n:>20}" for n in names))
+        for mode in order:
+            s = summary[mode]
+            cells = []
+            for key in ("ready", "cold", "to_main", "init"):
+                change = overhead(s[key], host[key]) if host and mode != "host" else None
+                cells.append(f"{fmt(s[key], 1e3) + fmt_change(change):>18}")
+            figure_cells = []
+            for i, (name, value, better) in enumerate(s["figures"]):
+                change = (overhead(value, host["figures"][i][1], better)
+                          if host and mode != "host" else None)
+                figure_cells.append(f"{fmt(value) + fmt_change(change):>20}")
+                rows.append({"example": example, "mode": mode, "figure": name, "value": value,
+                             "overhead": change})
+            print(f"{mode:<8} {s['runs']:>4}  " + " ".join(cells) + "  "
+                  + "  ".join(figure_cells))
+            for key in ("ready", "cold", "to_main", "init"):
+                change = overhead(s[key], host[key]) if host and mode != "host" else None
+                rows.append({"example": example, "mode": mode, "figure": f"{key}_seconds",
+                             "value": s[key], "overhead": change})
+        if not host:
+            print("(no host runs: overhead not computed)")
+
+    print("\nOverhead in parentheses: change against host, positive = slower start,"
+          " higher latency or lower throughput")
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=["example", "mode", "figure", "value",
+                                                   "overhead"])
+            writer.writeheader()
+            writer.writerows(rows)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
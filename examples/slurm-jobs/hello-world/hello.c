@@ -3,27 +3,93 @@
  *
  * Simple MPI program that prints rank and hostname from each process.
  * Demonstrates basic MPI initialization and multi-node execution.
+ * With --probe it also measures the fabric: a ping-pong latency/bandwidth
+ * sweep between every pair of ranks, flagging slow links (see probe.h).
+ * The summary includes the startup time: MPI_Init, and with
+ * BENCH_LAUNCH_TIME set by the launcher the time from launch to all ranks
+ * initialized (see bench-startup.h).
  *
- * Compile: mpicc -o hello hello.c
- * Run: mpirun -np 4 ./hello
+ * Options:
+ *   --json[=PATH]     Also write a JSON record (ranks, hosts) to stdout or PATH
+ *   --probe           Run the all-pairs point-to-point sweep
+ *   --probe-max=N     Largest message in bytes, K/M/G suffixes allowed
+ *                     (default: 64M)
+ *   --probe-slow=F    Flag links F times slower than their class median
+ *                     (default: 2.0)
+ *
+ * Compile: mpicc -I../common -o hello hello.c probe.c ../common/bench-report.c \
+ *          ../common/bench-alloc.c ../common/bench-startup.c
+ * Run: mpirun -np 4 ./hello --probe
  */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "bench-report.h"
+#include "bench-startup.h"
+#include "probe.h"
+
 #define MAX_HOSTNAME_LEN 256
 
+// Number of distinct names in a list of MPI_MAX_PROCESSOR_NAME-sized slots
+int count_unique_hosts(const char *hosts, int count) {
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = strcmp(hosts + (size_t)i * MPI_MAX_PROCESSOR_NAME,
+                          hosts + (size_t)j * MPI_MAX_PROCESSOR_NAME) == 0;
+        }
+        unique += !seen;
+    }
+    return unique;
+}
+
+// Write the JSON record of this run (rank 0 only)
+void write_json_record(const char *path, int world_size, const char *hosts,
+                       const bench_startup_summary_t *startup,
+                       const probe_config_t *probe_config, const probe_result_t *probe) {
+    bench_json_t json;
+
+    if (bench_json_open(&json, path) != 0) {
+        printf("Warning: could not write JSON record\n");
+        return;
+    }
+    bench_json_begin_object(&json, NULL);
+    bench_json_header(&json, "hello", world_size, 1, hosts);
+    bench_json_begin_object(&json, "metrics");
+    bench_json_int(&json, "nodes", count_unique_hosts(hosts, world_size));
+    bench_json_end_object(&json);
+    bench_startup_json(&json, startup);
+    if (probe) {
+        probe_json(&json, probe, probe_config->slow_factor);
+    }
+    bench_json_end_object(&json);
+    if (bench_json_close(&json) != 0) {
+        printf("Warning: could not write JSON record\n");
+    }
+}
+
 int main(int argc, char** argv) {
     int world_size;  // Total number of processes
     int world_rank;  // Rank of this process
     char hostname[MAX_HOSTNAME_LEN];
     char processor_name[MPI_MAX_PROCESSOR_NAME];
     int name_len;
+    int json = 0;
+    const char *json_path = NULL;
+    int probe = 0;
+    probe_config_t probe_config = {PROBE_DEFAULT_MAX_BYTES, PROBE_DEFAULT_SLOW_FACTOR};
+    probe_result_t probe_result;
+    bench_startup_t startup;
 
     // Initialize MPI environment
+    bench_startup_begin(&startup);
     MPI_Init(&argc, &argv);
+    bench_startup_end(&startup);
 
     // Get total number of processes
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
@@ -31,6 +97,37 @@ int main(int argc, char** argv) {
     // Get rank of current process
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (bench_json_option(arg, &json_path)) {
+            json = 1;
+        } else if (strcmp(arg, "--probe") == 0) {
+            probe = 1;
+        } else if (strncmp(arg, "--probe-max=", 12) == 0) {
+            probe_config.max_bytes = (size_t)bench_parse_size(arg + 12);
+            probe = 1;
+        } else if (strncmp(arg, "--probe-slow=", 13) == 0) {
+            probe_config.slow_factor = atof(arg + 13);
+            probe = 1;
+        } else {
+            if (world_rank == 0) {
+                printf("Error: Unknown option '%s'\n", arg);
+                printf("Usage: %s [--json[=PATH]] [--probe] [--probe-max=N] [--probe-slow=F]\n",
+                       argv[0]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (probe_config.max_bytes < PROBE_MIN_BYTES || probe_config.max_bytes > (1u << 30)
+        || probe_config.slow_factor <= 1.0) {
+        if (world_rank == 0) {
+            printf("Error: --probe-max must be 8 bytes to 1G and --probe-slow greater than 1\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
     // Get processor name (hostname)
     MPI_Get_processor_name(processor_name, &name_len);
 
@@ -45,6 +142,7 @@ int main(int argc, char** argv) {
 
     // Synchronize all processes
     MPI_Barrier(MPI_COMM_WORLD);
+    bench_startup_summary_t startup_summary = bench_startup_summarize(&startup);
 
     // Rank 0 prints summary
     if (world_rank == 0) {
@@ -54,9 +152,33 @@ int main(int argc, char** argv) {
         printf("========================================\n");
         printf("Total processes: %d\n", world_size);
         printf("Master rank: %d (on %s)\n", world_rank, hostname);
+        bench_startup_print(&startup_summary);
         printf("========================================\n");
     }
 
+    if (json || probe) {
+        char *hosts = bench_gather_hosts();
+        if (probe) {
+            if (world_rank == 0) {
+                printf("\nProbing point-to-point links (%d pairs)...\n",
+                       world_size * (world_size - 1) / 2);
+                fflush(stdout);
+            }
+            probe_run(&probe_config, hosts, &probe_result);
+            if (world_rank == 0) {
+                probe_print(&probe_result, hosts, probe_config.slow_factor);
+            }
+        }
+        if (json && world_rank == 0) {
+            write_json_record(json_path, world_size, hosts, &startup_summary, &probe_config,
+                              probe ? &probe_result : NULL);
+        }
+        if (probe) {
+            probe_free(&probe_result);
+        }
+        free(hosts);
+    }
+
     // Finalize MPI environment
     MPI_Finalize();
 
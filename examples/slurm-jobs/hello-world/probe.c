@@ -0,0 +1,307 @@
+/*
+ * Point-to-point fabric probe for the hello-world example
+ */
+
+#include "probe.h"
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+
+#define PROBE_TAG 200
+#define PROBE_WARMUP 2
+
+// Round trips per size: many for small messages (timer resolution), a few
+// for large ones (bandwidth-bound, ~8 MB moved per direction at least)
+#define PROBE_MIN_ITERS 4
+#define PROBE_MAX_ITERS 200
+#define PROBE_BYTES_PER_SIZE (8u << 20)
+
+static int probe_iterations(size_t bytes) {
+    size_t iters = PROBE_BYTES_PER_SIZE / bytes;
+    if (iters < PROBE_MIN_ITERS) {
+        return PROBE_MIN_ITERS;
+    }
+    return iters > PROBE_MAX_ITERS ? PROBE_MAX_ITERS : (int)iters;
+}
+
+// Mean one-way time of `iters` round trips of `bytes` between a and b
+static double ping_pong(int me, int a, int b, char *buf, size_t bytes, int iters) {
+    double t0 = 0.0;
+    for (int it = -PROBE_WARMUP; it < iters; it++) {
+        if (it == 0) {
+            t0 = MPI_Wtime();
+        }
+        if (me == a) {
+            MPI_Send(buf, (int)bytes, MPI_CHAR, b, PROBE_TAG, MPI_COMM_WORLD);
+            MPI_Recv(buf, (int)bytes, MPI_CHAR, b, PROBE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(buf, (int)bytes, MPI_CHAR, a, PROBE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(buf, (int)bytes, MPI_CHAR, a, PROBE_TAG, MPI_COMM_WORLD);
+        }
+    }
+    return (MPI_Wtime() - t0) / (2.0 * iters);
+}
+
+static int compare_doubles(const void *x, const void *y) {
+    double a = *(const double *)x;
+    double b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static double median(double *values, int count) {
+    if (count == 0) {
+        return 0.0;
+    }
+    qsort(values, count, sizeof(double), compare_doubles);
+    return count % 2 ? values[count / 2] : 0.5 * (values[count / 2 - 1] + values[count / 2]);
+}
+
+double probe_latency(const probe_result_t *result, int a, int b) {
+    return result->one_way[((size_t)a * result->ranks + b) * result->num_sizes];
+}
+
+double probe_bandwidth(const probe_result_t *result, int a, int b) {
+    int last = result->num_sizes - 1;
+    double t = result->one_way[((size_t)a * result->ranks + b) * result->num_sizes + last];
+    return t > 0.0 ? result->sizes[last] / t : 0.0;
+}
+
+// Class medians and slow-link flags (rank 0)
+static void classify(probe_result_t *result, const char *hosts, double slow_factor) {
+    int p = result->ranks;
+    size_t pairs = (size_t)p * (p - 1) / 2;
+    double *lat[2], *bw[2];
+    int count[2] = {0, 0};
+
+    for (int c = 0; c < 2; c++) {
+        lat[c] = malloc((pairs + 1) * sizeof(double));
+        bw[c] = malloc((pairs + 1) * sizeof(double));
+        if (!lat[c] || !bw[c]) {
+            printf("Probe classification allocation failed\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++) {
+            int c = strcmp(hosts + (size_t)a * MPI_MAX_PROCESSOR_NAME,
+                           hosts + (size_t)b * MPI_MAX_PROCESSOR_NAME) == 0;
+            result->intra[a * p + b] = c;
+            lat[c][count[c]] = probe_latency(result, a, b);
+            bw[c][count[c]] = probe_bandwidth(result, a, b);
+            count[c]++;
+        }
+    }
+    for (int c = 0; c < 2; c++) {
+        result->median_latency[c] = median(lat[c], count[c]);
+        result->median_bandwidth[c] = median(bw[c], count[c]);
+        free(lat[c]);
+        free(bw[c]);
+    }
+
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++) {
+            int c = result->intra[a * p + b];
+            result->slow[a * p + b] =
+                probe_latency(result, a, b) > slow_factor * result->median_latency[c]
+                || probe_bandwidth(result, a, b) < result->median_bandwidth[c] / slow_factor;
+        }
+    }
+}
+
+void probe_run(const probe_config_t *config, const char *hosts, probe_result_t *result) {
+    int p, me;
+    MPI_Comm_size(MPI_COMM_WORLD, &p);
+    MPI_Comm_rank(MPI_COMM_WORLD, &me);
+
+    memset(result, 0, sizeof(*result));
+    result->ranks = p;
+    for (size_t s = PROBE_MIN_BYTES; s <= config->max_bytes; s *= 2) {
+        result->num_sizes++;
+    }
+    size_t cells = (size_t)p * p;
+    size_t entries = cells * result->num_sizes;
+    result->sizes = malloc(result->num_sizes * sizeof(size_t));
+    result->one_way = calloc(entries, sizeof(double));
+    result->intra = calloc(cells, sizeof(int));
+    result->slow = calloc(cells, sizeof(int));
+    double *local = calloc(entries, sizeof(double));
+    // Large messages move through huge pages where available (BENCH_HUGEPAGES)
+    char *buf = bench_alloc(config->max_bytes);
+    if (!result->sizes || !result->one_way || !result->intra || !result->slow
+        || !local || !buf) {
+        printf("Rank %d: Probe allocation failed\n", me);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    memset(buf, 0, config->max_bytes);
+    for (int i = 0; i < result->num_sizes; i++) {
+        result->sizes[i] = (size_t)PROBE_MIN_BYTES << i;
+    }
+
+    // One pair at a time; everyone else waits at the barrier
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++) {
+            if (me == a || me == b) {
+                double *out = local + ((size_t)a * p + b) * result->num_sizes;
+                for (int i = 0; i < result->num_sizes; i++) {
+                    size_t bytes = result->sizes[i];
+                    double t = ping_pong(me, a, b, buf, bytes, probe_iterations(bytes));
+                    if (me == a) {
+                        out[i] = t;
+                    }
+                }
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+
+    // Each entry is written by exactly one rank
+    MPI_Reduce(local, result->one_way, (int)entries, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (me == 0) {
+        classify(result, hosts, config->slow_factor);
+    }
+
+    free(local);
+    bench_free(buf);
+}
+
+static void format_bytes(size_t bytes, char *out, size_t len) {
+    if (bytes >= (1u << 20)) {
+        snprintf(out, len, "%zu MB", bytes >> 20);
+    } else if (bytes >= (1u << 10)) {
+        snprintf(out, len, "%zu KB", bytes >> 10);
+    } else {
+        snprintf(out, len, "%zu B", bytes);
+    }
+}
+
+void probe_print(const probe_result_t *result, const char *hosts, double slow_factor) {
+    int p = result->ranks;
+    int slow_links = 0;
+    char small[32], large[32];
+
+    format_bytes(result->sizes[0], small, sizeof(small));
+    format_bytes(result->sizes[result->num_sizes - 1], large, sizeof(large));
+
+    printf("\n");
+    printf("========================================\n");
+    printf("Point-to-Point Probe (%s to %s, %d sizes)\n", small, large, result->num_sizes);
+    printf("========================================\n");
+    for (int c = 1; c >= 0; c--) {
+        printf("Median %s: ", c ? "intra-node" : "inter-node");
+        if (result->median_latency[c] > 0.0) {
+            printf("%.2f us, %.0f MB/s\n", result->median_latency[c] * 1e6,
+                   result->median_bandwidth[c] / 1e6);
+        } else {
+            printf("n/a (no such pairs)\n");
+        }
+    }
+    printf("(* = slower than the median of its class by more than %.1fx)\n", slow_factor);
+
+    printf("\nLatency (us, %s one-way):\n%6s", small, "");
+    for (int b = 0; b < p; b++) {
+        printf(" %9d", b);
+    }
+    printf("\n");
+    for (int a = 0; a < p; a++) {
+        printf("%6d", a);
+        for (int b = 0; b < p; b++) {
+            int lo = a < b ? a : b, hi = a < b ? b : a;
+            if (a == b) {
+                printf(" %9s", "-");
+            } else {
+                printf(" %8.2f%c", probe_latency(result, lo, hi) * 1e6,
+                       result->slow[lo * p + hi] ? '*' : ' ');
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\nBandwidth (MB/s, %s):\n%6s", large, "");
+    for (int b = 0; b < p; b++) {
+        printf(" %9d", b);
+    }
+    printf("\n");
+    for (int a = 0; a < p; a++) {
+        printf("%6d", a);
+        for (int b = 0; b < p; b++) {
+            int lo = a < b ? a : b, hi = a < b ? b : a;
+            if (a == b) {
+                printf(" %9s", "-");
+            } else {
+                printf(" %8.0f%c", probe_bandwidth(result, lo, hi) / 1e6,
+                       result->slow[lo * p + hi] ? '*' : ' ');
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\nSlow links:\n");
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++) {
+            if (!result->slow[a * p + b]) {
+                continue;
+            }
+            printf("  %d (%s) <-> %d (%s) [%s]: %.2f us, %.0f MB/s\n",
+                   a, hosts + (size_t)a * MPI_MAX_PROCESSOR_NAME,
+                   b, hosts + (size_t)b * MPI_MAX_PROCESSOR_NAME,
+                   result->intra[a * p + b] ? "intra-node" : "inter-node",
+                   probe_latency(result, a, b) * 1e6, probe_bandwidth(result, a, b) / 1e6);
+            slow_links++;
+        }
+    }
+    if (slow_links == 0) {
+        printf("  none\n");
+    }
+    printf("========================================\n");
+}
+
+void probe_json(bench_json_t *json, const probe_result_t *result, double slow_factor) {
+    int p = result->ranks;
+
+    bench_json_begin_object(json, "probe");
+    bench_json_double(json, "slow_factor", slow_factor);
+    bench_json_begin_array(json, "sizes");
+    for (int i = 0; i < result->num_sizes; i++) {
+        bench_json_int(json, NULL, (long long)result->sizes[i]);
+    }
+    bench_json_end_array(json);
+    bench_json_double(json, "median_intra_latency_us", result->median_latency[1] * 1e6);
+    bench_json_double(json, "median_intra_bandwidth_mbs", result->median_bandwidth[1] / 1e6);
+    bench_json_double(json, "median_inter_latency_us", result->median_latency[0] * 1e6);
+    bench_json_double(json, "median_inter_bandwidth_mbs", result->median_bandwidth[0] / 1e6);
+
+    bench_json_begin_array(json, "pairs");
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++) {
+            const double *t = result->one_way + ((size_t)a * p + b) * result->num_sizes;
+            bench_json_begin_object(json, NULL);
+            bench_json_int(json, "a", a);
+            bench_json_int(json, "b", b);
+            bench_json_bool(json, "intra_node", result->intra[a * p + b]);
+            bench_json_bool(json, "slow", result->slow[a * p + b]);
+            bench_json_double(json, "latency_us", probe_latency(result, a, b) * 1e6);
+            bench_json_double(json, "bandwidth_mbs", probe_bandwidth(result, a, b) / 1e6);
+            bench_json_begin_array(json, "one_way_us");
+            for (int i = 0; i < result->num_sizes; i++) {
+                bench_json_double(json, NULL, t[i] * 1e6);
+            }
+            bench_json_end_array(json);
+            bench_json_end_object(json);
+        }
+    }
+    bench_json_end_array(json);
+    bench_json_end_object(json);
+}
+
+void probe_free(probe_result_t *result) {
+    free(result->sizes);
+    free(result->one_way);
+    free(result->intra);
+    free(result->slow);
+    memset(result, 0, sizeof(*result));
+}
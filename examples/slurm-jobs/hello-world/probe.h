@@ -0,0 +1,58 @@
+/*
+ * Point-to-point fabric probe for the hello-world example
+ *
+ * hello --probe runs a ping-pong sweep (8 B up to --probe-max, doubling)
+ * between every pair of ranks, one pair at a time so pairs do not compete
+ * for the same NIC. Pairs are classed as intra-node (same processor name)
+ * or inter-node. A link is flagged slow when its small-message latency is
+ * more than slow_factor times the median of its class, or its large-message
+ * bandwidth is less than the median divided by slow_factor. A misconfigured
+ * NIC, or a VM whose NIC is emulated instead of virtio, shows up as a row of
+ * flagged links.
+ */
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stddef.h>
+
+#include "bench-report.h"
+
+#define PROBE_MIN_BYTES 8
+#define PROBE_DEFAULT_MAX_BYTES (64u << 20)
+#define PROBE_DEFAULT_SLOW_FACTOR 2.0
+
+typedef struct {
+    size_t max_bytes;       // Largest message in the sweep
+    double slow_factor;     // Deviation from the class median that flags a link
+} probe_config_t;
+
+// Sweep results, significant on rank 0 after probe_run()
+typedef struct {
+    int ranks;
+    int num_sizes;
+    size_t *sizes;          // Message sizes, PROBE_MIN_BYTES doubling
+    double *one_way;        // [a * ranks + b][size] mean one-way time (s), a < b
+    int *intra;             // [a * ranks + b] 1 if a and b share a node
+    int *slow;              // [a * ranks + b] 1 if the link was flagged
+    double median_latency[2];   // Per class (0 = inter, 1 = intra), seconds
+    double median_bandwidth[2]; // Per class, bytes/s at the largest size
+} probe_result_t;
+
+// Run the sweep on MPI_COMM_WORLD and classify links on rank 0. hosts is
+// the bench_gather_hosts() list (rank 0 only). Collective.
+void probe_run(const probe_config_t *config, const char *hosts, probe_result_t *result);
+
+// Latency/bandwidth of one pair (a < b) from a result
+double probe_latency(const probe_result_t *result, int a, int b);
+double probe_bandwidth(const probe_result_t *result, int a, int b);
+
+// Print the all-pairs latency and bandwidth matrices and the slow links
+void probe_print(const probe_result_t *result, const char *hosts, double slow_factor);
+
+// Add a "probe" object (sizes, per-pair summary, flagged links) to a record
+void probe_json(bench_json_t *json, const probe_result_t *result, double slow_factor);
+
+void probe_free(probe_result_t *result);
+
+#endif /* PROBE_H */
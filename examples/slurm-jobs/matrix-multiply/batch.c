@@ -0,0 +1,418 @@
+/*
+ * Batched small-matrix multiplication (--batch=COUNT)
+ *
+ * The compact kernels are one C body instantiated per ISA with target
+ * attributes (like the GEMM micro-kernels) and per dtype: the lane loop
+ * has a compile-time width, so the compiler turns it into whole-vector
+ * FMAs of the attribute's ISA. Each kernel keeps a 1×4 block of C (four
+ * vectors) in registers across the k loop, so every k step loads one
+ * vector of A and four of B for four FMAs.
+ */
+
+#include "batch.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+#include "matrix-init.h"
+
+// Rounding tolerance factor, as in matrix-verify.c
+#define BATCH_VERIFY_TOLERANCE 64.0
+
+// Columns of C kept in registers by the compact kernels
+#define COMPACT_JB 4
+
+typedef void (*compact_fn)(int n, const void *A, const void *B, void *C);
+
+// C = A × B for one group of W interleaved n×n matrices
+#define COMPACT_KERNEL(name, attr, in_t, acc_t, W, LOAD)                            \
+    attr static void name(int n, const void *A_, const void *B_, void *C_) {        \
+        const in_t *restrict A = A_;                                                \
+        const in_t *restrict B = B_;                                                \
+        acc_t *restrict C = C_;                                                     \
+        for (int i = 0; i < n; i++) {                                               \
+            int j = 0;                                                              \
+            for (; j + COMPACT_JB <= n; j += COMPACT_JB) {                          \
+                acc_t acc[COMPACT_JB][W] = {{0}};                                   \
+                for (int p = 0; p < n; p++) {                                       \
+                    const in_t *a = A + ((size_t)i * n + p) * W;                    \
+                    const in_t *b = B + ((size_t)p * n + j) * W;                    \
+                    for (int jj = 0; jj < COMPACT_JB; jj++) {                       \
+                        for (int l = 0; l < W; l++) {                               \
+                            acc[jj][l] += LOAD(a[l]) * LOAD(b[jj * W + l]);         \
+                        }                                                           \
+                    }                                                               \
+                }                                                                   \
+                for (int jj = 0; jj < COMPACT_JB; jj++) {                           \
+                    for (int l = 0; l < W; l++) {                                   \
+                        C[((size_t)i * n + j + jj) * W + l] = acc[jj][l];           \
+                    }                                                               \
+                }                                                                   \
+            }                                                                       \
+            for (; j < n; j++) {                                                    \
+                acc_t acc[W] = {0};                                                 \
+                for (int p = 0; p < n; p++) {                                       \
+                    const in_t *a = A + ((size_t)i * n + p) * W;                    \
+                    const in_t *b = B + ((size_t)p * n + j) * W;                    \
+                    for (int l = 0; l < W; l++) {                                   \
+                        acc[l] += LOAD(a[l]) * LOAD(b[l]);                          \
+                    }                                                               \
+                }                                                                   \
+                for (int l = 0; l < W; l++) {                                       \
+                    C[((size_t)i * n + j) * W + l] = acc[l];                        \
+                }                                                                   \
+            }                                                                       \
+        }                                                                           \
+    }
+
+#define LOAD_NATIVE(x) (x)
+#define LOAD_BF16(x) gemm_bf16_to_float(x)
+
+// Portable paths: 16-byte vectors (SSE2, NEON)
+COMPACT_KERNEL(compact_generic_f64, , double, double, 2, LOAD_NATIVE)
+COMPACT_KERNEL(compact_generic_f32, , float, float, 4, LOAD_NATIVE)
+COMPACT_KERNEL(compact_generic_bf16, , gemm_bf16_t, float, 4, LOAD_BF16)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86 1
+#define AVX2_ATTR __attribute__((target("avx2,fma")))
+#define AVX512_ATTR __attribute__((target("avx512f")))
+COMPACT_KERNEL(compact_avx2_f64, AVX2_ATTR, double, double, 4, LOAD_NATIVE)
+COMPACT_KERNEL(compact_avx2_f32, AVX2_ATTR, float, float, 8, LOAD_NATIVE)
+COMPACT_KERNEL(compact_avx2_bf16, AVX2_ATTR, gemm_bf16_t, float, 8, LOAD_BF16)
+COMPACT_KERNEL(compact_avx512_f64, AVX512_ATTR, double, double, 8, LOAD_NATIVE)
+COMPACT_KERNEL(compact_avx512_f32, AVX512_ATTR, float, float, 16, LOAD_NATIVE)
+COMPACT_KERNEL(compact_avx512_bf16, AVX512_ATTR, gemm_bf16_t, float, 16, LOAD_BF16)
+#endif
+
+int batch_layout_from_name(const char *name, batch_layout_t *layout) {
+    if (strcmp(name, "auto") == 0) {
+        *layout = BATCH_LAYOUT_AUTO;
+    } else if (strcmp(name, "compact") == 0) {
+        *layout = BATCH_LAYOUT_COMPACT;
+    } else if (strcmp(name, "strided") == 0) {
+        *layout = BATCH_LAYOUT_STRIDED;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *batch_layout_name(batch_layout_t layout) {
+    switch (layout) {
+    case BATCH_LAYOUT_COMPACT:
+        return "compact";
+    case BATCH_LAYOUT_STRIDED:
+        return "strided";
+    default:
+        return "auto";
+    }
+}
+
+batch_layout_t batch_resolve_layout(batch_layout_t layout, int n) {
+    if (layout != BATCH_LAYOUT_AUTO) {
+        return layout;
+    }
+    return n <= BATCH_COMPACT_MAX_N ? BATCH_LAYOUT_COMPACT : BATCH_LAYOUT_STRIDED;
+}
+
+int batch_group_width(gemm_dtype_t dtype) {
+    int vector_bytes;
+    switch (gemm_get_isa()) {
+    case GEMM_ISA_AVX512:
+        vector_bytes = 64;
+        break;
+    case GEMM_ISA_AVX2:
+        vector_bytes = 32;
+        break;
+    default:
+        vector_bytes = 16;
+        break;
+    }
+    // BF16 is computed in FP32 lanes
+    return vector_bytes / (dtype == GEMM_DTYPE_F64 ? (int)sizeof(double) : (int)sizeof(float));
+}
+
+static compact_fn compact_kernel(gemm_dtype_t dtype) {
+    static const compact_fn generic[GEMM_DTYPE_COUNT] = {
+        compact_generic_f64, compact_generic_f32, compact_generic_bf16
+    };
+#ifdef BATCH_X86
+    static const compact_fn avx2[GEMM_DTYPE_COUNT] = {
+        compact_avx2_f64, compact_avx2_f32, compact_avx2_bf16
+    };
+    static const compact_fn avx512[GEMM_DTYPE_COUNT] = {
+        compact_avx512_f64, compact_avx512_f32, compact_avx512_bf16
+    };
+    switch (gemm_get_isa()) {
+    case GEMM_ISA_AVX512:
+        return avx512[dtype];
+    case GEMM_ISA_AVX2:
+        return avx2[dtype];
+    default:
+        break;
+    }
+#endif
+    return generic[dtype];
+}
+
+// Shape of this rank's batch in its layout
+typedef struct {
+    int n;
+    int count;              // Matrices of the rank
+    int width;              // Matrices per compact group (1: strided)
+    int groups;             // Compact groups (count rounded up), or count
+    gemm_dtype_t dtype;
+} batch_shape_t;
+
+// Elements of one operand of the whole batch, padding included
+static size_t batch_elements(const batch_shape_t *s) {
+    return (size_t)s->groups * s->width * s->n * s->n;
+}
+
+// Position of element (i, j) of matrix b
+static size_t batch_index(const batch_shape_t *s, int b, int i, int j) {
+    size_t nn = (size_t)s->n * s->n;
+    size_t within = (size_t)i * s->n + j;
+    return (size_t)(b / s->width) * nn * s->width + within * s->width + b % s->width;
+}
+
+// Element `index` of an input (dtype) or of C (out = 1: double or float)
+static double batch_load(const batch_shape_t *s, const void *buf, size_t index, int out) {
+    gemm_dtype_t type = s->dtype;
+    if (out && type == GEMM_DTYPE_BF16) {
+        type = GEMM_DTYPE_F32;
+    }
+    switch (type) {
+    case GEMM_DTYPE_F32:
+        return ((const float*)buf)[index];
+    case GEMM_DTYPE_BF16:
+        return gemm_bf16_to_float(((const gemm_bf16_t*)buf)[index]);
+    default:
+        return ((const double*)buf)[index];
+    }
+}
+
+// Generate this rank's matrices of `which` and store them rounded to dtype
+// in the layout; compact padding matrices are zero
+static void batch_init(const batch_shape_t *s, matrix_id_t which, uint64_t seed,
+                       int first, void *dst) {
+    size_t nn = (size_t)s->n * s->n;
+    size_t esize = gemm_dtype_size(s->dtype);
+    double *tall = bench_alloc((size_t)s->count * nn * sizeof(double));
+    void *rounded = s->width > 1 ? bench_alloc((size_t)s->count * nn * esize) : dst;
+
+    if (!tall || !rounded) {
+        printf("Memory allocation failed for input generation\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    matrix_init_block(which, seed, s->n, first * s->n, s->count * s->n, 0, s->n, tall, s->n);
+    gemm_lowp_round(s->dtype, tall, rounded, (size_t)s->count * nn);
+    if (s->width > 1) {
+        // Interleave, each thread writing (and first-touching) its groups
+        #pragma omp parallel for schedule(static)
+        for (int g = 0; g < s->groups; g++) {
+            char *group = (char*)dst + (size_t)g * s->width * nn * esize;
+            for (size_t e = 0; e < nn; e++) {
+                for (int l = 0; l < s->width; l++) {
+                    int b = g * s->width + l;
+                    char *out = group + (e * s->width + l) * esize;
+                    if (b < s->count) {
+                        memcpy(out, (char*)rounded + ((size_t)b * nn + e) * esize, esize);
+                    } else {
+                        memset(out, 0, esize);
+                    }
+                }
+            }
+        }
+        bench_free(rounded);
+    }
+    bench_free(tall);
+}
+
+// Largest residual / tolerance of this rank's products; fills the worst one
+static double batch_check(const batch_shape_t *s, uint64_t seed, const void *A,
+                          const void *B, const void *C, double *worst_residual,
+                          double *worst_tolerance) {
+    int n = s->n;
+    double epsilon = gemm_dtype_epsilon(s->dtype);
+    double *r = malloc((size_t)n * sizeof(double));
+    double worst = -1.0;
+
+    if (!r) {
+        printf("Verification allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    matrix_init_signs(MATRIX_SIGN_STREAM_BASE, seed, n, r);
+    *worst_residual = 0.0;
+    *worst_tolerance = 0.0;
+
+    #pragma omp parallel
+    {
+        double *Br = malloc(3 * (size_t)n * sizeof(double));
+        double local_worst = -1.0, local_residual = 0.0, local_tolerance = 0.0;
+
+        if (!Br) {
+            printf("Verification allocation failed\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        double *Cr = Br + n;
+        double *norm = Cr + n;
+        #pragma omp for schedule(static)
+        for (int b = 0; b < s->count; b++) {
+            for (int i = 0; i < n; i++) {
+                Br[i] = 0.0;
+                Cr[i] = 0.0;
+                norm[i] = 0.0;
+                for (int j = 0; j < n; j++) {
+                    double c = batch_load(s, C, batch_index(s, b, i, j), 1);
+                    Br[i] += batch_load(s, B, batch_index(s, b, i, j), 0) * r[j];
+                    Cr[i] += c * r[j];
+                    norm[i] += c * c;
+                }
+            }
+            // Every row within its own bound, as in matrix-verify.c
+            for (int i = 0; i < n; i++) {
+                double ABr = 0.0;
+                for (int p = 0; p < n; p++) {
+                    ABr += batch_load(s, A, batch_index(s, b, i, p), 0) * Br[p];
+                }
+                double residual = fabs(Cr[i] - ABr);
+                double tolerance = BATCH_VERIFY_TOLERANCE * epsilon * sqrt((double)n * norm[i]);
+                double ratio = tolerance > 0.0 ? residual / tolerance
+                                               : (residual > 0.0 ? INFINITY : 0.0);
+                if (ratio > local_worst) {
+                    local_worst = ratio;
+                    local_residual = residual;
+                    local_tolerance = tolerance;
+                }
+            }
+        }
+        #pragma omp critical
+        {
+            if (local_worst > worst) {
+                worst = local_worst;
+                *worst_residual = local_residual;
+                *worst_tolerance = local_tolerance;
+            }
+        }
+        free(Br);
+    }
+    free(r);
+    return worst;
+}
+
+void batch_multiply(int n, int count, gemm_dtype_t dtype, batch_layout_t layout,
+                    gemm_kernel_t kernel, uint64_t seed, int verify,
+                    bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                    matrix_times_t *times) {
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    batch_shape_t shape;
+    shape.n = n;
+    shape.count = count;
+    shape.dtype = dtype;
+    shape.width = batch_resolve_layout(layout, n) == BATCH_LAYOUT_COMPACT
+                  ? batch_group_width(dtype) : 1;
+    shape.groups = (count + shape.width - 1) / shape.width;
+
+    size_t nn = (size_t)n * n;
+    size_t elements = batch_elements(&shape);
+    size_t in_size = gemm_dtype_size(dtype);
+    size_t out_size = dtype == GEMM_DTYPE_F64 ? sizeof(double) : sizeof(float);
+    void *A = bench_alloc(elements * in_size);
+    void *B = bench_alloc(elements * in_size);
+    void *C = bench_alloc(elements * out_size);
+
+    if (!A || !B || !C) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Inputs and a zero C, each block first touched by the thread that
+    // multiplies it (static split over groups or matrices)
+    double s0 = MPI_Wtime();
+    batch_init(&shape, MATRIX_A, seed, world_rank * count, A);
+    batch_init(&shape, MATRIX_B, seed, world_rank * count, B);
+    #pragma omp parallel for schedule(static)
+    for (int g = 0; g < shape.groups; g++) {
+        size_t block = (size_t)shape.width * nn * out_size;
+        memset((char*)C + g * block, 0, block);
+    }
+    times->setup += MPI_Wtime() - s0;
+
+    compact_fn compact = shape.width > 1 ? compact_kernel(dtype) : NULL;
+    size_t group_elements = (size_t)shape.width * nn;
+
+    if (world_rank == 0) {
+        printf("Multiplying %d matrices of %d x %d per rank (%s layout)...\n",
+               count, n, n, shape.width > 1 ? "compact" : "strided");
+    }
+
+    // Start timing
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    bench_perf_start(tlb);
+    bench_perf_profile_resume(profile);
+
+    #pragma omp parallel for schedule(static)
+    for (int g = 0; g < shape.groups; g++) {
+        size_t offset = g * group_elements;
+        const char *a = (const char*)A + offset * in_size;
+        const char *b = (const char*)B + offset * in_size;
+        char *c = (char*)C + offset * out_size;
+        if (compact) {
+            compact(n, a, b, c);
+        } else if (dtype == GEMM_DTYPE_F64) {
+            gemm_multiply(kernel, n, n, n, (const double*)a, n, (const double*)b, n,
+                          (double*)c, n);
+        } else {
+            gemm_lowp_multiply(dtype, n, n, n, a, n, b, n, (float*)c, n);
+        }
+    }
+
+    bench_perf_profile_pause(profile);
+    times->compute = MPI_Wtime() - start_time;
+    times->dtlb_misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+    times->total = MPI_Wtime() - start_time;
+    times->local_flops = 2.0 * count * (double)nn * n;
+
+    if (verify) {
+        if (world_rank == 0) {
+            printf("Verifying result (C r against A (B r) for every matrix)...\n");
+        }
+        double v0 = MPI_Wtime();
+        struct {
+            double ratio;
+            int rank;
+        } local, global;
+        double worst[2];
+        local.ratio = batch_check(&shape, seed, A, B, C, &worst[0], &worst[1]);
+        local.rank = world_rank;
+        MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MAXLOC, MPI_COMM_WORLD);
+        MPI_Bcast(worst, 2, MPI_DOUBLE, global.rank, MPI_COMM_WORLD);
+        times->check.residual = worst[0];
+        times->check.tolerance = worst[1];
+        times->check.passed = global.ratio <= 1.0;
+        times->verify = MPI_Wtime() - v0;
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_batch", A, elements * in_size},
+        {"B_batch", B, elements * in_size},
+        {"C_batch", C, elements * out_size},
+    };
+    times->numa_local = bench_numa_report(buffers, 3);
+    times->huge_share = bench_alloc_report(buffers, 3, times->dtlb_misses);
+
+    bench_free(A);
+    bench_free(B);
+    bench_free(C);
+}
@@ -0,0 +1,69 @@
+/*
+ * Batched small-matrix multiplication (--batch=COUNT)
+ *
+ * Every rank multiplies COUNT independent n×n pairs, C_b = A_b × B_b, the
+ * shape of the per-head and per-sample GEMMs of ML training. There is no
+ * communication, so the result is the node throughput and the spread
+ * across ranks shows slow nodes. Two storage layouts:
+ *
+ *   compact: groups of W matrices interleaved element by element, W being
+ *            the SIMD lanes of the selected ISA (8 doubles or 16 floats on
+ *            AVX-512). Element (i, j) of a group is one vector, so the
+ *            kernel runs the plain triple loop on whole vectors, one matrix
+ *            per lane: full vectors whatever n is, no packing and no
+ *            partial tiles. Suits tiny matrices, which would mostly pad
+ *            the blocked kernel's register tiles.
+ *   strided: matrices stored one after another, each multiplied by the
+ *            blocked kernel on a single thread while the threads split the
+ *            batch. Suits matrices that fill the tiles.
+ *
+ * auto picks compact up to n = BATCH_COMPACT_MAX_N.
+ *
+ * The inputs of all ranks form one tall (P·COUNT·n)×n matrix of the
+ * deterministic generator (matrix-init.h), rounded to the dtype, so every
+ * matrix has the same contents for any rank count and layout. The check
+ * multiplies each product by a ±1 vector r and compares C r with A (B r)
+ * in double, O(n²) per matrix.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+#include "bench-perf.h"
+#include "gemm-kernels.h"
+#include "gemm-lowp.h"
+#include "matrix-mult.h"
+
+// Largest n for which --batch-layout=auto picks the compact layout
+#define BATCH_COMPACT_MAX_N 16
+
+typedef enum {
+    BATCH_LAYOUT_AUTO = 0,
+    BATCH_LAYOUT_COMPACT,
+    BATCH_LAYOUT_STRIDED
+} batch_layout_t;
+
+// Parse "auto", "compact", "strided"; returns 0 on success, -1 if unknown
+int batch_layout_from_name(const char *name, batch_layout_t *layout);
+const char *batch_layout_name(batch_layout_t layout);
+
+// Layout used for n×n matrices (resolves auto)
+batch_layout_t batch_resolve_layout(batch_layout_t layout, int n);
+
+// Matrices per interleaved group of the compact layout for dtype under the
+// selected ISA
+int batch_group_width(gemm_dtype_t dtype);
+
+// Multiply this rank's `count` n×n pairs, A and B in dtype (C in double for
+// f64, float otherwise), strided products with `kernel`. Fills compute,
+// total, local_flops, dtlb_misses (tlb over the timed region), setup and,
+// with `verify`, verify/check in times; profile counts the multiplies.
+// Collective over MPI_COMM_WORLD (barriers and the check's reduction).
+void batch_multiply(int n, int count, gemm_dtype_t dtype, batch_layout_t layout,
+                    gemm_kernel_t kernel, uint64_t seed, int verify,
+                    bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                    matrix_times_t *times);
+
+#endif /* BATCH_H */
@@ -0,0 +1,167 @@
+/*
+ * Checkpoint/restart of the 1D matrix multiplication
+ */
+
+#include "checkpoint.h"
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// File offsets of the row flags and of row `row` of C
+static MPI_Offset flag_offset(int row) {
+    return BENCH_CKPT_DATA_OFFSET + row;
+}
+
+static MPI_Offset row_offset(const checkpoint_t *ckpt, int row) {
+    MPI_Offset flags = ((MPI_Offset)ckpt->n + 4095) / 4096 * 4096;
+    return BENCH_CKPT_DATA_OFFSET + flags + (MPI_Offset)row * ckpt->n * sizeof(double);
+}
+
+int checkpoint_open(checkpoint_t *ckpt, const char *dir, double interval, int n,
+                    uint64_t seed, int from_files, int row0, int rows) {
+    bench_ckpt_header_t header;
+
+    bench_ckpt_header_init(&header, "matrix-mult");
+    header.params[0] = n;
+    header.params[1] = (int64_t)seed;
+    header.params[2] = from_files;
+
+    memset(ckpt, 0, sizeof(*ckpt));
+    ckpt->n = n;
+    ckpt->row0 = row0;
+    ckpt->rows = rows;
+    ckpt->done = calloc(rows > 0 ? (size_t)rows : 1, 1);
+    if (!ckpt->done) {
+        printf("Memory allocation failed for checkpoint flags\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (bench_ckpt_open(&ckpt->io, dir, CHECKPOINT_FILE, interval, &header) != 0) {
+        free(ckpt->done);
+        return -1;
+    }
+    MPI_Type_contiguous(n, MPI_DOUBLE, &ckpt->row_type);
+    MPI_Type_commit(&ckpt->row_type);
+    return 0;
+}
+
+int checkpoint_restore(checkpoint_t *ckpt, double *C_local) {
+    int n = ckpt->n;
+    int restored = 0;
+
+    if (!ckpt->io.resumed) {
+        return 0;
+    }
+    // Flags past the end of the file were never written
+    int flags = bench_ckpt_read(&ckpt->io, flag_offset(ckpt->row0), ckpt->done,
+                                ckpt->rows, MPI_BYTE);
+    memset(ckpt->done + flags, 0, (size_t)(ckpt->rows - flags));
+
+    // One read per run of saved rows
+    for (int i = 0; i < ckpt->rows; ) {
+        if (ckpt->done[i] != 1) {
+            ckpt->done[i++] = 0;
+            continue;
+        }
+        int end = i + 1;
+        while (end < ckpt->rows && ckpt->done[end] == 1) {
+            end++;
+        }
+        int got = bench_ckpt_read(&ckpt->io, row_offset(ckpt, ckpt->row0 + i),
+                                  C_local + (size_t)i * n, end - i, ckpt->row_type);
+        if (got != end - i) {
+            int rank;
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            printf("Rank %d: Checkpoint %s is truncated; recomputing its rows\n",
+                   rank, ckpt->io.path);
+            memset(ckpt->done + i, 0, (size_t)(end - i));
+            memset(C_local + (size_t)i * n, 0, (size_t)(end - i) * n * sizeof(double));
+        } else {
+            restored += end - i;
+        }
+        i = end;
+    }
+    ckpt->io.stats.restored = restored;
+    return restored;
+}
+
+// Flag the rows of the completed C write
+static void flag_span(checkpoint_t *ckpt) {
+    int count = ckpt->span1 - ckpt->span0;
+    if (count <= 0) {
+        return;
+    }
+    memset(ckpt->done + ckpt->span0, 1, (size_t)count);
+    bench_ckpt_write(&ckpt->io, flag_offset(ckpt->row0 + ckpt->span0),
+                     ckpt->done + ckpt->span0, count, MPI_BYTE);
+    ckpt->span0 = ckpt->span1 = 0;
+}
+
+// Checkpoint local rows [written, upto): rows restored at the ends of the
+// range are left out, those in between are rewritten with the same values
+static void save_rows(checkpoint_t *ckpt, const double *C_local, int upto) {
+    int lo = ckpt->written, hi = upto;
+
+    bench_ckpt_begin(&ckpt->io);
+    flag_span(ckpt);
+    while (lo < hi && ckpt->done[lo]) {
+        lo++;
+    }
+    while (hi > lo && ckpt->done[hi - 1]) {
+        hi--;
+    }
+    if (hi > lo) {
+        bench_ckpt_write(&ckpt->io, row_offset(ckpt, ckpt->row0 + lo),
+                         C_local + (size_t)lo * ckpt->n, hi - lo, ckpt->row_type);
+        ckpt->span0 = lo;
+        ckpt->span1 = hi;
+    }
+    ckpt->written = upto;
+}
+
+int checkpoint_multiply(checkpoint_t *ckpt, gemm_kernel_t kernel, int panel,
+                        const double *A_local, const double *B, double *C_local,
+                        bench_perf_profile_t *profile) {
+    int n = ckpt->n;
+    int computed = 0;
+
+    for (int i = 0; i < ckpt->rows; ) {
+        if (ckpt->done[i]) {
+            i++;
+            continue;
+        }
+        int end = i + 1;
+        while (end < ckpt->rows && !ckpt->done[end] && end - i < panel) {
+            end++;
+        }
+        bench_perf_profile_resume(profile);
+        gemm_multiply(kernel, end - i, n, n, A_local + (size_t)i * n, n, B, n,
+                      C_local + (size_t)i * n, n);
+        bench_perf_profile_pause(profile);
+        computed += end - i;
+        i = end;
+
+        // Flag rows as soon as their write is done, then checkpoint when due
+        if (ckpt->span1 > ckpt->span0 && bench_ckpt_test(&ckpt->io)) {
+            flag_span(ckpt);
+        }
+        if (bench_ckpt_due(&ckpt->io)) {
+            save_rows(ckpt, C_local, i);
+        }
+    }
+
+    // C_local must outlive the writes; the last rows stay unsaved, the run
+    // is about to complete
+    bench_ckpt_wait(&ckpt->io);
+    flag_span(ckpt);
+    bench_ckpt_wait(&ckpt->io);
+    return computed;
+}
+
+void checkpoint_close(checkpoint_t *ckpt, int remove) {
+    bench_ckpt_close(&ckpt->io, remove);
+    MPI_Type_free(&ckpt->row_type);
+    free(ckpt->done);
+    ckpt->done = NULL;
+}
@@ -0,0 +1,64 @@
+/*
+ * Checkpoint/restart of the 1D matrix multiplication (--checkpoint=DIR)
+ *
+ * Each rank computes its rows of C in panels of --panel rows. Once the
+ * checkpoint interval has passed, the rows finished since the last
+ * checkpoint are written to DIR/matrix-checkpoint.bin with non-blocking
+ * MPI-IO while the next panels compute (see bench-checkpoint.h), and a
+ * row is flagged as saved only after its write completed, so a job killed
+ * mid-write never resumes from a torn row. File layout after the common
+ * header:
+ *
+ *   BENCH_CKPT_DATA_OFFSET:       one flag byte per row of C (1 = saved)
+ *   + n rounded up to 4096 bytes: C, n×n row-major doubles
+ *
+ * A restart with the same n, seed and input source reads the saved rows
+ * back into the ranks that own them now (the rank count may differ) and
+ * computes only the rest. The file is removed once the run completes.
+ * With --data-dir the inputs are files, so delete the checkpoint when they
+ * change underneath it.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "bench-checkpoint.h"
+#include "bench-perf.h"
+#include "gemm-kernels.h"
+
+#define CHECKPOINT_FILE "matrix-checkpoint.bin"
+
+typedef struct {
+    bench_ckpt_t io;
+    MPI_Datatype row_type;  // One row of C
+    int n;
+    int row0;               // This rank's rows of C
+    int rows;
+    unsigned char *done;    // Local rows saved in the file (as flagged there)
+    int written;            // Local rows [0, written) were saved or started
+    int span0, span1;       // Local rows in flight, flagged once written
+} checkpoint_t;
+
+// Open (or create) the checkpoint of an n×n product in dir for this rank's
+// rows [row0, row0 + rows). from_files: A and B come from --data-dir.
+// Returns 0 on success, -1 after printing the MPI-IO error. Collective.
+int checkpoint_open(checkpoint_t *ckpt, const char *dir, double interval, int n,
+                    uint64_t seed, int from_files, int row0, int rows);
+
+// Read this rank's saved rows into C_local (rows×n); returns their count
+int checkpoint_restore(checkpoint_t *ckpt, double *C_local);
+
+// C_local += A_local × B for the rows not restored, in panels of `panel`
+// rows, checkpointing finished rows at the interval; returns the rows
+// computed. Waits for the last writes before returning. profile counts the
+// GEMM calls only.
+int checkpoint_multiply(checkpoint_t *ckpt, gemm_kernel_t kernel, int panel,
+                        const double *A_local, const double *B, double *C_local,
+                        bench_perf_profile_t *profile);
+
+// Close; with remove the file is deleted (the run completed). Collective.
+void checkpoint_close(checkpoint_t *ckpt, int remove);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,340 @@
+/*
+ * GPU GEMM backend for the matrix-multiply example (cuBLAS)
+ *
+ * cuBLAS is column-major. A row-major m×n matrix with row stride ld is the
+ * same memory as a column-major n×m matrix with leading dimension ld, so
+ * row-major C = A × B is computed as column-major C^T = B^T × A^T by
+ * swapping the operands, without any transposed copies.
+ */
+
+#include "gemm-gpu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef MATRIX_HAVE_CUDA
+#include <cublas_v2.h>
+#include <cuda_runtime_api.h>
+#endif
+
+static char gpu_error[256] = "";
+
+int matrix_device_from_name(const char *name, matrix_device_t *device) {
+    if (strcmp(name, "cpu") == 0) {
+        *device = MATRIX_DEVICE_CPU;
+    } else if (strcmp(name, "gpu") == 0) {
+        *device = MATRIX_DEVICE_GPU;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *matrix_device_name(matrix_device_t device) {
+    return device == MATRIX_DEVICE_GPU ? "gpu" : "cpu";
+}
+
+const char *gemm_gpu_error(void) {
+    return gpu_error;
+}
+
+#ifdef MATRIX_HAVE_CUDA
+
+// Record a failed CUDA runtime call; returns nonzero on error
+static int cuda_failed(cudaError_t err, const char *what) {
+    if (err == cudaSuccess) {
+        return 0;
+    }
+    snprintf(gpu_error, sizeof(gpu_error), "%s: %s", what, cudaGetErrorString(err));
+    return 1;
+}
+
+// Fold the last DGEMM's device time into gemm_seconds once it has finished
+static void collect_gemm_time(gemm_gpu_t *gpu) {
+    float ms;
+    if (gpu->gemm_pending
+        && cudaEventElapsedTime(&ms, (cudaEvent_t)gpu->gemm_start,
+                                (cudaEvent_t)gpu->gemm_stop) == cudaSuccess) {
+        gpu->gemm_seconds += ms / 1e3;
+    }
+    gpu->gemm_pending = 0;
+}
+
+int gemm_gpu_built(void) {
+    return 1;
+}
+
+int gemm_gpu_open(gemm_gpu_t *gpu, int local_rank) {
+    int count = 0;
+    cudaStream_t stream;
+    cudaEvent_t start, stop;
+    cublasHandle_t handle;
+    struct cudaDeviceProp prop;
+
+    memset(gpu, 0, sizeof(*gpu));
+    gpu->device = -1;
+    if (cuda_failed(cudaGetDeviceCount(&count), "cudaGetDeviceCount")) {
+        return -1;
+    }
+    if (count == 0) {
+        snprintf(gpu_error, sizeof(gpu_error), "no CUDA device visible");
+        return -1;
+    }
+    // Ranks on a node spread over its GPUs; with per-task GPU binding
+    // (CUDA_VISIBLE_DEVICES per rank) every rank sees exactly one
+    int device = local_rank % count;
+    if (cuda_failed(cudaSetDevice(device), "cudaSetDevice")
+        || cuda_failed(cudaGetDeviceProperties(&prop, device), "cudaGetDeviceProperties")
+        || cuda_failed(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking),
+                       "cudaStreamCreate")) {
+        return -1;
+    }
+    if (cuda_failed(cudaEventCreate(&start), "cudaEventCreate")
+        || cuda_failed(cudaEventCreate(&stop), "cudaEventCreate")) {
+        cudaStreamDestroy(stream);
+        return -1;
+    }
+    if (cublasCreate(&handle) != CUBLAS_STATUS_SUCCESS) {
+        snprintf(gpu_error, sizeof(gpu_error), "cublasCreate failed");
+        cudaEventDestroy(start);
+        cudaEventDestroy(stop);
+        cudaStreamDestroy(stream);
+        return -1;
+    }
+    cublasSetStream(handle, stream);
+
+    gpu->device = device;
+    snprintf(gpu->name, sizeof(gpu->name), "%s", prop.name);
+    gpu->memory_gb = prop.totalGlobalMem / 1e9;
+    gpu->handle = handle;
+    gpu->stream = stream;
+    gpu->gemm_start = start;
+    gpu->gemm_stop = stop;
+    return 0;
+}
+
+void gemm_gpu_close(gemm_gpu_t *gpu) {
+    if (gpu->device < 0) {
+        return;
+    }
+    cublasDestroy((cublasHandle_t)gpu->handle);
+    cudaEventDestroy((cudaEvent_t)gpu->gemm_start);
+    cudaEventDestroy((cudaEvent_t)gpu->gemm_stop);
+    cudaStreamDestroy((cudaStream_t)gpu->stream);
+    gpu->device = -1;
+}
+
+int gemm_gpu_pin(void *ptr, size_t bytes) {
+    if (!ptr || bytes == 0) {
+        return 0;
+    }
+    return cuda_failed(cudaHostRegister(ptr, bytes, cudaHostRegisterDefault),
+                       "cudaHostRegister") ? -1 : 0;
+}
+
+void gemm_gpu_unpin(void *ptr) {
+    if (ptr) {
+        cudaHostUnregister(ptr);
+    }
+}
+
+double *gemm_gpu_alloc(size_t count) {
+    void *ptr = NULL;
+    if (cuda_failed(cudaMalloc(&ptr, count * sizeof(double)), "cudaMalloc")) {
+        return NULL;
+    }
+    return (double*)ptr;
+}
+
+void gemm_gpu_free(double *ptr) {
+    if (ptr) {
+        cudaFree(ptr);
+    }
+}
+
+int gemm_gpu_upload(gemm_gpu_t *gpu, double *dst, int ldd,
+                    const double *src, int lds, int rows, int cols) {
+    if (cuda_failed(cudaMemcpy2DAsync(dst, (size_t)ldd * sizeof(double), src,
+                                      (size_t)lds * sizeof(double), (size_t)cols * sizeof(double),
+                                      rows, cudaMemcpyHostToDevice, (cudaStream_t)gpu->stream),
+                    "cudaMemcpy2DAsync (host to device)")) {
+        return -1;
+    }
+    gpu->bytes_h2d += (double)rows * cols * sizeof(double);
+    return 0;
+}
+
+int gemm_gpu_download(gemm_gpu_t *gpu, double *dst, int ldd,
+                      const double *src, int lds, int rows, int cols) {
+    if (cuda_failed(cudaMemcpy2DAsync(dst, (size_t)ldd * sizeof(double), src,
+                                      (size_t)lds * sizeof(double), (size_t)cols * sizeof(double),
+                                      rows, cudaMemcpyDeviceToHost, (cudaStream_t)gpu->stream),
+                    "cudaMemcpy2DAsync (device to host)")) {
+        return -1;
+    }
+    gpu->bytes_d2h += (double)rows * cols * sizeof(double);
+    return 0;
+}
+
+int gemm_gpu_multiply(gemm_gpu_t *gpu, int m, int n, int k,
+                      const double *A, int lda, const double *B, int ldb,
+                      double *C, int ldc) {
+    const double one = 1.0, zero = 0.0;
+    cublasStatus_t status;
+
+    // One event pair: time the previous DGEMM before reusing it
+    if (gpu->gemm_pending) {
+        cudaEventSynchronize((cudaEvent_t)gpu->gemm_stop);
+        collect_gemm_time(gpu);
+    }
+    cudaEventRecord((cudaEvent_t)gpu->gemm_start, (cudaStream_t)gpu->stream);
+    status = cublasDgemm((cublasHandle_t)gpu->handle, CUBLAS_OP_N, CUBLAS_OP_N, n, m, k,
+                         &one, B, ldb, A, lda, &zero, C, ldc);
+    if (status != CUBLAS_STATUS_SUCCESS) {
+        snprintf(gpu_error, sizeof(gpu_error), "cublasDgemm failed (status %d)", (int)status);
+        return -1;
+    }
+    cudaEventRecord((cudaEvent_t)gpu->gemm_stop, (cudaStream_t)gpu->stream);
+    gpu->gemm_pending = 1;
+    return 0;
+}
+
+int gemm_gpu_idle(gemm_gpu_t *gpu) {
+    cudaError_t err = cudaStreamQuery((cudaStream_t)gpu->stream);
+    if (err == cudaErrorNotReady) {
+        return 0;
+    }
+    collect_gemm_time(gpu);
+    return cuda_failed(err, "cudaStreamQuery") ? -1 : 1;
+}
+
+int gemm_gpu_wait(gemm_gpu_t *gpu) {
+    // Errors of queued copies and kernels surface here
+    int failed = cuda_failed(cudaStreamSynchronize((cudaStream_t)gpu->stream),
+                             "cudaStreamSynchronize");
+    collect_gemm_time(gpu);
+    return failed ? -1 : 0;
+}
+
+int gemm_gpu_bandwidth(gemm_gpu_t *gpu, size_t bytes, double *h2d_gbps, double *d2h_gbps) {
+    const int reps = 5;
+    void *host = NULL, *dev = NULL;
+    cudaStream_t stream = (cudaStream_t)gpu->stream;
+    cudaEvent_t start = (cudaEvent_t)gpu->gemm_start, stop = (cudaEvent_t)gpu->gemm_stop;
+    float ms_h2d = 0.0f, ms_d2h = 0.0f;
+
+    *h2d_gbps = *d2h_gbps = 0.0;
+    gemm_gpu_wait(gpu);
+    if (cuda_failed(cudaMallocHost(&host, bytes), "cudaMallocHost")) {
+        return -1;
+    }
+    if (cuda_failed(cudaMalloc(&dev, bytes), "cudaMalloc")) {
+        cudaFreeHost(host);
+        return -1;
+    }
+    memset(host, 0, bytes);
+
+    // One untimed copy each way, then `reps` timed ones
+    cudaMemcpyAsync(dev, host, bytes, cudaMemcpyHostToDevice, stream);
+    cudaMemcpyAsync(host, dev, bytes, cudaMemcpyDeviceToHost, stream);
+    cudaEventRecord(start, stream);
+    for (int r = 0; r < reps; r++) {
+        cudaMemcpyAsync(dev, host, bytes, cudaMemcpyHostToDevice, stream);
+    }
+    cudaEventRecord(stop, stream);
+    cudaEventSynchronize(stop);
+    cudaEventElapsedTime(&ms_h2d, start, stop);
+    cudaEventRecord(start, stream);
+    for (int r = 0; r < reps; r++) {
+        cudaMemcpyAsync(host, dev, bytes, cudaMemcpyDeviceToHost, stream);
+    }
+    cudaEventRecord(stop, stream);
+    cudaEventSynchronize(stop);
+    cudaEventElapsedTime(&ms_d2h, start, stop);
+    int failed = cuda_failed(cudaGetLastError(), "bandwidth copies");
+
+    cudaFree(dev);
+    cudaFreeHost(host);
+    if (failed || ms_h2d <= 0.0f || ms_d2h <= 0.0f) {
+        return -1;
+    }
+    *h2d_gbps = (double)reps * bytes / (ms_h2d / 1e3) / 1e9;
+    *d2h_gbps = (double)reps * bytes / (ms_d2h / 1e3) / 1e9;
+    return 0;
+}
+
+#else /* !MATRIX_HAVE_CUDA */
+
+int gemm_gpu_built(void) {
+    return 0;
+}
+
+int gemm_gpu_open(gemm_gpu_t *gpu, int local_rank) {
+    (void)local_rank;
+    memset(gpu, 0, sizeof(*gpu));
+    gpu->device = -1;
+    snprintf(gpu_error, sizeof(gpu_error), "built without CUDA (no CUDA toolkit at build time)");
+    return -1;
+}
+
+void gemm_gpu_close(gemm_gpu_t *gpu) {
+    gpu->device = -1;
+}
+
+int gemm_gpu_pin(void *ptr, size_t bytes) {
+    (void)ptr;
+    (void)bytes;
+    return -1;
+}
+
+void gemm_gpu_unpin(void *ptr) {
+    (void)ptr;
+}
+
+double *gemm_gpu_alloc(size_t count) {
+    (void)count;
+    return NULL;
+}
+
+void gemm_gpu_free(double *ptr) {
+    (void)ptr;
+}
+
+int gemm_gpu_upload(gemm_gpu_t *gpu, double *dst, int ldd,
+                    const double *src, int lds, int rows, int cols) {
+    (void)gpu; (void)dst; (void)ldd; (void)src; (void)lds; (void)rows; (void)cols;
+    return -1;
+}
+
+int gemm_gpu_download(gemm_gpu_t *gpu, double *dst, int ldd,
+                      const double *src, int lds, int rows, int cols) {
+    (void)gpu; (void)dst; (void)ldd; (void)src; (void)lds; (void)rows; (void)cols;
+    return -1;
+}
+
+int gemm_gpu_multiply(gemm_gpu_t *gpu, int m, int n, int k,
+                      const double *A, int lda, const double *B, int ldb,
+                      double *C, int ldc) {
+    (void)gpu; (void)m; (void)n; (void)k; (void)A; (void)lda; (void)B; (void)ldb;
+    (void)C; (void)ldc;
+    return -1;
+}
+
+int gemm_gpu_idle(gemm_gpu_t *gpu) {
+    (void)gpu;
+    return 1;
+}
+
+int gemm_gpu_wait(gemm_gpu_t *gpu) {
+    (void)gpu;
+    return 0;
+}
+
+int gemm_gpu_bandwidth(gemm_gpu_t *gpu, size_t bytes, double *h2d_gbps, double *d2h_gbps) {
+    (void)gpu;
+    (void)bytes;
+    *h2d_gbps = *d2h_gbps = 0.0;
+    return -1;
+}
+
+#endif /* MATRIX_HAVE_CUDA */
@@ -0,0 +1,94 @@
+/*
+ * GPU GEMM backend for the matrix-multiply example (cuBLAS)
+ *
+ * Used by --device=gpu with the 1d and pipeline algorithms. Each rank
+ * drives one GPU, chosen by its rank on the node, through a single CUDA
+ * stream: host-to-device copies, DGEMM and device-to-host copies are queued
+ * asynchronously, so the caller keeps polling its MPI requests while the
+ * GPU works. Host buffers stay those of bench_alloc() (huge pages, NUMA
+ * placement) and are page-locked in place with gemm_gpu_pin(), so the
+ * copies run as DMA without a staging buffer.
+ *
+ * The driver calls cuBLAS through its C API, so no CUDA compiler is
+ * involved. Without the CUDA toolkit at build time (MATRIX_HAVE_CUDA
+ * undefined) every function fails cleanly and gemm_gpu_open() reports that
+ * the binary was built without GPU support.
+ */
+
+#ifndef GEMM_GPU_H
+#define GEMM_GPU_H
+
+#include <stddef.h>
+
+// Compute device for the local multiply
+typedef enum {
+    MATRIX_DEVICE_CPU = 0,
+    MATRIX_DEVICE_GPU
+} matrix_device_t;
+
+// One rank's GPU: device, cuBLAS handle, stream and timing state
+typedef struct {
+    int device;             // CUDA device index (-1 if not open)
+    char name[256];         // Device name
+    double memory_gb;       // Device memory
+    void *handle;           // cublasHandle_t
+    void *stream;           // cudaStream_t
+    void *gemm_start;       // cudaEvent_t pair around the last queued DGEMM
+    void *gemm_stop;
+    int gemm_pending;       // Last DGEMM not yet added to gemm_seconds
+    double gemm_seconds;    // Device time of all completed DGEMMs
+    double bytes_h2d;       // Bytes queued host -> device
+    double bytes_d2h;       // Bytes queued device -> host
+} gemm_gpu_t;
+
+// Parse a device name ("cpu", "gpu"); returns 0 on success, -1 if unknown
+int matrix_device_from_name(const char *name, matrix_device_t *device);
+
+const char *matrix_device_name(matrix_device_t device);
+
+// Nonzero if this binary was built with CUDA
+int gemm_gpu_built(void);
+
+// Open GPU (local_rank mod device count) with a stream and a cuBLAS handle;
+// returns 0 on success, -1 with the reason in gemm_gpu_error()
+int gemm_gpu_open(gemm_gpu_t *gpu, int local_rank);
+
+void gemm_gpu_close(gemm_gpu_t *gpu);
+
+// Reason for the last failure of a gemm_gpu_* call
+const char *gemm_gpu_error(void);
+
+// Page-lock an existing host buffer for asynchronous copies (0 on success)
+int gemm_gpu_pin(void *ptr, size_t bytes);
+void gemm_gpu_unpin(void *ptr);
+
+// Device memory (NULL on failure)
+double *gemm_gpu_alloc(size_t count);
+void gemm_gpu_free(double *ptr);
+
+// Queue a rows×cols copy of doubles between host and device; ld* are the
+// row strides in doubles (row-major on both sides). Returns 0, or -1 with
+// the reason in gemm_gpu_error().
+int gemm_gpu_upload(gemm_gpu_t *gpu, double *dst, int ldd,
+                    const double *src, int lds, int rows, int cols);
+int gemm_gpu_download(gemm_gpu_t *gpu, double *dst, int ldd,
+                      const double *src, int lds, int rows, int cols);
+
+// Queue C[m×n] = A[m×k] × B[k×n] on device buffers (row-major); returns
+// 0, or -1 with the reason in gemm_gpu_error()
+int gemm_gpu_multiply(gemm_gpu_t *gpu, int m, int n, int k,
+                      const double *A, int lda, const double *B, int ldb,
+                      double *C, int ldc);
+
+// 1 once all queued work has finished, 0 while it runs, -1 if it failed
+// (does not block)
+int gemm_gpu_idle(gemm_gpu_t *gpu);
+
+// Block until all queued work has finished; returns -1 if any of it failed
+int gemm_gpu_wait(gemm_gpu_t *gpu);
+
+// Pinned host <-> device bandwidth in GB/s over `bytes`-sized copies;
+// returns 0 on success. Run before the timed region.
+int gemm_gpu_bandwidth(gemm_gpu_t *gpu, size_t bytes, double *h2d_gbps, double *d2h_gbps);
+
+#endif /* GEMM_GPU_H */
@@ -0,0 +1,421 @@
+/*
+ * GEMM compute kernels for the matrix-multiply example
+ *
+ * The blocked kernel follows the classic GotoBLAS/BLIS layering:
+ *
+ *   jc loop: NC-wide column panels of B      (sized for L3)
+ *   pc loop: KC-deep slices of the k dimension
+ *            -> pack B[KC×NC] into NR-wide micro-panels
+ *   ic loop: MC-tall row blocks of A         (sized for L2)
+ *            -> pack A[MC×KC] into MR-tall micro-panels
+ *   jr/ir:   MR×NR register tiles computed by the micro-kernel,
+ *            streaming one KC×NR B micro-panel from L1
+ *
+ * Packing turns the strided column walk over B into unit-stride reads and
+ * lets the micro-kernel keep the whole MR×NR block of C in registers.
+ *
+ * The micro-kernel is chosen once at startup (gemm_set_isa) from the
+ * portable C kernel below and the SIMD kernels in gemm-simd.c.
+ *
+ * With OpenMP, threads pack each B panel cooperatively into one shared
+ * buffer and then split (row block × column chunk) units, each thread
+ * packing A into its own buffer. Called from inside a parallel region
+ * (batched small matrices, one per thread), a multiply runs on the calling
+ * thread alone.
+ */
+
+#include "gemm-kernels.h"
+#include "gemm-ukernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Cache blocking parameters (doubles). Defaults target a typical x86 core:
+// 32-48 KB L1d, 1-2 MB L2, several MB of shared L3. The per-microarchitecture
+// builds (arch-variants.cmake) override them with -D for their cache sizes.
+#ifndef GEMM_MC
+#define GEMM_MC 96      // A block: MC×KC ≈ 192 KB (L2)
+#endif
+#ifndef GEMM_KC
+#define GEMM_KC 256     // B micro-panel: KC×NR ≈ 16 KB (L1)
+#endif
+#ifndef GEMM_NC
+#define GEMM_NC 2048    // B panel: KC×NC ≈ 4 MB (L3)
+#endif
+
+// Register tile of the portable micro-kernel (SIMD tiles: gemm-simd.c)
+#define GEMM_MR 4
+#define GEMM_NR 8
+
+// Largest MR×NR register tile of any micro-kernel (edge scratch buffer size)
+#define GEMM_MAX_TILE (16 * 16)
+
+#define GEMM_ALIGNMENT 64
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Portable micro-kernel: fixed-size accumulator the compiler keeps in registers
+static void ukernel_generic_4x8(int kc, const double *restrict Ap,
+                                const double *restrict Bp,
+                                double *restrict C, int ldc) {
+    double acc[GEMM_MR][GEMM_NR] = {{0.0}};
+
+    for (int p = 0; p < kc; p++) {
+        const double *a = Ap + p * GEMM_MR;
+        const double *b = Bp + p * GEMM_NR;
+        for (int i = 0; i < GEMM_MR; i++) {
+            for (int j = 0; j < GEMM_NR; j++) {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (int i = 0; i < GEMM_MR; i++) {
+        for (int j = 0; j < GEMM_NR; j++) {
+            C[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+static const gemm_ukernel_t ukernel_generic = {GEMM_MR, GEMM_NR, ukernel_generic_4x8};
+
+// Micro-kernel used by the blocked driver (see gemm_set_isa)
+static gemm_isa_t active_isa = GEMM_ISA_GENERIC;
+static const gemm_ukernel_t *active_ukernel = &ukernel_generic;
+
+static const gemm_ukernel_t *ukernel_for_isa(gemm_isa_t isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    case GEMM_ISA_AVX2:
+        return &gemm_ukernel_avx2;
+    case GEMM_ISA_AVX512:
+        return &gemm_ukernel_avx512;
+#endif
+#if defined(__aarch64__)
+    case GEMM_ISA_NEON:
+        return &gemm_ukernel_neon;
+#endif
+    case GEMM_ISA_GENERIC:
+        return &ukernel_generic;
+    default:
+        return NULL;
+    }
+}
+
+int gemm_isa_supported(gemm_isa_t isa) {
+    switch (isa) {
+    case GEMM_ISA_AUTO:
+    case GEMM_ISA_GENERIC:
+        return 1;
+#if defined(__x86_64__) || defined(__i386__)
+    case GEMM_ISA_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case GEMM_ISA_AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(__aarch64__)
+    case GEMM_ISA_NEON:
+        return 1;   // Advanced SIMD is mandatory on AArch64
+#endif
+    default:
+        return 0;
+    }
+}
+
+gemm_isa_t gemm_detect_isa(void) {
+    static const gemm_isa_t preference[] = {
+        GEMM_ISA_AVX512, GEMM_ISA_AVX2, GEMM_ISA_NEON
+    };
+    for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+        if (gemm_isa_supported(preference[i])) {
+            return preference[i];
+        }
+    }
+    return GEMM_ISA_GENERIC;
+}
+
+int gemm_set_isa(gemm_isa_t isa) {
+    if (isa == GEMM_ISA_AUTO) {
+        isa = gemm_detect_isa();
+    }
+    if (!gemm_isa_supported(isa) || !ukernel_for_isa(isa)) {
+        return -1;
+    }
+    active_isa = isa;
+    active_ukernel = ukernel_for_isa(isa);
+    return 0;
+}
+
+gemm_isa_t gemm_get_isa(void) {
+    return active_isa;
+}
+
+void gemm_get_tile(int *mr, int *nr) {
+    *mr = active_ukernel->mr;
+    *nr = active_ukernel->nr;
+}
+
+void gemm_get_blocking(int *mc, int *kc, int *nc) {
+    *mc = GEMM_MC;
+    *kc = GEMM_KC;
+    *nc = GEMM_NC;
+}
+
+int gemm_isa_from_name(const char *name, gemm_isa_t *isa) {
+    for (int i = 0; i < GEMM_ISA_COUNT; i++) {
+        if (strcmp(name, gemm_isa_name((gemm_isa_t)i)) == 0) {
+            *isa = (gemm_isa_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *gemm_isa_name(gemm_isa_t isa) {
+    switch (isa) {
+    case GEMM_ISA_AUTO:
+        return "auto";
+    case GEMM_ISA_GENERIC:
+        return "generic";
+    case GEMM_ISA_AVX2:
+        return "avx2";
+    case GEMM_ISA_AVX512:
+        return "avx512";
+    case GEMM_ISA_NEON:
+        return "neon";
+    case GEMM_ISA_COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+int gemm_kernel_from_name(const char *name, gemm_kernel_t *kernel) {
+    if (strcmp(name, "naive") == 0) {
+        *kernel = GEMM_KERNEL_NAIVE;
+    } else if (strcmp(name, "blocked") == 0) {
+        *kernel = GEMM_KERNEL_BLOCKED;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *gemm_kernel_name(gemm_kernel_t kernel) {
+    switch (kernel) {
+    case GEMM_KERNEL_NAIVE:
+        return "naive";
+    case GEMM_KERNEL_BLOCKED:
+        return "blocked";
+    }
+    return "unknown";
+}
+
+// OpenMP threads for one multiply; 1 when called from a parallel region
+static int call_threads(void) {
+#ifdef _OPENMP
+    return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Reference i-j-k triple loop (rows split across OpenMP threads)
+static void gemm_naive(int m, int n, int k,
+                       const double *A, int lda,
+                       const double *B, int ldb,
+                       double *C, int ldc) {
+    #pragma omp parallel for schedule(static) if (call_threads() > 1)
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (int p = 0; p < k; p++) {
+                sum += A[i * lda + p] * B[p * ldb + j];
+            }
+            C[i * ldc + j] += sum;
+        }
+    }
+}
+
+// Pack A[mc×kc] into MR-tall micro-panels (column-major within a panel),
+// zero-padding the last panel so the micro-kernel never reads out of bounds
+static void pack_a(int mc, int kc, const double *A, int lda, double *Ap, int mr) {
+    for (int ir = 0; ir < mc; ir += mr) {
+        int rows = MIN(mr, mc - ir);
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < rows; i++) {
+                Ap[p * mr + i] = A[(ir + i) * lda + p];
+            }
+            for (int i = rows; i < mr; i++) {
+                Ap[p * mr + i] = 0.0;
+            }
+        }
+        Ap += kc * mr;
+    }
+}
+
+// Pack one NR-wide micro-panel of B[kc×cols] (row-major within the panel)
+static void pack_b_panel(int kc, int cols, const double *B, int ldb, double *Bp, int nr) {
+    for (int p = 0; p < kc; p++) {
+        const double *src = B + (size_t)p * ldb;
+        for (int j = 0; j < cols; j++) {
+            Bp[p * nr + j] = src[j];
+        }
+        for (int j = cols; j < nr; j++) {
+            Bp[p * nr + j] = 0.0;
+        }
+    }
+}
+
+// Multiply one packed A block by one packed B panel into C[mc×nc]
+static void macro_kernel(const gemm_ukernel_t *uk, int mc, int nc, int kc,
+                         const double *Ap, const double *Bp,
+                         double *C, int ldc) {
+    int mr = uk->mr;
+    int nr = uk->nr;
+    double edge[GEMM_MAX_TILE] __attribute__((aligned(GEMM_ALIGNMENT)));
+
+    for (int jr = 0; jr < nc; jr += nr) {
+        int cols = MIN(nr, nc - jr);
+        for (int ir = 0; ir < mc; ir += mr) {
+            int rows = MIN(mr, mc - ir);
+            const double *a = Ap + ir * kc;
+            const double *b = Bp + jr * kc;
+            double *c = C + ir * ldc + jr;
+
+            if (rows == mr && cols == nr) {
+                uk->fn(kc, a, b, c, ldc);
+            } else {
+                // Partial tile: compute into a scratch tile, then copy the valid part
+                memset(edge, 0, (size_t)mr * nr * sizeof(double));
+                uk->fn(kc, a, b, edge, nr);
+                for (int i = 0; i < rows; i++) {
+                    for (int j = 0; j < cols; j++) {
+                        c[i * ldc + j] += edge[i * nr + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static double *alloc_aligned(size_t count) {
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, GEMM_ALIGNMENT, count * sizeof(double)) != 0) {
+        return NULL;
+    }
+    return (double*)ptr;
+}
+
+// Split the nc columns of a B panel into chunks of whole micro-panels so that
+// (row block × column chunk) work units keep every thread busy even when the
+// local matrix has only a few MC row blocks
+static int column_chunk_width(int m_blocks, int nc, int nr, int threads) {
+    int n_panels = (nc + nr - 1) / nr;
+    int chunks = 1;
+    if (m_blocks < 4 * threads) {
+        chunks = (4 * threads + m_blocks - 1) / m_blocks;
+    }
+    if (chunks > n_panels) {
+        chunks = n_panels;
+    }
+    return ((n_panels + chunks - 1) / chunks) * nr;
+}
+
+static void gemm_blocked(const gemm_ukernel_t *uk, int m, int n, int k,
+                         const double *A, int lda,
+                         const double *B, int ldb,
+                         double *C, int ldc) {
+    int mr = uk->mr;
+    int nr = uk->nr;
+    // Packing buffers sized for this call, so small multiplies (batched
+    // mode) stay on the heap instead of mapping full-size panels
+    size_t kc_alloc = (size_t)MIN(GEMM_KC, k);
+    size_t mc_padded = (size_t)((MIN(GEMM_MC, m) + mr - 1) / mr) * mr;
+    size_t nc_padded = (size_t)((MIN(GEMM_NC, n) + nr - 1) / nr) * nr;
+    int m_blocks = (m + GEMM_MC - 1) / GEMM_MC;
+    int threads = call_threads();
+    int alloc_failed = 0;
+    double *Bp = alloc_aligned(nc_padded * kc_alloc);   // Shared by all threads
+
+    if (!Bp) {
+        fprintf(stderr, "gemm: packing buffer allocation failed, using naive kernel\n");
+        gemm_naive(m, n, k, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    #pragma omp parallel if (threads > 1)
+    {
+        double *Ap = alloc_aligned(mc_padded * kc_alloc);  // Private per thread
+        if (!Ap) {
+            #pragma omp atomic write
+            alloc_failed = 1;
+        }
+        #pragma omp barrier
+
+        for (int jc = 0; jc < n && !alloc_failed; jc += GEMM_NC) {
+            int nc = MIN(GEMM_NC, n - jc);
+            int chunk = column_chunk_width(m_blocks, nc, nr, threads);
+            int n_chunks = (nc + chunk - 1) / chunk;
+
+            for (int pc = 0; pc < k; pc += GEMM_KC) {
+                int kc = MIN(GEMM_KC, k - pc);
+                const double *B_panel = B + (size_t)pc * ldb + jc;
+
+                // Cooperative packing of the shared B panel
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += nr) {
+                    pack_b_panel(kc, MIN(nr, nc - jr), B_panel + jr, ldb,
+                                 Bp + (size_t)jr * kc, nr);
+                }
+
+                // Units are ordered row-block-major so a thread usually keeps
+                // its packed A block across consecutive units
+                int packed_ic = -1;
+                #pragma omp for schedule(static)
+                for (int unit = 0; unit < m_blocks * n_chunks; unit++) {
+                    int ic = (unit / n_chunks) * GEMM_MC;
+                    int jr = (unit % n_chunks) * chunk;
+                    int mc = MIN(GEMM_MC, m - ic);
+                    if (ic != packed_ic) {
+                        pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, Ap, mr);
+                        packed_ic = ic;
+                    }
+                    macro_kernel(uk, mc, MIN(chunk, nc - jr), kc, Ap,
+                                 Bp + (size_t)jr * kc,
+                                 C + (size_t)ic * ldc + jc + jr, ldc);
+                }
+            }
+        }
+        free(Ap);
+    }
+
+    free(Bp);
+
+    if (alloc_failed) {
+        fprintf(stderr, "gemm: packing buffer allocation failed, using naive kernel\n");
+        gemm_naive(m, n, k, A, lda, B, ldb, C, ldc);
+    }
+}
+
+void gemm_multiply(gemm_kernel_t kernel, int m, int n, int k,
+                   const double *A, int lda,
+                   const double *B, int ldb,
+                   double *C, int ldc) {
+    if (m <= 0 || n <= 0 || k <= 0) {
+        return;
+    }
+
+    switch (kernel) {
+    case GEMM_KERNEL_NAIVE:
+        gemm_naive(m, n, k, A, lda, B, ldb, C, ldc);
+        break;
+    case GEMM_KERNEL_BLOCKED:
+        gemm_blocked(active_ukernel, m, n, k, A, lda, B, ldb, C, ldc);
+        break;
+    }
+}
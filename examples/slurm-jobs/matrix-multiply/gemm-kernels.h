@@ -0,0 +1,69 @@
+/*
+ * GEMM compute kernels for the matrix-multiply example
+ *
+ * All kernels compute C += A × B on row-major matrices with explicit
+ * leading dimensions, so the same code serves full row blocks (1D
+ * decomposition) and sub-tiles of larger matrices.
+ *
+ * Kernels:
+ * - naive:   straightforward i-j-k triple loop (reference / baseline)
+ * - blocked: cache-blocked GEMM with packed A/B panels and a
+ *            register-blocked micro-kernel
+ *
+ * The blocked kernel's micro-kernel is selected at runtime from the ISAs
+ * the CPU supports (CPUID on x86), so one binary on shared storage runs
+ * the widest available FMA path on every node.
+ */
+
+#ifndef GEMM_KERNELS_H
+#define GEMM_KERNELS_H
+
+typedef enum {
+    GEMM_KERNEL_NAIVE = 0,
+    GEMM_KERNEL_BLOCKED
+} gemm_kernel_t;
+
+// Instruction-set paths for the blocked kernel's micro-kernel
+typedef enum {
+    GEMM_ISA_AUTO = 0,      // Best path supported by this CPU
+    GEMM_ISA_GENERIC,       // Portable C (compiler auto-vectorized)
+    GEMM_ISA_AVX2,          // x86 AVX2 + FMA
+    GEMM_ISA_AVX512,        // x86 AVX-512F
+    GEMM_ISA_NEON,          // AArch64 Advanced SIMD
+    GEMM_ISA_COUNT
+} gemm_isa_t;
+
+// Parse a kernel name ("naive", "blocked"); returns 0 on success, -1 if unknown
+int gemm_kernel_from_name(const char *name, gemm_kernel_t *kernel);
+
+// Human-readable kernel name
+const char *gemm_kernel_name(gemm_kernel_t kernel);
+
+// Parse an ISA name ("auto", "generic", "avx2", "avx512", "neon")
+int gemm_isa_from_name(const char *name, gemm_isa_t *isa);
+
+const char *gemm_isa_name(gemm_isa_t isa);
+
+// Nonzero if this CPU (and this build) can run the given ISA path
+int gemm_isa_supported(gemm_isa_t isa);
+
+// Widest ISA path supported by this CPU
+gemm_isa_t gemm_detect_isa(void);
+
+// Select the micro-kernel ISA (GEMM_ISA_AUTO detects); -1 if unsupported
+int gemm_set_isa(gemm_isa_t isa);
+
+// Currently selected ISA path and its MR×NR register tile
+gemm_isa_t gemm_get_isa(void);
+void gemm_get_tile(int *mr, int *nr);
+
+// Cache blocking of the blocked kernel (GEMM_MC/KC/NC, fixed at compile time)
+void gemm_get_blocking(int *mc, int *kc, int *nc);
+
+// C[m×n] += A[m×k] × B[k×n] using the selected kernel
+void gemm_multiply(gemm_kernel_t kernel, int m, int n, int k,
+                   const double *A, int lda,
+                   const double *B, int ldb,
+                   double *C, int ldc);
+
+#endif /* GEMM_KERNELS_H */
@@ -0,0 +1,547 @@
+/*
+ * Low-precision GEMM kernels for the matrix-multiply example
+ *
+ * The driver repeats gemm_blocked() of gemm-kernels.c (same loops, same
+ * cooperative packing of B) over FP32 C tiles. Micro-kernels read packed
+ * panels in one of two layouts:
+ *
+ *   kpair 1 (FP32):       Ap[kc][MR],      Bp[kc][NR]
+ *   kpair 2 (BF16 pairs): Ap[kc/2][MR][2], Bp[kc/2][NR][2]
+ *
+ * The pair layout is the operand order of VDPBF16PS: one 32-bit lane holds
+ * elements k and k+1 of a row of A or a column of B, and kc is rounded up
+ * to even with zero padding. BF16 inputs packed for an FP32 kernel are
+ * widened on the way, so every ISA runs both dtypes.
+ */
+
+#include "gemm-lowp.h"
+#include "gemm-kernels.h"
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOWP_X86 1
+#endif
+
+// Largest MR×NR register tile (edge scratch buffer size)
+#define LOWP_MAX_TILE (8 * 32)
+
+#define LOWP_ALIGNMENT 64
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef void (*lowp_ukernel_fn)(int kc, const void *Ap, const void *Bp,
+                                float *C, int ldc);
+
+typedef struct {
+    const char *name;
+    int mr;
+    int nr;
+    int kpair;              // 2: BF16 pairs along k, 1: FP32
+    lowp_ukernel_fn fn;
+} lowp_ukernel_t;
+
+int gemm_dtype_from_name(const char *name, gemm_dtype_t *dtype) {
+    for (int i = 0; i < GEMM_DTYPE_COUNT; i++) {
+        if (strcmp(name, gemm_dtype_name((gemm_dtype_t)i)) == 0) {
+            *dtype = (gemm_dtype_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *gemm_dtype_name(gemm_dtype_t dtype) {
+    switch (dtype) {
+    case GEMM_DTYPE_F64:
+        return "f64";
+    case GEMM_DTYPE_F32:
+        return "f32";
+    case GEMM_DTYPE_BF16:
+        return "bf16";
+    case GEMM_DTYPE_COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+size_t gemm_dtype_size(gemm_dtype_t dtype) {
+    switch (dtype) {
+    case GEMM_DTYPE_F32:
+        return sizeof(float);
+    case GEMM_DTYPE_BF16:
+        return sizeof(gemm_bf16_t);
+    default:
+        return sizeof(double);
+    }
+}
+
+double gemm_dtype_epsilon(gemm_dtype_t dtype) {
+    return dtype == GEMM_DTYPE_F64 ? DBL_EPSILON : FLT_EPSILON;
+}
+
+void gemm_lowp_round(gemm_dtype_t dtype, const double *src, void *dst, size_t count) {
+    if (dtype == GEMM_DTYPE_F64) {
+        memcpy(dst, src, count * sizeof(double));
+    } else if (dtype == GEMM_DTYPE_F32) {
+        float *out = dst;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (float)src[i];
+        }
+    } else {
+        gemm_bf16_t *out = dst;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; i++) {
+            out[i] = gemm_bf16_from_float((float)src[i]);
+        }
+    }
+}
+
+void gemm_lowp_widen(gemm_dtype_t dtype, const void *src, double *dst, size_t count) {
+    if (dtype == GEMM_DTYPE_F64) {
+        memcpy(dst, src, count * sizeof(double));
+    } else if (dtype == GEMM_DTYPE_F32) {
+        const float *in = src;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = in[i];
+        }
+    } else {
+        const gemm_bf16_t *in = src;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = gemm_bf16_to_float(in[i]);
+        }
+    }
+}
+
+// Element `index` of an FP32 or BF16 matrix as float
+static inline float load_elem(gemm_dtype_t dtype, const void *src, size_t index) {
+    return dtype == GEMM_DTYPE_F32 ? ((const float*)src)[index]
+                                   : gemm_bf16_to_float(((const gemm_bf16_t*)src)[index]);
+}
+
+#define GENERIC_MR 4
+#define GENERIC_NR 16
+
+// Portable micro-kernel: fixed-size accumulator the compiler keeps in registers
+static void ukernel_generic_4x16(int kc, const void *Ap_, const void *Bp_,
+                                 float *restrict C, int ldc) {
+    const float *restrict Ap = Ap_;
+    const float *restrict Bp = Bp_;
+    float acc[GENERIC_MR][GENERIC_NR] = {{0.0f}};
+
+    for (int p = 0; p < kc; p++) {
+        const float *a = Ap + p * GENERIC_MR;
+        const float *b = Bp + p * GENERIC_NR;
+        for (int i = 0; i < GENERIC_MR; i++) {
+            for (int j = 0; j < GENERIC_NR; j++) {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (int i = 0; i < GENERIC_MR; i++) {
+        for (int j = 0; j < GENERIC_NR; j++) {
+            C[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+static const lowp_ukernel_t ukernel_generic = {
+    "generic", GENERIC_MR, GENERIC_NR, 1, ukernel_generic_4x16
+};
+
+#ifdef LOWP_X86
+
+#define AVX2_MR 6
+#define AVX2_NR 16      // 2 × 8 floats
+
+// 12 accumulators + 2 B vectors + 1 broadcast = 15 of 16 ymm registers
+__attribute__((target("avx2,fma")))
+static void ukernel_avx2_6x16(int kc, const void *Ap_, const void *Bp_,
+                              float *restrict C, int ldc) {
+    const float *restrict Ap = Ap_;
+    const float *restrict Bp = Bp_;
+    __m256 c[AVX2_MR][2];
+
+    for (int i = 0; i < AVX2_MR; i++) {
+        c[i][0] = _mm256_setzero_ps();
+        c[i][1] = _mm256_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; p++) {
+        __m256 b0 = _mm256_load_ps(Bp);
+        __m256 b1 = _mm256_load_ps(Bp + 8);
+        for (int i = 0; i < AVX2_MR; i++) {
+            __m256 a = _mm256_broadcast_ss(Ap + i);
+            c[i][0] = _mm256_fmadd_ps(a, b0, c[i][0]);
+            c[i][1] = _mm256_fmadd_ps(a, b1, c[i][1]);
+        }
+        Ap += AVX2_MR;
+        Bp += AVX2_NR;
+    }
+
+    for (int i = 0; i < AVX2_MR; i++) {
+        float *row = C + i * ldc;
+        _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), c[i][0]));
+        _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), c[i][1]));
+    }
+}
+
+static const lowp_ukernel_t ukernel_avx2 = {"avx2", AVX2_MR, AVX2_NR, 1, ukernel_avx2_6x16};
+
+#define AVX512_MR 8
+#define AVX512_NR 32    // 2 × 16 floats
+
+// 16 accumulators + 2 B vectors + 1 broadcast of 32 zmm registers
+__attribute__((target("avx512f")))
+static void ukernel_avx512_8x32(int kc, const void *Ap_, const void *Bp_,
+                                float *restrict C, int ldc) {
+    const float *restrict Ap = Ap_;
+    const float *restrict Bp = Bp_;
+    __m512 c[AVX512_MR][2];
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        c[i][0] = _mm512_setzero_ps();
+        c[i][1] = _mm512_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; p++) {
+        __m512 b0 = _mm512_load_ps(Bp);
+        __m512 b1 = _mm512_load_ps(Bp + 16);
+        for (int i = 0; i < AVX512_MR; i++) {
+            __m512 a = _mm512_set1_ps(Ap[i]);
+            c[i][0] = _mm512_fmadd_ps(a, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_ps(a, b1, c[i][1]);
+        }
+        Ap += AVX512_MR;
+        Bp += AVX512_NR;
+    }
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        float *row = C + i * ldc;
+        _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), c[i][0]));
+        _mm512_storeu_ps(row + 16, _mm512_add_ps(_mm512_loadu_ps(row + 16), c[i][1]));
+    }
+}
+
+static const lowp_ukernel_t ukernel_avx512 = {
+    "avx512", AVX512_MR, AVX512_NR, 1, ukernel_avx512_8x32
+};
+
+// Same register budget; each step consumes two k (one BF16 pair per lane)
+// and every VDPBF16PS does 32 multiply-adds
+__attribute__((target("avx512f,avx512bf16")))
+static void ukernel_avx512_bf16_8x32(int kc, const void *Ap_, const void *Bp_,
+                                     float *restrict C, int ldc) {
+    const gemm_bf16_t *restrict Ap = Ap_;
+    const gemm_bf16_t *restrict Bp = Bp_;
+    __m512 c[AVX512_MR][2];
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        c[i][0] = _mm512_setzero_ps();
+        c[i][1] = _mm512_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; p += 2) {
+        __m512bh b0 = (__m512bh)_mm512_load_si512(Bp);
+        __m512bh b1 = (__m512bh)_mm512_load_si512(Bp + 32);
+        for (int i = 0; i < AVX512_MR; i++) {
+            int32_t pair;
+            memcpy(&pair, Ap + 2 * i, sizeof(pair));
+            __m512bh a = (__m512bh)_mm512_set1_epi32(pair);
+            c[i][0] = _mm512_dpbf16_ps(c[i][0], a, b0);
+            c[i][1] = _mm512_dpbf16_ps(c[i][1], a, b1);
+        }
+        Ap += 2 * AVX512_MR;
+        Bp += 2 * AVX512_NR;
+    }
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        float *row = C + i * ldc;
+        _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), c[i][0]));
+        _mm512_storeu_ps(row + 16, _mm512_add_ps(_mm512_loadu_ps(row + 16), c[i][1]));
+    }
+}
+
+static const lowp_ukernel_t ukernel_avx512_bf16 = {
+    "avx512-bf16", AVX512_MR, AVX512_NR, 2, ukernel_avx512_bf16_8x32
+};
+
+#endif /* LOWP_X86 */
+
+// Micro-kernel for dtype under the ISA selected by gemm_set_isa()
+static const lowp_ukernel_t *ukernel_for_dtype(gemm_dtype_t dtype) {
+    switch (gemm_get_isa()) {
+#ifdef LOWP_X86
+    case GEMM_ISA_AVX512:
+        if (dtype == GEMM_DTYPE_BF16 && __builtin_cpu_supports("avx512bf16")) {
+            return &ukernel_avx512_bf16;
+        }
+        return &ukernel_avx512;
+    case GEMM_ISA_AVX2:
+        return &ukernel_avx2;
+#endif
+    default:
+        (void)dtype;
+        return &ukernel_generic;
+    }
+}
+
+const char *gemm_lowp_path(gemm_dtype_t dtype, int *mr, int *nr) {
+    if (dtype == GEMM_DTYPE_F64) {
+        gemm_get_tile(mr, nr);
+        return gemm_isa_name(gemm_get_isa());
+    }
+    const lowp_ukernel_t *uk = ukernel_for_dtype(dtype);
+    *mr = uk->mr;
+    *nr = uk->nr;
+    return uk->name;
+}
+
+int gemm_lowp_bf16_native(void) {
+    return ukernel_for_dtype(GEMM_DTYPE_BF16)->kpair == 2;
+}
+
+// Bytes per packed element
+static size_t packed_size(const lowp_ukernel_t *uk) {
+    return uk->kpair == 2 ? sizeof(gemm_bf16_t) : sizeof(float);
+}
+
+// kc rounded up to whole pairs for the pair layout
+static int padded_depth(const lowp_ukernel_t *uk, int kc) {
+    return (kc + uk->kpair - 1) / uk->kpair * uk->kpair;
+}
+
+// Pack A[mc×kc] into MR-tall micro-panels, zero-padding rows and k
+static void pack_a(const lowp_ukernel_t *uk, gemm_dtype_t dtype, int mc, int kc,
+                   const void *A, int lda, void *Ap) {
+    int mr = uk->mr;
+    int kcp = padded_depth(uk, kc);
+
+    for (int ir = 0; ir < mc; ir += mr) {
+        int rows = MIN(mr, mc - ir);
+        if (uk->kpair == 2) {
+            const gemm_bf16_t *src = (const gemm_bf16_t*)A + (size_t)ir * lda;
+            gemm_bf16_t *dst = (gemm_bf16_t*)Ap + (size_t)ir * kcp;
+            for (int p = 0; p < kcp; p += 2) {
+                for (int i = 0; i < mr; i++) {
+                    for (int s = 0; s < 2; s++) {
+                        dst[p * mr + 2 * i + s] = i < rows && p + s < kc
+                                                  ? src[(size_t)i * lda + p + s] : 0;
+                    }
+                }
+            }
+        } else {
+            float *dst = (float*)Ap + (size_t)ir * kc;
+            for (int p = 0; p < kc; p++) {
+                for (int i = 0; i < rows; i++) {
+                    dst[p * mr + i] = load_elem(dtype, A, (size_t)(ir + i) * lda + p);
+                }
+                for (int i = rows; i < mr; i++) {
+                    dst[p * mr + i] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+// Pack one NR-wide micro-panel of B[kc×cols]
+static void pack_b_panel(const lowp_ukernel_t *uk, gemm_dtype_t dtype, int kc, int cols,
+                         const void *B, size_t offset, int ldb, void *Bp) {
+    int nr = uk->nr;
+
+    if (uk->kpair == 2) {
+        const gemm_bf16_t *src = (const gemm_bf16_t*)B + offset;
+        gemm_bf16_t *dst = Bp;
+        for (int p = 0; p < padded_depth(uk, kc); p += 2) {
+            for (int j = 0; j < nr; j++) {
+                for (int s = 0; s < 2; s++) {
+                    dst[p * nr + 2 * j + s] = j < cols && p + s < kc
+                                              ? src[(size_t)(p + s) * ldb + j] : 0;
+                }
+            }
+        }
+    } else {
+        float *dst = Bp;
+        for (int p = 0; p < kc; p++) {
+            for (int j = 0; j < cols; j++) {
+                dst[p * nr + j] = load_elem(dtype, B, offset + (size_t)p * ldb + j);
+            }
+            for (int j = cols; j < nr; j++) {
+                dst[p * nr + j] = 0.0f;
+            }
+        }
+    }
+}
+
+// Multiply one packed A block by one packed B panel into C[mc×nc]
+static void macro_kernel(const lowp_ukernel_t *uk, int mc, int nc, int kc,
+                         const char *Ap, const char *Bp, float *C, int ldc) {
+    int mr = uk->mr;
+    int nr = uk->nr;
+    int kcp = padded_depth(uk, kc);
+    size_t esize = packed_size(uk);
+    float edge[LOWP_MAX_TILE] __attribute__((aligned(LOWP_ALIGNMENT)));
+
+    for (int jr = 0; jr < nc; jr += nr) {
+        int cols = MIN(nr, nc - jr);
+        for (int ir = 0; ir < mc; ir += mr) {
+            int rows = MIN(mr, mc - ir);
+            const char *a = Ap + (size_t)ir * kcp * esize;
+            const char *b = Bp + (size_t)jr * kcp * esize;
+            float *c = C + ir * ldc + jr;
+
+            if (rows == mr && cols == nr) {
+                uk->fn(kcp, a, b, c, ldc);
+            } else {
+                memset(edge, 0, (size_t)mr * nr * sizeof(float));
+                uk->fn(kcp, a, b, edge, nr);
+                for (int i = 0; i < rows; i++) {
+                    for (int j = 0; j < cols; j++) {
+                        c[i * ldc + j] += edge[i * nr + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void *alloc_aligned(size_t bytes) {
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, LOWP_ALIGNMENT, bytes) != 0) {
+        return NULL;
+    }
+    return ptr;
+}
+
+// OpenMP threads for one call; 1 when called from a parallel region
+// (batched small matrices, one per thread)
+static int call_threads(void) {
+#ifdef _OPENMP
+    return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Reference triple loop with FP32 accumulation (packing buffers unavailable)
+static void lowp_naive(gemm_dtype_t dtype, int m, int n, int k,
+                       const void *A, int lda, const void *B, int ldb,
+                       float *C, int ldc) {
+    #pragma omp parallel for schedule(static) if (call_threads() > 1)
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            float sum = 0.0f;
+            for (int p = 0; p < k; p++) {
+                sum += load_elem(dtype, A, (size_t)i * lda + p)
+                       * load_elem(dtype, B, (size_t)p * ldb + j);
+            }
+            C[i * ldc + j] += sum;
+        }
+    }
+}
+
+// Column chunks of whole micro-panels, as in gemm-kernels.c
+static int column_chunk_width(int m_blocks, int nc, int nr, int threads) {
+    int n_panels = (nc + nr - 1) / nr;
+    int chunks = 1;
+    if (m_blocks < 4 * threads) {
+        chunks = (4 * threads + m_blocks - 1) / m_blocks;
+    }
+    if (chunks > n_panels) {
+        chunks = n_panels;
+    }
+    return ((n_panels + chunks - 1) / chunks) * nr;
+}
+
+void gemm_lowp_multiply(gemm_dtype_t dtype, int m, int n, int k,
+                        const void *A, int lda,
+                        const void *B, int ldb,
+                        float *C, int ldc) {
+    const lowp_ukernel_t *uk = ukernel_for_dtype(dtype);
+    int mc_max, kc_max, nc_max;
+    int threads = call_threads();
+    int alloc_failed = 0;
+
+    if (m <= 0 || n <= 0 || k <= 0) {
+        return;
+    }
+    gemm_get_blocking(&mc_max, &kc_max, &nc_max);
+
+    int mr = uk->mr;
+    int nr = uk->nr;
+    size_t esize = packed_size(uk);
+    // Packing buffers sized for this call, as in gemm-kernels.c
+    size_t kc_padded = (size_t)padded_depth(uk, MIN(kc_max, k));
+    size_t mc_padded = (size_t)((MIN(mc_max, m) + mr - 1) / mr) * mr;
+    size_t nc_padded = (size_t)((MIN(nc_max, n) + nr - 1) / nr) * nr;
+    int m_blocks = (m + mc_max - 1) / mc_max;
+    char *Bp = alloc_aligned(nc_padded * kc_padded * esize);   // Shared by all threads
+
+    if (!Bp) {
+        fprintf(stderr, "gemm: packing buffer allocation failed, using naive kernel\n");
+        lowp_naive(dtype, m, n, k, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    #pragma omp parallel if (threads > 1)
+    {
+        char *Ap = alloc_aligned(mc_padded * kc_padded * esize);   // Private per thread
+        if (!Ap) {
+            #pragma omp atomic write
+            alloc_failed = 1;
+        }
+        #pragma omp barrier
+
+        for (int jc = 0; jc < n && !alloc_failed; jc += nc_max) {
+            int nc = MIN(nc_max, n - jc);
+            int chunk = column_chunk_width(m_blocks, nc, nr, threads);
+            int n_chunks = (nc + chunk - 1) / chunk;
+
+            for (int pc = 0; pc < k; pc += kc_max) {
+                int kc = MIN(kc_max, k - pc);
+                size_t kcp = (size_t)padded_depth(uk, kc);
+
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += nr) {
+                    pack_b_panel(uk, dtype, kc, MIN(nr, nc - jr), B,
+                                 (size_t)pc * ldb + jc + jr, ldb, Bp + jr * kcp * esize);
+                }
+
+                int packed_ic = -1;
+                #pragma omp for schedule(static)
+                for (int unit = 0; unit < m_blocks * n_chunks; unit++) {
+                    int ic = (unit / n_chunks) * mc_max;
+                    int jr = (unit % n_chunks) * chunk;
+                    int mc = MIN(mc_max, m - ic);
+                    if (ic != packed_ic) {
+                        size_t offset = ((size_t)ic * lda + pc) * gemm_dtype_size(dtype);
+                        pack_a(uk, dtype, mc, kc, (const char*)A + offset, lda, Ap);
+                        packed_ic = ic;
+                    }
+                    macro_kernel(uk, mc, MIN(chunk, nc - jr), kc, Ap,
+                                 Bp + jr * kcp * esize,
+                                 C + (size_t)ic * ldc + jc + jr, ldc);
+                }
+            }
+        }
+        free(Ap);
+    }
+
+    free(Bp);
+
+    if (alloc_failed) {
+        fprintf(stderr, "gemm: packing buffer allocation failed, using naive kernel\n");
+        lowp_naive(dtype, m, n, k, A, lda, B, ldb, C, ldc);
+    }
+}
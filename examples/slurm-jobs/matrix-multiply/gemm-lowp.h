@@ -0,0 +1,85 @@
+/*
+ * Low-precision GEMM kernels for the matrix-multiply example
+ *
+ * C[m×n] += A[m×k] × B[k×n] on row-major FP32 or BF16 inputs with FP32
+ * accumulation and an FP32 C (--dtype=f32|bf16), the arithmetic of the ML
+ * training jobs. BF16 keeps the upper 16 bits of an FP32: the same 8-bit
+ * exponent, 7 mantissa bits.
+ *
+ * The blocked driver is the FP64 one (gemm-kernels.c) in single precision:
+ * the same MC/KC/NC blocking in elements, so packed panels take half the
+ * bytes, and micro-kernels twice as wide as the FP64 ones. BF16 inputs are
+ * widened to FP32 while they are packed; on CPUs with AVX512_BF16 they stay
+ * BF16 instead, packed as pairs along k, and VDPBF16PS multiplies each pair
+ * and adds both products to an FP32 accumulator.
+ *
+ * The micro-kernel follows the ISA selected for the FP64 kernels
+ * (gemm_set_isa); on NEON the portable kernel runs.
+ */
+
+#ifndef GEMM_LOWP_H
+#define GEMM_LOWP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Element type of the inputs (C is double for f64, float otherwise)
+typedef enum {
+    GEMM_DTYPE_F64 = 0,
+    GEMM_DTYPE_F32,
+    GEMM_DTYPE_BF16,
+    GEMM_DTYPE_COUNT
+} gemm_dtype_t;
+
+typedef uint16_t gemm_bf16_t;
+
+// Parse "f64", "f32", "bf16"; returns 0 on success, -1 if unknown
+int gemm_dtype_from_name(const char *name, gemm_dtype_t *dtype);
+const char *gemm_dtype_name(gemm_dtype_t dtype);
+
+// Bytes per input element
+size_t gemm_dtype_size(gemm_dtype_t dtype);
+
+// Unit roundoff of the products' accumulation (FP32 for f32 and bf16)
+double gemm_dtype_epsilon(gemm_dtype_t dtype);
+
+// Round to nearest even (NaNs stay NaN)
+static inline gemm_bf16_t gemm_bf16_from_float(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) {
+        return (gemm_bf16_t)((bits >> 16) | 0x0040u);
+    }
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return (gemm_bf16_t)(bits >> 16);
+}
+
+static inline float gemm_bf16_to_float(gemm_bf16_t x) {
+    uint32_t bits = (uint32_t)x << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// dst[count] = src rounded to dtype elements (float or gemm_bf16_t)
+void gemm_lowp_round(gemm_dtype_t dtype, const double *src, void *dst, size_t count);
+
+// dst[count] = dtype elements of src widened to double
+void gemm_lowp_widen(gemm_dtype_t dtype, const void *src, double *dst, size_t count);
+
+// Micro-kernel path for dtype and its MR×NR tile, e.g. "avx512-bf16" 8×32
+const char *gemm_lowp_path(gemm_dtype_t dtype, int *mr, int *nr);
+
+// Nonzero if BF16 inputs are multiplied as BF16 pairs (VDPBF16PS, which the
+// FP arithmetic counters do not count) rather than widened to FP32
+int gemm_lowp_bf16_native(void);
+
+// C[m×n] += A[m×k] × B[k×n] for dtype GEMM_DTYPE_F32 or GEMM_DTYPE_BF16
+// (A and B hold float or gemm_bf16_t), blocked kernel
+void gemm_lowp_multiply(gemm_dtype_t dtype, int m, int n, int k,
+                        const void *A, int lda,
+                        const void *B, int ldb,
+                        float *C, int ldc);
+
+#endif /* GEMM_LOWP_H */
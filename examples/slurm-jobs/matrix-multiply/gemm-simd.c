@@ -0,0 +1,138 @@
+/*
+ * SIMD GEMM micro-kernels for the matrix-multiply example
+ *
+ * Explicit FMA micro-kernels for AVX2, AVX-512 and NEON. The x86 kernels
+ * are compiled with per-function target attributes, so the binary builds
+ * without -march flags and still runs on nodes lacking AVX-512; the
+ * dispatcher in gemm-kernels.c only calls a kernel the CPU supports.
+ *
+ * Every kernel follows the same scheme: the MR×NR tile of C lives in vector
+ * registers for the whole KC loop, each step loads one row of the packed B
+ * micro-panel and broadcasts MR elements of the packed A micro-panel.
+ */
+
+#include "gemm-ukernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define AVX2_MR 6
+#define AVX2_NR 8       // 2 × 4 doubles
+
+// 12 accumulators + 2 B vectors + 1 broadcast = 15 of 16 ymm registers
+__attribute__((target("avx2,fma")))
+static void ukernel_avx2_6x8(int kc, const double *restrict Ap,
+                             const double *restrict Bp,
+                             double *restrict C, int ldc) {
+    __m256d c[AVX2_MR][2];
+
+    for (int i = 0; i < AVX2_MR; i++) {
+        c[i][0] = _mm256_setzero_pd();
+        c[i][1] = _mm256_setzero_pd();
+    }
+
+    for (int p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_load_pd(Bp);
+        __m256d b1 = _mm256_load_pd(Bp + 4);
+        for (int i = 0; i < AVX2_MR; i++) {
+            __m256d a = _mm256_broadcast_sd(Ap + i);
+            c[i][0] = _mm256_fmadd_pd(a, b0, c[i][0]);
+            c[i][1] = _mm256_fmadd_pd(a, b1, c[i][1]);
+        }
+        Ap += AVX2_MR;
+        Bp += AVX2_NR;
+    }
+
+    for (int i = 0; i < AVX2_MR; i++) {
+        double *row = C + i * ldc;
+        _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c[i][0]));
+        _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c[i][1]));
+    }
+}
+
+const gemm_ukernel_t gemm_ukernel_avx2 = {AVX2_MR, AVX2_NR, ukernel_avx2_6x8};
+
+#define AVX512_MR 8
+#define AVX512_NR 16    // 2 × 8 doubles
+
+// 16 accumulators + 2 B vectors + 1 broadcast of 32 zmm registers
+__attribute__((target("avx512f")))
+static void ukernel_avx512_8x16(int kc, const double *restrict Ap,
+                                const double *restrict Bp,
+                                double *restrict C, int ldc) {
+    __m512d c[AVX512_MR][2];
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        c[i][0] = _mm512_setzero_pd();
+        c[i][1] = _mm512_setzero_pd();
+    }
+
+    for (int p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_load_pd(Bp);
+        __m512d b1 = _mm512_load_pd(Bp + 8);
+        for (int i = 0; i < AVX512_MR; i++) {
+            __m512d a = _mm512_set1_pd(Ap[i]);
+            c[i][0] = _mm512_fmadd_pd(a, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_pd(a, b1, c[i][1]);
+        }
+        Ap += AVX512_MR;
+        Bp += AVX512_NR;
+    }
+
+    for (int i = 0; i < AVX512_MR; i++) {
+        double *row = C + i * ldc;
+        _mm512_storeu_pd(row, _mm512_add_pd(_mm512_loadu_pd(row), c[i][0]));
+        _mm512_storeu_pd(row + 8, _mm512_add_pd(_mm512_loadu_pd(row + 8), c[i][1]));
+    }
+}
+
+const gemm_ukernel_t gemm_ukernel_avx512 = {AVX512_MR, AVX512_NR, ukernel_avx512_8x16};
+
+#endif /* x86 */
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+#define NEON_MR 4
+#define NEON_NR 8       // 4 × 2 doubles
+
+// 16 accumulators + 4 B vectors of 32 q registers; A is applied by lane
+static void ukernel_neon_4x8(int kc, const double *restrict Ap,
+                             const double *restrict Bp,
+                             double *restrict C, int ldc) {
+    float64x2_t c[NEON_MR][4];
+
+    for (int i = 0; i < NEON_MR; i++) {
+        for (int j = 0; j < 4; j++) {
+            c[i][j] = vdupq_n_f64(0.0);
+        }
+    }
+
+    for (int p = 0; p < kc; p++) {
+        float64x2_t b[4];
+        for (int j = 0; j < 4; j++) {
+            b[j] = vld1q_f64(Bp + 2 * j);
+        }
+        for (int i = 0; i < NEON_MR; i++) {
+            float64x2_t a = vdupq_n_f64(Ap[i]);
+            for (int j = 0; j < 4; j++) {
+                c[i][j] = vfmaq_f64(c[i][j], a, b[j]);
+            }
+        }
+        Ap += NEON_MR;
+        Bp += NEON_NR;
+    }
+
+    for (int i = 0; i < NEON_MR; i++) {
+        double *row = C + i * ldc;
+        for (int j = 0; j < 4; j++) {
+            vst1q_f64(row + 2 * j, vaddq_f64(vld1q_f64(row + 2 * j), c[i][j]));
+        }
+    }
+}
+
+const gemm_ukernel_t gemm_ukernel_neon = {NEON_MR, NEON_NR, ukernel_neon_4x8};
+
+#endif /* __aarch64__ */
@@ -0,0 +1,32 @@
+/*
+ * GEMM micro-kernel interface (internal to the matrix-multiply example)
+ *
+ * A micro-kernel computes one MR×NR register tile:
+ *   C[MR×NR] += Ap[KC×MR] × Bp[KC×NR]
+ * where Ap/Bp are the packed micro-panels produced by the blocked driver
+ * in gemm-kernels.c. Each ISA-specific kernel publishes a descriptor; the
+ * driver picks one at startup based on CPUID.
+ */
+
+#ifndef GEMM_UKERNELS_H
+#define GEMM_UKERNELS_H
+
+typedef void (*gemm_ukernel_fn)(int kc, const double *Ap, const double *Bp,
+                                double *C, int ldc);
+
+typedef struct {
+    int mr;
+    int nr;
+    gemm_ukernel_fn fn;
+} gemm_ukernel_t;
+
+#if defined(__x86_64__) || defined(__i386__)
+extern const gemm_ukernel_t gemm_ukernel_avx2;     // 6×8, FMA on 256-bit vectors
+extern const gemm_ukernel_t gemm_ukernel_avx512;   // 8×16, FMA on 512-bit vectors
+#endif
+
+#if defined(__aarch64__)
+extern const gemm_ukernel_t gemm_ukernel_neon;     // 4×8, FMA on 128-bit vectors
+#endif
+
+#endif /* GEMM_UKERNELS_H */
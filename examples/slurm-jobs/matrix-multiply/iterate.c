@@ -0,0 +1,341 @@
+/*
+ * Steady-state 1D matrix multiplication (--iterations=N, --warmup=W)
+ */
+
+#include "iterate.h"
+
+#include <mpi.h>
+#if MPI_VERSION < 4 && defined(OPEN_MPI) && OMPI_MAJOR_VERSION >= 4
+#include <mpi-ext.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+#include "bench-report.h"
+#include "matrix-verify.h"
+
+// Persistent collectives: standard in MPI 4, an extension in Open MPI 4
+#if MPI_VERSION >= 4
+#define COLL_INIT(op) MPI_##op##_init
+#define EXCHANGE_NAME "mpi-4 collectives"
+#elif defined(OMPI_HAVE_MPI_EXT_PCOLLREQ)
+#define COLL_INIT(op) MPIX_##op##_init
+#define EXCHANGE_NAME "mpix collectives"
+#else
+#define EXCHANGE_NAME "point-to-point"
+#endif
+
+// Point-to-point tags of the three exchanges
+#define TAG_A 1
+#define TAG_B 2
+#define TAG_C 3
+
+// One exchange of the iteration: persistent requests and, for the
+// point-to-point form, the copy of the rank's own block
+typedef struct {
+    MPI_Request *requests;
+    int count;
+    void *copy_dst;
+    const void *copy_src;
+    size_t copy_bytes;
+} exchange_t;
+
+const char *iterate_exchange_name(void) {
+    return EXCHANGE_NAME;
+}
+
+static void exchange_alloc(exchange_t *x, int world_size) {
+    memset(x, 0, sizeof(*x));
+    x->requests = malloc(2 * (size_t)world_size * sizeof(MPI_Request));
+    if (!x->requests) {
+        printf("Memory allocation failed for persistent requests\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+#ifndef COLL_INIT
+static void exchange_copy(exchange_t *x, void *dst, const void *src, int count) {
+    x->copy_dst = dst;
+    x->copy_src = src;
+    x->copy_bytes = (size_t)count * sizeof(double);
+}
+#endif
+
+// buf[count] from root to every rank
+static void exchange_bcast(exchange_t *x, double *buf, int count, int root, int tag) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    exchange_alloc(x, world_size);
+#ifdef COLL_INIT
+    (void)tag;
+    COLL_INIT(Bcast)(buf, count, MPI_DOUBLE, root, MPI_COMM_WORLD, MPI_INFO_NULL,
+                     &x->requests[x->count++]);
+#else
+    if (world_rank != root) {
+        MPI_Recv_init(buf, count, MPI_DOUBLE, root, tag, MPI_COMM_WORLD,
+                      &x->requests[x->count++]);
+        return;
+    }
+    for (int r = 0; r < world_size; r++) {
+        if (r != root) {
+            MPI_Send_init(buf, count, MPI_DOUBLE, r, tag, MPI_COMM_WORLD,
+                          &x->requests[x->count++]);
+        }
+    }
+#endif
+}
+
+// Block r of sendbuf (significant on root) to rank r's recvbuf
+static void exchange_scatterv(exchange_t *x, const double *sendbuf, const int *counts,
+                              const int *displs, double *recvbuf, int root, int tag) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    exchange_alloc(x, world_size);
+#ifdef COLL_INIT
+    (void)tag;
+    COLL_INIT(Scatterv)(sendbuf, counts, displs, MPI_DOUBLE, recvbuf, counts[world_rank],
+                        MPI_DOUBLE, root, MPI_COMM_WORLD, MPI_INFO_NULL,
+                        &x->requests[x->count++]);
+#else
+    if (world_rank != root) {
+        MPI_Recv_init(recvbuf, counts[world_rank], MPI_DOUBLE, root, tag, MPI_COMM_WORLD,
+                      &x->requests[x->count++]);
+        return;
+    }
+    for (int r = 0; r < world_size; r++) {
+        if (r != root) {
+            MPI_Send_init(sendbuf + displs[r], counts[r], MPI_DOUBLE, r, tag,
+                          MPI_COMM_WORLD, &x->requests[x->count++]);
+        }
+    }
+    exchange_copy(x, recvbuf, sendbuf + displs[root], counts[root]);
+#endif
+}
+
+// Every rank's block of buf (in place) to all ranks
+static void exchange_allgatherv(exchange_t *x, double *buf, const int *counts,
+                                const int *displs, int tag) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    exchange_alloc(x, world_size);
+#ifdef COLL_INIT
+    (void)tag;
+    COLL_INIT(Allgatherv)(MPI_IN_PLACE, 0, MPI_DOUBLE, buf, counts, displs, MPI_DOUBLE,
+                          MPI_COMM_WORLD, MPI_INFO_NULL, &x->requests[x->count++]);
+#else
+    for (int r = 0; r < world_size; r++) {
+        if (r != world_rank) {
+            MPI_Recv_init(buf + displs[r], counts[r], MPI_DOUBLE, r, tag, MPI_COMM_WORLD,
+                          &x->requests[x->count++]);
+            MPI_Send_init(buf + displs[world_rank], counts[world_rank], MPI_DOUBLE, r, tag,
+                          MPI_COMM_WORLD, &x->requests[x->count++]);
+        }
+    }
+#endif
+}
+
+// Rank r's sendbuf to block r of recvbuf (significant on root)
+static void exchange_gatherv(exchange_t *x, const double *sendbuf, double *recvbuf,
+                             const int *counts, const int *displs, int root, int tag) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    exchange_alloc(x, world_size);
+#ifdef COLL_INIT
+    (void)tag;
+    COLL_INIT(Gatherv)(sendbuf, counts[world_rank], MPI_DOUBLE, recvbuf, counts, displs,
+                       MPI_DOUBLE, root, MPI_COMM_WORLD, MPI_INFO_NULL,
+                       &x->requests[x->count++]);
+#else
+    if (world_rank != root) {
+        MPI_Send_init(sendbuf, counts[world_rank], MPI_DOUBLE, root, tag, MPI_COMM_WORLD,
+                      &x->requests[x->count++]);
+        return;
+    }
+    for (int r = 0; r < world_size; r++) {
+        if (r != root) {
+            MPI_Recv_init(recvbuf + displs[r], counts[r], MPI_DOUBLE, r, tag,
+                          MPI_COMM_WORLD, &x->requests[x->count++]);
+        }
+    }
+    exchange_copy(x, recvbuf + displs[root], sendbuf, counts[root]);
+#endif
+}
+
+static void exchange_run(exchange_t *x) {
+    if (x->copy_bytes) {
+        memcpy(x->copy_dst, x->copy_src, x->copy_bytes);
+    }
+    MPI_Startall(x->count, x->requests);
+    MPI_Waitall(x->count, x->requests, MPI_STATUSES_IGNORE);
+}
+
+static void exchange_free(exchange_t *x) {
+    for (int i = 0; i < x->count; i++) {
+        MPI_Request_free(&x->requests[i]);
+    }
+    free(x->requests);
+    x->requests = NULL;
+    x->count = 0;
+}
+
+// Median of count values (sorts them)
+static double median(double *values, int count) {
+    return bench_percentiles(values, count).p50;
+}
+
+void iterate_multiply(int n, gemm_kernel_t kernel, const row_partition_t *part,
+                      matrix_init_t init, uint64_t seed, int gather, int verify,
+                      int iterations, int warmup,
+                      const double *A, const double *B, double *C,
+                      bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                      matrix_times_t *times) {
+    int world_size, world_rank;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    int local_rows = part->rows[world_rank];
+    int row0 = part->offsets[world_rank];
+    int *counts = malloc((size_t)world_size * sizeof(int));
+    int *displs = malloc((size_t)world_size * sizeof(int));
+    double *A_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    double *B_local = bench_alloc((size_t)n * n * sizeof(double));
+    double *C_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    // Per timed iteration: distribute, compute, gather, whole iteration
+    double *samples = malloc(4 * (size_t)iterations * sizeof(double));
+
+    if (!A_local || !B_local || !C_local || !counts || !displs || !samples) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    double *distribute = samples;
+    double *compute = distribute + iterations;
+    double *collect = compute + iterations;
+    double *iteration = collect + iterations;
+
+    bench_numa_touch_rows(A_local, local_rows, n);
+    bench_numa_touch_rows(B_local, n, n);
+    bench_numa_touch_rows(C_local, local_rows, n);
+    for (int r = 0; r < world_size; r++) {
+        counts[r] = part->rows[r] * n;
+        displs[r] = part->offsets[r] * n;
+    }
+
+    // Inputs once: own rows of A and B, or (--init=root) B copied into
+    // rank 0's broadcast buffer; every iteration moves them again
+    double s0 = MPI_Wtime();
+    if (init == MATRIX_INIT_DISTRIBUTED) {
+        matrix_init_block(MATRIX_A, seed, n, row0, local_rows, 0, n, A_local, n);
+        matrix_init_block(MATRIX_B, seed, n, row0, local_rows, 0, n,
+                          B_local + (size_t)row0 * n, n);
+    } else if (world_rank == 0) {
+        bench_numa_copy_rows(B_local, B, n, n);
+    }
+    times->setup += MPI_Wtime() - s0;
+
+    exchange_t a_exchange = {0}, b_exchange, c_exchange = {0};
+    double p0 = MPI_Wtime();
+    if (init == MATRIX_INIT_DISTRIBUTED) {
+        exchange_allgatherv(&b_exchange, B_local, counts, displs, TAG_B);
+    } else {
+        exchange_scatterv(&a_exchange, A, counts, displs, A_local, 0, TAG_A);
+        exchange_bcast(&b_exchange, B_local, n * n, 0, TAG_B);
+    }
+    if (gather) {
+        exchange_gatherv(&c_exchange, C_local, C, counts, displs, 0, TAG_C);
+    }
+    times->persist_setup = MPI_Wtime() - p0;
+
+    if (world_rank == 0) {
+        printf("Running %d warm-up and %d timed iterations (persistent %s)...\n",
+               warmup, iterations, EXCHANGE_NAME);
+    }
+    double first = 0.0;
+    for (int it = -warmup; it < iterations; it++) {
+        if (it == 0) {
+            bench_perf_start(tlb);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+        if (a_exchange.requests) {
+            exchange_run(&a_exchange);
+        }
+        exchange_run(&b_exchange);
+        double t1 = MPI_Wtime();
+
+        if (it == iterations - 1) {
+            bench_perf_profile_reset(profile);
+            bench_perf_profile_resume(profile);
+        }
+        bench_numa_touch_rows(C_local, local_rows, n);
+        gemm_multiply(kernel, local_rows, n, n, A_local, n, B_local, n, C_local, n);
+        if (it == iterations - 1) {
+            bench_perf_profile_pause(profile);
+        }
+        double t2 = MPI_Wtime();
+
+        if (gather) {
+            exchange_run(&c_exchange);
+        }
+        double t3 = MPI_Wtime();
+        if (it == -warmup) {
+            first = t3 - t0;
+        }
+        if (it >= 0) {
+            distribute[it] = t1 - t0;
+            compute[it] = t2 - t1;
+            collect[it] = t3 - t2;
+            iteration[it] = t3 - t0;
+        }
+    }
+    long long misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // Iterations bounded by the slowest rank; phases as per-rank medians
+    MPI_Allreduce(MPI_IN_PLACE, iteration, iterations, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&first, &times->cold, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    times->iteration = bench_percentiles(iteration, iterations);
+    times->distribute = median(distribute, iterations);
+    times->compute = median(compute, iterations);
+    times->gather = median(collect, iterations);
+    times->total = times->iteration.p50;
+    times->local_flops = 2.0 * local_rows * n * (double)n;
+    times->dtlb_misses = misses < 0 ? misses : misses / iterations;
+
+    if (verify) {
+        if (world_rank == 0) {
+            printf("Verifying result (Freivalds, %d probes)...\n", MATRIX_VERIFY_PROBES);
+        }
+        double v0 = MPI_Wtime();
+        matrix_block_t a_block = {A_local, row0, local_rows, 0, n, n};
+        matrix_block_t b_block = {B_local + (size_t)row0 * n, row0, local_rows, 0, n, n};
+        matrix_block_t c_block = {C_local, row0, local_rows, 0, n, n};
+        times->check = matrix_verify(n, seed, &a_block, 1, &b_block, 1, &c_block, 1);
+        times->verify = MPI_Wtime() - v0;
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_local", A_local, (size_t)local_rows * n * sizeof(double)},
+        {"B_local", B_local, (size_t)n * n * sizeof(double)},
+        {"C_local", C_local, (size_t)local_rows * n * sizeof(double)},
+    };
+    times->numa_local = bench_numa_report(buffers, 3);
+    times->huge_share = bench_alloc_report(buffers, 3, times->dtlb_misses);
+
+    exchange_free(&a_exchange);
+    exchange_free(&b_exchange);
+    exchange_free(&c_exchange);
+    bench_free(A_local);
+    bench_free(B_local);
+    bench_free(C_local);
+    free(samples);
+    free(counts);
+    free(displs);
+}
@@ -0,0 +1,48 @@
+/*
+ * Steady-state 1D matrix multiplication (--iterations=N, --warmup=W)
+ *
+ * The --algo=1d multiply repeated W untimed and then N timed times on the
+ * same buffers, so page faults, cold caches and MPI connection setup stay in
+ * the first iterations instead of in the result. The exchanges of B (and of
+ * A and C) are persistent requests created once and restarted with
+ * MPI_Startall every iteration:
+ *
+ *   MPI 4:      MPI_Bcast_init, MPI_Scatterv_init, MPI_Allgatherv_init,
+ *               MPI_Gatherv_init
+ *   Open MPI 4: the same calls as MPIX_*_init (pcollreq extension)
+ *   otherwise:  MPI_Send_init/MPI_Recv_init of the blocks each collective
+ *               would move (linear from or to the root)
+ *
+ * Every iteration starts after a barrier. Its time on the slowest rank is
+ * reported as percentiles; the phase times are each rank's medians, so the
+ * usual results show the median iteration.
+ */
+
+#ifndef ITERATE_H
+#define ITERATE_H
+
+#include "bench-perf.h"
+#include "gemm-kernels.h"
+#include "matrix-init.h"
+#include "matrix-mult.h"
+#include "partition.h"
+
+// Persistent requests of this build: "mpi-4 collectives", "mpix collectives"
+// or "point-to-point"
+const char *iterate_exchange_name(void);
+
+// C = A × B on MPI_COMM_WORLD, rows of A/C split as in part, warmup + iterations
+// times. A, B and C are significant on rank 0 only, as for run_1d(): with
+// MATRIX_INIT_DISTRIBUTED each rank generates its rows instead (A and B are
+// unused), without `gather` C is unused. Fills the fields of times that
+// run_1d() fills on the CPU with per-iteration medians (dtlb_misses per
+// iteration), plus iteration, cold and persist_setup; profile counts the
+// last timed iteration.
+void iterate_multiply(int n, gemm_kernel_t kernel, const row_partition_t *part,
+                      matrix_init_t init, uint64_t seed, int gather, int verify,
+                      int iterations, int warmup,
+                      const double *A, const double *B, double *C,
+                      bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                      matrix_times_t *times);
+
+#endif /* ITERATE_H */
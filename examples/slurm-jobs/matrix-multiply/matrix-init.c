@@ -0,0 +1,72 @@
+/*
+ * Deterministic matrix contents for the matrix-multiply example
+ */
+
+#include "matrix-init.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "bench-philox.h"
+
+int matrix_init_from_name(const char *name, matrix_init_t *init) {
+    if (strcmp(name, "distributed") == 0) {
+        *init = MATRIX_INIT_DISTRIBUTED;
+    } else if (strcmp(name, "root") == 0) {
+        *init = MATRIX_INIT_ROOT;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *matrix_init_name(matrix_init_t init) {
+    return init == MATRIX_INIT_ROOT ? "root" : "distributed";
+}
+
+// Philox4x32-10 of counter (block, which) under key (k0, k1)
+static void philox_block(uint64_t block, uint32_t which, uint32_t k0, uint32_t k1,
+                         uint32_t out[4]) {
+    out[0] = (uint32_t)block;
+    out[1] = (uint32_t)(block >> 32);
+    out[2] = which;
+    out[3] = 0;
+    bench_philox4x32(out, k0, k1);
+}
+
+void matrix_init_signs(uint32_t stream, uint64_t seed, int count, double *out) {
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+
+    for (int i = 0; i < count; i += 4) {
+        uint32_t words[4];
+        philox_block((uint64_t)i / 4, stream, k0, k1, words);
+        for (int l = 0; l < 4 && i + l < count; l++) {
+            out[i + l] = (words[l] & 1u) ? 1.0 : -1.0;
+        }
+    }
+}
+
+void matrix_init_block(matrix_id_t which, uint64_t seed, int n, int row0, int rows,
+                       int col0, int cols, double *buf, int ld) {
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < rows; r++) {
+        uint64_t first = (uint64_t)(row0 + r) * (uint64_t)n + (uint64_t)col0;
+        uint64_t end = first + (uint64_t)cols;
+        double *row = buf + (size_t)r * ld;
+
+        for (uint64_t block = first / 4; 4 * block < end; block++) {
+            uint32_t words[4];
+            philox_block(block, (uint32_t)which, k0, k1, words);
+            for (int l = 0; l < 4; l++) {
+                uint64_t g = 4 * block + (uint64_t)l;
+                if (g >= first && g < end) {
+                    row[g - first] = (double)(words[l] % 100u) / 10.0;
+                }
+            }
+        }
+    }
+}
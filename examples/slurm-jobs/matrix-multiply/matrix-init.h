@@ -0,0 +1,53 @@
+/*
+ * Deterministic matrix contents for the matrix-multiply example
+ *
+ * Element (i, j) of A or B is a pure function of the seed, the matrix and
+ * its global index i·n + j: Philox4x32-10 (common/bench-philox.h, shared
+ * with pi-calculation) maps the counter (index / 4, matrix) under the seed
+ * key to four 32-bit words, one per element. Any rank can therefore generate exactly the rows or
+ * tile it owns, in place and in parallel, and the matrices (and so C) are
+ * bit-identical for every number of ranks and threads, algorithm and
+ * initialization mode.
+ *
+ * Values are k / 10 for k in 0..99 (0.0 to 9.9), like the original
+ * rand()-based initialization.
+ */
+
+#ifndef MATRIX_INIT_H
+#define MATRIX_INIT_H
+
+#include <stdint.h>
+
+#define MATRIX_DEFAULT_SEED 42
+
+// Which input matrix to generate
+typedef enum {
+    MATRIX_A = 0,
+    MATRIX_B = 1
+} matrix_id_t;
+
+// Where the inputs are created
+typedef enum {
+    MATRIX_INIT_DISTRIBUTED = 0,    // Every rank generates its own rows/tiles
+    MATRIX_INIT_ROOT                // Rank 0 generates full A and B, then distributes
+} matrix_init_t;
+
+// Parse "distributed" / "root"; returns 0 on success, -1 if unknown
+int matrix_init_from_name(const char *name, matrix_init_t *init);
+const char *matrix_init_name(matrix_init_t init);
+
+// First matrix_init_signs() stream; lower ids are A and B
+#define MATRIX_SIGN_STREAM_BASE 2
+
+// Fill out[count] with ±1 entries of vector `stream` (>= MATRIX_SIGN_STREAM_BASE);
+// like the matrices, every rank gets the same vector for the same seed
+void matrix_init_signs(uint32_t stream, uint64_t seed, int count, double *out);
+
+// Fill buf (leading dimension ld) with the rows×cols block at global
+// (row0, col0) of the n×n matrix `which`. Rows are split across OpenMP
+// threads with schedule(static), so on fresh memory this is also the first
+// touch that places the pages (see bench-numa.h).
+void matrix_init_block(matrix_id_t which, uint64_t seed, int n, int row0, int rows,
+                       int col0, int cols, double *buf, int ld);
+
+#endif /* MATRIX_INIT_H */
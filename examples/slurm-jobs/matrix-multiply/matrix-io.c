@@ -0,0 +1,114 @@
+/*
+ * Matrix files on shared storage for the matrix-multiply example
+ */
+
+#include "matrix-io.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+
+void matrix_io_path(const char *dir, const char *name, char *out, size_t len) {
+    snprintf(out, len, "%s/%s.bin", dir, name);
+}
+
+// Print an MPI-IO error for path; returns -1
+static int io_error(const char *what, const char *path, int err) {
+    char message[MPI_MAX_ERROR_STRING];
+    int length, rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Error_string(err, message, &length);
+    printf("Rank %d: %s %s failed: %s\n", rank, what, path, message);
+    return -1;
+}
+
+int matrix_io_dimension(const char *path) {
+    MPI_File fh;
+    MPI_Offset size;
+
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh)
+        != MPI_SUCCESS) {
+        return 0;
+    }
+    int err = MPI_File_get_size(fh, &size);
+    MPI_File_close(&fh);
+    if (err != MPI_SUCCESS || size <= 0) {
+        return 0;
+    }
+    long long elements = (long long)(size / (MPI_Offset)sizeof(double));
+    long long n = llround(sqrt((double)elements));
+    return (n * n * (long long)sizeof(double) == (long long)size && n <= 0x7fffffff) ? (int)n : 0;
+}
+
+// Open path and set a view selecting the block, in units of whole block rows
+static int open_block(const char *path, int amode, int n, int row0, int rows, int col0,
+                      int cols, MPI_File *fh, MPI_Datatype *row_type) {
+    int sizes[2] = {n, n};
+    int subsizes[2] = {rows, cols};
+    int starts[2] = {row0, col0};
+    MPI_Datatype block;
+    MPI_Info info;
+    int err;
+
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "romio_cb_read", "enable");
+    MPI_Info_set(info, "romio_cb_write", "enable");
+    err = MPI_File_open(MPI_COMM_WORLD, path, amode, info, fh);
+    if (err != MPI_SUCCESS) {
+        MPI_Info_free(&info);
+        return io_error("Opening", path, err);
+    }
+    if (amode & MPI_MODE_CREATE) {
+        err = MPI_File_set_size(*fh, (MPI_Offset)n * n * sizeof(double));
+        if (err != MPI_SUCCESS) {
+            MPI_Info_free(&info);
+            MPI_File_close(fh);
+            return io_error("Sizing", path, err);
+        }
+    }
+
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &block);
+    MPI_Type_commit(&block);
+    err = MPI_File_set_view(*fh, 0, MPI_DOUBLE, block, "native", info);
+    MPI_Type_free(&block);
+    MPI_Info_free(&info);
+    if (err != MPI_SUCCESS) {
+        MPI_File_close(fh);
+        return io_error("Setting view on", path, err);
+    }
+
+    // Transfer counts are block rows, so int counts cover any block size
+    MPI_Type_contiguous(cols, MPI_DOUBLE, row_type);
+    MPI_Type_commit(row_type);
+    return 0;
+}
+
+int matrix_io_read_block(const char *path, int n, int row0, int rows, int col0, int cols,
+                         double *buf) {
+    MPI_File fh;
+    MPI_Datatype row_type;
+
+    if (open_block(path, MPI_MODE_RDONLY, n, row0, rows, col0, cols, &fh, &row_type) != 0) {
+        return -1;
+    }
+    int err = MPI_File_read_all(fh, buf, rows, row_type, MPI_STATUS_IGNORE);
+    MPI_Type_free(&row_type);
+    MPI_File_close(&fh);
+    return err == MPI_SUCCESS ? 0 : io_error("Reading", path, err);
+}
+
+int matrix_io_write_block(const char *path, int n, int row0, int rows, int col0, int cols,
+                          const double *buf) {
+    MPI_File fh;
+    MPI_Datatype row_type;
+
+    if (open_block(path, MPI_MODE_CREATE | MPI_MODE_WRONLY, n, row0, rows, col0, cols, &fh,
+                   &row_type) != 0) {
+        return -1;
+    }
+    int err = MPI_File_write_all(fh, buf, rows, row_type, MPI_STATUS_IGNORE);
+    MPI_Type_free(&row_type);
+    MPI_File_close(&fh);
+    return err == MPI_SUCCESS ? 0 : io_error("Writing", path, err);
+}
@@ -0,0 +1,37 @@
+/*
+ * Matrix files on shared storage for the matrix-multiply example
+ *
+ * With --data-dir=DIR the matrices live in DIR/A.bin, DIR/B.bin and
+ * DIR/C.bin instead of rank 0's memory. Each file holds one n×n matrix as
+ * raw row-major doubles in native byte order, with no header (numpy:
+ * np.fromfile(path).reshape(n, n)). Every rank reads and writes only its own
+ * row block or tile with collective MPI-IO, so nothing passes through rank 0
+ * and a run measures parallel file system (BeeGFS) bandwidth together with
+ * GEMM throughput, on the same shared-storage path the training jobs use.
+ *
+ * Collective buffering is requested through ROMIO hints; MPI-IO
+ * implementations that do not know them ignore them.
+ */
+
+#ifndef MATRIX_IO_H
+#define MATRIX_IO_H
+
+#include <stddef.h>
+
+// Path of matrix `name` ("A", "B" or "C") under dir
+void matrix_io_path(const char *dir, const char *name, char *out, size_t len);
+
+// Dimension of the square matrix stored in path, or 0 if the file is
+// missing or does not hold n×n doubles. Collective over MPI_COMM_WORLD.
+int matrix_io_dimension(const char *path);
+
+// Read / write the rows×cols block at (row0, col0) of the n×n matrix in path
+// from / to a contiguous rows×cols buffer. Writing creates the file and
+// sizes it to n×n. Returns 0 on success, -1 after printing the MPI-IO error.
+// Collective over MPI_COMM_WORLD.
+int matrix_io_read_block(const char *path, int n, int row0, int rows, int col0, int cols,
+                         double *buf);
+int matrix_io_write_block(const char *path, int n, int row0, int rows, int col0, int cols,
+                          const double *buf);
+
+#endif /* MATRIX_IO_H */
@@ -1,34 +1,262 @@
 /*
  * Parallel Matrix Multiplication using MPI
  *
- * Multiplies two square matrices using row-wise decomposition.
+ * Multiplies two square matrices using row-wise or 2D decomposition.
  * Demonstrates:
- * - Data distribution with MPI_Scatter
+ * - Data distribution with MPI_Scatterv
  * - Matrix operations
- * - Result gathering with MPI_Gather
+ * - Result gathering with MPI_Gatherv
+ * - 2D process grids with MPI_Cart_create (SUMMA)
  * - Memory-intensive parallel workload
  *
  * Algorithm: C = A × B
+ * --algo=1d (default):
  * - Matrix A is distributed row-wise across processes
  * - Matrix B is broadcast to all processes
  * - Each process computes its assigned rows of C
+ * - Row blocks may differ in size, so n only needs to be >= P; with
+ *   --balance=throughput they follow each rank's measured GEMM speed
+ *   (see partition.c)
+ * --algo=summa:
+ * - Processes form a 2D grid; A, B and C are split into 2D tiles
+ * - k-panels of A travel along grid rows, k-panels of B along grid columns
+ * - Memory per process is O(n²/P) instead of O(n²) (see summa.c)
+ * --algo=pipeline:
+ * - Same decomposition as 1d, but B moves as column panels (MPI_Ibcast)
+ *   and C slices stream back (MPI_Igather) while other panels compute
+ *   (see pipeline.c); reports how much communication was hidden
  *
- * Compile: mpicc -o matrix-mult matrix-mult.c -lm
- * Run: mpirun -np 4 ./matrix-mult 1000
+ * Hybrid MPI+OpenMP: when built with OpenMP, each rank runs the local
+ * multiply on SLURM_CPUS_PER_TASK threads (or OMP_NUM_THREADS). Running one
+ * rank per node or per socket (matrix-hybrid.sbatch) keeps a single copy of
+ * B per rank instead of one per core.
+ *
+ * NUMA placement: local buffers are page-aligned and first touched by the
+ * threads that compute on them, before MPI writes any data into them (see
+ * bench-numa.h); after the run a table shows the NUMA node of every rank's
+ * threads and buffer pages.
+ *
+ * Initialization: by default every rank generates its own rows or tiles of
+ * A and B in place from a counter-based generator keyed on global indices
+ * (see matrix-init.h), so A is never scattered and rank 0 needs no full
+ * copy of A; --init=root keeps the old path (rank 0 generates A and B, then
+ * scatters them). The inputs are the same for any rank count, and setup
+ * time is reported separately from the timed multiply.
+ *
+ * Out-of-core data (--data-dir=DIR): A and B are read from DIR/A.bin and
+ * DIR/B.bin with collective MPI-IO, each rank reading only its rows or
+ * tile, and C is written to DIR/C.bin the same way; rank 0 never holds a
+ * full matrix (see matrix-io.h). --generate-input first writes random A/B.
+ *
+ * Verification: after the timed region every rank checks its part of C in
+ * place with a randomized Freivalds test (u^T C r against (u^T A)(B r),
+ * one MPI_Allreduce, O(n²/P) work per rank; see matrix-verify.h), so the
+ * result is trusted without gathering it. --no-gather then skips the final
+ * gather (or the C.bin write) entirely, and rank 0 never allocates C.
+ *
+ * GPU offload (--device=gpu, 1d and pipeline): each rank multiplies on one
+ * GPU of its node with cuBLAS DGEMM (see gemm-gpu.h). Host buffers are
+ * pinned in place; the copies and the DGEMM run asynchronously on the
+ * GPU's stream while the rank keeps MPI moving (1d: A is copied during the
+ * exchange of B; pipeline: B panels and C slices travel during the device
+ * work of the previous panel). The banner shows the pinned host-device
+ * bandwidth of the slowest GPU. The results show the DGEMM device time
+ * next to the compute phase; the difference is the copy overhead. GPU
+ * support is built only when the CUDA toolkit is found; matrix-gpu.sbatch
+ * runs it on the gpu partition.
+ *
+ * Huge pages: all matrices come from bench_alloc() (bench-alloc.h), by
+ * default 2 MB-aligned and advised for transparent huge pages. A second
+ * table shows the page backing each buffer got and the dTLB load misses of
+ * the timed region (n/a where perf counters are unavailable).
+ *
+ * Hardware counters: --counters adds cycles, instructions, LLC misses and
+ * (Intel) counted double-precision FLOPs around the local GEMM calls only,
+ * reported next to the GFLOPS lines as clock, IPC, estimated DRAM traffic
+ * and arithmetic intensity, i.e. where the kernel sits on the node's
+ * roofline (bench-perf.h). Without FP events the FLOPs are the 2·rows·n²
+ * of the rank's multiply.
+ *
+ * Mixed precision (--dtype=f32|bf16, 1d on the CPU): A and B are rounded
+ * to FP32 or BF16, exchanged in that format and multiplied by the blocked
+ * low-precision kernels with FP32 accumulation into an FP32 C (see
+ * mixed.h, gemm-lowp.h); verification allows for FP32 rounding.
+ *
+ * Batched small GEMMs (--batch=COUNT): instead of one distributed n×n
+ * product, every rank multiplies COUNT independent n×n pairs in the
+ * selected dtype, with no communication. Tiny matrices are stored
+ * interleaved across SIMD lanes, larger ones one after another with a
+ * blocked multiply per thread (--batch-layout, see batch.h).
+ *
+ * Node-aware B (--node-aware, 1d f64 on the CPU): the ranks of each node
+ * (MPI_Comm_split_type) share one copy of B in an MPI_Win_allocate_shared
+ * window, and B crosses the network between node leaders only, so its
+ * memory and inter-node traffic grow with the nodes instead of the ranks
+ * (see bench-node.h).
+ *
+ * Steady state (--iterations=N --warmup=W, 1d f64 on the CPU): the multiply
+ * runs W + N times on the same buffers, with the exchanges as persistent
+ * requests created once (see iterate.h). The results describe the median
+ * iteration of the slowest rank; min/p50/p90/p99/max follow, next to the
+ * first (cold) iteration, which carries page faults and connection setup.
+ *
+ * Checkpoint/restart (--checkpoint=DIR, 1d f64 on the CPU): rows of C are
+ * computed in panels and, every --checkpoint-interval seconds, the finished
+ * ones are written to DIR with non-blocking MPI-IO while the next panels
+ * compute. A job restarted after its time limit or preemption resumes from
+ * the saved rows (see checkpoint.h); the results show the checkpoint
+ * overhead and write bandwidth for tuning the interval.
+ *
+ * Startup: the results start with the MPI_Init time and, when the launcher
+ * sets BENCH_LAUNCH_TIME, the time from launch to all ranks initialized
+ * (see bench-startup.h), so container and bare-metal launches compare.
+ *
+ * Options:
+ *   --algo=1d|summa|pipeline Distributed algorithm (default: 1d)
+ *   --panel=N                SUMMA k-panel / pipeline B column panel width
+ *                            (default: 256)
+ *   --balance=even|throughput
+ *                            Row split for 1d/pipeline (default: even)
+ *   --device=cpu|gpu         Where the local multiply runs (default: cpu;
+ *                            gpu: 1d and pipeline, one GPU per rank)
+ *   --kernel=naive|blocked   Local GEMM kernel (default: blocked)
+ *   --isa=auto|generic|avx2|avx512|neon
+ *                            Micro-kernel ISA for the blocked kernel
+ *                            (default: auto, chosen per node via CPUID)
+ *   --hugepages=none|thp|2m|1g
+ *                            Page size for the matrices (default: thp, or
+ *                            BENCH_HUGEPAGES); 2m/1g need reserved
+ *                            hugetlbfs pages and fall back to thp
+ *   --init=distributed|root  Where A and B are generated (default: distributed)
+ *   --seed=N                 Generator seed (default: 42)
+ *   --data-dir=DIR           Read A/B from and write C to DIR (1d and summa;
+ *                            n defaults to the size of DIR/A.bin)
+ *   --generate-input         Write random DIR/A.bin and DIR/B.bin first
+ *   --no-gather              Leave C distributed (no gather, no C.bin)
+ *   --no-verify              Skip the Freivalds check of C
+ *   --inject-error           Negate one element of C before the check, which
+ *                            must then fail (1d, summa, --dtype; tests the
+ *                            check itself)
+ *   --dtype=f64|f32|bf16     Element type of A and B (default: f64; f32 and
+ *                            bf16 accumulate in FP32; 1d on the CPU or --batch)
+ *   --batch=COUNT            Multiply COUNT independent n×n pairs per rank
+ *   --batch-layout=auto|compact|strided
+ *                            Storage of the batch (default: auto, compact up
+ *                            to n = 16)
+ *   --iterations=N           Repeat the multiply N times (default: 1) and
+ *                            report per-iteration percentiles (f64 1d, CPU)
+ *   --warmup=N               Untimed repetitions first (default: 0)
+ *   --node-aware             One shared copy of B per node, broadcast
+ *                            between node leaders (f64 1d on the CPU)
+ *   --checkpoint=DIR         Checkpoint rows of C to DIR and resume from an
+ *                            earlier checkpoint there (f64 1d on the CPU)
+ *   --checkpoint-interval=S  Seconds between checkpoints (default: 60;
+ *                            0 = after every panel of --panel rows)
+ *   --counters               Hardware counter profile of the local GEMM
+ *                            (CPU kernels)
+ *   --json[=PATH]            Also write a JSON record of the run to stdout
+ *                            or PATH (see bench-report.h)
+ *
+ * Compile: mpicc -O3 -fopenmp -I../common -o matrix-mult matrix-mult.c \
+ *          summa.c pipeline.c mixed.c batch.c iterate.c checkpoint.c partition.c \
+ *          matrix-io.c matrix-init.c matrix-verify.c gemm-kernels.c gemm-simd.c \
+ *          gemm-lowp.c gemm-gpu.c ../common/bench-threads.c ../common/bench-report.c \
+ *          ../common/bench-numa.c ../common/bench-alloc.c ../common/bench-perf.c \
+ *          ../common/bench-node.c ../common/bench-checkpoint.c \
+ *          ../common/bench-startup.c -lm
+ *          (GPU support: add -DMATRIX_HAVE_CUDA -I$CUDA/include
+ *           -L$CUDA/lib64 -lcublas -lcudart)
+ * Run: mpirun -np 4 ./matrix-mult 1000 --algo=summa
+ *      mpirun -np 4 ./matrix-mult 8 --batch=100000 --dtype=f32
  */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
-// Initialize matrix with random values
-void initialize_matrix(double *matrix, int rows, int cols, int rank) {
-    srand(time(NULL) + rank);
-    for (int i = 0; i < rows * cols; i++) {
-        matrix[i] = (double)(rand() % 100) / 10.0;  // Values 0.0 to 9.9
-    }
-}
+#include "bench-alloc.h"
+#include "bench-node.h"
+#include "bench-numa.h"
+#include "bench-perf.h"
+#include "bench-report.h"
+#include "bench-startup.h"
+#include "bench-threads.h"
+#include "batch.h"
+#include "checkpoint.h"
+#include "gemm-gpu.h"
+#include "gemm-kernels.h"
+#include "gemm-lowp.h"
+#include "iterate.h"
+#include "matrix-init.h"
+#include "matrix-io.h"
+#include "matrix-mult.h"
+#include "matrix-verify.h"
+#include "mixed.h"
+#include "partition.h"
+#include "pipeline.h"
+#include "summa.h"
+
+#define DEFAULT_PANEL_WIDTH 256
+
+// Copy size of the host-device bandwidth probe (--device=gpu)
+#define GPU_PROBE_BYTES (64u << 20)
+
+// Command-line configuration
+typedef struct {
+    int n;                  // Matrix dimension (n×n matrices)
+    int n_set;              // n given on the command line
+    matrix_algo_t algo;     // Distributed algorithm
+    int panel_width;        // SUMMA k-panel width
+    partition_mode_t balance;   // Row split for the 1D algorithms
+    matrix_device_t device; // CPU kernels or cuBLAS on a GPU
+    gemm_kernel_t kernel;   // Local multiply kernel
+    gemm_isa_t isa;         // Micro-kernel ISA (auto = detect per rank)
+    gemm_dtype_t dtype;     // Element type of A and B
+    int batch;              // Independent n×n products per rank (0 = one
+                            // distributed product)
+    batch_layout_t batch_layout;    // Storage of the batch
+    int iterations;         // Timed repetitions of the multiply
+    int node_aware;         // One shared B per node (1d)
+    int warmup;             // Untimed repetitions before them
+    const char *checkpoint_dir; // Checkpoint directory (NULL = none)
+    double checkpoint_interval; // Seconds between checkpoints
+    matrix_init_t init;     // Where A and B are generated
+    uint64_t seed;          // Generator seed for A and B
+    const char *data_dir;   // Matrix files on shared storage (NULL = in memory)
+    int generate_input;     // Write random A/B files before the run
+    int gather;             // Collect C on rank 0 (or write C.bin)
+    int verify;             // Freivalds check of C after the run
+    int inject_error;       // Corrupt one element of C before the check
+    int counters;           // Hardware counter profile of the local GEMM
+    int json;               // Write a JSON record
+    const char *json_path;  // JSON destination (NULL = stdout)
+} matrix_config_t;
+
+// Phase and throughput statistics across ranks (valid on rank 0)
+typedef struct {
+    bench_stats_t setup;
+    bench_stats_t distribute;
+    bench_stats_t comm;
+    bench_stats_t compute;
+    bench_stats_t gather;
+    bench_stats_t hidden;
+    bench_stats_t io_read;
+    bench_stats_t io_write;
+    bench_stats_t verify;
+    bench_stats_t total;
+    bench_stats_t persist_setup;    // --iterations/--warmup only
+    bench_stats_t rank_gflops;
+    bench_stats_t dtlb_misses;  // Valid only if every rank could count
+    bench_stats_t device_gemm;      // --device=gpu only
+    bench_stats_t device_gflops;
+    bench_stats_t device_bytes;
+    bench_stats_t h2d_gbps;
+    bench_stats_t d2h_gbps;
+    bench_perf_summary_t counters;  // --counters
+    bench_ckpt_summary_t checkpoint;    // --checkpoint
+    bench_startup_summary_t startup;    // MPI_Init and launch (bench-startup.h)
+} matrix_stats_t;
 
 // Print matrix (for small matrices only)
 void print_matrix(double *matrix, int rows, int cols, const char *name) {
@@ -48,151 +276,1418 @@ void print_matrix(double *matrix, int rows, int cols, const char *name) {
 
 // Multiply matrices: C_local = A_local × B
 void multiply_matrices(double *A_local, double *B, double *C_local,
-                      int local_rows, int n) {
-    for (int i = 0; i < local_rows; i++) {
-        for (int j = 0; j < n; j++) {
-            C_local[i * n + j] = 0.0;
-            for (int k = 0; k < n; k++) {
-                C_local[i * n + j] += A_local[i * n + k] * B[k * n + j];
+                      int local_rows, int n, gemm_kernel_t kernel) {
+    bench_numa_touch_rows(C_local, local_rows, n);
+    gemm_multiply(kernel, local_rows, n, n, A_local, n, B, n, C_local, n);
+}
+
+const char *algo_name(matrix_algo_t algo) {
+    switch (algo) {
+    case MATRIX_ALGO_SUMMA:
+        return "summa";
+    case MATRIX_ALGO_PIPELINE:
+        return "pipeline";
+    default:
+        return "1d";
+    }
+}
+
+// Print the micro-kernel ISA path(s) selected across ranks
+void print_isa_summary(const matrix_config_t *config, const int *isa_counts) {
+    int compact = config->batch
+                  && batch_resolve_layout(config->batch_layout, config->n) == BATCH_LAYOUT_COMPACT;
+    if (config->kernel != GEMM_KERNEL_BLOCKED && !compact) {
+        printf("ISA path: n/a (%s kernel)\n", gemm_kernel_name(config->kernel));
+        return;
+    }
+    int mr, nr;
+    const char *path = gemm_lowp_path(config->dtype, &mr, &nr);
+    if (compact) {
+        printf("ISA path: %s (compact kernel, %d matrices per vector on rank 0)",
+               gemm_isa_name(gemm_get_isa()), batch_group_width(config->dtype));
+    } else if (config->dtype != GEMM_DTYPE_F64) {
+        printf("ISA path: %s (%dx%d %s micro-kernel on rank 0)", path, mr, nr,
+               gemm_dtype_name(config->dtype));
+    } else {
+        printf("ISA path: %s (%dx%d micro-kernel on rank 0)", path, mr, nr);
+    }
+    for (int i = 0; i < GEMM_ISA_COUNT; i++) {
+        if (isa_counts[i] > 0) {
+            printf(" [%s: %d rank%s]", gemm_isa_name((gemm_isa_t)i),
+                   isa_counts[i], isa_counts[i] == 1 ? "" : "s");
+        }
+    }
+    printf("\n");
+}
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [matrix_size] [--algo=1d|summa|pipeline] [--panel=N]\n"
+           "       [--balance=even|throughput] [--device=cpu|gpu]\n"
+           "       [--kernel=naive|blocked] [--isa=auto|generic|avx2|avx512|neon]\n"
+           "       [--hugepages=none|thp|2m|1g] [--data-dir=DIR [--generate-input]]\n"
+           "       [--init=distributed|root] [--seed=N] [--no-gather] [--no-verify] [--inject-error]\n"
+           "       [--dtype=f64|f32|bf16] [--batch=COUNT [--batch-layout=auto|compact|strided]]\n"
+           "       [--iterations=N] [--warmup=N] [--node-aware]\n"
+           "       [--checkpoint=DIR [--checkpoint-interval=SECONDS]]\n"
+           "       [--counters] [--json[=PATH]]\n", prog);
+}
+
+// Nonzero if the multiply is repeated (--iterations > 1 or --warmup)
+int iterative(const matrix_config_t *config) {
+    return config->iterations > 1 || config->warmup > 0;
+}
+
+// Parse command line; returns 0 on success, -1 on invalid arguments.
+// Every rank parses the arguments; only rank 0 reports errors.
+int parse_args(int argc, char **argv, matrix_config_t *config, int rank) {
+    const char *value;
+
+    config->n = 100;  // Default size
+    config->n_set = 0;
+    config->init = MATRIX_INIT_DISTRIBUTED;
+    config->seed = MATRIX_DEFAULT_SEED;
+    config->data_dir = NULL;
+    config->generate_input = 0;
+    config->gather = 1;
+    config->verify = 1;
+    config->inject_error = 0;
+    config->counters = 0;
+    config->algo = MATRIX_ALGO_1D;
+    config->panel_width = DEFAULT_PANEL_WIDTH;
+    config->balance = PARTITION_EVEN;
+    config->json = 0;
+    config->json_path = NULL;
+    config->device = MATRIX_DEVICE_CPU;
+    config->kernel = GEMM_KERNEL_BLOCKED;
+    config->isa = GEMM_ISA_AUTO;
+    config->dtype = GEMM_DTYPE_F64;
+    config->batch = 0;
+    config->batch_layout = BATCH_LAYOUT_AUTO;
+    config->iterations = 1;
+    config->warmup = 0;
+    config->node_aware = 0;
+    config->checkpoint_dir = NULL;
+    config->checkpoint_interval = -1.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        int pages_option = bench_alloc_option(arg);
+        if (pages_option < 0) {
+            if (rank == 0) {
+                printf("Error: Unknown huge page mode '%s'\n", arg + strlen("--hugepages="));
             }
+            return -1;
+        } else if (pages_option > 0) {
+            continue;
         }
+        if ((value = bench_option_value(arg, "--device="))) {
+            if (matrix_device_from_name(value, &config->device) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown device '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--kernel="))) {
+            if (gemm_kernel_from_name(value, &config->kernel) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown kernel '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--isa="))) {
+            if (gemm_isa_from_name(value, &config->isa) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown ISA '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--dtype="))) {
+            if (gemm_dtype_from_name(value, &config->dtype) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown data type '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--batch="))) {
+            config->batch = atoi(value);
+            if (config->batch <= 0) {
+                if (rank == 0) {
+                    printf("Error: Batch count must be a positive integer\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--batch-layout="))) {
+            if (batch_layout_from_name(value, &config->batch_layout) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown batch layout '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if (strcmp(arg, "--node-aware") == 0) {
+            config->node_aware = 1;
+        } else if ((value = bench_option_value(arg, "--checkpoint="))) {
+            config->checkpoint_dir = value;
+        } else if ((value = bench_option_value(arg, "--checkpoint-interval="))) {
+            char *end;
+            config->checkpoint_interval = strtod(value, &end);
+            if (*end != '\0' || end == value || config->checkpoint_interval < 0.0) {
+                if (rank == 0) {
+                    printf("Error: Checkpoint interval must be zero or more seconds\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--iterations="))) {
+            config->iterations = atoi(value);
+            if (config->iterations <= 0) {
+                if (rank == 0) {
+                    printf("Error: Iterations must be a positive integer\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--warmup="))) {
+            config->warmup = atoi(value);
+            if (config->warmup < 0) {
+                if (rank == 0) {
+                    printf("Error: Warm-up iterations must be zero or more\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--algo="))) {
+            if (strcmp(value, "1d") == 0) {
+                config->algo = MATRIX_ALGO_1D;
+            } else if (strcmp(value, "summa") == 0) {
+                config->algo = MATRIX_ALGO_SUMMA;
+            } else if (strcmp(value, "pipeline") == 0) {
+                config->algo = MATRIX_ALGO_PIPELINE;
+            } else {
+                if (rank == 0) {
+                    printf("Error: Unknown algorithm '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--panel="))) {
+            config->panel_width = atoi(value);
+            if (config->panel_width <= 0) {
+                if (rank == 0) {
+                    printf("Error: Panel width must be a positive integer\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--balance="))) {
+            if (partition_mode_from_name(value, &config->balance) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown balance mode '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--init="))) {
+            if (matrix_init_from_name(value, &config->init) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown initialization '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--seed="))) {
+            config->seed = strtoull(value, NULL, 10);
+        } else if ((value = bench_option_value(arg, "--data-dir="))) {
+            config->data_dir = value;
+        } else if (strcmp(arg, "--generate-input") == 0) {
+            config->generate_input = 1;
+        } else if (strcmp(arg, "--no-gather") == 0) {
+            config->gather = 0;
+        } else if (strcmp(arg, "--no-verify") == 0) {
+            config->verify = 0;
+        } else if (strcmp(arg, "--inject-error") == 0) {
+            config->inject_error = 1;
+        } else if (strcmp(arg, "--counters") == 0) {
+            config->counters = 1;
+        } else if (bench_json_option(arg, &config->json_path)) {
+            config->json = 1;
+        } else if (arg[0] != '-') {
+            config->n = atoi(arg);
+            config->n_set = 1;
+        } else {
+            if (rank == 0) {
+                printf("Error: Unknown option '%s'\n", arg);
+            }
+            return -1;
+        }
+    }
+
+    if (config->n <= 0) {
+        if (rank == 0) {
+            printf("Error: Matrix size must be a positive integer\n");
+        }
+        return -1;
+    }
+    if (config->data_dir && config->algo == MATRIX_ALGO_PIPELINE) {
+        if (rank == 0) {
+            printf("Error: --data-dir applies to the 1d and summa algorithms\n");
+        }
+        return -1;
+    }
+    if (config->generate_input && !config->data_dir) {
+        if (rank == 0) {
+            printf("Error: --generate-input needs --data-dir\n");
+        }
+        return -1;
+    }
+    if (config->device == MATRIX_DEVICE_GPU && config->algo == MATRIX_ALGO_SUMMA) {
+        if (rank == 0) {
+            printf("Error: --device=gpu applies to the 1d and pipeline algorithms\n");
+        }
+        return -1;
+    }
+    if (config->device == MATRIX_DEVICE_GPU && config->counters) {
+        if (rank == 0) {
+            printf("Error: --counters profiles the CPU kernels; not with --device=gpu\n");
+        }
+        return -1;
+    }
+    if (config->device == MATRIX_DEVICE_GPU && config->balance != PARTITION_EVEN) {
+        if (rank == 0) {
+            printf("Error: --balance=%s measures CPU throughput; use --balance=even with --device=gpu\n",
+                   partition_mode_name(config->balance));
+        }
+        return -1;
+    }
+    if (config->algo == MATRIX_ALGO_SUMMA && config->balance != PARTITION_EVEN) {
+        if (rank == 0) {
+            printf("Error: --balance=%s applies to the 1d and pipeline algorithms\n",
+                   partition_mode_name(config->balance));
+        }
+        return -1;
+    }
+    if (config->batch && (config->algo != MATRIX_ALGO_1D || config->device != MATRIX_DEVICE_CPU
+                          || config->data_dir || config->balance != PARTITION_EVEN)) {
+        if (rank == 0) {
+            printf("Error: --batch multiplies rank-local matrices on the CPU; not with\n"
+                   "       --algo=summa|pipeline, --device=gpu, --data-dir or --balance\n");
+        }
+        return -1;
+    }
+    if (config->dtype != GEMM_DTYPE_F64 && !config->batch
+        && (config->algo != MATRIX_ALGO_1D || config->device != MATRIX_DEVICE_CPU
+            || config->data_dir)) {
+        if (rank == 0) {
+            printf("Error: --dtype=%s applies to --algo=1d on the CPU with in-memory data\n",
+                   gemm_dtype_name(config->dtype));
+        }
+        return -1;
     }
+    if (config->dtype != GEMM_DTYPE_F64 && config->kernel != GEMM_KERNEL_BLOCKED) {
+        if (rank == 0) {
+            printf("Error: --dtype=%s needs --kernel=blocked\n", gemm_dtype_name(config->dtype));
+        }
+        return -1;
+    }
+    if (config->node_aware && (config->algo != MATRIX_ALGO_1D || config->device != MATRIX_DEVICE_CPU
+                               || config->dtype != GEMM_DTYPE_F64 || config->batch
+                               || iterative(config))) {
+        if (rank == 0) {
+            printf("Error: --node-aware shares B of the f64 --algo=1d multiply on the CPU;\n"
+                   "       not with --device=gpu, --dtype, --batch or --iterations/--warmup\n");
+        }
+        return -1;
+    }
+    if (config->checkpoint_interval >= 0.0 && !config->checkpoint_dir) {
+        if (rank == 0) {
+            printf("Error: --checkpoint-interval needs --checkpoint\n");
+        }
+        return -1;
+    }
+    if (config->checkpoint_interval < 0.0) {
+        config->checkpoint_interval = BENCH_CKPT_DEFAULT_INTERVAL;
+    }
+    if (config->checkpoint_dir && (config->algo != MATRIX_ALGO_1D
+                                   || config->device != MATRIX_DEVICE_CPU
+                                   || config->dtype != GEMM_DTYPE_F64 || config->batch
+                                   || iterative(config))) {
+        if (rank == 0) {
+            printf("Error: --checkpoint saves rows of C of the f64 --algo=1d multiply on the CPU;\n"
+                   "       not with --device=gpu, --dtype, --batch or --iterations/--warmup\n");
+        }
+        return -1;
+    }
+    if (config->inject_error && (!config->verify || config->algo == MATRIX_ALGO_PIPELINE
+                                 || config->batch || iterative(config))) {
+        if (rank == 0) {
+            printf("Error: --inject-error corrupts C of the 1d, summa or --dtype multiply before\n"
+                   "       its check; not with --no-verify, --algo=pipeline, --batch or\n"
+                   "       --iterations/--warmup\n");
+        }
+        return -1;
+    }
+    if (iterative(config) && (config->algo != MATRIX_ALGO_1D || config->device != MATRIX_DEVICE_CPU
+                              || config->data_dir || config->dtype != GEMM_DTYPE_F64
+                              || config->batch)) {
+        if (rank == 0) {
+            printf("Error: --iterations/--warmup repeat the f64 --algo=1d multiply on the CPU\n"
+                   "       with in-memory data\n");
+        }
+        return -1;
+    }
+    return 0;
 }
 
-int main(int argc, char** argv) {
+// Read block (row0, col0) of matrix `name` from the data directory; aborts on error
+void read_data_block(const matrix_config_t *config, const char *name,
+                     int row0, int rows, int col0, int cols, double *buf) {
+    char path[4096];
+    matrix_io_path(config->data_dir, name, path, sizeof(path));
+    if (matrix_io_read_block(path, config->n, row0, rows, col0, cols, buf) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// Write block (row0, col0) of matrix `name` to the data directory; aborts on error
+void write_data_block(const matrix_config_t *config, const char *name,
+                      int row0, int rows, int col0, int cols, const double *buf) {
+    char path[4096];
+    matrix_io_path(config->data_dir, name, path, sizeof(path));
+    if (matrix_io_write_block(path, config->n, row0, rows, col0, cols, buf) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// Freivalds check of C from this rank's blocks of A, B and C (collective)
+void verify_result(const matrix_config_t *config, const matrix_block_t *a,
+                   const matrix_block_t *b, const matrix_block_t *c, matrix_times_t *times) {
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    if (world_rank == 0) {
+        printf("Verifying result (Freivalds, %d probes)...\n", MATRIX_VERIFY_PROBES);
+    }
+    double t0 = MPI_Wtime();
+    times->check = matrix_verify(config->n, config->seed, a, 1, b, 1, c, 1);
+    times->verify = MPI_Wtime() - t0;
+}
+
+// Node-aware exchange of B (--node-aware): every rank has written its rows
+// into the node's shared copy; the leaders broadcast each node's rows to the
+// other nodes, one broadcast per run of rows held by the same node
+void exchange_node_rows(const bench_node_t *node, bench_node_shared_t *shared,
+                        const int *node_of, const int *counts, const int *displs,
+                        double *B_node) {
+    int world_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    bench_node_shared_sync(node, shared);
+    if (node->leaders != MPI_COMM_NULL && node->num_nodes > 1) {
+        for (int r = 0; r < world_size; ) {
+            int end = r + 1;
+            int count = counts[r];
+            while (end < world_size && node_of[end] == node_of[r]) {
+                count += counts[end++];
+            }
+            MPI_Bcast(B_node + displs[r], count, MPI_DOUBLE, node_of[r], node->leaders);
+            r = end;
+        }
+    }
+    bench_node_shared_sync(node, shared);
+}
+
+// 1D row decomposition: scatter rows of A, broadcast all of B (distributed
+// init: generate own rows of A and B, allgather B; --data-dir: read them
+// instead and write own rows of C). With a GPU, A is copied to the device
+// while B is exchanged. With a node split (--node-aware), B is one shared
+// copy per node, exchanged between the node leaders only. With a
+// checkpoint, saved rows of C are restored first and the rest computed in
+// checkpointed panels.
+void run_1d(const matrix_config_t *config, const row_partition_t *part,
+            const double *A, const double *B, double *C, gemm_gpu_t *gpu,
+            const bench_node_t *node, checkpoint_t *ckpt, bench_perf_counter_t *tlb,
+            bench_perf_profile_t *profile, matrix_times_t *times) {
     int world_size, world_rank;
-    int n;  // Matrix dimension (n×n matrices)
-    double *A = NULL, *B = NULL, *C = NULL;  // Full matrices (rank 0 only)
+    int n = config->n;
     double *A_local, *B_local, *C_local;     // Local portions
-    int local_rows;
-    double start_time, end_time;
+    double t0, t1;
 
-    // Initialize MPI
-    MPI_Init(&argc, &argv);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
-    // Get matrix size from command line
-    if (argc > 1) {
-        n = atoi(argv[1]);
+    // Rows of this process; counts/displacements of every block in doubles
+    int local_rows = part->rows[world_rank];
+    int *counts = (int*)malloc((size_t)world_size * sizeof(int));
+    int *displs = (int*)malloc((size_t)world_size * sizeof(int));
+
+    // Allocate local arrays; full B needed by all, per rank or per node
+    bench_node_shared_t shared;
+    int *node_of = NULL;
+    int row0 = part->offsets[world_rank];
+    A_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    C_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    if (node) {
+        B_local = bench_node_shared_alloc(node, (size_t)n * n * sizeof(double), &shared);
+        node_of = bench_node_map(node, MPI_COMM_WORLD);
+    } else {
+        B_local = bench_alloc((size_t)n * n * sizeof(double));
+    }
+
+    if (!A_local || !B_local || !C_local || !counts || !displs) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // First touch by the compute threads, so Scatterv/Bcast write into
+    // pages already placed next to them (of a shared B, only the own rows)
+    bench_numa_touch_rows(A_local, local_rows, n);
+    if (node) {
+        bench_numa_touch_rows(B_local + (size_t)row0 * n, local_rows, n);
     } else {
-        n = 100;  // Default size
+        bench_numa_touch_rows(B_local, n, n);
+    }
+    bench_numa_touch_rows(C_local, local_rows, n);
+    for (int r = 0; r < world_size; r++) {
+        counts[r] = part->rows[r] * n;
+        displs[r] = part->offsets[r] * n;
     }
 
-    // Validate matrix size
-    if (n < world_size) {
+    // GPU: pin the host buffers in place, full B and A/C row blocks on the device
+    double *A_dev = NULL, *B_dev = NULL, *C_dev = NULL;
+    if (gpu) {
+        if (gemm_gpu_pin(A_local, (size_t)local_rows * n * sizeof(double)) != 0
+            || gemm_gpu_pin(B_local, (size_t)n * n * sizeof(double)) != 0
+            || gemm_gpu_pin(C_local, (size_t)local_rows * n * sizeof(double)) != 0) {
+            printf("Rank %d: Warning: could not pin host buffers (%s)\n",
+                   world_rank, gemm_gpu_error());
+        }
+        A_dev = gemm_gpu_alloc((size_t)local_rows * n);
+        B_dev = gemm_gpu_alloc((size_t)n * n);
+        C_dev = gemm_gpu_alloc((size_t)local_rows * n);
+        if (!A_dev || !B_dev || !C_dev) {
+            printf("Rank %d: GPU memory allocation failed (%s)\n", world_rank, gemm_gpu_error());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    int local_inputs = config->data_dir || config->init == MATRIX_INIT_DISTRIBUTED;
+    if (!config->data_dir && config->init == MATRIX_INIT_DISTRIBUTED) {
+        double s0 = MPI_Wtime();
+        matrix_init_block(MATRIX_A, config->seed, n, row0, local_rows, 0, n, A_local, n);
+        matrix_init_block(MATRIX_B, config->seed, n, row0, local_rows, 0, n,
+                          B_local + (size_t)row0 * n, n);
+        times->setup += MPI_Wtime() - s0;
+    }
+    int restored = 0;
+    if (ckpt && ckpt->io.resumed) {
         if (world_rank == 0) {
-            printf("Error: Matrix size (%d) must be >= number of processes (%d)\n",
-                   n, world_size);
+            printf("Restoring rows of C from %s...\n", ckpt->io.path);
+        }
+        restored = checkpoint_restore(ckpt, C_local);
+    }
+
+    // Start timing
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    bench_perf_start(tlb);
+
+    if (local_inputs) {
+        // Each rank holds (or reads) its rows of A and the same rows of B;
+        // the B row blocks are exchanged so every rank holds all of B
+        if (world_rank == 0) {
+            if (config->data_dir) {
+                printf("Reading matrices A and B from %s...\n", config->data_dir);
+            } else {
+                printf("Exchanging row blocks of B...\n");
+            }
+        }
+        t0 = MPI_Wtime();
+        if (config->data_dir) {
+            read_data_block(config, "A", row0, local_rows, 0, n, A_local);
+            read_data_block(config, "B", row0, local_rows, 0, n, B_local + (size_t)row0 * n);
+            times->io_read = MPI_Wtime() - t0;
+        }
+        if (gpu && gemm_gpu_upload(gpu, A_dev, n, A_local, n, local_rows, n) != 0) {
+            printf("Rank %d: GPU upload failed (%s)\n", world_rank, gemm_gpu_error());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (node) {
+            exchange_node_rows(node, &shared, node_of, counts, displs, B_local);
+        } else {
+            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DOUBLE, B_local, counts, displs, MPI_DOUBLE,
+                           MPI_COMM_WORLD);
+        }
+    } else {
+        // Distribute rows of A to all processes
+        if (world_rank == 0) {
+            printf("Distributing matrix A...\n");
+        }
+        t0 = MPI_Wtime();
+        MPI_Scatterv(A, counts, displs, MPI_DOUBLE,
+                     A_local, local_rows * n, MPI_DOUBLE,
+                     0, MPI_COMM_WORLD);
+        if (gpu && gemm_gpu_upload(gpu, A_dev, n, A_local, n, local_rows, n) != 0) {
+            printf("Rank %d: GPU upload failed (%s)\n", world_rank, gemm_gpu_error());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        // Broadcast matrix B to all processes (or to the node leaders,
+        // which share it with their node)
+        if (world_rank == 0) {
+            printf("Broadcasting matrix B%s...\n", node ? " to node leaders" : "");
+            // Copy B to B_local for rank 0 (threads keep their pages)
+            bench_numa_copy_rows(B_local, B, n, n);
+        }
+        if (!node) {
+            MPI_Bcast(B_local, n * n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        } else {
+            if (node->leaders != MPI_COMM_NULL) {
+                MPI_Bcast(B_local, n * n, MPI_DOUBLE, 0, node->leaders);
+            }
+            bench_node_shared_sync(node, &shared);
+        }
+    }
+    t1 = MPI_Wtime();
+    times->distribute = t1 - t0;
+
+    // Each process computes its portion of C
+    if (world_rank == 0) {
+        printf("Computing matrix multiplication...\n");
+    }
+    if (gpu) {
+        if (gemm_gpu_upload(gpu, B_dev, n, B_local, n, n, n) != 0
+            || gemm_gpu_multiply(gpu, local_rows, n, n, A_dev, n, B_dev, n, C_dev, n) != 0
+            || gemm_gpu_download(gpu, C_local, n, C_dev, n, local_rows, n) != 0
+            || gemm_gpu_wait(gpu) != 0) {
+            printf("Rank %d: GPU multiply failed (%s)\n", world_rank, gemm_gpu_error());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        times->device_gemm = gpu->gemm_seconds;
+        times->device_bytes = gpu->bytes_h2d + gpu->bytes_d2h;
+    } else if (ckpt) {
+        checkpoint_multiply(ckpt, config->kernel, config->panel_width, A_local, B_local,
+                            C_local, profile);
+    } else {
+        bench_perf_profile_resume(profile);
+        multiply_matrices(A_local, B_local, C_local, local_rows, n, config->kernel);
+        bench_perf_profile_pause(profile);
+    }
+    t0 = MPI_Wtime();
+    times->compute = t0 - t1;
+    times->local_flops = 2.0 * (local_rows - restored) * n * (double)n;
+
+    // Gather results back to rank 0, or write them next to A and B
+    if (!config->gather) {
+        // C stays distributed
+    } else if (config->data_dir) {
+        if (world_rank == 0) {
+            printf("Writing matrix C to %s...\n", config->data_dir);
+        }
+        write_data_block(config, "C", row0, local_rows, 0, n, C_local);
+        times->io_write = MPI_Wtime() - t0;
+    } else {
+        if (world_rank == 0) {
+            printf("Gathering results...\n");
+        }
+        MPI_Gatherv(C_local, local_rows * n, MPI_DOUBLE,
+                    C, counts, displs, MPI_DOUBLE,
+                    0, MPI_COMM_WORLD);
+    }
+    times->gather = MPI_Wtime() - t0;
+
+    // Stop timing
+    times->dtlb_misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+    times->total = MPI_Wtime() - start_time;
+
+    // Every rank holds all of B but contributes only its own rows of it
+    if (config->verify) {
+        matrix_block_t a_block = {A_local, row0, local_rows, 0, n, n};
+        matrix_block_t b_block = {B_local + (size_t)row0 * n, row0, local_rows, 0, n, n};
+        matrix_block_t c_block = {C_local, row0, local_rows, 0, n, n};
+        size_t fault;
+        if (config->inject_error && matrix_verify_fault(n, &c_block, &fault)) {
+            C_local[fault] = -C_local[fault];
+        }
+        verify_result(config, &a_block, &b_block, &c_block, times);
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_local", A_local, (size_t)local_rows * n * sizeof(double)},
+        {node ? "B_node" : "B_local", B_local, (size_t)n * n * sizeof(double)},
+        {"C_local", C_local, (size_t)local_rows * n * sizeof(double)},
+    };
+    times->numa_local = bench_numa_report(buffers, 3);
+    times->huge_share = bench_alloc_report(buffers, 3, times->dtlb_misses);
+
+    if (gpu) {
+        gemm_gpu_free(A_dev);
+        gemm_gpu_free(B_dev);
+        gemm_gpu_free(C_dev);
+        gemm_gpu_unpin(A_local);
+        gemm_gpu_unpin(B_local);
+        gemm_gpu_unpin(C_local);
+    }
+    bench_free(A_local);
+    if (node) {
+        bench_node_shared_free(&shared);
+        free(node_of);
+    } else {
+        bench_free(B_local);
+    }
+    bench_free(C_local);
+    free(counts);
+    free(displs);
+}
+
+// SUMMA on a 2D process grid: tiles of A/B/C, panel broadcasts along rows/columns
+void run_summa(const matrix_config_t *config, const summa_grid_t *grid,
+               const double *A, const double *B, double *C,
+               bench_perf_counter_t *tlb, bench_perf_profile_t *profile, matrix_times_t *times) {
+    int world_rank;
+    int n = config->n;
+    int rows = summa_tile_rows(grid, n);
+    int cols = summa_tile_cols(grid, n);
+    double t0, t1;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    double *A_tile = bench_alloc((size_t)rows * cols * sizeof(double));
+    double *B_tile = bench_alloc((size_t)rows * cols * sizeof(double));
+    double *C_tile = bench_alloc((size_t)rows * cols * sizeof(double));
+
+    if (!A_tile || !B_tile || !C_tile) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    bench_numa_touch_rows(A_tile, rows, cols);
+    bench_numa_touch_rows(B_tile, rows, cols);
+    bench_numa_touch_rows(C_tile, rows, cols);
+
+    int row0 = block_offset(n, grid->dims[0], grid->coords[0]);
+    int col0 = block_offset(n, grid->dims[1], grid->coords[1]);
+    if (!config->data_dir && config->init == MATRIX_INIT_DISTRIBUTED) {
+        double s0 = MPI_Wtime();
+        matrix_init_block(MATRIX_A, config->seed, n, row0, rows, col0, cols, A_tile, cols);
+        matrix_init_block(MATRIX_B, config->seed, n, row0, rows, col0, cols, B_tile, cols);
+        times->setup += MPI_Wtime() - s0;
+    }
+
+    // Start timing
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    bench_perf_start(tlb);
+
+    if (config->data_dir) {
+        if (world_rank == 0) {
+            printf("Reading tiles of A and B from %s...\n", config->data_dir);
+        }
+        t0 = MPI_Wtime();
+        read_data_block(config, "A", row0, rows, col0, cols, A_tile);
+        read_data_block(config, "B", row0, rows, col0, cols, B_tile);
+        times->io_read = MPI_Wtime() - t0;
+    } else if (config->init == MATRIX_INIT_ROOT) {
+        if (world_rank == 0) {
+            printf("Distributing tiles of A and B...\n");
+        }
+        t0 = MPI_Wtime();
+        summa_scatter(grid, n, A, A_tile);
+        summa_scatter(grid, n, B, B_tile);
+    } else {
+        t0 = MPI_Wtime();   // Tiles were generated in place
+    }
+    t1 = MPI_Wtime();
+    times->distribute = t1 - t0;
+
+    if (world_rank == 0) {
+        printf("Computing matrix multiplication (SUMMA)...\n");
+    }
+    summa_multiply(grid, n, config->panel_width, config->kernel,
+                   A_tile, B_tile, C_tile, profile, times);
+
+    t0 = MPI_Wtime();
+    if (!config->gather) {
+        // C stays distributed
+    } else if (config->data_dir) {
+        if (world_rank == 0) {
+            printf("Writing tiles of C to %s...\n", config->data_dir);
+        }
+        write_data_block(config, "C", row0, rows, col0, cols, C_tile);
+        times->io_write = MPI_Wtime() - t0;
+    } else {
+        if (world_rank == 0) {
+            printf("Gathering results...\n");
+        }
+        summa_gather(grid, n, C_tile, C);
+    }
+    times->gather = MPI_Wtime() - t0;
+
+    // Stop timing
+    times->dtlb_misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+    times->total = MPI_Wtime() - start_time;
+
+    if (config->verify) {
+        matrix_block_t a_block = {A_tile, row0, rows, col0, cols, cols};
+        matrix_block_t b_block = {B_tile, row0, rows, col0, cols, cols};
+        matrix_block_t c_block = {C_tile, row0, rows, col0, cols, cols};
+        size_t fault;
+        if (config->inject_error && matrix_verify_fault(n, &c_block, &fault)) {
+            C_tile[fault] = -C_tile[fault];
+        }
+        verify_result(config, &a_block, &b_block, &c_block, times);
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_tile", A_tile, (size_t)rows * cols * sizeof(double)},
+        {"B_tile", B_tile, (size_t)rows * cols * sizeof(double)},
+        {"C_tile", C_tile, (size_t)rows * cols * sizeof(double)},
+    };
+    times->numa_local = bench_numa_report(buffers, 3);
+    times->huge_share = bench_alloc_report(buffers, 3, times->dtlb_misses);
+
+    bench_free(A_tile);
+    bench_free(B_tile);
+    bench_free(C_tile);
+}
+
+// Pipelined 1D: B column panels and C slices overlap with compute
+void run_pipeline(const matrix_config_t *config, const row_partition_t *part,
+                  const double *A, const double *B, double *C, gemm_gpu_t *gpu,
+                  bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                  matrix_times_t *times) {
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    if (world_rank == 0) {
+        printf("Pipelining B column panels and C slices (panel width %d)...\n",
+               config->panel_width);
+    }
+    pipeline_multiply(config->n, config->panel_width, config->kernel, gpu, part,
+                      config->init, config->seed, config->gather, config->verify,
+                      A, B, C, tlb, profile, times);
+}
+
+// Write random A and B to the data directory, one even row block per rank;
+// returns the elapsed time (barrier to barrier)
+double generate_input(const matrix_config_t *config) {
+    int world_size, world_rank;
+    int n = config->n;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    int rows = block_size(n, world_size, world_rank);
+    int row0 = block_offset(n, world_size, world_rank);
+    double *block = bench_alloc((size_t)rows * n * sizeof(double));
+    if (!block) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    matrix_init_block(MATRIX_A, config->seed, n, row0, rows, 0, n, block, n);
+    write_data_block(config, "A", row0, rows, 0, n, block);
+    matrix_init_block(MATRIX_B, config->seed, n, row0, rows, 0, n, block, n);
+    write_data_block(config, "B", row0, rows, 0, n, block);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double elapsed = MPI_Wtime() - t0;
+
+    bench_free(block);
+    return elapsed;
+}
+
+// Dimension shared by DIR/A.bin and DIR/B.bin, or 0 (error printed on
+// rank 0) if they are missing, differ, or disagree with an explicit n
+int data_dimension(const matrix_config_t *config, int rank) {
+    char path_a[4096], path_b[4096];
+    matrix_io_path(config->data_dir, "A", path_a, sizeof(path_a));
+    matrix_io_path(config->data_dir, "B", path_b, sizeof(path_b));
+    int n_a = matrix_io_dimension(path_a);
+    int n_b = matrix_io_dimension(path_b);
+
+    if (n_a == 0 || n_b != n_a) {
+        if (rank == 0) {
+            printf("Error: %s and %s must hold square matrices of doubles of the same size\n"
+                   "       (use --generate-input to create them)\n", path_a, path_b);
+        }
+        return 0;
+    }
+    if (config->n_set && config->n != n_a) {
+        if (rank == 0) {
+            printf("Error: Matrix size %d does not match %s (%d x %d)\n",
+                   config->n, path_a, n_a, n_a);
+        }
+        return 0;
+    }
+    return n_a;
+}
+
+// Floating-point operations of the run: 2n^3 for the product, for every
+// matrix of every rank with --batch, less the rows of C restored from a
+// checkpoint
+double run_flops(const matrix_config_t *config, int world_size, double restored_rows) {
+    double flops = 2.0 * config->n * config->n * ((double)config->n - restored_rows);
+    return config->batch ? flops * config->batch * world_size : flops;
+}
+
+// Write the JSON record of this run (rank 0 only)
+void write_json_record(const matrix_config_t *config, int world_size, int threads,
+                       const int *isa_counts, const matrix_stats_t *stats,
+                       const matrix_times_t *times, const gemm_gpu_t *gpu,
+                       const char *ckpt_path, const char *hosts) {
+    bench_json_t json;
+    double flops = run_flops(config, world_size, stats->checkpoint.total_restored);
+
+    if (bench_json_open(&json, config->json_path) != 0) {
+        printf("Warning: could not write JSON record\n");
+        return;
+    }
+    bench_json_begin_object(&json, NULL);
+    bench_json_header(&json, "matrix-mult", world_size, threads, hosts);
+
+    bench_json_begin_object(&json, "config");
+    bench_json_int(&json, "n", config->n);
+    bench_json_string(&json, "algo", algo_name(config->algo));
+    bench_json_int(&json, "panel_width", config->panel_width);
+    bench_json_string(&json, "balance", partition_mode_name(config->balance));
+    bench_json_string(&json, "device", matrix_device_name(config->device));
+    bench_json_string(&json, "kernel", config->device == MATRIX_DEVICE_GPU
+                      ? "cublas" : gemm_kernel_name(config->kernel));
+    bench_json_string(&json, "isa_requested", gemm_isa_name(config->isa));
+    bench_json_string(&json, "dtype", gemm_dtype_name(config->dtype));
+    bench_json_int(&json, "batch", config->batch);
+    if (config->batch) {
+        bench_json_string(&json, "batch_layout",
+                          batch_layout_name(batch_resolve_layout(config->batch_layout,
+                                                                 config->n)));
+    }
+    int mc, kc, nc;
+    gemm_get_blocking(&mc, &kc, &nc);
+    bench_json_int(&json, "gemm_mc", mc);
+    bench_json_int(&json, "gemm_kc", kc);
+    bench_json_int(&json, "gemm_nc", nc);
+    bench_json_string(&json, "hugepages", bench_pages_name(bench_alloc_policy()));
+    bench_json_string(&json, "init", matrix_init_name(config->init));
+    bench_json_int(&json, "seed", (long long)config->seed);
+    if (config->data_dir) {
+        bench_json_string(&json, "data_dir", config->data_dir);
+        bench_json_bool(&json, "generate_input", config->generate_input);
+    }
+    bench_json_bool(&json, "gather", config->gather);
+    bench_json_bool(&json, "verify", config->verify);
+    bench_json_bool(&json, "inject_error", config->inject_error);
+    bench_json_bool(&json, "node_aware", config->node_aware);
+    bench_json_int(&json, "iterations", config->iterations);
+    bench_json_int(&json, "warmup", config->warmup);
+    if (iterative(config)) {
+        bench_json_string(&json, "persistent", iterate_exchange_name());
+    }
+    if (config->checkpoint_dir) {
+        bench_json_string(&json, "checkpoint_dir", config->checkpoint_dir);
+        bench_json_double(&json, "checkpoint_interval", config->checkpoint_interval);
+    }
+    bench_json_end_object(&json);
+
+    if (gpu) {
+        bench_json_begin_object(&json, "gpu");
+        bench_json_string(&json, "name", gpu->name);
+        bench_json_double(&json, "memory_gb", gpu->memory_gb);
+        bench_json_end_object(&json);
+    }
+
+    // ISA path on rank 0 plus how many ranks took each path
+    bench_json_string(&json, "isa", config->kernel == GEMM_KERNEL_BLOCKED
+                      ? gemm_isa_name(gemm_get_isa()) : "n/a");
+    bench_json_begin_object(&json, "isa_ranks");
+    for (int i = 0; i < GEMM_ISA_COUNT; i++) {
+        if (isa_counts[i] > 0) {
+            bench_json_int(&json, gemm_isa_name((gemm_isa_t)i), isa_counts[i]);
+        }
+    }
+    bench_json_end_object(&json);
+
+    bench_json_begin_object(&json, "phases");
+    bench_json_stats(&json, "setup", &stats->setup);
+    bench_json_stats(&json, "distribute", &stats->distribute);
+    bench_json_stats(&json, "comm", &stats->comm);
+    bench_json_stats(&json, "compute", &stats->compute);
+    bench_json_stats(&json, "gather", &stats->gather);
+    bench_json_stats(&json, "hidden", &stats->hidden);
+    if (config->data_dir) {
+        bench_json_stats(&json, "io_read", &stats->io_read);
+        bench_json_stats(&json, "io_write", &stats->io_write);
+    }
+    bench_json_stats(&json, "total", &stats->total);
+    if (config->verify) {
+        bench_json_stats(&json, "verify", &stats->verify);
+    }
+    if (gpu) {
+        bench_json_stats(&json, "device_gemm", &stats->device_gemm);
+    }
+    if (iterative(config)) {
+        bench_json_percentiles(&json, "iteration", &times->iteration);
+        bench_json_double(&json, "cold_iteration", times->cold);
+        bench_json_stats(&json, "persist_setup", &stats->persist_setup);
+    }
+    bench_json_end_object(&json);
+    bench_startup_json(&json, &stats->startup);
+
+    bench_json_begin_object(&json, "metrics");
+    bench_json_double(&json, "flops", flops);
+    bench_json_double(&json, "gflops", flops / stats->total.max / 1e9);
+    bench_json_double(&json, "compute_gflops", flops / stats->compute.max / 1e9);
+    bench_json_stats(&json, "rank_gflops", &stats->rank_gflops);
+    bench_json_double(&json, "compute_imbalance", stats->compute.max / stats->compute.avg);
+    if (times->numa_local >= 0.0) {
+        bench_json_double(&json, "numa_local_fraction", times->numa_local);
+    }
+    bench_json_double(&json, "huge_page_fraction", times->huge_share);
+    if (config->data_dir) {
+        double bytes = (double)config->n * config->n * sizeof(double);
+        bench_json_double(&json, "read_gbps", 2.0 * bytes / stats->io_read.max / 1e9);
+        if (config->gather) {
+            bench_json_double(&json, "write_gbps", bytes / stats->io_write.max / 1e9);
+        }
+    }
+    if (stats->dtlb_misses.min >= 0.0) {
+        bench_json_stats(&json, "dtlb_load_misses", &stats->dtlb_misses);
+    }
+    bench_perf_json(&json, &stats->counters, "gemm");
+    if (config->checkpoint_dir) {
+        bench_ckpt_json(&json, &stats->checkpoint, ckpt_path);
+    }
+    if (gpu) {
+        bench_json_stats(&json, "device_gflops", &stats->device_gflops);
+        bench_json_stats(&json, "device_copy_bytes", &stats->device_bytes);
+        bench_json_stats(&json, "h2d_gbps", &stats->h2d_gbps);
+        bench_json_stats(&json, "d2h_gbps", &stats->d2h_gbps);
+    }
+    if (iterative(config)) {
+        bench_json_double(&json, "steady_gflops_p50", flops / times->iteration.p50 / 1e9);
+        bench_json_double(&json, "steady_gflops_p99", flops / times->iteration.p99 / 1e9);
+    }
+    if (config->verify) {
+        bench_json_bool(&json, "verified", times->check.passed);
+        bench_json_double(&json, "verify_residual", times->check.residual);
+        bench_json_double(&json, "verify_tolerance", times->check.tolerance);
+    }
+    bench_json_end_object(&json);
+
+    bench_json_end_object(&json);
+    if (bench_json_close(&json) != 0) {
+        printf("Warning: could not write JSON record\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    int world_size, world_rank;
+    int n;  // Matrix dimension (n×n matrices)
+    matrix_config_t config;
+    summa_grid_t grid;
+    row_partition_t part;
+    double *A = NULL, *B = NULL, *C = NULL;  // Full matrices (rank 0 only)
+    matrix_times_t times;
+    bench_startup_t startup;
+
+    // Initialize MPI (only the main thread makes MPI calls)
+    int thread_support;
+    bench_startup_begin(&startup);
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
+    bench_startup_end(&startup);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    // Parse command line
+    if (parse_args(argc, argv, &config, world_rank) != 0) {
+        if (world_rank == 0) {
+            print_usage(argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (config.data_dir && !config.generate_input) {
+        config.n = data_dimension(&config, world_rank);
+        if (config.n == 0) {
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    n = config.n;
+
+    const char *thread_source;
+    int threads = bench_threads_init(&thread_source);
+
+    // Per-thread dTLB miss counters; the timed region of each algorithm
+    // starts and stops them
+    bench_perf_counter_t tlb;
+    bench_perf_open(&tlb, BENCH_PERF_DTLB_LOAD_MISSES);
+
+    // Select the micro-kernel for this node; a forced ISA must work everywhere
+    int isa_ok = (gemm_set_isa(config.isa) == 0);
+    int all_isa_ok;
+    MPI_Allreduce(&isa_ok, &all_isa_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    if (!all_isa_ok) {
+        if (!isa_ok) {
+            printf("Rank %d: ISA '%s' is not supported on this CPU\n",
+                   world_rank, gemm_isa_name(config.isa));
         }
         MPI_Finalize();
         return 1;
     }
 
-    if (n % world_size != 0) {
+    // Compute profile, paused and resumed around every local GEMM call. It
+    // counts the FP events of the dtype's arithmetic (BF16 widened to FP32
+    // is FP32); BF16 dot products have none, so their FLOPs are the
+    // operation count
+    bench_perf_profile_t profile = {0};
+    if (config.counters) {
+        int compact = config.batch
+                      && batch_resolve_layout(config.batch_layout, n) == BATCH_LAYOUT_COMPACT;
+        bench_perf_fp_t fp = BENCH_PERF_FP_DOUBLE;
+        if (config.dtype == GEMM_DTYPE_BF16 && gemm_lowp_bf16_native() && !compact) {
+            fp = BENCH_PERF_FP_NONE;
+        } else if (config.dtype != GEMM_DTYPE_F64) {
+            fp = BENCH_PERF_FP_SINGLE;
+        }
+        bench_perf_profile_open_fp(&profile, fp);
+    }
+
+    // One GPU per rank (ranks on a node take its GPUs in turn); every rank
+    // must have one. The pinned copy bandwidth shows whether the GPU got a
+    // full PCIe link (e.g. through VM passthrough).
+    gemm_gpu_t gpu_state;
+    gemm_gpu_t *gpu = NULL;
+    bench_stats_t h2d_stats = {0}, d2h_stats = {0};
+    if (config.device == MATRIX_DEVICE_GPU) {
+        MPI_Comm node_comm;
+        int local_rank;
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+        MPI_Comm_rank(node_comm, &local_rank);
+        MPI_Comm_free(&node_comm);
+
+        int gpu_ok = (gemm_gpu_open(&gpu_state, local_rank) == 0);
+        int all_gpu_ok;
+        MPI_Allreduce(&gpu_ok, &all_gpu_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+        if (!all_gpu_ok) {
+            if (!gpu_ok) {
+                printf("Rank %d: No GPU for --device=gpu: %s\n", world_rank, gemm_gpu_error());
+            }
+            gemm_gpu_close(&gpu_state);
+            MPI_Finalize();
+            return 1;
+        }
+        gpu = &gpu_state;
+        double h2d_gbps, d2h_gbps;
+        if (gemm_gpu_bandwidth(gpu, GPU_PROBE_BYTES, &h2d_gbps, &d2h_gbps) != 0) {
+            printf("Rank %d: Warning: host-device bandwidth probe failed (%s)\n",
+                   world_rank, gemm_gpu_error());
+        }
+        h2d_stats = bench_reduce_stats(h2d_gbps);
+        d2h_stats = bench_reduce_stats(d2h_gbps);
+    }
+
+    // Validate matrix size (a batch gives every rank its own matrices,
+    // numbered through one generator row space)
+    if (config.batch && (double)world_size * config.batch * n > 2147483647.0) {
         if (world_rank == 0) {
-            printf("Error: Matrix size (%d) must be divisible by number of processes (%d)\n",
+            printf("Error: Batch too large (%d ranks x %d matrices x %d rows exceed 2^31 rows)\n",
+                   world_size, config.batch, n);
+        }
+        if (gpu) {
+            gemm_gpu_close(gpu);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (n < world_size && !config.batch) {
+        if (world_rank == 0) {
+            printf("Error: Matrix size (%d) must be >= number of processes (%d)\n",
                    n, world_size);
         }
+        if (gpu) {
+            gemm_gpu_close(gpu);
+        }
         MPI_Finalize();
         return 1;
     }
 
-    // Calculate local rows per process
-    local_rows = n / world_size;
+    // Split rows for the 1D algorithms; a throughput split needs every
+    // rank's warm-up rate, so all ranks compute the same partition
+    double min_warmup = 0.0, max_warmup = 0.0;
+    if (config.batch) {
+        // Rank-local matrices, nothing to split
+    } else if (config.algo == MATRIX_ALGO_SUMMA) {
+        summa_grid_create(MPI_COMM_WORLD, &grid);
+    } else if (config.balance == PARTITION_THROUGHPUT) {
+        double rate = partition_measure_gflops(config.kernel, n);
+        double *rates = (double*)malloc((size_t)world_size * sizeof(double));
+        if (!rates) {
+            printf("Rank %d: Memory allocation failed\n", world_rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        MPI_Allgather(&rate, 1, MPI_DOUBLE, rates, 1, MPI_DOUBLE, MPI_COMM_WORLD);
+        partition_weighted(n, world_size, rates, &part);
+        min_warmup = max_warmup = rates[0];
+        for (int r = 1; r < world_size; r++) {
+            min_warmup = rates[r] < min_warmup ? rates[r] : min_warmup;
+            max_warmup = rates[r] > max_warmup ? rates[r] : max_warmup;
+        }
+        free(rates);
+    } else {
+        partition_even(n, world_size, &part);
+    }
+
+    // Ranks per node and node leaders for the shared B
+    bench_node_t node;
+    if (config.node_aware) {
+        bench_node_init(&node, MPI_COMM_WORLD);
+    }
+
+    // Checkpoint of this rank's rows of C; resumes a matching earlier run
+    checkpoint_t ckpt;
+    if (config.checkpoint_dir
+        && checkpoint_open(&ckpt, config.checkpoint_dir, config.checkpoint_interval, n,
+                           config.seed, config.data_dir != NULL, part.offsets[world_rank],
+                           part.rows[world_rank]) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Count ranks per ISA path (mixed-generation nodes may differ)
+    int isa_local[GEMM_ISA_COUNT] = {0};
+    int isa_counts[GEMM_ISA_COUNT];
+    isa_local[gemm_get_isa()] = 1;
+    MPI_Reduce(isa_local, isa_counts, GEMM_ISA_COUNT, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
 
     // Print configuration
     if (world_rank == 0) {
+        double mb = 1024.0 * 1024.0;
+        size_t esize = gemm_dtype_size(config.dtype);
+        size_t c_size = config.dtype == GEMM_DTYPE_F64 ? sizeof(double) : sizeof(float);
         printf("========================================\n");
         printf("Parallel Matrix Multiplication\n");
         printf("========================================\n");
         printf("Matrix size: %d x %d\n", n, n);
         printf("Number of processes: %d\n", world_size);
-        printf("Rows per process: %d\n", local_rows);
-        printf("Total elements: %d\n", n * n);
-        printf("Memory per matrix: %.2f MB\n", (n * n * sizeof(double)) / (1024.0 * 1024.0));
+        if (config.batch) {
+            batch_layout_t layout = batch_resolve_layout(config.batch_layout, n);
+            printf("Algorithm: batch (independent matrices per rank, no communication)\n");
+            printf("Batch: %d matrices per rank, %.0f in total\n", config.batch,
+                   (double)config.batch * world_size);
+            printf("Batch layout: %s%s\n", batch_layout_name(layout),
+                   config.batch_layout == BATCH_LAYOUT_AUTO ? " (auto)" : "");
+            printf("Memory per process: %.2f MB (A/B/C batches)\n",
+                   (double)config.batch * n * n * (2.0 * esize + c_size) / mb);
+        } else {
+            printf("Algorithm: %s\n", algo_name(config.algo));
+        }
+        if (config.batch) {
+            // Shown above
+        } else if (config.algo == MATRIX_ALGO_SUMMA) {
+            int rows = block_size(n, grid.dims[0], 0);
+            int cols = block_size(n, grid.dims[1], 0);
+            printf("Process grid: %d x %d\n", grid.dims[0], grid.dims[1]);
+            printf("Tile size: up to %d x %d\n", rows, cols);
+            printf("Panel width: %d\n", config.panel_width);
+            printf("Memory per process: %.2f MB (A/B/C tiles + A/B panels)\n",
+                   (3.0 * rows * cols + (double)config.panel_width * (rows + cols))
+                   * sizeof(double) / mb);
+        } else {
+            int min_rows = part.rows[0], max_rows = part.rows[0];
+            for (int r = 1; r < world_size; r++) {
+                min_rows = part.rows[r] < min_rows ? part.rows[r] : min_rows;
+                max_rows = part.rows[r] > max_rows ? part.rows[r] : max_rows;
+            }
+            printf("Row balance: %s\n", partition_mode_name(config.balance));
+            if (config.balance == PARTITION_THROUGHPUT) {
+                printf("Warm-up throughput: %.2f GFLOPS (slowest) / %.2f GFLOPS (fastest)\n",
+                       min_warmup, max_warmup);
+            }
+            if (min_rows == max_rows) {
+                printf("Rows per process: %d\n", max_rows);
+            } else {
+                printf("Rows per process: %d to %d\n", min_rows, max_rows);
+            }
+            if (config.algo == MATRIX_ALGO_PIPELINE) {
+                int w = config.panel_width < n ? config.panel_width : n;
+                printf("Panel width: %d (%d panels)\n", w, (n + w - 1) / w);
+                printf("Memory per process: %.2f MB (two B panels + A/C row blocks)\n",
+                       (2.0 * n * w + 2.0 * max_rows * n) * sizeof(double) / mb);
+                if (gpu) {
+                    printf("GPU memory per process: %.2f MB (one B panel + A/C row blocks)\n",
+                           ((double)n * w + 2.0 * max_rows * n) * sizeof(double) / mb);
+                }
+            } else if (config.node_aware) {
+                printf("Node-aware B: one shared copy per node (%d nodes, up to %d ranks"
+                       " per node), broadcast between node leaders\n",
+                       node.num_nodes, node.max_node_size);
+                printf("Memory per process: %.2f MB (A/C row blocks), %.2f MB per node (B)\n",
+                       2.0 * max_rows * n * sizeof(double) / mb,
+                       (double)n * n * sizeof(double) / mb);
+            } else {
+                printf("Memory per process: %.2f MB (full B + A/C row blocks)\n",
+                       (((double)n * n + (double)max_rows * n) * esize
+                        + (double)max_rows * n * c_size) / mb);
+                if (gpu) {
+                    printf("GPU memory per process: %.2f MB (full B + A/C row blocks)\n",
+                           ((double)n * n + 2.0 * max_rows * n) * sizeof(double) / mb);
+                }
+            }
+        }
+        printf("Threads per process: %d (%s)\n", threads, thread_source);
+        if (threads > 1 && thread_support < MPI_THREAD_FUNNELED) {
+            printf("Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+        }
+        if (gpu) {
+            printf("Device: gpu, cuBLAS DGEMM (rank 0: %s, %.1f GB)\n",
+                   gpu->name, gpu->memory_gb);
+            printf("Host-device bandwidth (pinned, slowest GPU): %.2f GB/s H2D, %.2f GB/s D2H\n",
+                   h2d_stats.min, d2h_stats.min);
+        } else {
+            printf("Kernel: %s\n", gemm_kernel_name(config.kernel));
+            print_isa_summary(&config, isa_counts);
+        }
+        printf("Data type: %s%s\n", gemm_dtype_name(config.dtype),
+               config.dtype == GEMM_DTYPE_F64 ? "" : " (FP32 accumulation)");
+        int mc, kc, nc;
+        gemm_get_blocking(&mc, &kc, &nc);
+        printf("Build: %s (blocking MC=%d KC=%d NC=%d)\n", BENCH_BUILD_VARIANT, mc, kc, nc);
+        printf("Huge pages: %s\n", bench_pages_name(bench_alloc_policy()));
+        if (!config.data_dir) {
+            printf("Initialization: %s (seed %llu)\n", matrix_init_name(config.init),
+                   (unsigned long long)config.seed);
+        }
+        if (config.data_dir) {
+            printf("Data: %s/{A,B,C}.bin (collective MPI-IO, no full matrices on rank 0)\n",
+                   config.data_dir);
+        }
+        if (config.checkpoint_dir) {
+            printf("Checkpoint: %s every %g s, panels of %d rows (%s)\n", ckpt.io.path,
+                   config.checkpoint_interval, config.panel_width,
+                   ckpt.io.resumed ? "resuming an earlier run" : "new");
+        }
+        printf("Result: %s, %s\n", config.batch ? "kept on each rank"
+                                : config.gather ? (config.data_dir ? "written" : "gathered")
+                                                : "left distributed",
+               config.verify ? "Freivalds check" : "not verified");
+        if (config.inject_error) {
+            printf("Fault injection: C(%d,%d) negated before the check (must FAIL)\n",
+                   n / 2, n / 2);
+        }
+        printf("Total elements: %.0f\n", (double)n * n);
+        printf("Memory per matrix: %.2f MB\n", ((double)n * n * esize) / mb);
         printf("========================================\n");
         printf("\n");
     }
 
-    // Allocate local arrays
-    A_local = (double*)malloc(local_rows * n * sizeof(double));
-    B_local = (double*)malloc(n * n * sizeof(double));  // Full B needed by all
-    C_local = (double*)malloc(local_rows * n * sizeof(double));
-
-    if (!A_local || !B_local || !C_local) {
-        printf("Rank %d: Memory allocation failed\n", world_rank);
-        MPI_Abort(MPI_COMM_WORLD, 1);
+    if (config.generate_input) {
+        if (world_rank == 0) {
+            printf("Generating A and B in %s...\n", config.data_dir);
+        }
+        double elapsed = generate_input(&config);
+        if (world_rank == 0) {
+            printf("Input written: %.2f GB in %.3f seconds (%.2f GB/s)\n\n",
+                   2.0 * n * n * sizeof(double) / 1e9, elapsed,
+                   2.0 * n * n * sizeof(double) / elapsed / 1e9);
+        }
     }
 
-    // Rank 0 initializes matrices
-    if (world_rank == 0) {
-        printf("Initializing matrices...\n");
-        A = (double*)malloc(n * n * sizeof(double));
-        B = (double*)malloc(n * n * sizeof(double));
-        C = (double*)malloc(n * n * sizeof(double));
+    // Full matrices on rank 0: A and B only with --init=root (pipeline also
+    // broadcasts B panels from there), C unless it goes to --data-dir or
+    // stays distributed (--no-gather)
+    memset(&times, 0, sizeof(times));
+    if (world_rank == 0 && !config.data_dir && !config.batch) {
+        int full_a = config.init == MATRIX_INIT_ROOT;
+        int full_b = full_a || config.algo == MATRIX_ALGO_PIPELINE;
+        size_t bytes = (size_t)n * n * sizeof(double);
 
-        if (!A || !B || !C) {
+        printf("Initializing matrices (%s, seed %llu)...\n", matrix_init_name(config.init),
+               (unsigned long long)config.seed);
+        A = full_a ? bench_alloc(bytes) : NULL;
+        B = full_b ? bench_alloc(bytes) : NULL;
+        C = config.gather ? bench_alloc(bytes) : NULL;
+
+        if ((full_a && !A) || (full_b && !B) || (config.gather && !C)) {
             printf("Memory allocation failed for full matrices\n");
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
 
-        initialize_matrix(A, n, n, world_rank);
-        initialize_matrix(B, n, n, world_rank + 1);
+        double s0 = MPI_Wtime();
+        if (full_a) {
+            matrix_init_block(MATRIX_A, config.seed, n, 0, n, 0, n, A, n);
+        }
+        if (full_b) {
+            matrix_init_block(MATRIX_B, config.seed, n, 0, n, 0, n, B, n);
+        }
+        times.setup = MPI_Wtime() - s0;
 
-        // Print small matrices for verification
+        // Print small matrices for verification (same values in every mode)
         if (n <= 10) {
-            print_matrix(A, n, n, "Matrix A");
-            print_matrix(B, n, n, "Matrix B");
+            double small[100];
+            matrix_init_block(MATRIX_A, config.seed, n, 0, n, 0, n, small, n);
+            print_matrix(small, n, n, "Matrix A");
+            matrix_init_block(MATRIX_B, config.seed, n, 0, n, 0, n, small, n);
+            print_matrix(small, n, n, "Matrix B");
         }
         printf("\n");
     }
-
-    // Start timing
-    MPI_Barrier(MPI_COMM_WORLD);
-    start_time = MPI_Wtime();
-
-    // Distribute rows of A to all processes
-    if (world_rank == 0) {
-        printf("Distributing matrix A...\n");
+    if (config.batch) {
+        batch_multiply(n, config.batch, config.dtype, config.batch_layout, config.kernel,
+                       config.seed, config.verify, &tlb, &profile, &times);
+    } else if (iterative(&config)) {
+        iterate_multiply(n, config.kernel, &part, config.init, config.seed, config.gather,
+                         config.verify, config.iterations, config.warmup, A, B, C,
+                         &tlb, &profile, &times);
+    } else if (config.dtype != GEMM_DTYPE_F64) {
+        mixed_multiply(n, config.dtype, &part, config.init, config.seed, config.gather,
+                       config.verify, config.inject_error, A, B, C, &tlb, &profile, &times);
+    } else if (config.algo == MATRIX_ALGO_SUMMA) {
+        run_summa(&config, &grid, A, B, C, &tlb, &profile, &times);
+    } else if (config.algo == MATRIX_ALGO_PIPELINE) {
+        run_pipeline(&config, &part, A, B, C, gpu, &tlb, &profile, &times);
+    } else {
+        run_1d(&config, &part, A, B, C, gpu, config.node_aware ? &node : NULL,
+               config.checkpoint_dir ? &ckpt : NULL, &tlb, &profile, &times);
     }
-    MPI_Scatter(A, local_rows * n, MPI_DOUBLE,
-                A_local, local_rows * n, MPI_DOUBLE,
-                0, MPI_COMM_WORLD);
+    bench_perf_close(&tlb);
+    times.counters = bench_perf_profile_read(&profile);
+    bench_perf_profile_close(&profile);
 
-    // Broadcast matrix B to all processes
-    if (world_rank == 0) {
-        printf("Broadcasting matrix B...\n");
-    }
-    if (world_rank == 0) {
-        // Copy B to B_local for rank 0
-        for (int i = 0; i < n * n; i++) {
-            B_local[i] = B[i];
-        }
-    }
-    MPI_Bcast(B_local, n * n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // Per-rank compute throughput: the spread exposes slow nodes
+    matrix_stats_t stats;
+    stats.rank_gflops = bench_reduce_stats(times.local_flops / times.compute / 1e9);
 
-    // Each process computes its portion of C
-    if (world_rank == 0) {
-        printf("Computing matrix multiplication...\n");
+    // Phase statistics across ranks; the slowest rank (max) bounds each phase
+    stats.setup = bench_reduce_stats(times.setup);
+    stats.distribute = bench_reduce_stats(times.distribute);
+    stats.comm = bench_reduce_stats(times.comm);
+    stats.compute = bench_reduce_stats(times.compute);
+    stats.gather = bench_reduce_stats(times.gather);
+    stats.hidden = bench_reduce_stats(times.hidden);
+    stats.io_read = bench_reduce_stats(times.io_read);
+    stats.io_write = bench_reduce_stats(times.io_write);
+    stats.verify = bench_reduce_stats(times.verify);
+    stats.total = bench_reduce_stats(times.total);
+    stats.persist_setup = bench_reduce_stats(times.persist_setup);
+    stats.startup = bench_startup_summarize(&startup);
+    stats.dtlb_misses = bench_reduce_stats((double)times.dtlb_misses);
+    stats.counters = bench_perf_summarize(&times.counters, times.compute, threads,
+                                          times.local_flops);
+    memset(&stats.checkpoint, 0, sizeof(stats.checkpoint));
+    if (config.checkpoint_dir) {
+        stats.checkpoint = bench_ckpt_summarize(&ckpt.io);
     }
-    multiply_matrices(A_local, B_local, C_local, local_rows, n);
-
-    // Gather results back to rank 0
-    if (world_rank == 0) {
-        printf("Gathering results...\n");
+    if (gpu) {
+        stats.device_gemm = bench_reduce_stats(times.device_gemm);
+        stats.device_gflops = bench_reduce_stats(times.device_gemm > 0.0
+                                                 ? times.local_flops / times.device_gemm / 1e9
+                                                 : 0.0);
+        stats.device_bytes = bench_reduce_stats(times.device_bytes);
+        stats.h2d_gbps = h2d_stats;
+        stats.d2h_gbps = d2h_stats;
     }
-    MPI_Gather(C_local, local_rows * n, MPI_DOUBLE,
-               C, local_rows * n, MPI_DOUBLE,
-               0, MPI_COMM_WORLD);
 
-    // Stop timing
-    MPI_Barrier(MPI_COMM_WORLD);
-    end_time = MPI_Wtime();
+    double max_distribute = stats.distribute.max;
+    double max_comm = stats.comm.max;
+    double max_compute = stats.compute.max;
+    double max_gather = stats.gather.max;
+    double max_hidden = stats.hidden.max;
+    double total_time = stats.total.max;
 
     // Print results
     if (world_rank == 0) {
-        if (n <= 10) {
+        if (n <= 10 && C) {
             print_matrix(C, n, n, "Result Matrix C");
         }
 
@@ -200,28 +1695,144 @@ int main(int argc, char** argv) {
         printf("========================================\n");
         printf("Results\n");
         printf("========================================\n");
-        printf("Computation time: %.3f seconds\n", end_time - start_time);
+        if (config.batch) {
+            printf("Algorithm: batch (%d x %d matrices, %s layout)\n", config.batch, n,
+                   batch_layout_name(batch_resolve_layout(config.batch_layout, n)));
+        } else {
+            printf("Algorithm: %s\n", algo_name(config.algo));
+        }
+        printf("Kernel: %s\n", gpu ? "cublas (gpu)" : gemm_kernel_name(config.kernel));
+        printf("Data type: %s\n", gemm_dtype_name(config.dtype));
+        bench_startup_print(&stats.startup);
+        printf("Setup (input generation, not timed): %.3f seconds\n", stats.setup.max);
+        if (iterative(&config)) {
+            printf("Iterations: %d timed after %d warm-up (persistent %s, %.3f ms to create)\n",
+                   config.iterations, config.warmup, iterate_exchange_name(),
+                   1e3 * stats.persist_setup.max);
+            printf("Per iteration (slowest rank): min %.3f / p50 %.3f / p90 %.3f / p99 %.3f"
+                   " / max %.3f ms\n", 1e3 * times.iteration.min, 1e3 * times.iteration.p50,
+                   1e3 * times.iteration.p90, 1e3 * times.iteration.p99,
+                   1e3 * times.iteration.max);
+            printf("First iteration (cold): %.3f ms (%.2fx the median)\n", 1e3 * times.cold,
+                   times.cold / times.iteration.p50);
+        }
+        printf("Computation time: %.3f seconds%s\n", total_time,
+               iterative(&config) ? " (median iteration)" : "");
+        printf("Phase times (slowest rank):\n");
+        if (config.algo == MATRIX_ALGO_PIPELINE) {
+            // Only time blocked in MPI_Wait is exposed; the rest overlapped compute
+            printf("  Distribute (exposed wait): %.3f seconds\n", max_distribute);
+            printf("  Compute: %.3f seconds\n", max_compute);
+            printf("  Gather (exposed wait): %.3f seconds\n", max_gather);
+            printf("  Communication hidden behind compute: %.3f seconds\n", max_hidden);
+            double in_flight = max_hidden + max_distribute + max_gather;
+            if (in_flight > 0.0) {
+                printf("  Overlap: %.1f%% of communication time hidden\n",
+                       100.0 * max_hidden / in_flight);
+            }
+        } else {
+            printf("  Distribute: %.3f seconds\n", max_distribute);
+            if (config.algo == MATRIX_ALGO_SUMMA) {
+                printf("  Panel exchange: %.3f seconds\n", max_comm);
+            }
+            printf("  Compute: %.3f seconds\n", max_compute);
+            printf("  Gather: %.3f seconds\n", max_gather);
+        }
+        if (config.data_dir) {
+            // Aggregate file system bandwidth, bounded by the slowest rank
+            double bytes = (double)n * n * sizeof(double);
+            printf("  Read A/B (MPI-IO): %.3f seconds (%.2f GB/s)\n",
+                   stats.io_read.max, 2.0 * bytes / stats.io_read.max / 1e9);
+            if (config.gather) {
+                printf("  Write C (MPI-IO): %.3f seconds (%.2f GB/s)\n",
+                       stats.io_write.max, bytes / stats.io_write.max / 1e9);
+            }
+        }
+        if (config.checkpoint_dir) {
+            bench_ckpt_print(&stats.checkpoint, ckpt.io.path, "rows of C", max_compute);
+        }
 
         // Calculate FLOPS (2*n^3 operations for matrix multiplication)
-        double flops = 2.0 * n * n * n;
-        double gflops = flops / (end_time - start_time) / 1e9;
+        // End-to-end includes data movement; compute-only isolates node
+        // throughput, so a large gap between the two points at the interconnect
+        double flops = run_flops(&config, world_size, stats.checkpoint.total_restored);
+        double gflops = flops / total_time / 1e9;
+        double compute_gflops = flops / max_compute / 1e9;
         printf("Operations: %.2e FLOPS\n", flops);
         printf("Performance: %.2f GFLOPS\n", gflops);
+        printf("Compute performance: %.2f GFLOPS\n", compute_gflops);
+        if (iterative(&config)) {
+            printf("Steady-state performance: %.2f GFLOPS (p50) / %.2f GFLOPS (p99)\n",
+                   flops / times.iteration.p50 / 1e9, flops / times.iteration.p99 / 1e9);
+        }
+        printf("Per-rank compute: %.2f GFLOPS (slowest) / %.2f GFLOPS (fastest)\n",
+               stats.rank_gflops.min, stats.rank_gflops.max);
+        if (config.counters && stats.counters.ghz.min >= 0.0) {
+            bench_perf_print(&stats.counters, "local GEMM");
+        } else if (config.counters) {
+            printf("Hardware counters: n/a (perf counters unavailable)\n");
+        }
+        // The gap between compute and the DGEMM device time is the cost of
+        // the host-device copies that were not overlapped
+        if (gpu) {
+            printf("GPU DGEMM (device time): %.3f seconds (%.2f GFLOPS per GPU, slowest)\n",
+                   stats.device_gemm.max, stats.device_gflops.min);
+            printf("Host-device copies: %.1f MB per rank, %.3f seconds of compute outside DGEMM\n",
+                   stats.device_bytes.avg / 1e6, max_compute - stats.device_gemm.max);
+        }
+        // Ranks finishing early idle at the final barrier; 1.00 is perfect balance
+        if (stats.compute.avg > 0.0) {
+            printf("Compute imbalance (max/avg): %.2f\n", max_compute / stats.compute.avg);
+        }
+        printf("Huge-page coverage: %.0f%% of buffer bytes (lowest rank)\n",
+               100.0 * times.huge_share);
+        if (stats.dtlb_misses.min >= 0.0) {
+            printf("dTLB load misses: %.3g per rank (avg) / %.3g (max)\n",
+                   stats.dtlb_misses.avg, stats.dtlb_misses.max);
+        } else {
+            printf("dTLB load misses: n/a (perf counters unavailable)\n");
+        }
+        if (config.verify) {
+            printf("Verification: %s (Freivalds residual %.3g, tolerance %.3g, %.3f seconds)\n",
+                   times.check.passed ? "PASSED" : "FAILED", times.check.residual,
+                   times.check.tolerance, stats.verify.max);
+        }
         printf("========================================\n");
     }
 
+    if (config.json) {
+        char *hosts = bench_gather_hosts();
+        if (world_rank == 0) {
+            write_json_record(&config, world_size, threads, isa_counts, &stats,
+                              &times, gpu, config.checkpoint_dir ? ckpt.io.path : NULL, hosts);
+            free(hosts);
+        }
+    }
+
     // Cleanup
-    free(A_local);
-    free(B_local);
-    free(C_local);
+    if (gpu) {
+        gemm_gpu_close(gpu);
+    }
+    if (config.algo == MATRIX_ALGO_SUMMA) {
+        summa_grid_free(&grid);
+    } else if (!config.batch) {
+        partition_free(&part);
+    }
+    if (config.node_aware) {
+        bench_node_free(&node);
+    }
+    // The run completed, nothing left to resume
+    if (config.checkpoint_dir) {
+        checkpoint_close(&ckpt, 1);
+    }
     if (world_rank == 0) {
-        free(A);
-        free(B);
-        free(C);
+        bench_free(A);
+        bench_free(B);
+        bench_free(C);
     }
 
     // Finalize MPI
     MPI_Finalize();
 
-    return 0;
+    return config.verify && !times.check.passed ? 1 : 0;
 }
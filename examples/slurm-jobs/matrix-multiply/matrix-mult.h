@@ -0,0 +1,73 @@
+/*
+ * Shared definitions for the matrix-multiply example
+ *
+ * Types used by the driver (matrix-mult.c) and the distributed algorithms
+ * (1D row decomposition in matrix-mult.c, SUMMA in summa.c, pipelined 1D
+ * in pipeline.c).
+ */
+
+#ifndef MATRIX_MULT_H
+#define MATRIX_MULT_H
+
+#include "bench-perf.h"
+#include "matrix-verify.h"
+
+// Distributed multiplication algorithm
+typedef enum {
+    MATRIX_ALGO_1D = 0,     // Row blocks of A, full B broadcast to every rank
+    MATRIX_ALGO_SUMMA,      // 2D process grid, A/B panels along rows/columns
+    MATRIX_ALGO_PIPELINE    // 1D with B column panels overlapped with compute
+} matrix_algo_t;
+
+// Per-rank phase timings (seconds) and work done by one run
+typedef struct {
+    double setup;           // Generating A/B (untimed, before the start barrier)
+    double distribute;      // Moving A/B from rank 0 to the ranks that own them
+    double comm;            // Communication inside the multiply (SUMMA panels)
+    double compute;         // Local GEMM
+    double gather;          // Collecting C on rank 0
+    double hidden;          // Communication overlapped with compute (pipeline)
+    double io_read;         // Reading A/B from --data-dir files (part of distribute)
+    double io_write;        // Writing C to --data-dir (the gather phase)
+    double verify;          // Freivalds check of C (untimed, after the run)
+    double device_gemm;     // DGEMM time on the GPU (device events; part
+                            // of compute, which adds the copies)
+    double device_bytes;    // Bytes copied between host and GPU
+    double total;           // End-to-end, barrier to barrier
+    double local_flops;     // Floating-point operations done by this rank
+    double numa_local;      // Lowest share of a rank's buffer pages on its
+                            // threads' NUMA nodes (rank 0; < 0 if unknown)
+    double huge_share;      // Lowest share of a rank's buffer bytes on huge
+                            // pages (rank 0)
+    long long dtlb_misses;  // dTLB load misses in the timed region (< 0 if
+                            // counters are unavailable)
+    bench_perf_sample_t counters;   // Compute profile over the local GEMM
+                                    // calls (--counters)
+    matrix_verify_result_t check;   // Freivalds result (same on every rank)
+    bench_percentiles_t iteration;  // Timed iterations of the slowest rank
+                                    // (--iterations/--warmup; count 0 otherwise)
+    double cold;            // First iteration, warm-up or timed (slowest rank)
+    double persist_setup;   // Creating the persistent requests (untimed)
+} matrix_times_t;
+
+// Size of block `index` when n items are split into `parts` near-equal
+// blocks (the first n % parts blocks get one extra item)
+static inline int block_size(int n, int parts, int index) {
+    return n / parts + (index < n % parts ? 1 : 0);
+}
+
+// Global offset of block `index` in the same split
+static inline int block_offset(int n, int parts, int index) {
+    int rem = n % parts;
+    return index * (n / parts) + (index < rem ? index : rem);
+}
+
+// Block index owning global item k in the same split
+static inline int block_owner(int n, int parts, int k) {
+    int q = n / parts;
+    int rem = n % parts;
+    int split = rem * (q + 1);
+    return k < split ? k / (q + 1) : rem + (k - split) / q;
+}
+
+#endif /* MATRIX_MULT_H */
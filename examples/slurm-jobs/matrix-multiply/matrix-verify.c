@@ -0,0 +1,138 @@
+/*
+ * Distributed result verification for the matrix-multiply example
+ */
+
+#include "matrix-verify.h"
+
+#include <float.h>
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "matrix-init.h"
+
+// Rounding tolerance factor: the residual of row i is compared with
+// VERIFY_TOLERANCE · epsilon · sqrt(n) · ||C_i||₂
+#define VERIFY_TOLERANCE 64.0
+
+matrix_verify_result_t matrix_verify(int n, uint64_t seed,
+                                     const matrix_block_t *a, int num_a,
+                                     const matrix_block_t *b, int num_b,
+                                     const matrix_block_t *c, int num_c) {
+    return matrix_verify_eps(n, seed, DBL_EPSILON, a, num_a, b, num_b, c, num_c);
+}
+
+matrix_verify_result_t matrix_verify_eps(int n, uint64_t seed, double epsilon,
+                                         const matrix_block_t *a, int num_a,
+                                         const matrix_block_t *b, int num_b,
+                                         const matrix_block_t *c, int num_c) {
+    // B r for every probe (probe-major, n each), then per row i every
+    // probe's (C r)_i - (A (B r))_i followed by Σ_j C_ij²
+    size_t width = MATRIX_VERIFY_PROBES + 1;
+    double *Br = calloc(MATRIX_VERIFY_PROBES * (size_t)n, sizeof(double));
+    double *rows = calloc(width * (size_t)n, sizeof(double));
+    double *r = malloc(MATRIX_VERIFY_PROBES * (size_t)n * sizeof(double));
+    matrix_verify_result_t result;
+
+    if (!Br || !rows || !r) {
+        printf("Verification allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int p = 0; p < MATRIX_VERIFY_PROBES; p++) {
+        matrix_init_signs(MATRIX_SIGN_STREAM_BASE + 2 * p + 1, seed, n, r + (size_t)p * n);
+    }
+
+    for (int i = 0; i < num_b; i++) {
+        const matrix_block_t *blk = &b[i];
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < blk->rows; row++) {
+            const double *src = blk->data + (size_t)row * blk->ld;
+            for (int p = 0; p < MATRIX_VERIFY_PROBES; p++) {
+                const double *rp = r + (size_t)p * n + blk->col0;
+                double dot = 0.0;
+                for (int col = 0; col < blk->cols; col++) {
+                    dot += src[col] * rp[col];
+                }
+                Br[(size_t)p * n + blk->row0 + row] += dot;
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, Br, MATRIX_VERIFY_PROBES * n, MPI_DOUBLE, MPI_SUM,
+                  MPI_COMM_WORLD);
+
+    // Blocks of one matrix never overlap, so rows of a block are disjoint
+    for (int i = 0; i < num_c; i++) {
+        const matrix_block_t *blk = &c[i];
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < blk->rows; row++) {
+            const double *src = blk->data + (size_t)row * blk->ld;
+            double *dst = rows + width * (size_t)(blk->row0 + row);
+            double norm = 0.0;
+            for (int col = 0; col < blk->cols; col++) {
+                norm += src[col] * src[col];
+            }
+            for (int p = 0; p < MATRIX_VERIFY_PROBES; p++) {
+                const double *rp = r + (size_t)p * n + blk->col0;
+                double dot = 0.0;
+                for (int col = 0; col < blk->cols; col++) {
+                    dot += src[col] * rp[col];
+                }
+                dst[p] += dot;
+            }
+            dst[MATRIX_VERIFY_PROBES] += norm;
+        }
+    }
+    for (int i = 0; i < num_a; i++) {
+        const matrix_block_t *blk = &a[i];
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < blk->rows; row++) {
+            const double *src = blk->data + (size_t)row * blk->ld;
+            double *dst = rows + width * (size_t)(blk->row0 + row);
+            for (int p = 0; p < MATRIX_VERIFY_PROBES; p++) {
+                const double *Brp = Br + (size_t)p * n + blk->col0;
+                double dot = 0.0;
+                for (int col = 0; col < blk->cols; col++) {
+                    dot += src[col] * Brp[col];
+                }
+                dst[p] -= dot;
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, rows, (int)(width * n), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    // Report the row and probe closest to (or furthest past) its bound
+    double worst = -1.0;
+    result.residual = 0.0;
+    result.tolerance = 0.0;
+    for (int i = 0; i < n; i++) {
+        const double *row = rows + width * (size_t)i;
+        double tolerance = VERIFY_TOLERANCE * epsilon
+                           * sqrt((double)n * row[MATRIX_VERIFY_PROBES]);
+        for (int p = 0; p < MATRIX_VERIFY_PROBES; p++) {
+            double residual = fabs(row[p]);
+            double ratio = tolerance > 0.0 ? residual / tolerance
+                                           : (residual > 0.0 ? INFINITY : 0.0);
+            if (ratio > worst) {
+                worst = ratio;
+                result.residual = residual;
+                result.tolerance = tolerance;
+            }
+        }
+    }
+    result.passed = worst <= 1.0;
+
+    free(Br);
+    free(rows);
+    free(r);
+    return result;
+}
+
+int matrix_verify_fault(int n, const matrix_block_t *c, size_t *offset) {
+    int row = n / 2 - c->row0, col = n / 2 - c->col0;
+    if (row < 0 || row >= c->rows || col < 0 || col >= c->cols) {
+        return 0;
+    }
+    *offset = (size_t)row * c->ld + col;
+    return 1;
+}
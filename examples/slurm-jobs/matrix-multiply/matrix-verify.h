@@ -0,0 +1,69 @@
+/*
+ * Distributed result verification for the matrix-multiply example
+ *
+ * Freivalds check of C = A × B that never gathers C: for a random ±1
+ * vector r, the vector C r must equal A (B r) row by row. Every rank adds
+ * the contributions of the B blocks it owns to B r, a first MPI_Allreduce
+ * sums it, and then every rank adds the row partials of (C r)_i -
+ * (A (B r))_i and of Σ_j C_ij² from its C and A blocks; a second
+ * MPI_Allreduce completes them (1d and pipeline hold whole rows, SUMMA
+ * tiles contribute partial rows). The check costs O(n²/P) flops and O(n)
+ * communication per rank, whatever the algorithm.
+ *
+ * Each row is compared with its own rounding bound. The element errors
+ * e_ij of a dot product of length n are of order epsilon · sqrt(n) ·
+ * |C_ij|, and their ±r_j sum has spread ||e_i||₂, so the bound is
+ * epsilon · sqrt(n) · ||C_i||₂ (times a safety factor): it grows like
+ * epsilon · n times a typical element, and a wrong element is caught long
+ * before its error reaches the element itself, in low precision as well.
+ * Errors that cancel within one row of one probe survive it with
+ * probability at most 1/2; MATRIX_VERIFY_PROBES independent probes share
+ * the reductions and make that vanishingly unlikely.
+ */
+
+#ifndef MATRIX_VERIFY_H
+#define MATRIX_VERIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MATRIX_VERIFY_PROBES 4
+
+// A rows×cols block at global (row0, col0), stored with leading dimension ld
+typedef struct {
+    const double *data;
+    int row0;
+    int rows;
+    int col0;
+    int cols;
+    int ld;
+} matrix_block_t;
+
+typedef struct {
+    double residual;        // |(C r)_i - (A (B r))_i| of the worst row and probe
+    double tolerance;       // Rounding bound of that row
+    int passed;             // Every row within its bound
+} matrix_verify_result_t;
+
+// Check C = A × B (n×n) from this rank's blocks. Together the ranks must
+// provide every element of A, B and C exactly once. Collective over
+// MPI_COMM_WORLD; the result is the same on every rank.
+matrix_verify_result_t matrix_verify(int n, uint64_t seed,
+                                     const matrix_block_t *a, int num_a,
+                                     const matrix_block_t *b, int num_b,
+                                     const matrix_block_t *c, int num_c);
+
+// Same check for a C computed in lower precision: the tolerance scales with
+// epsilon, the unit roundoff of the accumulation (DBL_EPSILON above), and
+// the blocks hold A and B as the multiply saw them, rounded to its dtype
+matrix_verify_result_t matrix_verify_eps(int n, uint64_t seed, double epsilon,
+                                         const matrix_block_t *a, int num_a,
+                                         const matrix_block_t *b, int num_b,
+                                         const matrix_block_t *c, int num_c);
+
+// Fault injection for testing the check (--inject-error): returns 1 and the
+// offset of element (n / 2, n / 2) of C in c->data if block c holds it, for
+// the caller to corrupt before verifying; 0 otherwise
+int matrix_verify_fault(int n, const matrix_block_t *c, size_t *offset);
+
+#endif /* MATRIX_VERIFY_H */
@@ -0,0 +1,201 @@
+/*
+ * Mixed-precision 1D matrix multiplication (--dtype=f32|bf16)
+ */
+
+#include "mixed.h"
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+#include "matrix-verify.h"
+
+// First touch of a rows×cols block of `size`-byte elements by the compute
+// threads (whole doubles per row; the rest of a row is touched by MPI)
+static void touch_rows(void *buf, int rows, int cols, size_t size) {
+    bench_numa_touch_rows(buf, rows, (int)((size_t)cols * size / sizeof(double)));
+}
+
+// Generate rows [row0, row0 + rows) of matrix `which` in FP64 and round
+// them to dtype in dst (leading dimension n)
+static void init_rows(matrix_id_t which, uint64_t seed, int n, int row0, int rows,
+                      gemm_dtype_t dtype, void *dst) {
+    double *tmp = bench_alloc((size_t)rows * n * sizeof(double));
+    if (!tmp) {
+        printf("Memory allocation failed for input generation\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    matrix_init_block(which, seed, n, row0, rows, 0, n, tmp, n);
+    gemm_lowp_round(dtype, tmp, dst, (size_t)rows * n);
+    bench_free(tmp);
+}
+
+// Block of dtype (or float, for C) elements widened to doubles
+static double *widen_block(gemm_dtype_t dtype, const void *src, size_t count) {
+    double *out = bench_alloc(count * sizeof(double));
+    if (!out) {
+        printf("Verification allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    gemm_lowp_widen(dtype, src, out, count);
+    return out;
+}
+
+void mixed_multiply(int n, gemm_dtype_t dtype, const row_partition_t *part,
+                    matrix_init_t init, uint64_t seed, int gather, int verify,
+                    int inject_error, const double *A, const double *B, double *C,
+                    bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                    matrix_times_t *times) {
+    int world_size, world_rank;
+    size_t esize = gemm_dtype_size(dtype);
+    MPI_Datatype mpi_type = dtype == GEMM_DTYPE_F32 ? MPI_FLOAT : MPI_UINT16_T;
+    double t0, t1;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    int local_rows = part->rows[world_rank];
+    int row0 = part->offsets[world_rank];
+    int *counts = malloc((size_t)world_size * sizeof(int));
+    int *displs = malloc((size_t)world_size * sizeof(int));
+    void *A_local = bench_alloc((size_t)local_rows * n * esize);
+    void *B_local = bench_alloc((size_t)n * n * esize);
+    float *C_local = bench_alloc((size_t)local_rows * n * sizeof(float));
+
+    if (!A_local || !B_local || !C_local || !counts || !displs) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    touch_rows(A_local, local_rows, n, esize);
+    touch_rows(B_local, n, n, esize);
+    touch_rows(C_local, local_rows, n, sizeof(float));
+    for (int r = 0; r < world_size; r++) {
+        counts[r] = part->rows[r] * n;
+        displs[r] = part->offsets[r] * n;
+    }
+
+    // Inputs rounded to dtype before the timed region: own rows of A and B,
+    // or (--init=root) full copies on rank 0 to scatter and broadcast
+    void *A_root = NULL;
+    float *C_root = NULL;
+    double s0 = MPI_Wtime();
+    if (init == MATRIX_INIT_DISTRIBUTED) {
+        init_rows(MATRIX_A, seed, n, row0, local_rows, dtype, A_local);
+        init_rows(MATRIX_B, seed, n, row0, local_rows, dtype,
+                  (char*)B_local + (size_t)row0 * n * esize);
+    } else if (world_rank == 0) {
+        A_root = bench_alloc((size_t)n * n * esize);
+        if (!A_root) {
+            printf("Memory allocation failed for full matrices\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        gemm_lowp_round(dtype, A, A_root, (size_t)n * n);
+        gemm_lowp_round(dtype, B, B_local, (size_t)n * n);
+    }
+    times->setup += MPI_Wtime() - s0;
+    if (gather && world_rank == 0) {
+        C_root = bench_alloc((size_t)n * n * sizeof(float));
+        if (!C_root) {
+            printf("Memory allocation failed for full matrices\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    // Start timing
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    bench_perf_start(tlb);
+
+    t0 = MPI_Wtime();
+    if (init == MATRIX_INIT_DISTRIBUTED) {
+        if (world_rank == 0) {
+            printf("Exchanging row blocks of B (%s)...\n", gemm_dtype_name(dtype));
+        }
+        MPI_Allgatherv(MPI_IN_PLACE, 0, mpi_type, B_local, counts, displs, mpi_type,
+                       MPI_COMM_WORLD);
+    } else {
+        if (world_rank == 0) {
+            printf("Distributing matrix A and broadcasting matrix B (%s)...\n",
+                   gemm_dtype_name(dtype));
+        }
+        MPI_Scatterv(A_root, counts, displs, mpi_type,
+                     A_local, local_rows * n, mpi_type, 0, MPI_COMM_WORLD);
+        MPI_Bcast(B_local, n * n, mpi_type, 0, MPI_COMM_WORLD);
+    }
+    t1 = MPI_Wtime();
+    times->distribute = t1 - t0;
+
+    if (world_rank == 0) {
+        printf("Computing matrix multiplication (%s, FP32 accumulation)...\n",
+               gemm_dtype_name(dtype));
+    }
+    memset(C_local, 0, (size_t)local_rows * n * sizeof(float));
+    bench_perf_profile_resume(profile);
+    gemm_lowp_multiply(dtype, local_rows, n, n, A_local, n, B_local, n, C_local, n);
+    bench_perf_profile_pause(profile);
+    t0 = MPI_Wtime();
+    times->compute = t0 - t1;
+    times->local_flops = 2.0 * local_rows * n * (double)n;
+
+    if (gather) {
+        if (world_rank == 0) {
+            printf("Gathering results...\n");
+        }
+        MPI_Gatherv(C_local, local_rows * n, MPI_FLOAT,
+                    C_root, counts, displs, MPI_FLOAT, 0, MPI_COMM_WORLD);
+    }
+    times->gather = MPI_Wtime() - t0;
+
+    // Stop timing
+    times->dtlb_misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+    times->total = MPI_Wtime() - start_time;
+
+    if (C_root) {
+        gemm_lowp_widen(GEMM_DTYPE_F32, C_root, C, (size_t)n * n);
+    }
+
+    // Freivalds on the rounded inputs, as the multiply saw them
+    if (verify) {
+        if (world_rank == 0) {
+            printf("Verifying result (Freivalds, %d probes)...\n", MATRIX_VERIFY_PROBES);
+        }
+        double v0 = MPI_Wtime();
+        size_t block = (size_t)local_rows * n;
+        double *A_check = widen_block(dtype, A_local, block);
+        double *B_check = widen_block(dtype, (char*)B_local + (size_t)row0 * n * esize, block);
+        double *C_check = widen_block(GEMM_DTYPE_F32, C_local, block);
+        matrix_block_t a_block = {A_check, row0, local_rows, 0, n, n};
+        matrix_block_t b_block = {B_check, row0, local_rows, 0, n, n};
+        matrix_block_t c_block = {C_check, row0, local_rows, 0, n, n};
+        size_t fault;
+        if (inject_error && matrix_verify_fault(n, &c_block, &fault)) {
+            C_check[fault] = -C_check[fault];
+        }
+        times->check = matrix_verify_eps(n, seed, gemm_dtype_epsilon(dtype),
+                                         &a_block, 1, &b_block, 1, &c_block, 1);
+        times->verify = MPI_Wtime() - v0;
+        bench_free(A_check);
+        bench_free(B_check);
+        bench_free(C_check);
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_local", A_local, (size_t)local_rows * n * esize},
+        {"B_local", B_local, (size_t)n * n * esize},
+        {"C_local", C_local, (size_t)local_rows * n * sizeof(float)},
+    };
+    times->numa_local = bench_numa_report(buffers, 3);
+    times->huge_share = bench_alloc_report(buffers, 3, times->dtlb_misses);
+
+    bench_free(A_root);
+    bench_free(C_root);
+    bench_free(A_local);
+    bench_free(B_local);
+    bench_free(C_local);
+    free(counts);
+    free(displs);
+}
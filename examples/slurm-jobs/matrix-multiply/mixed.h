@@ -0,0 +1,37 @@
+/*
+ * Mixed-precision 1D matrix multiplication (--dtype=f32|bf16)
+ *
+ * The --algo=1d decomposition with A and B held and exchanged in the low
+ * precision (MPI_FLOAT or 16-bit words for BF16), so the broadcast of B
+ * moves half or a quarter of the FP64 bytes, and the local multiply done by
+ * gemm_lowp_multiply() with FP32 accumulation into an FP32 C.
+ *
+ * A and B are generated as in FP64 and rounded to the dtype; verification
+ * runs Freivalds on those rounded values widened back to double, with a
+ * tolerance for FP32 accumulation, so it checks the multiply and not the
+ * rounding of the inputs. A gathered C is widened to double on rank 0.
+ */
+
+#ifndef MIXED_H
+#define MIXED_H
+
+#include "bench-perf.h"
+#include "gemm-lowp.h"
+#include "matrix-init.h"
+#include "matrix-mult.h"
+#include "partition.h"
+
+// C = A × B on MPI_COMM_WORLD in dtype (GEMM_DTYPE_F32 or GEMM_DTYPE_BF16)
+// with rows of A/C split as in part. A, B and C (doubles) are significant
+// on rank 0 only, as for run_1d(): with MATRIX_INIT_DISTRIBUTED each rank
+// generates its rows instead (A and B are unused), without `gather` C is
+// unused. inject_error negates one element of the checked C (see
+// matrix_verify_fault()). Fills the same fields of times as run_1d() on
+// the CPU.
+void mixed_multiply(int n, gemm_dtype_t dtype, const row_partition_t *part,
+                    matrix_init_t init, uint64_t seed, int gather, int verify,
+                    int inject_error, const double *A, const double *B, double *C,
+                    bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                    matrix_times_t *times);
+
+#endif /* MIXED_H */
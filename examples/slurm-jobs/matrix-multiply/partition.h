@@ -0,0 +1,46 @@
+/*
+ * Row partitions for the 1D matrix-multiply algorithms
+ *
+ * --algo=1d and --algo=pipeline give every rank a contiguous block of rows
+ * of A and C. Blocks need not be equal: an even split hands the first
+ * n % P ranks one extra row, and a throughput split sizes each block from a
+ * short warm-up GEMM so slower nodes (older CPUs, fewer threads, a weaker
+ * ISA path) get proportionally fewer rows. Blocks are moved with
+ * MPI_Scatterv/MPI_Gatherv, so any n >= P works.
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "gemm-kernels.h"
+
+// How rows are assigned to ranks
+typedef enum {
+    PARTITION_EVEN = 0,     // Near-equal blocks (sizes differ by at most one)
+    PARTITION_THROUGHPUT    // Blocks proportional to measured GEMM throughput
+} partition_mode_t;
+
+typedef struct {
+    int parts;              // Number of ranks
+    int *rows;              // Rows owned by each rank
+    int *offsets;           // First global row of each rank
+} row_partition_t;
+
+// Parse "even" / "throughput"; returns 0 on success, -1 if unknown
+int partition_mode_from_name(const char *name, partition_mode_t *mode);
+const char *partition_mode_name(partition_mode_t mode);
+
+// Split n rows into near-equal blocks
+void partition_even(int n, int parts, row_partition_t *part);
+
+// Split n rows proportionally to weights[0..parts-1]; every rank keeps at
+// least one row so no rank sits out the collectives with an empty block
+void partition_weighted(int n, int parts, const double *weights, row_partition_t *part);
+
+void partition_free(row_partition_t *part);
+
+// Local GEMM throughput (GFLOPS) of this rank for rows of an n-wide
+// problem, from a short untimed warm-up with the given kernel
+double partition_measure_gflops(gemm_kernel_t kernel, int n);
+
+#endif /* PARTITION_H */
@@ -0,0 +1,325 @@
+/*
+ * Pipelined 1D matrix multiplication for the matrix-multiply example
+ */
+
+#include "pipeline.h"
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+#include "matrix-verify.h"
+
+// Rows computed between two MPI progress polls. Most MPI libraries only
+// advance nonblocking collectives inside MPI calls, so the compute loop
+// yields to MPI regularly to keep the next panel moving.
+#define PIPELINE_POLL_ROWS 128
+
+// Nonblocking request and whether its completion has been observed
+typedef struct {
+    MPI_Request request;
+    int done;
+} tracked_request_t;
+
+// Test outstanding requests; returns how many are still in flight
+static int poll_requests(tracked_request_t *reqs, int count) {
+    int pending = 0;
+    for (int i = 0; i < count; i++) {
+        if (reqs[i].done) {
+            continue;
+        }
+        MPI_Test(&reqs[i].request, &reqs[i].done, MPI_STATUS_IGNORE);
+        pending += !reqs[i].done;
+    }
+    return pending;
+}
+
+// Block until a request completes; returns the exposed wait time
+static double wait_request(tracked_request_t *t) {
+    if (t->done) {
+        return 0.0;
+    }
+    double t0 = MPI_Wtime();
+    MPI_Wait(&t->request, MPI_STATUS_IGNORE);
+    t->done = 1;
+    return MPI_Wtime() - t0;
+}
+
+// Datatype for `width` consecutive doubles of one row of an n-wide matrix,
+// resized to the full row so a count of r selects an r×width column slice
+static MPI_Datatype row_slice_type(int n, int width) {
+    MPI_Datatype slice, resized;
+    MPI_Type_contiguous(width, MPI_DOUBLE, &slice);
+    MPI_Type_create_resized(slice, 0, (MPI_Aint)n * sizeof(double), &resized);
+    MPI_Type_commit(&resized);
+    MPI_Type_free(&slice);
+    return resized;
+}
+
+void pipeline_multiply(int n, int panel_width, gemm_kernel_t kernel, gemm_gpu_t *gpu,
+                       const row_partition_t *part, matrix_init_t init, uint64_t seed,
+                       int gather, int verify,
+                       const double *A, const double *B, double *C,
+                       bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                       matrix_times_t *times) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    int local_rows = part->rows[world_rank];
+    int w = panel_width < n ? panel_width : n;
+    int num_panels = (n + w - 1) / w;
+    int last_w = n - (num_panels - 1) * w;
+
+    double *A_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    double *B_ring[2];
+    B_ring[0] = bench_alloc((size_t)n * w * sizeof(double));
+    B_ring[1] = bench_alloc((size_t)n * w * sizeof(double));
+    // C slices are stored panel after panel, each local_rows × width contiguous
+    double *C_local = bench_alloc((size_t)local_rows * n * sizeof(double));
+    tracked_request_t *b_reqs = malloc((size_t)num_panels * sizeof(tracked_request_t));
+    tracked_request_t *c_reqs = malloc((size_t)num_panels * sizeof(tracked_request_t));
+    tracked_request_t a_req;
+    // A moves in doubles; C slices move in row-slice units, so the partition
+    // rows/offsets serve directly as their counts/displacements
+    int *a_counts = malloc((size_t)world_size * sizeof(int));
+    int *a_displs = malloc((size_t)world_size * sizeof(int));
+
+    if (!A_local || !B_ring[0] || !B_ring[1] || !C_local || !b_reqs || !c_reqs
+        || !a_counts || !a_displs) {
+        printf("Rank %d: Memory allocation failed\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int r = 0; r < world_size; r++) {
+        a_counts[r] = part->rows[r] * n;
+        a_displs[r] = part->offsets[r] * n;
+    }
+
+    // First touch by the compute threads, before MPI writes into the buffers
+    bench_numa_touch_rows(A_local, local_rows, n);
+    bench_numa_touch_rows(B_ring[0], n, w);
+    bench_numa_touch_rows(B_ring[1], n, w);
+    for (int p = 0; p < num_panels; p++) {
+        bench_numa_touch_rows(C_local + (size_t)local_rows * p * w, local_rows,
+                              p == num_panels - 1 ? last_w : w);
+    }
+
+    // Distributed initialization: own rows of A are generated in place
+    if (init == MATRIX_INIT_DISTRIBUTED) {
+        double s0 = MPI_Wtime();
+        matrix_init_block(MATRIX_A, seed, n, part->offsets[world_rank], local_rows, 0, n,
+                          A_local, n);
+        times->setup += MPI_Wtime() - s0;
+    }
+
+    // GPU: page-lock the host buffers in place for asynchronous copies and
+    // keep A, one B panel and C on the device
+    double *A_dev = NULL, *B_dev = NULL, *C_dev = NULL;
+    int a_uploaded = 0;
+    if (gpu) {
+        void *pinned[] = {A_local, B_ring[0], B_ring[1], C_local, (void*)B};
+        size_t pinned_bytes[] = {(size_t)local_rows * n * sizeof(double),
+                                 (size_t)n * w * sizeof(double), (size_t)n * w * sizeof(double),
+                                 (size_t)local_rows * n * sizeof(double),
+                                 world_rank == 0 ? (size_t)n * n * sizeof(double) : 0};
+        for (int i = 0; i < 5; i++) {
+            if (gemm_gpu_pin(pinned[i], pinned_bytes[i]) != 0) {
+                printf("Rank %d: Warning: could not pin host buffers (%s)\n",
+                       world_rank, gemm_gpu_error());
+                break;
+            }
+        }
+        A_dev = gemm_gpu_alloc((size_t)local_rows * n);
+        B_dev = gemm_gpu_alloc((size_t)n * w);
+        C_dev = gemm_gpu_alloc((size_t)local_rows * n);
+        if (!A_dev || !B_dev || !C_dev) {
+            printf("Rank %d: GPU memory allocation failed (%s)\n", world_rank, gemm_gpu_error());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    // At most two panel widths exist: w for all panels, last_w for the tail
+    MPI_Datatype slice_full = row_slice_type(n, w);
+    MPI_Datatype slice_last = row_slice_type(n, last_w);
+
+    double exposed_ab = 0.0, exposed_c = 0.0, hidden = 0.0, compute = 0.0;
+
+    // Start timing
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    bench_perf_start(tlb);
+
+    a_req.done = (init == MATRIX_INIT_DISTRIBUTED);
+    if (!a_req.done) {
+        MPI_Iscatterv(A, a_counts, a_displs, MPI_DOUBLE, A_local, local_rows * n, MPI_DOUBLE,
+                      0, MPI_COMM_WORLD, &a_req.request);
+    }
+
+    for (int k = 0; k <= num_panels; k++) {
+        // Post panel k (rank 0 sends straight out of B)
+        if (k < num_panels) {
+            int width = (k == num_panels - 1) ? last_w : w;
+            MPI_Datatype slice = (width == w) ? slice_full : slice_last;
+            b_reqs[k].done = 0;
+            if (world_rank == 0) {
+                MPI_Ibcast((void*)(B + (size_t)k * w), n, slice, 0, MPI_COMM_WORLD,
+                           &b_reqs[k].request);
+            } else {
+                MPI_Ibcast(B_ring[k % 2], n * width, MPI_DOUBLE, 0, MPI_COMM_WORLD,
+                           &b_reqs[k].request);
+            }
+        }
+        if (k == 0) {
+            continue;
+        }
+
+        // Compute panel p = k - 1 while panel k is in flight
+        int p = k - 1;
+        int width = (p == num_panels - 1) ? last_w : w;
+        const double *B_p = (world_rank == 0) ? B + (size_t)p * w : B_ring[p % 2];
+        int ldb = (world_rank == 0) ? n : width;
+        double *C_p = C_local + (size_t)local_rows * p * w;
+
+        exposed_ab += wait_request(&a_req);
+        exposed_ab += wait_request(&b_reqs[p]);
+
+        // Compute time spent while any transfer is still pending is
+        // communication latency hidden behind compute
+        int pending = poll_requests(b_reqs, k < num_panels ? k + 1 : num_panels)
+                      + poll_requests(c_reqs, p);
+        if (gpu) {
+            // Queue the copies and the DGEMM, then poll MPI until the
+            // stream drains; the C slice is on the host before its gather
+            double t0 = MPI_Wtime();
+            double *C_dev_p = C_dev + (size_t)local_rows * p * w;
+            if ((!a_uploaded && gemm_gpu_upload(gpu, A_dev, n, A_local, n, local_rows, n) != 0)
+                || gemm_gpu_upload(gpu, B_dev, width, B_p, ldb, n, width) != 0
+                || gemm_gpu_multiply(gpu, local_rows, width, n, A_dev, n, B_dev, width,
+                                     C_dev_p, width) != 0
+                || gemm_gpu_download(gpu, C_p, width, C_dev_p, width, local_rows, width) != 0) {
+                printf("Rank %d: GPU multiply failed (%s)\n", world_rank, gemm_gpu_error());
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            a_uploaded = 1;
+            for (;;) {
+                int idle = gemm_gpu_idle(gpu);
+                if (idle < 0) {
+                    printf("Rank %d: GPU multiply failed (%s)\n", world_rank, gemm_gpu_error());
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+                double t = MPI_Wtime();
+                compute += t - t0;
+                if (pending) {
+                    hidden += t - t0;
+                }
+                t0 = t;
+                if (idle) {
+                    break;
+                }
+                pending = poll_requests(b_reqs, k < num_panels ? k + 1 : num_panels)
+                          + poll_requests(c_reqs, p);
+            }
+        } else {
+            for (int r = 0; r < local_rows; r += PIPELINE_POLL_ROWS) {
+                int rows = local_rows - r < PIPELINE_POLL_ROWS ? local_rows - r : PIPELINE_POLL_ROWS;
+                double t0 = MPI_Wtime();
+                bench_perf_profile_resume(profile);
+                gemm_multiply(kernel, rows, width, n, A_local + (size_t)r * n, n,
+                              B_p, ldb, C_p + (size_t)r * width, width);
+                bench_perf_profile_pause(profile);
+                double dt = MPI_Wtime() - t0;
+                compute += dt;
+                if (pending) {
+                    hidden += dt;
+                }
+                pending = poll_requests(b_reqs, k < num_panels ? k + 1 : num_panels)
+                          + poll_requests(c_reqs, p);
+            }
+        }
+
+        // Stream this C slice back to rank 0
+        MPI_Datatype slice = (width == w) ? slice_full : slice_last;
+        c_reqs[p].done = !gather;
+        if (gather) {
+            MPI_Igatherv(C_p, local_rows * width, MPI_DOUBLE,
+                         C ? C + (size_t)p * w : NULL, part->rows, part->offsets, slice,
+                         0, MPI_COMM_WORLD, &c_reqs[p].request);
+        }
+    }
+
+    for (int p = 0; p < num_panels; p++) {
+        exposed_c += wait_request(&c_reqs[p]);
+    }
+
+    // Stop timing
+    times->dtlb_misses = bench_perf_stop(tlb);
+    MPI_Barrier(MPI_COMM_WORLD);
+    times->total = MPI_Wtime() - start_time;
+    times->distribute = exposed_ab;
+    times->compute = compute;
+    times->gather = exposed_c;
+    times->hidden = hidden;
+    times->local_flops = 2.0 * local_rows * n * (double)n;
+    if (gpu) {
+        times->device_gemm = gpu->gemm_seconds;
+        times->device_bytes = gpu->bytes_h2d + gpu->bytes_d2h;
+    }
+
+    // Check the C slices where they are; rank 0 alone contributes B
+    if (verify) {
+        int row0 = part->offsets[world_rank];
+        matrix_block_t a_block = {A_local, row0, local_rows, 0, n, n};
+        matrix_block_t b_block = {B, 0, n, 0, n, n};
+        matrix_block_t *c_blocks = malloc((size_t)num_panels * sizeof(matrix_block_t));
+        if (!c_blocks) {
+            printf("Rank %d: Memory allocation failed\n", world_rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (int p = 0; p < num_panels; p++) {
+            int width = (p == num_panels - 1) ? last_w : w;
+            c_blocks[p] = (matrix_block_t){C_local + (size_t)local_rows * p * w,
+                                           row0, local_rows, p * w, width, width};
+        }
+        double v0 = MPI_Wtime();
+        times->check = matrix_verify(n, seed, &a_block, 1, &b_block, world_rank == 0,
+                                     c_blocks, num_panels);
+        times->verify = MPI_Wtime() - v0;
+        free(c_blocks);
+    }
+
+    bench_numa_buffer_t buffers[] = {
+        {"A_local", A_local, (size_t)local_rows * n * sizeof(double)},
+        {"B_panel0", B_ring[0], (size_t)n * w * sizeof(double)},
+        {"B_panel1", B_ring[1], (size_t)n * w * sizeof(double)},
+        {"C_local", C_local, (size_t)local_rows * n * sizeof(double)},
+    };
+    times->numa_local = bench_numa_report(buffers, 4);
+    times->huge_share = bench_alloc_report(buffers, 4, times->dtlb_misses);
+
+    if (gpu) {
+        gemm_gpu_free(A_dev);
+        gemm_gpu_free(B_dev);
+        gemm_gpu_free(C_dev);
+        gemm_gpu_unpin(A_local);
+        gemm_gpu_unpin(B_ring[0]);
+        gemm_gpu_unpin(B_ring[1]);
+        gemm_gpu_unpin(C_local);
+        if (world_rank == 0) {
+            gemm_gpu_unpin((void*)B);
+        }
+    }
+    MPI_Type_free(&slice_full);
+    MPI_Type_free(&slice_last);
+    bench_free(A_local);
+    bench_free(B_ring[0]);
+    bench_free(B_ring[1]);
+    bench_free(C_local);
+    free(b_reqs);
+    free(c_reqs);
+    free(a_counts);
+    free(a_displs);
+}
@@ -0,0 +1,53 @@
+/*
+ * Pipelined 1D matrix multiplication with nonblocking collectives
+ *
+ * Same decomposition as --algo=1d (row blocks of A and C per rank, all of B
+ * needed everywhere), but B travels as column panels with MPI_Ibcast and
+ * C column slices stream back with MPI_Igatherv:
+ *
+ *   post Iscatterv(A), Ibcast(B panel 0)
+ *   for each panel k:
+ *     wait B panel k; post Ibcast(B panel k+1)
+ *     C(:, k) = A_local × B(:, k)   (polling MPI between row chunks)
+ *     post Igatherv(C(:, k))
+ *   wait all C slices
+ *
+ * B is held in a two-panel ring, so each rank needs 2·n·w doubles for B
+ * instead of n². Communication still in flight while computing counts as
+ * hidden; time blocked in MPI_Wait counts as exposed.
+ *
+ * On a GPU (--device=gpu) each panel is copied to the device, multiplied
+ * with cuBLAS and its C slice copied back on the GPU's stream while the
+ * host keeps polling the MPI requests, so the next B panel and the
+ * previous C slices move during the device work.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "bench-perf.h"
+#include "gemm-gpu.h"
+#include "gemm-kernels.h"
+#include "matrix-init.h"
+#include "matrix-mult.h"
+#include "partition.h"
+
+// C = A × B on MPI_COMM_WORLD with rows of A/C split as in part.
+// A, B and C are significant on rank 0 only; with MATRIX_INIT_DISTRIBUTED
+// each rank generates its rows of A from seed instead (A is unused).
+// Fills distribute (exposed A/B wait), compute, gather (exposed C wait)
+// and hidden (communication overlapped with compute) in times, and
+// dtlb_misses from tlb over the timed region; profile counts the CPU GEMM
+// calls only. Without `gather` the C
+// slices stay on their ranks (C is unused); with `verify` the result is
+// checked in place afterwards (times->verify, times->check). With a
+// non-NULL gpu the panels are multiplied on it (kernel is unused) and
+// times->device_gemm/device_bytes are filled.
+void pipeline_multiply(int n, int panel_width, gemm_kernel_t kernel, gemm_gpu_t *gpu,
+                       const row_partition_t *part, matrix_init_t init, uint64_t seed,
+                       int gather, int verify,
+                       const double *A, const double *B, double *C,
+                       bench_perf_counter_t *tlb, bench_perf_profile_t *profile,
+                       matrix_times_t *times);
+
+#endif /* PIPELINE_H */
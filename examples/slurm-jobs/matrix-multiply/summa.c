@@ -0,0 +1,211 @@
+/*
+ * SUMMA distributed matrix multiplication for the matrix-multiply example
+ */
+
+#include "summa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+
+#define SUMMA_TAG_TILE 100
+
+void summa_grid_create(MPI_Comm comm, summa_grid_t *grid) {
+    int size, rank;
+    int periods[2] = {0, 0};
+    int keep_cols[2] = {0, 1};
+    int keep_rows[2] = {1, 0};
+
+    MPI_Comm_size(comm, &size);
+    grid->dims[0] = 0;
+    grid->dims[1] = 0;
+    MPI_Dims_create(size, 2, grid->dims);
+
+    // No reordering: grid rank == parent rank, so rank 0 stays at (0, 0)
+    MPI_Cart_create(comm, 2, grid->dims, periods, 0, &grid->grid_comm);
+    MPI_Comm_rank(grid->grid_comm, &rank);
+    MPI_Cart_coords(grid->grid_comm, rank, 2, grid->coords);
+
+    MPI_Cart_sub(grid->grid_comm, keep_cols, &grid->row_comm);
+    MPI_Cart_sub(grid->grid_comm, keep_rows, &grid->col_comm);
+}
+
+void summa_grid_free(summa_grid_t *grid) {
+    MPI_Comm_free(&grid->row_comm);
+    MPI_Comm_free(&grid->col_comm);
+    MPI_Comm_free(&grid->grid_comm);
+}
+
+int summa_tile_rows(const summa_grid_t *grid, int n) {
+    return block_size(n, grid->dims[0], grid->coords[0]);
+}
+
+int summa_tile_cols(const summa_grid_t *grid, int n) {
+    return block_size(n, grid->dims[1], grid->coords[1]);
+}
+
+// Subarray type selecting the tile of grid rank `rank` inside the full matrix
+static MPI_Datatype tile_type(const summa_grid_t *grid, int n, int rank) {
+    int coords[2];
+    int sizes[2] = {n, n};
+    int subsizes[2];
+    int starts[2];
+    MPI_Datatype type;
+
+    MPI_Cart_coords(grid->grid_comm, rank, 2, coords);
+    for (int d = 0; d < 2; d++) {
+        subsizes[d] = block_size(n, grid->dims[d], coords[d]);
+        starts[d] = block_offset(n, grid->dims[d], coords[d]);
+    }
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+// Copy a rows×cols tile between a strided matrix and a contiguous buffer
+static void copy_tile(int rows, int cols, const double *src, int lds, double *dst, int ldd) {
+    for (int i = 0; i < rows; i++) {
+        memcpy(dst + (size_t)i * ldd, src + (size_t)i * lds, (size_t)cols * sizeof(double));
+    }
+}
+
+void summa_scatter(const summa_grid_t *grid, int n, const double *full, double *tile) {
+    int size, rank;
+    int rows = summa_tile_rows(grid, n);
+    int cols = summa_tile_cols(grid, n);
+
+    MPI_Comm_size(grid->grid_comm, &size);
+    MPI_Comm_rank(grid->grid_comm, &rank);
+
+    if (rank != 0) {
+        MPI_Recv(tile, rows * cols, MPI_DOUBLE, 0, SUMMA_TAG_TILE, grid->grid_comm,
+                 MPI_STATUS_IGNORE);
+        return;
+    }
+
+    MPI_Request *requests = malloc((size_t)size * sizeof(MPI_Request));
+    MPI_Datatype *types = malloc((size_t)size * sizeof(MPI_Datatype));
+    if (!requests || !types) {
+        printf("Rank 0: SUMMA scatter allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int r = 1; r < size; r++) {
+        types[r] = tile_type(grid, n, r);
+        MPI_Isend(full, 1, types[r], r, SUMMA_TAG_TILE, grid->grid_comm, &requests[r - 1]);
+    }
+    copy_tile(rows, cols, full, n, tile, cols);   // Rank 0 owns the (0, 0) tile
+    MPI_Waitall(size - 1, requests, MPI_STATUSES_IGNORE);
+
+    for (int r = 1; r < size; r++) {
+        MPI_Type_free(&types[r]);
+    }
+    free(types);
+    free(requests);
+}
+
+void summa_gather(const summa_grid_t *grid, int n, const double *tile, double *full) {
+    int size, rank;
+    int rows = summa_tile_rows(grid, n);
+    int cols = summa_tile_cols(grid, n);
+
+    MPI_Comm_size(grid->grid_comm, &size);
+    MPI_Comm_rank(grid->grid_comm, &rank);
+
+    if (rank != 0) {
+        MPI_Send(tile, rows * cols, MPI_DOUBLE, 0, SUMMA_TAG_TILE, grid->grid_comm);
+        return;
+    }
+
+    MPI_Request *requests = malloc((size_t)size * sizeof(MPI_Request));
+    MPI_Datatype *types = malloc((size_t)size * sizeof(MPI_Datatype));
+    if (!requests || !types) {
+        printf("Rank 0: SUMMA gather allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int r = 1; r < size; r++) {
+        types[r] = tile_type(grid, n, r);
+        MPI_Irecv(full, 1, types[r], r, SUMMA_TAG_TILE, grid->grid_comm, &requests[r - 1]);
+    }
+    copy_tile(rows, cols, tile, cols, full, n);
+    MPI_Waitall(size - 1, requests, MPI_STATUSES_IGNORE);
+
+    for (int r = 1; r < size; r++) {
+        MPI_Type_free(&types[r]);
+    }
+    free(types);
+    free(requests);
+}
+
+void summa_multiply(const summa_grid_t *grid, int n, int panel_width,
+                    gemm_kernel_t kernel,
+                    const double *A_tile, const double *B_tile, double *C_tile,
+                    bench_perf_profile_t *profile, matrix_times_t *times) {
+    int pr = grid->dims[0];
+    int pc = grid->dims[1];
+    int my_row = grid->coords[0];
+    int my_col = grid->coords[1];
+    int rows = summa_tile_rows(grid, n);
+    int cols = summa_tile_cols(grid, n);
+    // A tile columns follow the pc split, B tile rows follow the pr split
+    int a_col0 = block_offset(n, pc, my_col);
+    int b_row0 = block_offset(n, pr, my_row);
+
+    double *A_panel = bench_alloc((size_t)rows * panel_width * sizeof(double));
+    double *B_panel = bench_alloc((size_t)panel_width * cols * sizeof(double));
+    if (!A_panel || !B_panel) {
+        printf("SUMMA panel allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    bench_numa_touch_rows(C_tile, rows, cols);
+
+    for (int k = 0; k < n;) {
+        // Panel must stay inside one A column block and one B row block
+        int a_owner = block_owner(n, pc, k);
+        int b_owner = block_owner(n, pr, k);
+        int a_end = block_offset(n, pc, a_owner) + block_size(n, pc, a_owner);
+        int b_end = block_offset(n, pr, b_owner) + block_size(n, pr, b_owner);
+        int kb = panel_width;
+        if (a_end - k < kb) {
+            kb = a_end - k;
+        }
+        if (b_end - k < kb) {
+            kb = b_end - k;
+        }
+
+        double t0 = MPI_Wtime();
+
+        // A(:, k:k+kb) along my grid row
+        if (my_col == a_owner) {
+            copy_tile(rows, kb, A_tile + (k - a_col0), cols, A_panel, kb);
+        }
+        MPI_Bcast(A_panel, rows * kb, MPI_DOUBLE, a_owner, grid->row_comm);
+
+        // B(k:k+kb, :) along my grid column; owner's rows are already contiguous
+        const double *B_k = B_panel;
+        if (my_row == b_owner) {
+            B_k = B_tile + (size_t)(k - b_row0) * cols;
+        }
+        MPI_Bcast((void*)B_k, kb * cols, MPI_DOUBLE, b_owner, grid->col_comm);
+
+        double t1 = MPI_Wtime();
+        bench_perf_profile_resume(profile);
+        gemm_multiply(kernel, rows, cols, kb, A_panel, kb, B_k, cols, C_tile, cols);
+        bench_perf_profile_pause(profile);
+        double t2 = MPI_Wtime();
+
+        times->comm += t1 - t0;
+        times->compute += t2 - t1;
+        k += kb;
+    }
+
+    times->local_flops += 2.0 * rows * cols * (double)n;
+
+    bench_free(A_panel);
+    bench_free(B_panel);
+}
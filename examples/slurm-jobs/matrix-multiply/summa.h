@@ -0,0 +1,52 @@
+/*
+ * SUMMA (Scalable Universal Matrix Multiplication Algorithm)
+ *
+ * Ranks form a pr × pc Cartesian grid. A, B and C are split into 2D blocks:
+ * rank (i, j) owns rows block i (of pr) and columns block j (of pc) of each
+ * matrix. For every k-panel, the grid column owning A(:, k) broadcasts it
+ * along process rows and the grid row owning B(k, :) broadcasts it along
+ * process columns; every rank then accumulates C_ij += A_ik × B_kj.
+ *
+ * Memory per rank is O(n²/P) and each panel travels only across one grid
+ * row or column, instead of the full B going to every rank.
+ */
+
+#ifndef SUMMA_H
+#define SUMMA_H
+
+#include <mpi.h>
+
+#include "gemm-kernels.h"
+#include "matrix-mult.h"
+
+typedef struct {
+    MPI_Comm grid_comm;     // 2D Cartesian communicator (same ranks as parent)
+    MPI_Comm row_comm;      // Ranks in my grid row, ordered by column
+    MPI_Comm col_comm;      // Ranks in my grid column, ordered by row
+    int dims[2];            // Grid shape: rows, columns
+    int coords[2];          // My position: row, column
+} summa_grid_t;
+
+// Build the most square pr × pc grid for the communicator's size
+void summa_grid_create(MPI_Comm comm, summa_grid_t *grid);
+void summa_grid_free(summa_grid_t *grid);
+
+// Local tile shape of this rank for an n×n matrix
+int summa_tile_rows(const summa_grid_t *grid, int n);
+int summa_tile_cols(const summa_grid_t *grid, int n);
+
+// Distribute a full n×n matrix held by grid rank 0 into per-rank tiles
+void summa_scatter(const summa_grid_t *grid, int n, const double *full, double *tile);
+
+// Collect per-rank tiles into a full n×n matrix on grid rank 0
+void summa_gather(const summa_grid_t *grid, int n, const double *tile, double *full);
+
+// C_tile = A × B using k-panels of at most panel_width columns.
+// Adds panel broadcast time to times->comm and GEMM time to times->compute;
+// profile counts the GEMM calls only.
+void summa_multiply(const summa_grid_t *grid, int n, int panel_width,
+                    gemm_kernel_t kernel,
+                    const double *A_tile, const double *B_tile, double *C_tile,
+                    bench_perf_profile_t *profile, matrix_times_t *times);
+
+#endif /* SUMMA_H */
@@ -0,0 +1,167 @@
+/*
+ * Fault-tolerant sampling for the pi-calculation example
+ */
+
+#include "pi-ft.h"
+
+#include <mpi.h>
+#if defined(OPEN_MPI)
+#include <mpi-ext.h>
+#endif
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pi-sampler.h"
+
+// ULFM: the ftmpi extension of Open MPI 5, built into MPICH
+#if defined(OMPI_HAVE_MPI_EXT_FTMPI) || defined(MPIX_ERR_PROC_FAILED)
+#define PI_HAVE_ULFM 1
+#else
+#define PI_HAVE_ULFM 0
+#endif
+
+// The round of fail_rank's suicide: after one agreed round, so there is
+// kept work before the failure and lost work in it
+#define PI_FAIL_ROUND 1
+
+int pi_ft_available(void) {
+    return PI_HAVE_ULFM;
+}
+
+// Same verdict on every live rank: did all of them complete the reduction?
+static int round_agreed(MPI_Comm comm, int err) {
+#if PI_HAVE_ULFM
+    int flag = err == MPI_SUCCESS;
+    if (!flag) {
+        MPIX_Comm_revoke(comm);     // Release the ranks still inside it
+    }
+    err = MPIX_Comm_agree(comm, &flag);
+    return err == MPI_SUCCESS && flag;
+#else
+    (void)comm;
+    return err == MPI_SUCCESS;
+#endif
+}
+
+// Replace comm by its live ranks
+static void shrink(MPI_Comm *comm) {
+#if PI_HAVE_ULFM
+    MPI_Comm live;
+    int rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPIX_Comm_revoke(*comm);
+    if (MPIX_Comm_shrink(*comm, &live) != MPI_SUCCESS) {
+        printf("Rank %d: Shrinking the communicator failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Comm_set_errhandler(live, MPI_ERRORS_RETURN);
+    MPI_Comm_free(comm);
+    *comm = live;
+#else
+    (void)comm;
+    printf("Collective failed without ULFM to recover from it\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+}
+
+static long long chunk_count(long long index, long long chunk, long long total_samples) {
+    long long first = index * chunk;
+    return total_samples - first < chunk ? total_samples - first : chunk;
+}
+
+void pi_ft_run(long long total_samples, long long chunk, uint64_t seed, int fail_rank,
+               pi_work_stats_t *stats, pi_ft_result_t *result, MPI_Comm *survivors) {
+    int world_size, world_rank;
+    MPI_Comm comm;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    memset(stats, 0, sizeof(*stats));
+    memset(result, 0, sizeof(*result));
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+    MPI_Comm_set_errhandler(comm, MPI_ERRORS_RETURN);
+
+    // Every failed rank requeues at most one chunk, so world_size entries
+    // hold all of them; round slots are indexed by the round's ranks
+    long long num_chunks = (total_samples + chunk - 1) / chunk;
+    long long next = 0;             // First chunk never handed out
+    int head = 0, tail = 0;
+    long long *requeued = malloc((size_t)world_size * sizeof(long long));
+    long long *slots = malloc((size_t)world_size * sizeof(long long));
+    long long *mine = malloc((size_t)world_size * sizeof(long long));
+    long long *drawn = malloc((size_t)world_size * sizeof(long long));
+    if (!requeued || !slots || !mine || !drawn) {
+        printf("Rank %d: Memory allocation failed for the chunk rounds\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    while (next < num_chunks || head < tail) {
+        int size, rank;
+        MPI_Comm_size(comm, &size);
+        MPI_Comm_rank(comm, &rank);
+
+        // The same on every live rank: requeued chunks first, then new ones
+        for (int j = 0; j < size; j++) {
+            slots[j] = head < tail ? requeued[head++] : next < num_chunks ? next++ : -1;
+        }
+
+        // hits + 1 in this rank's slot, so 0 marks a chunk nobody reported
+        memset(mine, 0, (size_t)size * sizeof(long long));
+        if (slots[rank] >= 0) {
+            long long count = chunk_count(slots[rank], chunk, total_samples);
+            double t0 = MPI_Wtime();
+            mine[rank] = pi_count_hits(seed, slots[rank] * chunk, count) + 1;
+            stats->busy += MPI_Wtime() - t0;
+            stats->chunks++;
+            stats->samples += count;
+        }
+        if (world_rank == fail_rank && result->rounds == PI_FAIL_ROUND) {
+            printf("Rank %d: Failing on purpose in round %d (--fail-rank)\n",
+                   world_rank, result->rounds + 1);
+            fflush(stdout);
+            raise(SIGKILL);
+        }
+
+        // Retried among the survivors until all agree it succeeded; the
+        // slots keep the numbering of the round's start
+        double t0 = MPI_Wtime();
+        for (;;) {
+            int err = MPI_Allreduce(mine, drawn, size, MPI_LONG_LONG, MPI_SUM, comm);
+            if (round_agreed(comm, err)) {
+                break;
+            }
+            double t1 = MPI_Wtime();
+            shrink(&comm);
+            result->recovery += MPI_Wtime() - t1;
+        }
+        stats->sched += MPI_Wtime() - t0;
+
+        for (int j = 0; j < size; j++) {
+            if (slots[j] < 0) {
+                continue;
+            }
+            long long count = chunk_count(slots[j], chunk, total_samples);
+            if (drawn[j] > 0) {
+                result->hits += drawn[j] - 1;
+                result->samples += count;
+            } else {
+                requeued[tail++] = slots[j];
+                result->lost_chunks++;
+                result->lost_samples += count;
+            }
+        }
+        result->rounds++;
+    }
+
+    int live;
+    MPI_Comm_size(comm, &live);
+    result->ranks_lost = world_size - live;
+    *survivors = comm;
+    free(requeued);
+    free(slots);
+    free(mine);
+    free(drawn);
+}
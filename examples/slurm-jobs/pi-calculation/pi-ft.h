@@ -0,0 +1,53 @@
+/*
+ * Fault-tolerant sampling for the pi-calculation example (--fault-tolerant)
+ *
+ * The sample stream is cut into chunks as for the dynamic schedule, but
+ * handed out in rounds: every live rank draws one chunk per round, and the
+ * round's hit counts are combined with an MPI_Allreduce on a copy of
+ * MPI_COMM_WORLD that returns errors instead of aborting. MPIX_Comm_agree
+ * gives every rank the same verdict on the round. When a rank died, the
+ * survivors revoke the communicator, MPIX_Comm_shrink it to the live ranks
+ * and reduce the round again among themselves; the chunks only dead ranks
+ * had drawn are discarded and handed out again in the next round. Rounds
+ * agreed before a failure are kept, so each failed rank costs at most one
+ * chunk, and the survivors finish with the hit count of a run without
+ * failures. No rank is special: the totals are known to every survivor,
+ * and the lowest surviving rank reports them.
+ *
+ * Needs the ULFM extension (MPIX_Comm_revoke/shrink/agree: Open MPI 5,
+ * started with mpirun --with-ft ulfm, or MPICH); without it the mode is
+ * unavailable and pi_ft_available() returns 0. Failures during sampling
+ * are survived; one during the final report still ends the job.
+ */
+
+#ifndef PI_FT_H
+#define PI_FT_H
+
+#include <mpi.h>
+#include <stdint.h>
+
+#include "pi-schedule.h"
+
+// Outcome of a fault-tolerant run (identical on every survivor)
+typedef struct {
+    long long hits;         // Totals over all chunks
+    long long samples;
+    int rounds;
+    int ranks_lost;         // Ranks that failed during the run
+    long long lost_chunks;  // Chunks handed to failed ranks, drawn again
+    long long lost_samples;
+    double recovery;        // Seconds this rank spent revoking and shrinking
+} pi_ft_result_t;
+
+// Nonzero if the MPI library provides ULFM
+int pi_ft_available(void);
+
+// Draw total_samples samples of seed's stream in chunks over the live ranks
+// of MPI_COMM_WORLD, surviving rank failures. fail_rank (-1 = none) is a
+// world rank that kills itself in the second round, to exercise recovery.
+// *survivors receives the live ranks for the rest of the run (errors
+// return; free with MPI_Comm_free). Collective.
+void pi_ft_run(long long total_samples, long long chunk, uint64_t seed, int fail_rank,
+               pi_work_stats_t *stats, pi_ft_result_t *result, MPI_Comm *survivors);
+
+#endif /* PI_FT_H */
@@ -7,67 +7,468 @@
  * π ≈ 4 * (points inside circle / total points)
  *
  * Demonstrates:
- * - Parallel random number generation
+ * - Parallel random number generation: a counter-based Philox stream keyed
+ *   by --seed, so ranks never share samples and a fixed seed reproduces the
+ *   same hit count for any process/thread count (see pi-sampler.h)
  * - Work distribution across processes
  * - MPI reduction for aggregating results
  * - Scaling with more processes
+ * - Hybrid MPI+OpenMP: with OpenMP, each rank splits its samples across
+ *   SLURM_CPUS_PER_TASK threads (see pi-hybrid.sbatch)
  *
- * Compile: mpicc -o pi-monte-carlo pi-monte-carlo.c -lm
- * Run: mpirun -np 4 ./pi-monte-carlo 10000000
+ * - Early termination: --target-error overlaps an MPI_Iallreduce of the
+ *   running totals with the next round and stops once accurate enough
+ * - Dynamic load balancing: ranks claim sample chunks from a shared
+ *   counter with MPI_Fetch_and_op, so mixed CPU generations finish together
+ *   (see pi-schedule.h); the report shows chunks and idle time per rank
+ * - Hardware counters: --counters adds cycles, instructions, LLC misses
+ *   and (Intel) counted FLOPs of the sampling calls to the performance
+ *   report (bench-perf.h); the sampler is compute bound, so its
+ *   arithmetic intensity is far to the right of the node's ridge point
+ * - Node-aware reduction: --node-aware reduces the totals to a leader on
+ *   each node through shared memory, then across the leaders only
+ *   (bench-node.h), so the network carries one message per node
+ * - Checkpoint/restart: --checkpoint=DIR saves the stream position and hit
+ *   count of every rank (static) or the round totals (--target-error) to DIR
+ *   with non-blocking MPI-IO; a job restarted after its time limit or
+ *   preemption continues from there and reaches the same hit count
+ *   (pi-schedule.h). The performance report shows the checkpoint overhead.
+ * - Fault tolerance: --fault-tolerant draws chunks in agreed rounds and,
+ *   when a rank dies, shrinks the communicator with ULFM and redraws the
+ *   lost chunks on the survivors instead of ending the job (pi-ft.h); the
+ *   results report the ranks and work lost
+ * - Startup time: the performance report shows MPI_Init and, with
+ *   BENCH_LAUNCH_TIME from the launcher, the time from launch to all ranks
+ *   initialized (bench-startup.h), e.g. to compare container launches
+ *
+ * Options:
+ *   --seed=N                   Stream key (default: time-based, printed)
+ *   --schedule=dynamic|static  Work distribution (default: dynamic)
+ *   --chunk=N                  Samples per dynamic chunk, K/M/G suffixes
+ *                              allowed (default: up to 4M, at least 8
+ *                              chunks per rank); with
+ *                              --target-error, samples per rank per round
+ *   --target-error=E           Stop once the standard error of the estimate
+ *                              is below E; total_samples becomes the cap
+ *   --counters                 Hardware counter profile of the sampling
+ *   --node-aware               Two-level reduction (node, then node leaders)
+ *   --checkpoint=DIR           Checkpoint to DIR and resume from an earlier
+ *                              checkpoint there (needs --seed; static
+ *                              schedule or --target-error)
+ *   --checkpoint-interval=S    Seconds between checkpoints (default: 60;
+ *                              0 = after every chunk or round)
+ *   --fault-tolerant           Survive rank failures (needs ULFM; chunks of
+ *                              --chunk samples, one per rank per round)
+ *   --fail-rank=R              Kill rank R in the second round to exercise
+ *                              --fault-tolerant
+ *   --json[=PATH]              Also write a JSON record of the run to stdout
+ *                              or PATH (see bench-report.h)
+ *
+ * Compile: mpicc -O3 -fopenmp -I../common -o pi-monte-carlo pi-monte-carlo.c \
+ *          pi-sampler.c pi-schedule.c pi-ft.c ../common/bench-threads.c \
+ *          ../common/bench-report.c ../common/bench-perf.c \
+ *          ../common/bench-node.c ../common/bench-checkpoint.c \
+ *          ../common/bench-startup.c -lm
+ * Run: mpirun -np 4 ./pi-monte-carlo 10000000 --seed=42
  */
 
 #include <mpi.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 
+#include "bench-checkpoint.h"
+#include "bench-node.h"
+#include "bench-perf.h"
+#include "bench-report.h"
+#include "bench-startup.h"
+#include "bench-threads.h"
+#include "pi-ft.h"
+#include "pi-sampler.h"
+#include "pi-schedule.h"
+
 // Default number of samples if not specified
 #define DEFAULT_SAMPLES 10000000
 
-// Monte Carlo estimation of Pi
-long long count_circle_points(long long num_samples, int rank) {
-    long long count = 0;
-    double x, y, distance;
+// Per-rank accounting gathered on rank 0 for the work distribution report
+// (STAT_RANK: world rank, renumbered survivors after failures)
+enum { STAT_CHUNKS, STAT_SAMPLES, STAT_BUSY, STAT_SCHED, STAT_IDLE, STAT_RANK, STAT_COUNT };
 
-    // Seed random number generator with rank and time
-    // This ensures each process generates different random numbers
-    unsigned int seed = (unsigned int)(time(NULL) + rank);
+// Command-line configuration
+typedef struct {
+    long long total_samples;    // Samples over all ranks
+    uint64_t seed;              // Philox key shared by all ranks
+    int has_seed;               // 0 when no --seed was given
+    pi_schedule_t schedule;     // Work distribution
+    long long chunk;            // Dynamic chunk / round size (0 = default)
+    double target_error;        // Standard error to stop at (0 = draw all)
+    int counters;               // Hardware counter profile of the sampling
+    int node_aware;             // Reduce per node, then across node leaders
+    const char *checkpoint_dir; // Checkpoint directory (NULL = none)
+    double checkpoint_interval; // Seconds between checkpoints
+    int fault_tolerant;         // Survive rank failures (ULFM)
+    int fail_rank;              // Rank that kills itself (-1 = none)
+    int json;                   // Write a JSON record
+    const char *json_path;      // JSON destination (NULL = stdout)
+} pi_config_t;
 
-    for (long long i = 0; i < num_samples; i++) {
-        // Generate random point in unit square [0,1] x [0,1]
-        x = (double)rand_r(&seed) / RAND_MAX;
-        y = (double)rand_r(&seed) / RAND_MAX;
+void print_usage(const char *prog) {
+    printf("Usage: %s [total_samples] [--seed=N] [--schedule=dynamic|static] [--chunk=N]\n"
+           "       [--target-error=E] [--counters] [--node-aware]\n"
+           "       [--checkpoint=DIR [--checkpoint-interval=SECONDS]]\n"
+           "       [--fault-tolerant [--fail-rank=R]] [--json[=PATH]]\n", prog);
+}
 
-        // Check if point is inside unit circle
-        distance = x * x + y * y;
-        if (distance <= 1.0) {
-            count++;
+// Parse command line; returns 0 on success, -1 on invalid arguments.
+// Every rank parses the arguments; only rank 0 reports errors.
+int parse_args(int argc, char **argv, pi_config_t *config, int rank) {
+    const char *value;
+
+    config->total_samples = DEFAULT_SAMPLES;
+    config->has_seed = 0;
+    config->schedule = PI_SCHEDULE_DYNAMIC;
+    config->chunk = 0;
+    config->target_error = 0.0;
+    config->counters = 0;
+    config->node_aware = 0;
+    config->checkpoint_dir = NULL;
+    config->checkpoint_interval = -1.0;
+    config->fault_tolerant = 0;
+    config->fail_rank = -1;
+    config->json = 0;
+    config->json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if ((value = bench_option_value(arg, "--seed="))) {
+            char *end;
+            config->seed = strtoull(value, &end, 0);
+            if (*end != '\0' || end == value) {
+                if (rank == 0) {
+                    printf("Error: Seed must be an unsigned integer\n");
+                }
+                return -1;
+            }
+            config->has_seed = 1;
+        } else if ((value = bench_option_value(arg, "--schedule="))) {
+            if (pi_schedule_from_name(value, &config->schedule) != 0) {
+                if (rank == 0) {
+                    printf("Error: Unknown schedule '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--chunk="))) {
+            config->chunk = bench_parse_size(value);
+            if (config->chunk <= 0) {
+                if (rank == 0) {
+                    printf("Error: Chunk size must be a positive integer\n");
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--target-error="))) {
+            config->target_error = atof(value);
+            if (config->target_error <= 0.0) {
+                if (rank == 0) {
+                    printf("Error: Target error must be a positive number\n");
+                }
+                return -1;
+            }
+        } else if (strcmp(arg, "--counters") == 0) {
+            config->counters = 1;
+        } else if (strcmp(arg, "--node-aware") == 0) {
+            config->node_aware = 1;
+        } else if ((value = bench_option_value(arg, "--checkpoint="))) {
+            config->checkpoint_dir = value;
+        } else if ((value = bench_option_value(arg, "--checkpoint-interval="))) {
+            char *end;
+            config->checkpoint_interval = strtod(value, &end);
+            if (*end != '\0' || end == value || config->checkpoint_interval < 0.0) {
+                if (rank == 0) {
+                    printf("Error: Checkpoint interval must be zero or more seconds\n");
+                }
+                return -1;
+            }
+        } else if (strcmp(arg, "--fault-tolerant") == 0) {
+            config->fault_tolerant = 1;
+        } else if ((value = bench_option_value(arg, "--fail-rank="))) {
+            char *end;
+            config->fail_rank = (int)strtol(value, &end, 10);
+            if (*end != '\0' || end == value || config->fail_rank < 0) {
+                if (rank == 0) {
+                    printf("Error: Failing rank must be a rank number\n");
+                }
+                return -1;
+            }
+        } else if (bench_json_option(arg, &config->json_path)) {
+            config->json = 1;
+        } else if (arg[0] != '-') {
+            config->total_samples = atoll(arg);
+        } else {
+            if (rank == 0) {
+                printf("Error: Unknown option '%s'\n", arg);
+            }
+            return -1;
         }
     }
 
-    return count;
+    // A restart must draw the same stream in the same ranges or rounds
+    if (config->checkpoint_interval >= 0.0 && !config->checkpoint_dir) {
+        if (rank == 0) {
+            printf("Error: --checkpoint-interval needs --checkpoint\n");
+        }
+        return -1;
+    }
+    if (config->checkpoint_interval < 0.0) {
+        config->checkpoint_interval = BENCH_CKPT_DEFAULT_INTERVAL;
+    }
+    if (config->checkpoint_dir && !config->has_seed) {
+        if (rank == 0) {
+            printf("Error: --checkpoint needs --seed, so a restart draws the same samples\n");
+        }
+        return -1;
+    }
+    if (config->checkpoint_dir && config->schedule == PI_SCHEDULE_DYNAMIC
+        && config->target_error <= 0.0) {
+        if (rank == 0) {
+            printf("Error: --checkpoint needs --schedule=static or --target-error (dynamic\n"
+                   "       chunks finish out of order)\n");
+        }
+        return -1;
+    }
+
+    // The fault-tolerant rounds replace the schedule, and the collectives of
+    // the other modes would not survive a failure
+    if (config->fail_rank >= 0 && !config->fault_tolerant) {
+        if (rank == 0) {
+            printf("Error: --fail-rank needs --fault-tolerant\n");
+        }
+        return -1;
+    }
+    if (config->fault_tolerant && !pi_ft_available()) {
+        if (rank == 0) {
+            printf("Error: --fault-tolerant needs an MPI library with ULFM (MPIX_Comm_shrink),\n"
+                   "       e.g. Open MPI 5 started with mpirun --with-ft ulfm\n");
+        }
+        return -1;
+    }
+    if (config->fault_tolerant && (config->target_error > 0.0 || config->node_aware
+                                   || config->checkpoint_dir || config->counters)) {
+        if (rank == 0) {
+            printf("Error: --fault-tolerant cannot be combined with --target-error,\n"
+                   "       --node-aware, --checkpoint or --counters\n");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Print per-rank chunk counts, busy and idle time of the ranks that
+// finished the run (rank 0 only)
+void print_work_report(const pi_config_t *config, const double *stats,
+                       const char *hosts, int ranks) {
+    double max_busy = 0.0, sum_busy = 0.0, max_idle = 0.0, max_sched = 0.0;
+
+    printf("========================================\n");
+    if (config->fault_tolerant) {
+        printf("Work Distribution (fault-tolerant rounds, %lld samples/chunk)\n",
+               config->chunk);
+    } else if (config->target_error > 0.0) {
+        printf("Work Distribution (target-error rounds, %lld samples/rank/round)\n",
+               config->chunk);
+    } else if (config->schedule == PI_SCHEDULE_DYNAMIC) {
+        printf("Work Distribution (dynamic, %lld samples/chunk)\n", config->chunk);
+    } else {
+        printf("Work Distribution (static)\n");
+    }
+    printf("========================================\n");
+    // Busy + claim/wait + idle is the rank's share of the execution time
+    const char *sched_label = "Sched (s)";
+    if (config->fault_tolerant || config->target_error > 0.0) {
+        sched_label = "Wait (s)";
+    } else if (config->schedule == PI_SCHEDULE_DYNAMIC) {
+        sched_label = "Claim (s)";
+    }
+    printf("%6s  %-20s %8s %14s %10s %10s %10s %10s %12s\n",
+           "Rank", "Host", "Chunks", "Samples", "Busy (s)", sched_label, "Idle (s)",
+           "Total (s)", "Samples/s");
+    for (int r = 0; r < ranks; r++) {
+        const double *st = stats + (size_t)r * STAT_COUNT;
+        double rate = st[STAT_BUSY] > 0.0 ? st[STAT_SAMPLES] / st[STAT_BUSY] : 0.0;
+        printf("%6.0f  %-20.20s %8.0f %14.0f %10.3f %10.3f %10.3f %10.3f %12.2e\n",
+               st[STAT_RANK], hosts + (size_t)r * MPI_MAX_PROCESSOR_NAME, st[STAT_CHUNKS],
+               st[STAT_SAMPLES], st[STAT_BUSY], st[STAT_SCHED], st[STAT_IDLE],
+               st[STAT_BUSY] + st[STAT_SCHED] + st[STAT_IDLE], rate);
+        sum_busy += st[STAT_BUSY];
+        max_busy = st[STAT_BUSY] > max_busy ? st[STAT_BUSY] : max_busy;
+        max_idle = st[STAT_IDLE] > max_idle ? st[STAT_IDLE] : max_idle;
+        max_sched = st[STAT_SCHED] > max_sched ? st[STAT_SCHED] : max_sched;
+    }
+    // 1.00 means every rank sampled for the same time; idle is time spent
+    // waiting for the slowest rank after running out of work (and anything
+    // else outside sampling and claims)
+    if (sum_busy > 0.0) {
+        printf("Busy imbalance (max/avg): %.2f\n", max_busy / (sum_busy / ranks));
+    }
+    printf("Max idle time: %.3f seconds\n", max_idle);
+    if (config->fault_tolerant) {
+        printf("Max round reduction and agreement time: %.3f seconds\n", max_sched);
+    } else if (config->target_error > 0.0) {
+        printf("Max exposed round-reduction wait: %.3f seconds\n", max_sched);
+    } else if (config->schedule == PI_SCHEDULE_DYNAMIC) {
+        printf("Max chunk-claim time: %.3f seconds\n", max_sched);
+    }
+    printf("========================================\n");
+    printf("\n");
+}
+
+// Write the JSON record of this run (rank 0 only); rank_stats and hosts
+// cover the ranks that finished it
+void write_json_record(const pi_config_t *config, int world_size, int ranks, int threads,
+                       const double *rank_stats, const char *hosts,
+                       const bench_stats_t *phases, const pi_converge_t *converge,
+                       const bench_perf_summary_t *counters, const bench_node_t *node,
+                       const bench_ckpt_summary_t *checkpoint, const char *ckpt_path,
+                       const pi_ft_result_t *ft, const bench_startup_summary_t *startup,
+                       double reduce_time, long long hits, long long samples,
+                       long long drawn, double elapsed) {
+    bench_json_t json;
+    double pi_estimate = 4.0 * hits / (double)samples;
+
+    if (bench_json_open(&json, config->json_path) != 0) {
+        printf("Warning: could not write JSON record\n");
+        return;
+    }
+    bench_json_begin_object(&json, NULL);
+    bench_json_header(&json, "pi-monte-carlo", ranks, threads, hosts);
+
+    bench_json_begin_object(&json, "config");
+    bench_json_int(&json, "total_samples", config->total_samples);
+    bench_json_int(&json, "seed", (long long)config->seed);
+    bench_json_bool(&json, "seed_given", config->has_seed);
+    bench_json_string(&json, "schedule", config->fault_tolerant ? "fault-tolerant"
+                      : config->target_error > 0.0 ? "target-error"
+                      : pi_schedule_name(config->schedule));
+    bench_json_int(&json, "chunk", config->chunk);
+    bench_json_double(&json, "target_error", config->target_error);
+    bench_json_string(&json, "rng", "philox4x32-10");
+    bench_json_bool(&json, "node_aware", config->node_aware);
+    if (config->checkpoint_dir) {
+        bench_json_string(&json, "checkpoint_dir", config->checkpoint_dir);
+        bench_json_double(&json, "checkpoint_interval", config->checkpoint_interval);
+    }
+    bench_json_end_object(&json);
+
+    bench_json_string(&json, "isa", pi_sampler_isa());
+
+    // busy = sampling, sched = chunk claims or round-reduction waits, idle =
+    // the rest (mostly waiting for the slowest rank); they add up per rank
+    bench_json_begin_object(&json, "phases");
+    bench_json_stats(&json, "busy", &phases[STAT_BUSY]);
+    bench_json_stats(&json, "idle", &phases[STAT_IDLE]);
+    bench_json_stats(&json, "sched", &phases[STAT_SCHED]);
+    bench_json_double(&json, "reduce", reduce_time);
+    bench_json_double(&json, "total", elapsed);
+    bench_json_end_object(&json);
+    bench_startup_json(&json, startup);
+
+    bench_json_begin_array(&json, "per_rank");
+    for (int r = 0; r < ranks; r++) {
+        const double *st = rank_stats + (size_t)r * STAT_COUNT;
+        bench_json_begin_object(&json, NULL);
+        bench_json_int(&json, "rank", (long long)st[STAT_RANK]);
+        bench_json_int(&json, "chunks", (long long)st[STAT_CHUNKS]);
+        bench_json_int(&json, "samples", (long long)st[STAT_SAMPLES]);
+        bench_json_double(&json, "busy", st[STAT_BUSY]);
+        bench_json_double(&json, "sched", st[STAT_SCHED]);
+        bench_json_double(&json, "idle", st[STAT_IDLE]);
+        bench_json_end_object(&json);
+    }
+    bench_json_end_array(&json);
+
+    bench_json_begin_object(&json, "metrics");
+    bench_json_int(&json, "samples", samples);
+    bench_json_int(&json, "hits", hits);
+    bench_json_double(&json, "pi_estimate", pi_estimate);
+    bench_json_double(&json, "abs_error", fabs(pi_estimate - M_PI));
+    bench_json_double(&json, "standard_error", pi_standard_error(hits, samples));
+    bench_json_int(&json, "samples_drawn", drawn);
+    bench_json_double(&json, "samples_per_second", drawn / elapsed);
+    // Per surviving rank: ranks lost to a failure drew nothing at the end
+    bench_json_double(&json, "samples_per_second_per_rank", drawn / elapsed / ranks);
+    if (node) {
+        bench_json_int(&json, "nodes", node->num_nodes);
+    }
+    if (config->target_error > 0.0) {
+        bench_json_bool(&json, "converged", converge->converged);
+        bench_json_int(&json, "rounds", converge->rounds);
+    }
+    bench_perf_json(&json, counters, "sampling");
+    if (checkpoint) {
+        bench_ckpt_json(&json, checkpoint, ckpt_path);
+    }
+    if (ft) {
+        bench_json_begin_object(&json, "fault_tolerance");
+        bench_json_int(&json, "rounds", ft->rounds);
+        bench_json_int(&json, "ranks_started", world_size);
+        bench_json_int(&json, "ranks_lost", ft->ranks_lost);
+        bench_json_double(&json, "samples_per_second_per_rank_started",
+                          drawn / elapsed / world_size);
+        bench_json_int(&json, "lost_chunks", ft->lost_chunks);
+        bench_json_int(&json, "lost_samples", ft->lost_samples);
+        bench_json_double(&json, "recovery", ft->recovery);
+        bench_json_end_object(&json);
+    }
+    bench_json_end_object(&json);
+
+    bench_json_end_object(&json);
+    if (bench_json_close(&json) != 0) {
+        printf("Warning: could not write JSON record\n");
+    }
 }
 
 int main(int argc, char** argv) {
     int world_size, world_rank;
+    pi_config_t config;
+    pi_work_stats_t work;
+    pi_converge_t converge = {0};
+    pi_ft_result_t ft = {0};
     long long total_samples;
-    long long samples_per_proc;
-    long long local_count, global_count;
+    long long local_count, global_count, global_samples;
     double pi_estimate;
     double start_time, end_time;
+    bench_startup_t startup;
 
-    // Initialize MPI
-    MPI_Init(&argc, &argv);
+    // Initialize MPI (only the main thread makes MPI calls)
+    int thread_support;
+    bench_startup_begin(&startup);
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
+    bench_startup_end(&startup);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
-    // Get number of samples from command line or use default
-    if (argc > 1) {
-        total_samples = atoll(argv[1]);
-    } else {
-        total_samples = DEFAULT_SAMPLES;
+    const char *thread_source;
+    int threads = bench_threads_init(&thread_source);
+
+    // Get number of samples, seed and schedule from command line
+    if (parse_args(argc, argv, &config, world_rank) != 0) {
+        if (world_rank == 0) {
+            print_usage(argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
     }
+    total_samples = config.total_samples;
+
+    // All ranks must share one key: rank 0 picks it when none was given
+    if (!config.has_seed) {
+        config.seed = (uint64_t)time(NULL);
+    }
+    MPI_Bcast(&config.seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    // While every rank is alive (--fault-tolerant)
+    bench_startup_summary_t startup_summary = bench_startup_summarize(&startup);
 
     // Ensure minimum samples per process
     if (total_samples < world_size) {
@@ -78,9 +479,30 @@ int main(int argc, char** argv) {
         MPI_Finalize();
         return 1;
     }
+    if (config.fail_rank >= world_size || (config.fail_rank >= 0 && world_size < 2)) {
+        if (world_rank == 0) {
+            printf("Error: --fail-rank=%d needs at least 2 processes and a rank below %d\n",
+                   config.fail_rank, world_size);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (config.chunk == 0) {
+        config.chunk = pi_default_chunk(total_samples, world_size);
+    }
+    bench_node_t node;
+    if (config.node_aware) {
+        bench_node_init(&node, MPI_COMM_WORLD);
+    }
 
-    // Divide work among processes
-    samples_per_proc = total_samples / world_size;
+    // Checkpoint of the stream position; resumes a matching earlier run
+    bench_ckpt_t ckpt;
+    if (config.checkpoint_dir
+        && pi_checkpoint_open(&ckpt, config.checkpoint_dir, config.checkpoint_interval,
+                              total_samples, config.chunk, config.seed,
+                              config.target_error) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
     // Print configuration from rank 0
     if (world_rank == 0) {
@@ -89,35 +511,166 @@ int main(int argc, char** argv) {
         printf("========================================\n");
         printf("Total samples: %lld\n", total_samples);
         printf("Number of processes: %d\n", world_size);
-        printf("Samples per process: %lld\n", samples_per_proc);
+        if (config.fault_tolerant) {
+            printf("Mode: fault tolerant (ULFM), one chunk per rank per round\n");
+            printf("Chunk size: %lld samples (%lld chunks)\n", config.chunk,
+                   (total_samples + config.chunk - 1) / config.chunk);
+            if (config.fail_rank >= 0) {
+                printf("Injected failure: rank %d in round 2\n", config.fail_rank);
+            }
+        } else if (config.target_error > 0.0) {
+            printf("Mode: target error %.2e (at most %lld samples)\n",
+                   config.target_error, total_samples);
+            printf("Round size: %lld samples per process\n", config.chunk);
+        } else if (config.schedule == PI_SCHEDULE_DYNAMIC) {
+            printf("Schedule: %s\n", pi_schedule_name(config.schedule));
+            printf("Chunk size: %lld samples (%lld chunks)\n", config.chunk,
+                   (total_samples + config.chunk - 1) / config.chunk);
+        } else {
+            printf("Schedule: %s\n", pi_schedule_name(config.schedule));
+            printf("Samples per process: %lld\n", total_samples / world_size);
+        }
+        printf("Seed: %llu%s\n", (unsigned long long)config.seed,
+               config.has_seed ? "" : " (time-based; pass --seed to reproduce)");
+        printf("RNG: Philox4x32-10, %d-block batches (%s)\n",
+               PI_SAMPLER_LANES, pi_sampler_isa());
+        printf("Build: %s\n", BENCH_BUILD_VARIANT);
+        printf("Threads per process: %d (%s)\n", threads, thread_source);
+        if (config.fault_tolerant) {
+            printf("Reduction: per round (MPI_Allreduce, then MPIX_Comm_agree)\n");
+        } else if (config.node_aware) {
+            printf("Reduction: two-level (%d nodes, up to %d ranks per node)\n",
+                   node.num_nodes, node.max_node_size);
+        } else {
+            printf("Reduction: flat (MPI_Reduce over all ranks)\n");
+        }
+        if (config.checkpoint_dir) {
+            printf("Checkpoint: %s every %g s, %s (%s)\n", ckpt.path,
+                   config.checkpoint_interval,
+                   config.target_error > 0.0 ? "round totals on rank 0"
+                                             : "stream position per rank",
+                   ckpt.resumed ? "resuming an earlier run" : "new");
+        }
+        if (threads > 1 && thread_support < MPI_THREAD_FUNNELED) {
+            printf("Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+        }
         printf("========================================\n");
         printf("\n");
         fflush(stdout);
     }
 
+    // Compute profile, paused and resumed around every sampling call
+    bench_perf_profile_t profile = {0};
+    if (config.counters) {
+        bench_perf_profile_open(&profile);
+    }
+
     // Synchronize before starting computation
     MPI_Barrier(MPI_COMM_WORLD);
     start_time = MPI_Wtime();
 
-    // Each process computes its portion
-    local_count = count_circle_points(samples_per_proc, world_rank);
+    // Each process computes its share (static range, claimed chunks,
+    // rounds until the target error is met, or fault-tolerant rounds). From
+    // here on the survivors of a failure carry on in comm.
+    MPI_Comm comm = MPI_COMM_WORLD;
+    if (config.fault_tolerant) {
+        pi_ft_run(total_samples, config.chunk, config.seed, config.fail_rank, &work, &ft,
+                  &comm);
+        local_count = ft.hits;
+    } else if (config.target_error > 0.0) {
+        local_count = pi_converge_run(total_samples, config.chunk, config.target_error,
+                                      config.seed, config.checkpoint_dir ? &ckpt : NULL,
+                                      &profile, &work, &converge);
+    } else {
+        local_count = pi_schedule_run(config.schedule, total_samples, config.chunk,
+                                      config.seed, config.checkpoint_dir ? &ckpt : NULL,
+                                      &profile, &work);
+    }
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
 
-    // Print local results (optional - can be noisy with many processes)
-    // printf("Rank %d: Local count = %lld (%.2f%% inside circle)\n",
-    //        world_rank, local_count, 100.0 * local_count / samples_per_proc);
+    // Idle is the rest of the rank's time up to here: waiting for the
+    // slowest rank (this barrier, the window free), checkpoint completion.
+    // Busy + sched + idle is the same wall time on every rank.
+    MPI_Barrier(comm);
+    double idle = MPI_Wtime() - start_time - work.busy - work.sched;
+    idle = idle > 0.0 ? idle : 0.0;
 
-    // Reduce all local counts to global count on rank 0
-    MPI_Reduce(&local_count, &global_count, 1, MPI_LONG_LONG,
-               MPI_SUM, 0, MPI_COMM_WORLD);
+    // Reduce all local counts to global count on rank 0: directly, or per
+    // node and then across the node leaders. Samples taken from a
+    // checkpoint count towards the estimate. The fault-tolerant rounds
+    // already agreed on the totals.
+    long long local_samples = work.samples + work.resumed;
+    double reduce_start = MPI_Wtime();
+    if (config.fault_tolerant) {
+        global_count = ft.hits;
+        global_samples = ft.samples;
+    } else if (config.node_aware) {
+        long long local_totals[2] = {local_count, local_samples};
+        long long global_totals[2];
+        bench_node_reduce(&node, local_totals, global_totals, 2, MPI_LONG_LONG, MPI_SUM);
+        global_count = global_totals[0];
+        global_samples = global_totals[1];
+    } else {
+        MPI_Reduce(&local_count, &global_count, 1, MPI_LONG_LONG,
+                   MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&local_samples, &global_samples, 1, MPI_LONG_LONG,
+                   MPI_SUM, 0, MPI_COMM_WORLD);
+    }
+    double reduce_time = MPI_Wtime() - reduce_start;
 
     // Synchronize and measure time
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(comm);
     end_time = MPI_Wtime();
 
+    // Collect per-rank accounting and host names for the report
+    double local_stats[STAT_COUNT] = {
+        (double)work.chunks, (double)work.samples, work.busy, work.sched, idle,
+        (double)world_rank
+    };
+    double *stats = NULL;
+    if (rank == 0) {
+        stats = malloc((size_t)size * STAT_COUNT * sizeof(double));
+        if (!stats) {
+            printf("Memory allocation failed for work report\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(local_stats, STAT_COUNT, MPI_DOUBLE, stats, STAT_COUNT, MPI_DOUBLE,
+               0, comm);
+    char *hosts = bench_gather_hosts_comm(comm);
+
+    // Min/max/avg of each accounting field for the JSON record
+    bench_stats_t phases[STAT_COUNT];
+    for (int i = 0; i < STAT_RANK; i++) {
+        phases[i] = bench_reduce_stats_comm(local_stats[i], comm);
+    }
+
+    // Counter rates over the sampling time; no operation count to fall
+    // back on without FP events (not with --fault-tolerant: the summary
+    // reduces over MPI_COMM_WORLD)
+    bench_perf_sample_t sample = bench_perf_profile_read(&profile);
+    bench_perf_profile_close(&profile);
+    bench_perf_summary_t counters = {0};
+    counters.ghz.min = -1.0;
+    if (!config.fault_tolerant) {
+        counters = bench_perf_summarize(&sample, work.busy, threads, -1.0);
+    }
+
+    // The run completed, nothing left to resume
+    bench_ckpt_summary_t ckpt_summary = {0};
+    if (config.checkpoint_dir) {
+        ckpt_summary = bench_ckpt_summarize(&ckpt);
+        bench_ckpt_close(&ckpt, 1);
+    }
+
     // Rank 0 calculates and prints results
-    if (world_rank == 0) {
+    if (rank == 0) {
         // Calculate pi estimate
-        double actual_total = (double)(samples_per_proc * world_size);
+        double actual_total = (double)global_samples;
+        double drawn = actual_total - ckpt_summary.total_restored;    // In this run
         pi_estimate = 4.0 * global_count / actual_total;
 
         // Calculate error
@@ -135,17 +688,75 @@ int main(int argc, char** argv) {
         printf("Actual Pi: %.10f\n", pi_actual);
         printf("Absolute error: %.10f\n", error);
         printf("Relative error: %.6f%%\n", percent_error);
+        printf("Standard error: %.2e\n", pi_standard_error(global_count, global_samples));
+        if (config.target_error > 0.0) {
+            // The stop decision used the totals one round behind the final ones
+            printf("Target error %.2e %s after %d rounds (decided at %lld samples, %.2e)\n",
+                   config.target_error, converge.converged ? "reached" : "NOT reached",
+                   converge.rounds, converge.decision_samples, converge.decision_error);
+        }
+        if (config.fault_tolerant && ft.ranks_lost > 0) {
+            printf("Fault tolerance: %d of %d ranks lost, %lld chunks (%lld samples) drawn"
+                   " again, %.3f s recovery\n", ft.ranks_lost, world_size, ft.lost_chunks,
+                   ft.lost_samples, ft.recovery);
+        } else if (config.fault_tolerant) {
+            printf("Fault tolerance: no rank failures in %d rounds\n", ft.rounds);
+        }
         printf("========================================\n");
         printf("\n");
 
+        print_work_report(&config, stats, hosts, size);
+
         printf("========================================\n");
         printf("Performance\n");
         printf("========================================\n");
         printf("Execution time: %.3f seconds\n", end_time - start_time);
-        printf("Samples/second: %.2e\n", actual_total / (end_time - start_time));
-        printf("Samples/second/process: %.2e\n",
-               (actual_total / world_size) / (end_time - start_time));
+        if (config.target_error > 0.0 && converge.converged) {
+            printf("Time to accuracy: %.3f seconds\n", end_time - start_time);
+        }
+        if (!config.fault_tolerant) {
+            printf("Final reduction (rank 0): %.3f ms (%s)\n", 1e3 * reduce_time,
+                   config.node_aware ? "two-level" : "flat");
+        }
+        printf("Samples/second: %.2e\n", drawn / (end_time - start_time));
+        // Rates per process and thread count the survivors of a failure
+        if (size < world_size) {
+            printf("Samples/second/process: %.2e (%d surviving ranks; %.2e over all %d)\n",
+                   (drawn / size) / (end_time - start_time), size,
+                   (drawn / world_size) / (end_time - start_time), world_size);
+        } else {
+            printf("Samples/second/process: %.2e\n", (drawn / size) / (end_time - start_time));
+        }
+        printf("Samples/second/thread: %.2e\n",
+               (drawn / ((double)size * threads)) / (end_time - start_time));
+        bench_startup_print(&startup_summary);
+        if (config.checkpoint_dir) {
+            bench_ckpt_print(&ckpt_summary, ckpt.path, "samples", phases[STAT_BUSY].max);
+        }
+        if (config.counters && counters.ghz.min >= 0.0) {
+            bench_perf_print(&counters, "sampling");
+        } else if (config.counters) {
+            printf("Hardware counters: n/a (perf counters unavailable)\n");
+        }
         printf("========================================\n");
+
+        if (config.json) {
+            write_json_record(&config, world_size, size, threads, stats, hosts, phases,
+                              &converge, &counters, config.node_aware ? &node : NULL,
+                              config.checkpoint_dir ? &ckpt_summary : NULL, ckpt.path,
+                              config.fault_tolerant ? &ft : NULL, &startup_summary, reduce_time,
+                              global_count, global_samples, (long long)drawn,
+                              end_time - start_time);
+        }
+        free(stats);
+        free(hosts);
+    }
+
+    if (config.node_aware) {
+        bench_node_free(&node);
+    }
+    if (comm != MPI_COMM_WORLD) {
+        MPI_Comm_free(&comm);
     }
 
     // Finalize MPI
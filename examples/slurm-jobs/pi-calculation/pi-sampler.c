@@ -0,0 +1,98 @@
+/*
+ * Counter-based sampling for the pi-calculation example
+ */
+
+#include "pi-sampler.h"
+
+#include "bench-philox.h"
+
+// 31 random bits per coordinate, mapped to cell centres of a 2^-31 grid
+#define PI_SAMPLER_SCALE (1.0 / 2147483648.0)
+
+// x86-64 builds carry AVX-512/AVX2 clones of the batch kernel next to the
+// baseline one; the loader picks the best for the CPU (like --isa=auto in
+// matrix-multiply, but through GCC function multiversioning)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define PI_SAMPLER_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define PI_SAMPLER_CLONES
+#endif
+
+// Hits among samples j_lo <= j < j_hi of the batch starting at Philox block
+// block0 (sample j of the batch is half j % 2 of block block0 + j / 2)
+PI_SAMPLER_CLONES
+static long long count_batch(uint64_t block0, uint32_t k0, uint32_t k1, int j_lo, int j_hi) {
+    uint32_t c0[PI_SAMPLER_LANES], c1[PI_SAMPLER_LANES];
+    uint32_t c2[PI_SAMPLER_LANES], c3[PI_SAMPLER_LANES];
+    long long hits = 0;
+
+    for (int l = 0; l < PI_SAMPLER_LANES; l++) {
+        uint64_t block = block0 + (uint64_t)l;
+        c0[l] = (uint32_t)block;
+        c1[l] = (uint32_t)(block >> 32);
+        c2[l] = 0;
+        c3[l] = 0;
+    }
+
+    for (int r = 0; r < BENCH_PHILOX_ROUNDS; r++) {
+        uint32_t ka = k0 + (uint32_t)r * BENCH_PHILOX_W0;
+        uint32_t kb = k1 + (uint32_t)r * BENCH_PHILOX_W1;
+        for (int l = 0; l < PI_SAMPLER_LANES; l++) {
+            bench_philox_round(&c0[l], &c1[l], &c2[l], &c3[l], ka, kb);
+        }
+    }
+
+    for (int l = 0; l < PI_SAMPLER_LANES; l++) {
+        double x0 = ((int32_t)(c0[l] >> 1) + 0.5) * PI_SAMPLER_SCALE;
+        double y0 = ((int32_t)(c1[l] >> 1) + 0.5) * PI_SAMPLER_SCALE;
+        double x1 = ((int32_t)(c2[l] >> 1) + 0.5) * PI_SAMPLER_SCALE;
+        double y1 = ((int32_t)(c3[l] >> 1) + 0.5) * PI_SAMPLER_SCALE;
+        int j = 2 * l;
+        hits += (j >= j_lo) & (j < j_hi) & (x0 * x0 + y0 * y0 <= 1.0);
+        hits += (j + 1 >= j_lo) & (j + 1 < j_hi) & (x1 * x1 + y1 * y1 <= 1.0);
+    }
+    return hits;
+}
+
+long long pi_count_hits(uint64_t seed, long long first, long long count) {
+    const long long batch_samples = 2LL * PI_SAMPLER_LANES;
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+    long long end = first + count;
+    long long block_first = first / 2;
+    long long num_batches;
+    long long hits = 0;
+
+    if (count <= 0) {
+        return 0;
+    }
+    num_batches = (end - 2 * block_first + batch_samples - 1) / batch_samples;
+
+    #pragma omp parallel for schedule(static) reduction(+:hits)
+    for (long long b = 0; b < num_batches; b++) {
+        long long base = 2 * (block_first + b * PI_SAMPLER_LANES);
+        long long lo = first - base;
+        long long hi = end - base;
+        int j_lo = lo > 0 ? (int)lo : 0;
+        int j_hi = hi < batch_samples ? (int)hi : (int)batch_samples;
+        hits += count_batch((uint64_t)(base / 2), k0, k1, j_lo, j_hi);
+    }
+    return hits;
+}
+
+const char *pi_sampler_isa(void) {
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return "avx512";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return "avx2";
+    }
+    return "sse2";
+#elif defined(__aarch64__)
+    return "neon";
+#else
+    return "generic";
+#endif
+}
@@ -0,0 +1,31 @@
+/*
+ * Counter-based sampling for the pi-calculation example
+ *
+ * Points come from Philox4x32-10 (common/bench-philox.h): a keyed
+ * bijection of a 128-bit counter. The key is the run seed and the counter
+ * is the global index of a point pair, so sample s is the same value no
+ * matter which rank or thread draws it.
+ * Streams of different ranks can never overlap, and a fixed seed gives a
+ * bit-identical hit count for any number of ranks and threads.
+ *
+ * Counters are evaluated PI_SAMPLER_LANES at a time in plain loops the
+ * compiler vectorizes (32×32→64-bit multiplies map onto pmuludq/vpmuludq),
+ * and the x² + y² <= 1 test runs over the whole batch without branches.
+ */
+
+#ifndef PI_SAMPLER_H
+#define PI_SAMPLER_H
+
+#include <stdint.h>
+
+// Philox blocks (two points each) evaluated per batch
+#define PI_SAMPLER_LANES 64
+
+// Count points with x² + y² <= 1 among global samples [first, first + count)
+// of the stream selected by seed. Splits the range across OpenMP threads.
+long long pi_count_hits(uint64_t seed, long long first, long long count);
+
+// Name of the vector path the batch kernel runs on this CPU
+const char *pi_sampler_isa(void);
+
+#endif /* PI_SAMPLER_H */
@@ -0,0 +1,296 @@
+/*
+ * Work distribution for the pi-calculation example
+ */
+
+#include "pi-schedule.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <string.h>
+
+#include "pi-sampler.h"
+
+// Largest default chunk (~10-40 ms of sampling per core) and how many
+// chunks per rank the default aims for at minimum
+#define PI_MAX_DEFAULT_CHUNK (1LL << 22)
+#define PI_MIN_CHUNKS_PER_RANK 8
+
+// Checkpoint records: static {samples drawn, hits} per rank, target error
+// {rounds, hits, samples} on rank 0
+#define PI_STATIC_RECORD 2
+#define PI_CONVERGE_RECORD 3
+
+int pi_schedule_from_name(const char *name, pi_schedule_t *schedule) {
+    if (strcmp(name, "static") == 0) {
+        *schedule = PI_SCHEDULE_STATIC;
+    } else if (strcmp(name, "dynamic") == 0) {
+        *schedule = PI_SCHEDULE_DYNAMIC;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char *pi_schedule_name(pi_schedule_t schedule) {
+    return schedule == PI_SCHEDULE_DYNAMIC ? "dynamic" : "static";
+}
+
+long long pi_default_chunk(long long total_samples, int world_size) {
+    long long chunk = total_samples / ((long long)world_size * PI_MIN_CHUNKS_PER_RANK);
+    if (chunk > PI_MAX_DEFAULT_CHUNK) {
+        chunk = PI_MAX_DEFAULT_CHUNK;
+    }
+    return chunk > 0 ? chunk : 1;
+}
+
+int pi_checkpoint_open(bench_ckpt_t *ckpt, const char *dir, double interval,
+                       long long total_samples, long long chunk, uint64_t seed,
+                       double target_error) {
+    bench_ckpt_header_t header;
+    int world_size;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    bench_ckpt_header_init(&header, "pi-monte-carlo");
+    header.params[0] = total_samples;
+    header.params[1] = (int64_t)seed;
+    header.params[2] = world_size;
+    header.params[3] = chunk;
+    memcpy(&header.params[4], &target_error, sizeof(target_error));
+    return bench_ckpt_open(ckpt, dir, "pi-checkpoint.bin", interval, &header);
+}
+
+// pi_count_hits() inside the compute profile
+static long long count_hits(bench_perf_profile_t *profile, uint64_t seed,
+                            long long first, long long count) {
+    bench_perf_profile_resume(profile);
+    long long hits = pi_count_hits(seed, first, count);
+    bench_perf_profile_pause(profile);
+    return hits;
+}
+
+// With a checkpoint the range is drawn chunk by chunk, and the record of
+// this rank is saved between chunks once the interval has passed
+static long long run_static(long long total_samples, long long chunk, uint64_t seed,
+                            bench_ckpt_t *ckpt, bench_perf_profile_t *profile,
+                            pi_work_stats_t *stats) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    long long rem = total_samples % world_size;
+    long long count = total_samples / world_size + (world_rank < rem ? 1 : 0);
+    long long first = world_rank * (total_samples / world_size)
+                      + (world_rank < rem ? world_rank : rem);
+
+    if (!ckpt) {
+        double t0 = MPI_Wtime();
+        long long hits = count_hits(profile, seed, first, count);
+        stats->busy = MPI_Wtime() - t0;
+        stats->chunks = 1;
+        stats->samples = count;
+        return hits;
+    }
+
+    long long record[PI_STATIC_RECORD] = {0, 0};    // Samples drawn, hits
+    MPI_Offset offset = BENCH_CKPT_DATA_OFFSET
+                        + (MPI_Offset)world_rank * sizeof(record);
+    if (ckpt->resumed
+        && (bench_ckpt_read(ckpt, offset, record, PI_STATIC_RECORD, MPI_LONG_LONG)
+            != PI_STATIC_RECORD || record[0] < 0 || record[0] > count)) {
+        record[0] = record[1] = 0;
+    }
+    long long done = record[0], hits = record[1];
+    stats->resumed = done;
+    ckpt->stats.restored = (double)done;
+
+    while (done < count) {
+        long long step = count - done < chunk ? count - done : chunk;
+        double t0 = MPI_Wtime();
+        hits += count_hits(profile, seed, first + done, step);
+        stats->busy += MPI_Wtime() - t0;
+        done += step;
+        bench_ckpt_test(ckpt);
+        if (bench_ckpt_due(ckpt)) {
+            bench_ckpt_begin(ckpt);
+            record[0] = done;
+            record[1] = hits;
+            bench_ckpt_write(ckpt, offset, record, PI_STATIC_RECORD, MPI_LONG_LONG);
+        }
+    }
+    bench_ckpt_wait(ckpt);
+    stats->chunks = 1;
+    stats->samples = count - stats->resumed;
+    return hits;
+}
+
+static long long run_dynamic(long long total_samples, long long chunk, uint64_t seed,
+                             bench_perf_profile_t *profile, pi_work_stats_t *stats) {
+    int world_rank;
+    long long *next = NULL;     // Next unclaimed sample (rank 0's window)
+    MPI_Win win;
+    long long hits = 0;
+
+    // Window setup and its barrier count as claim time: without the others
+    // ready no chunk can be claimed
+    double setup = MPI_Wtime();
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Win_allocate(world_rank == 0 ? (MPI_Aint)sizeof(long long) : 0, sizeof(long long),
+                     MPI_INFO_NULL, MPI_COMM_WORLD, &next, &win);
+    if (world_rank == 0) {
+        *next = 0;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    stats->sched = MPI_Wtime() - setup;
+
+    // One passive-target epoch for the whole run; each claim is an atomic
+    // fetch-and-add completed with a flush, the last one (past the end)
+    // included in the claim time
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+    for (;;) {
+        long long first;
+        double t0 = MPI_Wtime();
+        MPI_Fetch_and_op(&chunk, &first, MPI_LONG_LONG, 0, 0, MPI_SUM, win);
+        MPI_Win_flush(0, win);
+        double t1 = MPI_Wtime();
+        stats->sched += t1 - t0;
+
+        if (first >= total_samples) {
+            break;
+        }
+        long long count = total_samples - first < chunk ? total_samples - first : chunk;
+        hits += count_hits(profile, seed, first, count);
+        stats->busy += MPI_Wtime() - t1;
+        stats->chunks++;
+        stats->samples += count;
+    }
+    MPI_Win_unlock_all(win);
+
+    MPI_Win_free(&win);
+    return hits;
+}
+
+long long pi_schedule_run(pi_schedule_t schedule, long long total_samples,
+                          long long chunk, uint64_t seed, bench_ckpt_t *ckpt,
+                          bench_perf_profile_t *profile, pi_work_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (schedule == PI_SCHEDULE_DYNAMIC) {
+        return run_dynamic(total_samples, chunk, seed, profile, stats);
+    }
+    return run_static(total_samples, chunk, seed, ckpt, profile, stats);
+}
+
+double pi_standard_error(long long hits, long long samples) {
+    if (samples <= 0) {
+        return INFINITY;
+    }
+    double p = (double)hits / samples;
+    return 4.0 * sqrt(p * (1.0 - p) / samples);
+}
+
+// Draw this rank's share of round k: round k covers global samples
+// [k·P·round, (k+1)·P·round), cut at max_samples
+static void draw_round(int k, long long max_samples, long long round_samples,
+                       uint64_t seed, bench_perf_profile_t *profile, long long *local,
+                       pi_work_stats_t *stats) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    long long first = ((long long)k * world_size + world_rank) * round_samples;
+    long long count = round_samples;
+    if (first >= max_samples) {
+        count = 0;
+    } else if (max_samples - first < count) {
+        count = max_samples - first;
+    }
+
+    double t0 = MPI_Wtime();
+    long long hits = count_hits(profile, seed, first, count);
+    stats->busy += MPI_Wtime() - t0;
+    stats->chunks++;
+    stats->samples += count;
+    local[0] += hits;
+    local[1] += count;
+}
+
+long long pi_converge_run(long long max_samples, long long round_samples, double target_error,
+                          uint64_t seed, bench_ckpt_t *ckpt, bench_perf_profile_t *profile,
+                          pi_work_stats_t *stats, pi_converge_t *result) {
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    long long per_round = round_samples * world_size;
+    int max_rounds = (int)((max_samples + per_round - 1) / per_round);
+    long long local[2] = {0, 0};        // Running hits, samples of this rank
+    long long snapshot[2], totals[2];
+    long long record[PI_CONVERGE_RECORD] = {0, 0, 0};  // Rounds, hits, samples
+    MPI_Request request;
+
+    memset(stats, 0, sizeof(*stats));
+    memset(result, 0, sizeof(*result));
+
+    // A restart continues after the saved rounds, their totals on rank 0
+    int k = 0;
+    if (ckpt && ckpt->resumed) {
+        if (world_rank == 0
+            && (bench_ckpt_read(ckpt, BENCH_CKPT_DATA_OFFSET, record, PI_CONVERGE_RECORD,
+                                MPI_LONG_LONG) != PI_CONVERGE_RECORD
+                || record[0] < 0 || record[0] >= max_rounds)) {
+            record[0] = record[1] = record[2] = 0;
+        }
+        MPI_Bcast(record, PI_CONVERGE_RECORD, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+        k = (int)record[0];
+        if (world_rank == 0) {
+            local[0] = record[1];
+            local[1] = record[2];
+            stats->resumed = record[2];
+            ckpt->stats.restored = (double)record[2];
+        }
+    }
+
+    // Round k's totals are reduced while round k + 1 is drawn
+    draw_round(k, max_samples, round_samples, seed, profile, local, stats);
+    k++;
+    for (;;) {
+        int snapshot_rounds = k;
+        snapshot[0] = local[0];
+        snapshot[1] = local[1];
+        MPI_Iallreduce(snapshot, totals, 2, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &request);
+
+        if (k < max_rounds) {
+            draw_round(k, max_samples, round_samples, seed, profile, local, stats);
+            k++;
+        }
+
+        double t0 = MPI_Wtime();
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        stats->sched += MPI_Wtime() - t0;
+
+        result->decision_error = pi_standard_error(totals[0], totals[1]);
+        result->decision_samples = totals[1];
+        if (result->decision_error < target_error) {
+            result->converged = 1;
+            break;
+        }
+        if (totals[1] >= max_samples) {
+            break;
+        }
+
+        // The run continues past these totals, so a restart may too
+        if (ckpt && world_rank == 0 && bench_ckpt_test(ckpt) && bench_ckpt_due(ckpt)) {
+            bench_ckpt_begin(ckpt);
+            record[0] = snapshot_rounds;
+            record[1] = totals[0];
+            record[2] = totals[1];
+            bench_ckpt_write(ckpt, BENCH_CKPT_DATA_OFFSET, record, PI_CONVERGE_RECORD,
+                             MPI_LONG_LONG);
+        }
+    }
+    if (ckpt) {
+        bench_ckpt_wait(ckpt);
+    }
+
+    result->rounds = k;
+    return local[0];
+}
@@ -0,0 +1,103 @@
+/*
+ * Work distribution for the pi-calculation example
+ *
+ * static:  rank r draws one contiguous range of total / P samples (the
+ *          first total % P ranks take one extra), so the job runs at the
+ *          pace of the slowest rank.
+ * dynamic: the sample stream is cut into fixed-size chunks handed out from
+ *          a shared counter on rank 0. Each rank claims its next chunk with
+ *          MPI_Fetch_and_op on an RMA window (passive target, no
+ *          coordinator loop), so faster nodes simply claim more chunks.
+ *
+ * --target-error: ranks draw equal rounds of samples and combine running
+ *          totals with MPI_Iallreduce while the next round computes; every
+ *          rank sees the same totals, so all stop after the same round once
+ *          the standard error of the estimate drops below the target.
+ *
+ * The counter-based sampler makes results independent of who draws which
+ * chunk: a fixed --seed gives the same hit count under either schedule.
+ *
+ * --checkpoint=DIR (static and --target-error): the position in the sample
+ * stream is all the RNG state there is, so a checkpoint is a few counters,
+ * written asynchronously to DIR/pi-checkpoint.bin (see bench-checkpoint.h)
+ * after the common header:
+ *
+ *   static:       one record per rank, {samples drawn, hits}, updated while
+ *                 the rank draws its range in chunks
+ *   target error: one record on rank 0, {rounds, hits, samples} of the
+ *                 totals of the last round; a restart gives them to rank 0
+ *                 and continues with the next round
+ *
+ * A restart with the same samples, seed, ranks, chunk and target resumes
+ * from the records and gives the hit count of an uninterrupted run.
+ */
+
+#ifndef PI_SCHEDULE_H
+#define PI_SCHEDULE_H
+
+#include <stdint.h>
+
+#include "bench-checkpoint.h"
+#include "bench-perf.h"
+
+typedef enum {
+    PI_SCHEDULE_STATIC = 0,
+    PI_SCHEDULE_DYNAMIC
+} pi_schedule_t;
+
+// Per-rank work accounting for one run
+typedef struct {
+    long long chunks;       // Chunks (static: ranges, target error: rounds)
+    long long samples;      // Samples drawn by this rank
+    long long resumed;      // Samples taken from a checkpoint instead
+    double busy;            // Seconds spent sampling
+    double sched;           // Seconds claiming chunks (window setup included) /
+                            // waiting on round totals
+} pi_work_stats_t;
+
+// Outcome of a --target-error run (identical on every rank)
+typedef struct {
+    int rounds;             // Rounds drawn by each rank
+    int converged;          // 1 if the target was met before the sample cap
+    double decision_error;  // Standard error of the totals that ended the run
+    long long decision_samples; // Samples behind that decision
+} pi_converge_t;
+
+// Parse "static" / "dynamic"; returns 0 on success, -1 if unknown
+int pi_schedule_from_name(const char *name, pi_schedule_t *schedule);
+const char *pi_schedule_name(pi_schedule_t schedule);
+
+// Chunk size when none is given: large enough to amortize the atomic,
+// small enough that every rank sees several chunks
+long long pi_default_chunk(long long total_samples, int world_size);
+
+// Open (or create) the checkpoint of a run in dir (target_error 0: the
+// static schedule). Returns 0 on success, -1 after printing the MPI-IO
+// error. Collective.
+int pi_checkpoint_open(bench_ckpt_t *ckpt, const char *dir, double interval,
+                       long long total_samples, long long chunk, uint64_t seed,
+                       double target_error);
+
+// Count hits among total_samples samples of seed's stream on
+// MPI_COMM_WORLD; returns this rank's local hit count. profile counts the
+// sampling calls only (as stats->busy). With a checkpoint (static only,
+// NULL otherwise) the static range is drawn in chunks and resumed from the
+// checkpoint. Collective.
+long long pi_schedule_run(pi_schedule_t schedule, long long total_samples,
+                          long long chunk, uint64_t seed, bench_ckpt_t *ckpt,
+                          bench_perf_profile_t *profile, pi_work_stats_t *stats);
+
+// Standard error of the pi estimate 4·hits/samples (binomial variance)
+double pi_standard_error(long long hits, long long samples);
+
+// Draw rounds of round_samples per rank until the standard error falls
+// below target_error or max_samples are drawn; returns this rank's local
+// hit count. The decision for round k overlaps with computing round k + 1,
+// so one extra round is drawn and included in the totals. With a
+// checkpoint (NULL = none), rank 0 saves the totals behind each decision to
+// continue and a restart resumes after them. Collective.
+long long pi_converge_run(long long max_samples, long long round_samples, double target_error,
+                          uint64_t seed, bench_ckpt_t *ckpt, bench_perf_profile_t *profile,
+                          pi_work_stats_t *stats, pi_converge_t *result);
+
+#endif /* PI_SCHEDULE_H */
@@ -0,0 +1,733 @@
+/*
+ * PMPI Trace: lightweight per-rank MPI profiling by interposition
+ *
+ * A shared library that defines the MPI functions the examples use and
+ * forwards each to its PMPI_ entry point, timing the call. Loaded with
+ * LD_PRELOAD (or linked before the MPI library), it needs no change to the
+ * program, so it works for matrix-mult, pi-monte-carlo and hello as well
+ * as for MPI programs inside container images.
+ *
+ * Per call it records start, end, bytes and peer (destination, source or
+ * root) in a per-rank ring buffer of fixed size. Slots are claimed with an
+ * atomic fetch-and-add, so threads of an MPI_THREAD_MULTIPLE program never
+ * take a lock; when the ring is full the oldest events are overwritten
+ * (the trace keeps the end of the run) while the per-operation totals keep
+ * counting everything.
+ *
+ * At MPI_Finalize:
+ * - rank 0 prints a profile: per operation calls, time and bytes (average
+ *   and slowest rank), each rank's share of wall time spent in MPI, and the
+ *   straggler, the rank that waits least in blocking collectives because
+ *   the others wait for it
+ * - every rank appends its events to one Chrome trace file (Trace Event
+ *   Format, one row per rank) with MPI_File_write_ordered, so the timeline
+ *   of all ranks lands on shared storage in a single collective write.
+ *   Open it in https://ui.perfetto.dev or chrome://tracing. The gaps
+ *   between MPI calls are compute.
+ *
+ * Time zero is the exit of a barrier right after MPI_Init on every rank,
+ * so timelines line up to within the barrier's exit skew.
+ *
+ * Environment:
+ *   BENCH_TRACE_FILE     Trace path (default: pmpi-trace-<job id>.json in the
+ *                        working directory; "none" prints the profile only)
+ *   BENCH_TRACE_EVENTS   Ring buffer size in events per rank (default: 65536,
+ *                        32 bytes each)
+ *
+ * Build: mpicc -O2 -fPIC -shared -o libpmpi-trace.so pmpi-trace.c
+ * Run:   mpirun -x LD_PRELOAD=$PWD/libpmpi-trace.so ./matrix-mult 2000
+ */
+
+#include <mpi.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TRACE_DEFAULT_EVENTS 65536
+
+// Traced operations: enum name, MPI function name, trace category
+#define TRACE_OPS(X) \
+    X(SEND, "MPI_Send", "p2p") \
+    X(RECV, "MPI_Recv", "p2p") \
+    X(ISEND, "MPI_Isend", "p2p") \
+    X(IRECV, "MPI_Irecv", "p2p") \
+    X(WAIT, "MPI_Wait", "wait") \
+    X(WAITALL, "MPI_Waitall", "wait") \
+    X(TEST, "MPI_Test", "wait") \
+    X(BARRIER, "MPI_Barrier", "coll") \
+    X(BCAST, "MPI_Bcast", "coll") \
+    X(REDUCE, "MPI_Reduce", "coll") \
+    X(ALLREDUCE, "MPI_Allreduce", "coll") \
+    X(GATHER, "MPI_Gather", "coll") \
+    X(GATHERV, "MPI_Gatherv", "coll") \
+    X(SCATTER, "MPI_Scatter", "coll") \
+    X(SCATTERV, "MPI_Scatterv", "coll") \
+    X(ALLGATHER, "MPI_Allgather", "coll") \
+    X(ALLGATHERV, "MPI_Allgatherv", "coll") \
+    X(ALLTOALL, "MPI_Alltoall", "coll") \
+    X(IBARRIER, "MPI_Ibarrier", "icoll") \
+    X(IBCAST, "MPI_Ibcast", "icoll") \
+    X(IREDUCE, "MPI_Ireduce", "icoll") \
+    X(IALLREDUCE, "MPI_Iallreduce", "icoll") \
+    X(IGATHER, "MPI_Igather", "icoll") \
+    X(IGATHERV, "MPI_Igatherv", "icoll") \
+    X(ISCATTER, "MPI_Iscatter", "icoll") \
+    X(ISCATTERV, "MPI_Iscatterv", "icoll") \
+    X(IALLGATHER, "MPI_Iallgather", "icoll") \
+    X(IALLTOALL, "MPI_Ialltoall", "icoll") \
+    X(FETCH_AND_OP, "MPI_Fetch_and_op", "rma") \
+    X(WIN_FLUSH, "MPI_Win_flush", "rma") \
+    X(FILE_OPEN, "MPI_File_open", "io") \
+    X(FILE_READ_ALL, "MPI_File_read_all", "io") \
+    X(FILE_WRITE_ALL, "MPI_File_write_all", "io")
+
+#define TRACE_ENUM(id, name, cat) TRACE_OP_##id,
+typedef enum { TRACE_OPS(TRACE_ENUM) TRACE_OP_COUNT } trace_op_t;
+
+#define TRACE_NAME(id, name, cat) name,
+static const char *const op_names[] = { TRACE_OPS(TRACE_NAME) };
+
+#define TRACE_CATEGORY(id, name, cat) cat,
+static const char *const op_categories[] = { TRACE_OPS(TRACE_CATEGORY) };
+
+// One completed call (seconds since the trace epoch)
+typedef struct {
+    double start;
+    double end;
+    uint64_t bytes;
+    int32_t op;
+    int32_t peer;           // Destination, source or root (-1: none)
+} trace_event_t;
+
+static trace_event_t *ring = NULL;
+static size_t ring_capacity = 0;
+static atomic_size_t ring_head;
+
+// Per-operation totals over the whole run (never overwritten)
+static atomic_ullong op_calls[TRACE_OP_COUNT];
+static atomic_ullong op_nanos[TRACE_OP_COUNT];
+static atomic_ullong op_bytes[TRACE_OP_COUNT];
+
+static double epoch = 0.0;
+static int tracing = 0;
+
+static double trace_now(void) {
+    return PMPI_Wtime() - epoch;
+}
+
+static void trace_record(trace_op_t op, double start, uint64_t bytes, int peer) {
+    if (!tracing) {
+        return;
+    }
+    double end = trace_now();
+    atomic_fetch_add_explicit(&op_calls[op], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&op_nanos[op], (unsigned long long)((end - start) * 1e9),
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&op_bytes[op], bytes, memory_order_relaxed);
+    if (ring_capacity > 0) {
+        size_t slot = atomic_fetch_add_explicit(&ring_head, 1, memory_order_relaxed)
+                      % ring_capacity;
+        ring[slot] = (trace_event_t){start, end, bytes, (int32_t)op, (int32_t)peer};
+    }
+}
+
+static uint64_t type_bytes(MPI_Datatype type, int count) {
+    int size = 0;
+    if (count <= 0 || type == MPI_DATATYPE_NULL) {
+        return 0;
+    }
+    PMPI_Type_size(type, &size);
+    return (uint64_t)size * (uint64_t)count;
+}
+
+static int comm_rank(MPI_Comm comm) {
+    int rank = 0;
+    PMPI_Comm_rank(comm, &rank);
+    return rank;
+}
+
+static int comm_size(MPI_Comm comm) {
+    int size = 1;
+    PMPI_Comm_size(comm, &size);
+    return size;
+}
+
+// Ring buffer and a common time zero; called once MPI is initialized
+static void trace_start(void) {
+    const char *env = getenv("BENCH_TRACE_EVENTS");
+    long events = env ? atol(env) : TRACE_DEFAULT_EVENTS;
+
+    ring_capacity = events > 0 ? (size_t)events : 0;
+    ring = ring_capacity ? calloc(ring_capacity, sizeof(trace_event_t)) : NULL;
+    if (!ring) {
+        ring_capacity = 0;
+    }
+    atomic_init(&ring_head, 0);
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        atomic_init(&op_calls[i], 0);
+        atomic_init(&op_nanos[i], 0);
+        atomic_init(&op_bytes[i], 0);
+    }
+    PMPI_Barrier(MPI_COMM_WORLD);
+    epoch = PMPI_Wtime();
+    tracing = 1;
+}
+
+// ---------------------------------------------------------------------------
+// Finalize: profile on rank 0, one Chrome trace file from all ranks
+
+// Default trace path: pmpi-trace-<job id or pid of rank 0>.json
+static void trace_path(char *path, size_t len) {
+    const char *env = getenv("BENCH_TRACE_FILE");
+    if (env && env[0]) {
+        snprintf(path, len, "%s", env);
+        return;
+    }
+    const char *job = getenv("SLURM_JOB_ID");
+    long id = job ? atol(job) : (long)getpid();
+    PMPI_Bcast(&id, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+    snprintf(path, len, "pmpi-trace-%ld.json", id);
+}
+
+// Append printf output to a growing buffer; returns 0 on success
+static int buffer_printf(char **buf, size_t *len, size_t *cap, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static int buffer_printf(char **buf, size_t *len, size_t *cap, const char *fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(*buf + *len, *cap - *len, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            return -1;
+        }
+        if ((size_t)n < *cap - *len) {
+            *len += (size_t)n;
+            return 0;
+        }
+        size_t grown = *cap * 2 + (size_t)n;
+        char *p = realloc(*buf, grown);
+        if (!p) {
+            return -1;
+        }
+        *buf = p;
+        *cap = grown;
+    }
+}
+
+// Write the events of every rank to one Chrome trace file (collective);
+// returns the number of events written across ranks, or -1 on error
+static long long write_trace(const char *path, int rank, int size,
+                             unsigned long long *dropped) {
+    size_t recorded = atomic_load(&ring_head);
+    size_t count = recorded < ring_capacity ? recorded : ring_capacity;
+    size_t first = recorded < ring_capacity ? 0 : recorded % ring_capacity;
+    size_t len = 0, cap = 256 + count * 160;
+    char *buf = malloc(cap);
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int host_len = 0;
+    int ok = buf != NULL;
+
+    PMPI_Get_processor_name(host, &host_len);
+    if (ok && rank == 0) {
+        ok = buffer_printf(&buf, &len, &cap, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") == 0;
+    }
+    if (ok) {
+        ok = buffer_printf(&buf, &len, &cap,
+                           "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                           "\"args\":{\"name\":\"rank %d (%s)\"}},\n"
+                           "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,"
+                           "\"args\":{\"sort_index\":%d}},\n",
+                           rank, rank, host, rank, rank) == 0;
+    }
+    for (size_t i = 0; ok && i < count; i++) {
+        const trace_event_t *e = &ring[(first + i) % ring_capacity];
+        ok = buffer_printf(&buf, &len, &cap,
+                           "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+                           "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%llu,\"peer\":%d}},\n",
+                           op_names[e->op], op_categories[e->op], rank, e->start * 1e6,
+                           (e->end - e->start) * 1e6, (unsigned long long)e->bytes,
+                           (int)e->peer) == 0;
+    }
+    // The last element closes the array without a trailing comma
+    if (ok && rank == size - 1) {
+        ok = buffer_printf(&buf, &len, &cap,
+                           "{\"name\":\"trace_end\",\"ph\":\"M\",\"pid\":%d,\"args\":{}}\n]}\n",
+                           rank) == 0;
+    }
+
+    int all_ok;
+    PMPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    long long written = -1;
+    if (all_ok && len <= (size_t)INT32_MAX) {
+        MPI_File fh;
+        if (PMPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                           MPI_INFO_NULL, &fh) == MPI_SUCCESS) {
+            PMPI_File_set_size(fh, 0);
+            int rc = PMPI_File_write_ordered(fh, buf, (int)len, MPI_CHAR, MPI_STATUS_IGNORE);
+            PMPI_File_close(&fh);
+            long long local = (long long)count;
+            PMPI_Allreduce(&local, &written, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+            int file_ok = rc == MPI_SUCCESS, all_file_ok;
+            PMPI_Allreduce(&file_ok, &all_file_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+            if (!all_file_ok) {
+                written = -1;
+            }
+        }
+    }
+    unsigned long long lost = recorded - count;
+    PMPI_Reduce(&lost, dropped, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    free(buf);
+    return written;
+}
+
+// Order operations by slowest-rank time, longest first
+static const double *sort_times;
+
+static int compare_ops(const void *a, const void *b) {
+    double ta = sort_times[*(const int*)a], tb = sort_times[*(const int*)b];
+    return (ta < tb) - (ta > tb);
+}
+
+static void print_profile(int size, const double *sum, const double *max,
+                          const double *mpi_share, const double *coll_wait,
+                          const double *wall, const char *hosts) {
+    const double *calls = sum, *nanos = sum + TRACE_OP_COUNT, *bytes = sum + 2 * TRACE_OP_COUNT;
+    const double *max_nanos = max + TRACE_OP_COUNT;
+    int order[TRACE_OP_COUNT];
+    double max_wall = 0.0;
+    int min_rank = 0, max_rank = 0, late_rank = 0;
+    double share_sum = 0.0, wait_sum = 0.0;
+
+    for (int r = 0; r < size; r++) {
+        max_wall = wall[r] > max_wall ? wall[r] : max_wall;
+        min_rank = mpi_share[r] < mpi_share[min_rank] ? r : min_rank;
+        max_rank = mpi_share[r] > mpi_share[max_rank] ? r : max_rank;
+        late_rank = coll_wait[r] < coll_wait[late_rank] ? r : late_rank;
+        share_sum += mpi_share[r];
+        wait_sum += coll_wait[r];
+    }
+
+    printf("\n");
+    printf("========================================\n");
+    printf("PMPI Profile (pmpi-trace)\n");
+    printf("========================================\n");
+    printf("Ranks: %d, MPI_Init to MPI_Finalize: %.3f seconds (slowest rank)\n", size, max_wall);
+    printf("Time in MPI: %.1f%% avg, %.1f%% min (rank %d), %.1f%% max (rank %d)\n",
+           100.0 * share_sum / size, 100.0 * mpi_share[min_rank], min_rank,
+           100.0 * mpi_share[max_rank], max_rank);
+    printf("%-20s %10s %12s %12s %12s\n", "Operation", "Calls/rank", "Avg (s)", "Max (s)",
+           "MB/rank");
+    int ops = 0;
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        if (calls[i] > 0) {
+            order[ops++] = i;
+        }
+    }
+    sort_times = max_nanos;
+    qsort(order, ops, sizeof(int), compare_ops);
+    for (int k = 0; k < ops; k++) {
+        int i = order[k];
+        printf("%-20s %10.1f %12.6f %12.6f %12.3f\n", op_names[i], calls[i] / size,
+               nanos[i] / size / 1e9, max_nanos[i] / 1e9, bytes[i] / size / 1e6);
+    }
+    // The rank the others wait for spends the least time in blocking
+    // collectives (it arrives last)
+    if (size > 1 && wait_sum > 0.0) {
+        const char *host = hosts + (size_t)late_rank * MPI_MAX_PROCESSOR_NAME;
+        printf("Straggler: rank %d (%s) waits %.3f seconds in blocking collectives "
+               "(avg %.3f)\n", late_rank, host, coll_wait[late_rank], wait_sum / size);
+    }
+}
+
+static void trace_finish(void) {
+    int rank = comm_rank(MPI_COMM_WORLD);
+    int size = comm_size(MPI_COMM_WORLD);
+    double wall = trace_now();
+    tracing = 0;
+
+    // Totals per operation: calls, nanoseconds, bytes
+    double local[3 * TRACE_OP_COUNT], sum[3 * TRACE_OP_COUNT], max[3 * TRACE_OP_COUNT];
+    double in_mpi = 0.0, coll_wait = 0.0;
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        local[i] = (double)atomic_load(&op_calls[i]);
+        local[TRACE_OP_COUNT + i] = (double)atomic_load(&op_nanos[i]);
+        local[2 * TRACE_OP_COUNT + i] = (double)atomic_load(&op_bytes[i]);
+        in_mpi += local[TRACE_OP_COUNT + i] / 1e9;
+        if (strcmp(op_categories[i], "coll") == 0) {
+            coll_wait += local[TRACE_OP_COUNT + i] / 1e9;
+        }
+    }
+    PMPI_Reduce(local, sum, 3 * TRACE_OP_COUNT, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(local, max, 3 * TRACE_OP_COUNT, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Per-rank share of time in MPI, collective wait and host
+    double mine[3] = {wall > 0.0 ? in_mpi / wall : 0.0, coll_wait, wall};
+    double *per_rank = rank == 0 ? malloc((size_t)size * 3 * sizeof(double)) : NULL;
+    char *hosts = rank == 0 ? malloc((size_t)size * MPI_MAX_PROCESSOR_NAME) : NULL;
+    char host[MPI_MAX_PROCESSOR_NAME] = "";
+    int host_len;
+    PMPI_Get_processor_name(host, &host_len);
+    PMPI_Gather(mine, 3, MPI_DOUBLE, per_rank, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    PMPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, hosts, MPI_MAX_PROCESSOR_NAME,
+                MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    if (rank == 0 && per_rank && hosts) {
+        double *share = malloc((size_t)size * 3 * sizeof(double));
+        if (share) {
+            for (int r = 0; r < size; r++) {
+                share[r] = per_rank[3 * r];
+                share[size + r] = per_rank[3 * r + 1];
+                share[2 * size + r] = per_rank[3 * r + 2];
+            }
+            print_profile(size, sum, max, share, share + size, share + 2 * size, hosts);
+            free(share);
+        }
+    }
+
+    char path[4096];
+    trace_path(path, sizeof(path));
+    if (strcmp(path, "none") != 0) {
+        unsigned long long dropped = 0;
+        long long events = write_trace(path, rank, size, &dropped);
+        if (rank == 0) {
+            if (events < 0) {
+                printf("Trace: could not write %s\n", path);
+            } else {
+                printf("Trace: %s (%lld events", path, events);
+                if (dropped > 0) {
+                    printf(", %llu older events overwritten; raise BENCH_TRACE_EVENTS", dropped);
+                }
+                printf("; open in ui.perfetto.dev or chrome://tracing)\n");
+            }
+        }
+    }
+    if (rank == 0) {
+        printf("========================================\n");
+        fflush(stdout);
+    }
+    free(per_rank);
+    free(hosts);
+    free(ring);
+    ring = NULL;
+    ring_capacity = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Interposed MPI functions
+
+int MPI_Init(int *argc, char ***argv) {
+    int rc = PMPI_Init(argc, argv);
+    if (rc == MPI_SUCCESS) {
+        trace_start();
+    }
+    return rc;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided) {
+    int rc = PMPI_Init_thread(argc, argv, required, provided);
+    if (rc == MPI_SUCCESS) {
+        trace_start();
+    }
+    return rc;
+}
+
+int MPI_Finalize(void) {
+    if (tracing) {
+        trace_finish();
+    }
+    return PMPI_Finalize();
+}
+
+int MPI_Send(const void *buf, int count, MPI_Datatype type, int dest, int tag, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Send(buf, count, type, dest, tag, comm);
+    trace_record(TRACE_OP_SEND, t0, type_bytes(type, count), dest);
+    return rc;
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+             MPI_Status *status) {
+    double t0 = trace_now();
+    int rc = PMPI_Recv(buf, count, type, source, tag, comm, status);
+    trace_record(TRACE_OP_RECV, t0, type_bytes(type, count), source);
+    return rc;
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Isend(buf, count, type, dest, tag, comm, request);
+    trace_record(TRACE_OP_ISEND, t0, type_bytes(type, count), dest);
+    return rc;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Irecv(buf, count, type, source, tag, comm, request);
+    trace_record(TRACE_OP_IRECV, t0, type_bytes(type, count), source);
+    return rc;
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status) {
+    double t0 = trace_now();
+    int rc = PMPI_Wait(request, status);
+    trace_record(TRACE_OP_WAIT, t0, 0, -1);
+    return rc;
+}
+
+int MPI_Waitall(int count, MPI_Request requests[], MPI_Status statuses[]) {
+    double t0 = trace_now();
+    int rc = PMPI_Waitall(count, requests, statuses);
+    trace_record(TRACE_OP_WAITALL, t0, 0, -1);
+    return rc;
+}
+
+int MPI_Test(MPI_Request *request, int *flag, MPI_Status *status) {
+    double t0 = trace_now();
+    int rc = PMPI_Test(request, flag, status);
+    trace_record(TRACE_OP_TEST, t0, 0, -1);
+    return rc;
+}
+
+int MPI_Barrier(MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Barrier(comm);
+    trace_record(TRACE_OP_BARRIER, t0, 0, -1);
+    return rc;
+}
+
+int MPI_Bcast(void *buf, int count, MPI_Datatype type, int root, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Bcast(buf, count, type, root, comm);
+    trace_record(TRACE_OP_BCAST, t0, type_bytes(type, count), root);
+    return rc;
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type, MPI_Op op,
+               int root, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Reduce(sendbuf, recvbuf, count, type, op, root, comm);
+    trace_record(TRACE_OP_REDUCE, t0, type_bytes(type, count), root);
+    return rc;
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type, MPI_Op op,
+                  MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Allreduce(sendbuf, recvbuf, count, type, op, comm);
+    trace_record(TRACE_OP_ALLREDUCE, t0, type_bytes(type, count), -1);
+    return rc;
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+               int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    trace_record(TRACE_OP_GATHER, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcount) : type_bytes(sendtype, sendcount), root);
+    return rc;
+}
+
+int MPI_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                const int recvcounts[], const int displs[], MPI_Datatype recvtype, int root,
+                MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype,
+                          root, comm);
+    trace_record(TRACE_OP_GATHERV, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcounts[comm_rank(comm)])
+                 : type_bytes(sendtype, sendcount), root);
+    return rc;
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    trace_record(TRACE_OP_SCATTER, t0, recvbuf == MPI_IN_PLACE
+                 ? type_bytes(sendtype, sendcount) : type_bytes(recvtype, recvcount), root);
+    return rc;
+}
+
+int MPI_Scatterv(const void *sendbuf, const int sendcounts[], const int displs[],
+                 MPI_Datatype sendtype, void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 int root, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype,
+                           root, comm);
+    trace_record(TRACE_OP_SCATTERV, t0, recvbuf == MPI_IN_PLACE
+                 ? type_bytes(sendtype, sendcounts[comm_rank(comm)])
+                 : type_bytes(recvtype, recvcount), root);
+    return rc;
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                  int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    trace_record(TRACE_OP_ALLGATHER, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcount) : type_bytes(sendtype, sendcount), -1);
+    return rc;
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                   const int recvcounts[], const int displs[], MPI_Datatype recvtype,
+                   MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+                             recvtype, comm);
+    trace_record(TRACE_OP_ALLGATHERV, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcounts[comm_rank(comm)])
+                 : type_bytes(sendtype, sendcount), -1);
+    return rc;
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    double t0 = trace_now();
+    int rc = PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    trace_record(TRACE_OP_ALLTOALL, t0,
+                 type_bytes(recvtype, recvcount) * (uint64_t)comm_size(comm), -1);
+    return rc;
+}
+
+int MPI_Ibarrier(MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Ibarrier(comm, request);
+    trace_record(TRACE_OP_IBARRIER, t0, 0, -1);
+    return rc;
+}
+
+int MPI_Ibcast(void *buf, int count, MPI_Datatype type, int root, MPI_Comm comm,
+               MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Ibcast(buf, count, type, root, comm, request);
+    trace_record(TRACE_OP_IBCAST, t0, type_bytes(type, count), root);
+    return rc;
+}
+
+int MPI_Ireduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type, MPI_Op op,
+                int root, MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Ireduce(sendbuf, recvbuf, count, type, op, root, comm, request);
+    trace_record(TRACE_OP_IREDUCE, t0, type_bytes(type, count), root);
+    return rc;
+}
+
+int MPI_Iallreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type, MPI_Op op,
+                   MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Iallreduce(sendbuf, recvbuf, count, type, op, comm, request);
+    trace_record(TRACE_OP_IALLREDUCE, t0, type_bytes(type, count), -1);
+    return rc;
+}
+
+int MPI_Igather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm,
+                MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Igather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root,
+                          comm, request);
+    trace_record(TRACE_OP_IGATHER, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcount) : type_bytes(sendtype, sendcount), root);
+    return rc;
+}
+
+int MPI_Igatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                 const int recvcounts[], const int displs[], MPI_Datatype recvtype, int root,
+                 MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Igatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype,
+                           root, comm, request);
+    trace_record(TRACE_OP_IGATHERV, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcounts[comm_rank(comm)])
+                 : type_bytes(sendtype, sendcount), root);
+    return rc;
+}
+
+int MPI_Iscatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm,
+                 MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Iscatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root,
+                           comm, request);
+    trace_record(TRACE_OP_ISCATTER, t0, recvbuf == MPI_IN_PLACE
+                 ? type_bytes(sendtype, sendcount) : type_bytes(recvtype, recvcount), root);
+    return rc;
+}
+
+int MPI_Iscatterv(const void *sendbuf, const int sendcounts[], const int displs[],
+                  MPI_Datatype sendtype, void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  int root, MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Iscatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype,
+                            root, comm, request);
+    trace_record(TRACE_OP_ISCATTERV, t0, recvbuf == MPI_IN_PLACE
+                 ? type_bytes(sendtype, sendcounts[comm_rank(comm)])
+                 : type_bytes(recvtype, recvcount), root);
+    return rc;
+}
+
+int MPI_Iallgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                   int recvcount, MPI_Datatype recvtype, MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Iallgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm,
+                             request);
+    trace_record(TRACE_OP_IALLGATHER, t0, sendbuf == MPI_IN_PLACE
+                 ? type_bytes(recvtype, recvcount) : type_bytes(sendtype, sendcount), -1);
+    return rc;
+}
+
+int MPI_Ialltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                  int recvcount, MPI_Datatype recvtype, MPI_Comm comm, MPI_Request *request) {
+    double t0 = trace_now();
+    int rc = PMPI_Ialltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm,
+                            request);
+    trace_record(TRACE_OP_IALLTOALL, t0,
+                 type_bytes(recvtype, recvcount) * (uint64_t)comm_size(comm), -1);
+    return rc;
+}
+
+int MPI_Fetch_and_op(const void *origin, void *result, MPI_Datatype type, int target_rank,
+                     MPI_Aint target_disp, MPI_Op op, MPI_Win win) {
+    double t0 = trace_now();
+    int rc = PMPI_Fetch_and_op(origin, result, type, target_rank, target_disp, op, win);
+    trace_record(TRACE_OP_FETCH_AND_OP, t0, type_bytes(type, 1), target_rank);
+    return rc;
+}
+
+int MPI_Win_flush(int rank, MPI_Win win) {
+    double t0 = trace_now();
+    int rc = PMPI_Win_flush(rank, win);
+    trace_record(TRACE_OP_WIN_FLUSH, t0, 0, rank);
+    return rc;
+}
+
+int MPI_File_open(MPI_Comm comm, const char *filename, int amode, MPI_Info info, MPI_File *fh) {
+    double t0 = trace_now();
+    int rc = PMPI_File_open(comm, filename, amode, info, fh);
+    trace_record(TRACE_OP_FILE_OPEN, t0, 0, -1);
+    return rc;
+}
+
+int MPI_File_read_all(MPI_File fh, void *buf, int count, MPI_Datatype type, MPI_Status *status) {
+    double t0 = trace_now();
+    int rc = PMPI_File_read_all(fh, buf, count, type, status);
+    trace_record(TRACE_OP_FILE_READ_ALL, t0, type_bytes(type, count), -1);
+    return rc;
+}
+
+int MPI_File_write_all(MPI_File fh, const void *buf, int count, MPI_Datatype type,
+                       MPI_Status *status) {
+    double t0 = trace_now();
+    int rc = PMPI_File_write_all(fh, buf, count, type, status);
+    trace_record(TRACE_OP_FILE_WRITE_ALL, t0, type_bytes(type, count), -1);
+    return rc;
+}
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Scaling Sweep: efficiency report from the JSON records of a sweep.
+
+Reads the records that sweep-task.sbatch wrote to one or more results
+directories and prints, per base problem size, one row per configuration,
+ordered by core count (ranks x threads):
+
+  time      median over repetitions of the chosen phase (slowest rank)
+  speedup   S = T(base) / T(p)                       strong scaling
+            S = (p / p0) * T(base) / T(p)             weak (scaled speedup)
+  eff       E = S / (p / p0)
+  karp-flatt  e = (1/S - 1/q) / (1 - 1/q) with q = p / p0
+
+The base configuration is the one with the fewest cores, so q counts
+relative cores. The experimentally determined serial fraction e should stay
+flat. If it grows with q, the overhead is parallel (communication, imbalance):
+more nodes will pay off less and less. The verdict line names the largest
+node count whose efficiency is still at or above --threshold.
+
+Usage: sweep-report.py [--phase=total] [--threshold=0.7] [--csv=PATH] DIR...
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import statistics
+import sys
+
+RECORD_NAME = re.compile(
+    r"^(?P<example>[a-z]+)-b(?P<base>\d+)-n(?P<size>\d+)-N(?P<nodes>\d+)"
+    r"-R(?P<rpn>\d+)-T(?P<threads>\d+)-r(?P<rep>\d+)\.json$")
+
+
+def read_conf(directory):
+    """Key/value pairs of sweep.conf (empty if missing)."""
+    conf = {}
+    path = os.path.join(directory, "sweep.conf")
+    if os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                key, sep, value = line.rstrip("\n").partition("=")
+                if sep:
+                    conf[key] = value
+    return conf
+
+
+def phase_time(record, phase):
+    """Seconds of `phase` on the slowest rank (stats objects give max)."""
+    value = record.get("phases", {}).get(phase)
+    if isinstance(value, dict):
+        value = value.get("max")
+    return value if isinstance(value, (int, float)) and value > 0 else None
+
+
+def load_runs(directories, phase):
+    """Group run times by (mode, example, base size, nodes, ranks/node, threads)."""
+    groups = {}
+    for directory in directories:
+        mode = read_conf(directory).get("mode", "strong")
+        for name in sorted(os.listdir(directory)):
+            match = RECORD_NAME.match(name)
+            if not match:
+                continue
+            try:
+                with open(os.path.join(directory, name)) as f:
+                    record = json.load(f)
+            except (OSError, ValueError) as err:
+                print(f"Warning: skipping {name}: {err}", file=sys.stderr)
+                continue
+            seconds = phase_time(record, phase)
+            if seconds is None:
+                print(f"Warning: {name} has no '{phase}' phase", file=sys.stderr)
+                continue
+            key = (mode, match["example"], int(match["base"]), int(match["nodes"]),
+                   int(match["rpn"]), int(match["threads"]))
+            run = groups.setdefault(key, {"times": [], "size": int(match["size"]),
+                                          "ranks": record.get("ranks", 0),
+                                          "threads": record.get("threads_per_rank", 1),
+                                          "hosts": len(set(record.get("hosts", [])))})
+            run["times"].append(seconds)
+    return groups
+
+
+def scaling_rows(groups):
+    """Yield (mode, example, base, rows) with the derived metrics per row."""
+    series = {}
+    for key, run in groups.items():
+        mode, example, base = key[:3]
+        cores = run["ranks"] * run["threads"]
+        series.setdefault((mode, example, base), []).append({
+            "nodes": run["hosts"] or key[3], "rpn": key[4], "threads": key[5],
+            "cores": cores, "size": run["size"], "runs": len(run["times"]),
+            "time": statistics.median(run["times"]),
+            "min": min(run["times"]), "max": max(run["times"])})
+
+    for (mode, example, base), rows in sorted(series.items()):
+        rows.sort(key=lambda r: (r["cores"], r["nodes"]))
+        ref = rows[0]
+        for row in rows:
+            q = row["cores"] / ref["cores"]
+            ratio = ref["time"] / row["time"]
+            row["q"] = q
+            row["speedup"] = ratio if mode == "strong" else q * ratio
+            row["efficiency"] = row["speedup"] / q
+            if q > 1.0:
+                row["karp_flatt"] = (1.0 / row["speedup"] - 1.0 / q) / (1.0 - 1.0 / q)
+            else:
+                row["karp_flatt"] = None
+        yield mode, example, base, rows
+
+
+def print_table(mode, example, base, rows, phase, threshold):
+    size_label = "total size" if mode == "strong" else "size per rank (base)"
+    print("========================================")
+    print(f"{example}: {mode} scaling, {size_label} {base}, phase '{phase}'")
+    print("========================================")
+    print(f"{'Nodes':>5} {'Rk/N':>4} {'Thr':>3} {'Cores':>5} {'Size':>12} {'Runs':>4} "
+          f"{'Time (s)':>10} {'Spread':>7} {'Speedup':>8} {'Eff':>6} {'Karp-Flatt':>10}")
+    for row in rows:
+        spread = (row["max"] - row["min"]) / row["time"] if row["time"] > 0 else 0.0
+        kf = f"{row['karp_flatt']:10.4f}" if row["karp_flatt"] is not None else f"{'-':>10}"
+        print(f"{row['nodes']:5d} {row['rpn']:4d} {row['threads']:3d} {row['cores']:5d} "
+              f"{row['size']:12d} {row['runs']:4d} {row['time']:10.4f} {100 * spread:6.1f}% "
+              f"{row['speedup']:8.2f} {100 * row['efficiency']:5.1f}% {kf}")
+
+    # Largest node count still scaling at the threshold
+    good = [r for r in rows if r["efficiency"] >= threshold]
+    if good:
+        best = max(good, key=lambda r: (r["nodes"], r["cores"]))
+        print(f"Verdict: efficiency >= {100 * threshold:.0f}% up to {best['nodes']} node(s) "
+              f"({best['cores']} cores)")
+    kfs = [r["karp_flatt"] for r in rows if r["karp_flatt"] is not None]
+    if len(kfs) >= 2:
+        trend = "grows (parallel overhead)" if kfs[-1] > 1.5 * kfs[0] else "stays flat"
+        print(f"Karp-Flatt serial fraction {trend}: {kfs[0]:.4f} -> {kfs[-1]:.4f}")
+    print("")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Parallel-efficiency and Karp-Flatt tables from a scaling sweep")
+    parser.add_argument("directories", nargs="+", metavar="DIR",
+                        help="results directories written by sweep.sh")
+    parser.add_argument("--phase", default="total",
+                        help="phase timed (default: total; e.g. compute for matrix)")
+    parser.add_argument("--threshold", type=float, default=0.7,
+                        help="efficiency for the verdict line (default: 0.7)")
+    parser.add_argument("--csv", metavar="PATH", help="also write all rows as CSV")
+    args = parser.parse_args()
+    for directory in args.directories:
+        if not os.path.isdir(directory):
+            parser.error(f"{directory} is not a directory")
+
+    groups = load_runs(args.directories, args.phase)
+    if not groups:
+        print("No sweep records found", file=sys.stderr)
+        return 1
+
+    all_rows = []
+    for mode, example, base, rows in scaling_rows(groups):
+        print_table(mode, example, base, rows, args.phase, args.threshold)
+        all_rows.extend(dict(row, mode=mode, example=example, base=base) for row in rows)
+
+    if args.csv:
+        fields = ["example", "mode", "base", "nodes", "rpn", "threads", "cores", "size",
+                  "runs", "time", "min", "max", "q", "speedup", "efficiency", "karp_flatt"]
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+            writer.writeheader()
+            writer.writerows(all_rows)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
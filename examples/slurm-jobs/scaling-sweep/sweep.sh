@@ -0,0 +1,183 @@
+#!/bin/bash
+# ========================================
+# Scaling Sweep: submit job arrays
+# ========================================
+# Submits one Slurm job array per (node count, ranks per node) shape for
+# matrix-multiply or pi-calculation. Each array task runs one problem size
+# once (sweep-task.sbatch) and writes a JSON record. sweep-report.py turns
+# the records into speedup, parallel-efficiency and Karp-Flatt tables.
+#
+#   strong scaling: the same total problem at every rank count
+#   weak scaling:   the same work per rank (pi: SIZE samples per rank;
+#                   matrix: n = SIZE * p^(1/3), so 2n³/p flops per rank stay
+#                   constant)
+#
+# Usage: sweep.sh [options] matrix|pi [-- example args...]
+#   --mode=strong|weak      Scaling mode (default: strong)
+#   --nodes=LIST            Node counts, e.g. 1,2,4 (default: 1,2)
+#   --ranks-per-node=LIST   MPI ranks per node, e.g. 1,2 (default: 1,2)
+#   --threads=N             OpenMP threads per rank (default: 1)
+#   --size=LIST             Problem sizes; strong: total (matrix n, pi
+#                           samples), weak: per rank (default: matrix 2000,
+#                           pi 400000000 strong / 100000000 weak)
+#   --repeat=N              Runs per configuration (default: 3)
+#   --partition=NAME        Slurm partition (default: compute)
+#   --time=HH:MM:SS         Limit per array task (default: 00:15:00)
+#   --name=ID               Sweep ID, names the results directory
+#                           (default: <example>-<mode>-<date>-<time>)
+#   --results=DIR           Parent of the results directory
+#                           (default: /mnt/beegfs/slurm-jobs/scaling-sweep/results)
+#   --dry-run               Print the sbatch commands without submitting
+#
+# Example (from /mnt/beegfs/slurm-jobs/scaling-sweep):
+#   ./sweep.sh --mode=strong --nodes=1,2,4 --ranks-per-node=2 matrix -- --algo=summa
+#   ./sweep-report.py results/matrix-strong-*     # once the arrays finished
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+SLURM_JOBS_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+MODE=strong
+NODES=1,2
+RANKS_PER_NODE=1,2
+THREADS=1
+SIZES=""
+REPEAT=3
+PARTITION=compute
+TIME_LIMIT=00:15:00
+SWEEP_ID=""
+RESULTS_PARENT=/mnt/beegfs/slurm-jobs/scaling-sweep/results
+DRY_RUN=0
+EXAMPLE=""
+EXTRA_ARGS=()
+
+usage() {
+    sed -n '/^# Usage:/,/^# Example/p' "$0" | sed '$d; s/^# \{0,1\}//'
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --mode=*) MODE=${1#*=} ;;
+        --nodes=*) NODES=${1#*=} ;;
+        --ranks-per-node=*) RANKS_PER_NODE=${1#*=} ;;
+        --threads=*) THREADS=${1#*=} ;;
+        --size=*) SIZES=${1#*=} ;;
+        --repeat=*) REPEAT=${1#*=} ;;
+        --partition=*) PARTITION=${1#*=} ;;
+        --time=*) TIME_LIMIT=${1#*=} ;;
+        --name=*) SWEEP_ID=${1#*=} ;;
+        --results=*) RESULTS_PARENT=${1#*=} ;;
+        --dry-run) DRY_RUN=1 ;;
+        -h | --help)
+            usage
+            exit 0
+            ;;
+        --)
+            shift
+            EXTRA_ARGS=("$@")
+            break
+            ;;
+        -*)
+            echo "ERROR: unknown option $1" >&2
+            usage >&2
+            exit 1
+            ;;
+        *) EXAMPLE=$1 ;;
+    esac
+    shift
+done
+
+case "$EXAMPLE" in
+    matrix) DEFAULT_STRONG=2000 DEFAULT_WEAK=2000 ;;
+    pi) DEFAULT_STRONG=400000000 DEFAULT_WEAK=100000000 ;;
+    *)
+        echo "ERROR: example must be matrix or pi" >&2
+        usage >&2
+        exit 1
+        ;;
+esac
+case "$MODE" in
+    strong) SIZES=${SIZES:-$DEFAULT_STRONG} ;;
+    weak) SIZES=${SIZES:-$DEFAULT_WEAK} ;;
+    *)
+        echo "ERROR: --mode must be strong or weak" >&2
+        exit 1
+        ;;
+esac
+for value in "$THREADS" "$REPEAT" ${NODES//,/ } ${RANKS_PER_NODE//,/ } ${SIZES//,/ }; do
+    if ! [[ "$value" =~ ^[1-9][0-9]*$ ]]; then
+        echo "ERROR: '$value' is not a positive integer" >&2
+        exit 1
+    fi
+done
+
+SWEEP_ID=${SWEEP_ID:-$EXAMPLE-$MODE-$(date +%Y%m%d-%H%M%S)}
+RESULTS="$RESULTS_PARENT/$SWEEP_ID"
+
+# Problem size actually run at p ranks for base size $1
+scaled_size() {
+    local base=$1 p=$2
+    if [ "$MODE" = "strong" ]; then
+        echo "$base"
+    elif [ "$EXAMPLE" = "pi" ]; then
+        echo $((base * p))
+    else
+        awk -v n="$base" -v p="$p" 'BEGIN { printf "%d\n", n * p ^ (1.0 / 3.0) + 0.5 }'
+    fi
+}
+
+if [ "$DRY_RUN" = "0" ]; then
+    mkdir -p "$RESULTS"
+    # Sweep description for sweep-report.py
+    {
+        echo "example=$EXAMPLE"
+        echo "mode=$MODE"
+        echo "sizes=$SIZES"
+        echo "nodes=$NODES"
+        echo "ranks_per_node=$RANKS_PER_NODE"
+        echo "threads=$THREADS"
+        echo "repeat=$REPEAT"
+        echo "args=${EXTRA_ARGS[*]}"
+    } > "$RESULTS/sweep.conf"
+fi
+
+echo "Scaling sweep $SWEEP_ID ($EXAMPLE, $MODE scaling)"
+echo "  Results: $RESULTS"
+submitted=0
+for nodes in ${NODES//,/ }; do
+    for rpn in ${RANKS_PER_NODE//,/ }; do
+        p=$((nodes * rpn))
+        # One array task per (size, repetition); the task picks both from
+        # SLURM_ARRAY_TASK_ID
+        run_sizes=()
+        for base in ${SIZES//,/ }; do
+            run_sizes+=("$base:$(scaled_size "$base" "$p")")
+        done
+        tasks=$((${#run_sizes[@]} * REPEAT))
+
+        cmd=(sbatch --parsable
+             "--job-name=sweep-$EXAMPLE-${nodes}x${rpn}"
+             "--nodes=$nodes" "--ntasks-per-node=$rpn" "--cpus-per-task=$THREADS"
+             "--partition=$PARTITION" "--time=$TIME_LIMIT" --exclusive
+             "--array=0-$((tasks - 1))"
+             "--chdir=$SLURM_JOBS_DIR"
+             "--output=$RESULTS/slurm-%A_%a.out"
+             "--export=ALL,SWEEP_EXAMPLE=$EXAMPLE,SWEEP_MODE=$MODE,SWEEP_RESULTS=$RESULTS,SWEEP_SIZES=${run_sizes[*]},SWEEP_REPEAT=$REPEAT"
+             "$SCRIPT_DIR/sweep-task.sbatch" "${EXTRA_ARGS[@]}")
+        if [ "$DRY_RUN" = "1" ]; then
+            printf '%q ' "${cmd[@]}"
+            echo
+        else
+            job_id=$("${cmd[@]}")
+            echo "  ${nodes} node(s) x ${rpn} rank(s): array job $job_id ($tasks tasks)"
+            submitted=$((submitted + tasks))
+        fi
+    done
+done
+
+if [ "$DRY_RUN" = "0" ]; then
+    echo ""
+    echo "Submitted $submitted array tasks. When they have finished:"
+    echo "  $SCRIPT_DIR/sweep-report.py $RESULTS"
+fi
@@ -0,0 +1,642 @@
+/*
+ * STREAM Memory Bandwidth and Roofline Calibration
+ *
+ * Measures the sustainable memory bandwidth of every node and NUMA domain
+ * with the four STREAM kernels (copy, scale, add, triad; see
+ * stream-kernels.h), then the peak double-precision FP rate of the same
+ * cores. Together they give each node's roofline: attainable GFLOPS =
+ * min(peak, intensity x triad bandwidth), with the ridge point peak / triad
+ * (FLOP per byte) separating memory-bound from compute-bound kernels. The
+ * arithmetic intensity matrix-mult --counters reports for the GEMM can be
+ * placed on it directly.
+ *
+ * - Hybrid MPI+OpenMP: every rank owns three arrays of `elements` doubles,
+ *   first touched by its OpenMP threads with the split the kernels use, so
+ *   with ranks bound to sockets (NUMA domains) and threads bound to cores
+ *   each thread streams through local memory. The NUMA placement table
+ *   shows whether that held.
+ * - All ranks run each kernel at the same time (a barrier before every
+ *   kernel). A node's bandwidth is the bytes of its ranks over the slowest
+ *   of them, the best of all iterations but the first (STREAM's rule); the
+ *   same reduction per NUMA domain groups the ranks of a node by the nodes
+ *   their threads run on. A domain whose triad falls well below its
+ *   siblings' points at remote placement or a degraded memory channel.
+ * - Nontemporal stores (default where the CPU has them) skip the
+ *   write-allocate read, so the counted bytes are the DRAM traffic;
+ *   --stores=regular measures what ordinary code sees.
+ * - Nodes whose triad bandwidth or peak FP rate is below --threshold of the
+ *   median node are listed: on a cluster of identical VMs that is usually
+ *   lost memory or CPU passthrough (wrong NUMA topology, no huge pages on
+ *   the host, a throttled or overcommitted host).
+ * - The final values of the arrays are checked against the scalar STREAM
+ *   recurrence on every rank.
+ *
+ * Options:
+ *   [elements]            Doubles per array per rank, K/M/G suffixes allowed
+ *                         (default: 32M, 256 MB per array; keep each array
+ *                         at least 4x the last-level cache)
+ *   --iterations=N        Runs of each kernel, the first untimed (default: 10,
+ *                         2..200)
+ *   --stores=nt|regular   Store kind (default: nt where supported)
+ *   --peak-time=SECONDS   Duration of one peak FP measurement (default: 0.5)
+ *   --threshold=F         Flag nodes below F x the median node (default: 0.8)
+ *   --hugepages=none|thp|2m|1g   Page size for the arrays (default: thp,
+ *                         or BENCH_HUGEPAGES; see bench-alloc.h)
+ *   --json[=PATH]         Also write a JSON record to stdout or PATH
+ *
+ * Compile: mpicc -O3 -fopenmp -I../common -o stream-bench stream-bench.c \
+ *          stream-kernels.c ../common/bench-threads.c ../common/bench-report.c \
+ *          ../common/bench-numa.c ../common/bench-alloc.c -lm
+ * Run: OMP_NUM_THREADS=4 OMP_PLACES=cores OMP_PROC_BIND=close \
+ *      mpirun -np 2 --map-by numa:PE=4 --bind-to core -x OMP_NUM_THREADS \
+ *      -x OMP_PLACES -x OMP_PROC_BIND ./stream-bench 64M
+ */
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-alloc.h"
+#include "bench-numa.h"
+#include "bench-report.h"
+#include "bench-threads.h"
+#include "stream-kernels.h"
+
+#define DEFAULT_ELEMENTS (32LL << 20)
+#define DEFAULT_ITERATIONS 10
+#define MAX_ITERATIONS 200          // Array values grow 15x per iteration
+#define DEFAULT_PEAK_TIME 0.5
+#define DEFAULT_THRESHOLD 0.8
+
+#define STREAM_SCALAR 3.0
+#define STREAM_EPSILON 1e-13        // Largest relative error accepted (double)
+
+#define PEAK_TRIALS 3
+
+// Command-line configuration
+typedef struct {
+    long long elements;             // Per array per rank (rounded up to rows)
+    int iterations;
+    int nontemporal;                // Requested; used only where supported
+    double peak_time;
+    double threshold;
+    int json;                       // Write a JSON record
+    const char *json_path;          // JSON destination (NULL = stdout)
+} stream_config_t;
+
+// Results of one group of ranks: a node, a NUMA domain or the whole job
+typedef struct {
+    double ranks;
+    double gbps[STREAM_KERNEL_COUNT];   // Best bandwidth of the group
+    double gflops;                      // Sum of the ranks' peak FP rates
+    double nodes;                       // NUMA node mask of the threads
+} stream_group_t;
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [elements] [--iterations=N] [--stores=nt|regular] [--peak-time=SECONDS]\n"
+           "       [--threshold=F] [--hugepages=none|thp|2m|1g] [--json[=PATH]]\n", prog);
+}
+
+// Parse command line; returns 0 on success, -1 on invalid arguments.
+// Every rank parses the arguments; only rank 0 reports errors.
+int parse_args(int argc, char **argv, stream_config_t *config, int rank) {
+    const char *value;
+
+    config->elements = DEFAULT_ELEMENTS;
+    config->iterations = DEFAULT_ITERATIONS;
+    config->nontemporal = 1;
+    config->peak_time = DEFAULT_PEAK_TIME;
+    config->threshold = DEFAULT_THRESHOLD;
+    config->json = 0;
+    config->json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        int pages_option = bench_alloc_option(arg);
+        if (pages_option < 0) {
+            if (rank == 0) {
+                printf("Error: Unknown huge page mode '%s'\n", arg + strlen("--hugepages="));
+            }
+            return -1;
+        } else if (pages_option > 0) {
+            continue;
+        }
+        if ((value = bench_option_value(arg, "--iterations="))) {
+            config->iterations = atoi(value);
+        } else if ((value = bench_option_value(arg, "--stores="))) {
+            if (strcmp(value, "nt") == 0) {
+                config->nontemporal = 1;
+            } else if (strcmp(value, "regular") == 0) {
+                config->nontemporal = 0;
+            } else {
+                if (rank == 0) {
+                    printf("Error: Unknown store kind '%s'\n", value);
+                }
+                return -1;
+            }
+        } else if ((value = bench_option_value(arg, "--peak-time="))) {
+            config->peak_time = atof(value);
+        } else if ((value = bench_option_value(arg, "--threshold="))) {
+            config->threshold = atof(value);
+        } else if (bench_json_option(arg, &config->json_path)) {
+            config->json = 1;
+        } else if (arg[0] != '-') {
+            config->elements = bench_parse_size(arg);
+        } else {
+            if (rank == 0) {
+                printf("Error: Unknown option '%s'\n", arg);
+            }
+            return -1;
+        }
+    }
+
+    if (config->elements < STREAM_ROW) {
+        if (rank == 0) {
+            printf("Error: Array size must be at least %d elements\n", STREAM_ROW);
+        }
+        return -1;
+    }
+    if (config->iterations < 2 || config->iterations > MAX_ITERATIONS) {
+        if (rank == 0) {
+            printf("Error: Iterations must be between 2 and %d\n", MAX_ITERATIONS);
+        }
+        return -1;
+    }
+    if (config->peak_time <= 0.0 || config->threshold <= 0.0 || config->threshold > 1.0) {
+        if (rank == 0) {
+            printf("Error: Peak time must be positive and threshold in (0, 1]\n");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// a = 1, b = 2, c = 0 with the kernels' row split (after the first touch)
+void init_arrays(double *a, double *b, double *c, size_t rows) {
+    #pragma omp parallel for schedule(static)
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t i = r * STREAM_ROW; i < (r + 1) * STREAM_ROW; i++) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+    }
+}
+
+// Compare the arrays with the scalar recurrence of `iterations` runs;
+// returns 1 if every element is within STREAM_EPSILON
+int check_arrays(const double *a, const double *b, const double *c, size_t n,
+                 int iterations) {
+    double aj = 1.0, bj = 2.0, cj = 0.0;
+    double a_err = 0.0, b_err = 0.0, c_err = 0.0;
+
+    for (int it = 0; it < iterations; it++) {
+        cj = aj;
+        bj = STREAM_SCALAR * cj;
+        cj = aj + bj;
+        aj = bj + STREAM_SCALAR * cj;
+    }
+
+    #pragma omp parallel for reduction(+:a_err, b_err, c_err)
+    for (size_t i = 0; i < n; i++) {
+        a_err += fabs(a[i] - aj);
+        b_err += fabs(b[i] - bj);
+        c_err += fabs(c[i] - cj);
+    }
+    return a_err / n / fabs(aj) <= STREAM_EPSILON && b_err / n / fabs(bj) <= STREAM_EPSILON
+           && c_err / n / fabs(cj) <= STREAM_EPSILON;
+}
+
+// Peak FP rate of this rank: repeats sized for `seconds` on the first
+// pass, then the best of PEAK_TRIALS runs with all ranks running together
+double measure_peak(double seconds, stream_isa_t isa) {
+    long repeats = 1 << 12;
+    double t = 0.0, best = 0.0;
+
+    for (;;) {
+        double t0 = MPI_Wtime();
+        stream_peak_run(repeats, isa);
+        t = MPI_Wtime() - t0;
+        if (t >= seconds / 8 || repeats > (1L << 40)) {
+            break;
+        }
+        repeats *= 2;
+    }
+    repeats = (long)(repeats * (seconds / t)) + 1;
+
+    for (int trial = 0; trial < PEAK_TRIALS; trial++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+        double flops = stream_peak_run(repeats, isa);
+        double rate = flops / (MPI_Wtime() - t0);
+        best = rate > best ? rate : best;
+    }
+    return best;
+}
+
+// Bandwidth of the ranks in comm: per iteration and kernel the slowest
+// rank's time, best over the timed iterations. Valid on the communicator's
+// rank 0. Collective.
+void group_results(MPI_Comm comm, const double *times, int iterations, size_t n,
+                   double gflops, unsigned long nodes, stream_group_t *group) {
+    int size, rank;
+    double *slowest = malloc((size_t)iterations * STREAM_KERNEL_COUNT * sizeof(double));
+
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
+    if (!slowest) {
+        printf("Memory allocation failed for group timings\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Reduce(times, slowest, iterations * STREAM_KERNEL_COUNT, MPI_DOUBLE, MPI_MAX, 0, comm);
+    memset(group, 0, sizeof(*group));
+    MPI_Reduce(&gflops, &group->gflops, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    if (rank == 0) {
+        group->ranks = size;
+        group->nodes = (double)nodes;
+        for (int k = 0; k < STREAM_KERNEL_COUNT; k++) {
+            double best = slowest[STREAM_KERNEL_COUNT + k];
+            for (int it = 2; it < iterations; it++) {
+                double t = slowest[it * STREAM_KERNEL_COUNT + k];
+                best = t < best ? t : best;
+            }
+            group->gbps[k] = (double)size * n * stream_kernel_bytes((stream_kernel_t)k)
+                             / best / 1e9;
+        }
+    }
+    free(slowest);
+}
+
+// Gather the groups led by ranks with `leader` set (and their hosts) on
+// rank 0, which must be a leader; returns the count there. Collective.
+int gather_groups(const stream_group_t *group, int leader, stream_group_t **groups,
+                  char **hosts) {
+    int world_rank, count = 0;
+    char host[MPI_MAX_PROCESSOR_NAME] = {0};
+    MPI_Comm leaders;
+    int len;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_split(MPI_COMM_WORLD, leader ? 0 : MPI_UNDEFINED, world_rank, &leaders);
+    *groups = NULL;
+    *hosts = NULL;
+    if (leaders == MPI_COMM_NULL) {
+        return 0;
+    }
+    MPI_Comm_size(leaders, &count);
+    MPI_Get_processor_name(host, &len);
+    if (world_rank == 0) {
+        *groups = malloc((size_t)count * sizeof(stream_group_t));
+        *hosts = malloc((size_t)count * MPI_MAX_PROCESSOR_NAME);
+        if (!*groups || !*hosts) {
+            printf("Memory allocation failed for node results\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(group, sizeof(stream_group_t) / sizeof(double), MPI_DOUBLE, *groups,
+               sizeof(stream_group_t) / sizeof(double), MPI_DOUBLE, 0, leaders);
+    MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, *hosts, MPI_MAX_PROCESSOR_NAME,
+               MPI_CHAR, 0, leaders);
+    MPI_Comm_free(&leaders);
+    return count;
+}
+
+// "n0,n1" for a NUMA node mask ("?" if unknown)
+void format_nodes(unsigned long mask, char *out, size_t len) {
+    size_t used = 0;
+
+    snprintf(out, len, "?");
+    for (int node = 0; node < (int)(8 * sizeof(mask)) && used < len; node++) {
+        if ((mask >> node) & 1) {
+            used += snprintf(out + used, len - used, "%sn%d", used ? "," : "", node);
+        }
+    }
+}
+
+// Median of a per-node value
+double median_of(const stream_group_t *nodes, int count, int triad) {
+    double *values = malloc((size_t)count * sizeof(double));
+    if (!values) {
+        printf("Memory allocation failed for node medians\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < count; i++) {
+        values[i] = triad ? nodes[i].gbps[STREAM_TRIAD] : nodes[i].gflops;
+    }
+    double median = bench_percentiles(values, count).p50;
+    free(values);
+    return median;
+}
+
+// Flags of a node below the threshold: bit 0 memory, bit 1 FP
+int node_flags(const stream_group_t *node, double median_triad, double median_gflops,
+               double threshold) {
+    return (node->gbps[STREAM_TRIAD] < threshold * median_triad ? 1 : 0)
+           | (node->gflops < threshold * median_gflops ? 2 : 0);
+}
+
+void print_groups(const char *title, const stream_group_t *groups, const char *hosts,
+                  int count, int with_domains) {
+    printf("\n========================================\n");
+    printf("%s\n", title);
+    printf("========================================\n");
+    printf("%-16s ", "Host");
+    if (with_domains) {
+        printf("%-8s ", "Threads");
+    }
+    printf("%5s %9s %9s %9s %9s %9s %7s\n", "Ranks", "Copy", "Scale", "Add", "Triad",
+           "GFLOPS", "Ridge");
+    for (int i = 0; i < count; i++) {
+        const stream_group_t *g = &groups[i];
+        printf("%-16.16s ", hosts + (size_t)i * MPI_MAX_PROCESSOR_NAME);
+        if (with_domains) {
+            char nodes[64];
+            format_nodes((unsigned long)g->nodes, nodes, sizeof(nodes));
+            printf("%-8.8s ", nodes);
+        }
+        printf("%5.0f %9.2f %9.2f %9.2f %9.2f %9.2f %7.2f\n", g->ranks,
+               g->gbps[STREAM_COPY], g->gbps[STREAM_SCALE], g->gbps[STREAM_ADD],
+               g->gbps[STREAM_TRIAD], g->gflops, g->gflops / g->gbps[STREAM_TRIAD]);
+    }
+    printf("========================================\n");
+}
+
+// Add one group's bandwidths and roofline
+void json_group(bench_json_t *json, const stream_group_t *group) {
+    for (int k = 0; k < STREAM_KERNEL_COUNT; k++) {
+        char key[32];
+        snprintf(key, sizeof(key), "%s_gbps", stream_kernel_name((stream_kernel_t)k));
+        bench_json_double(json, key, group->gbps[k]);
+    }
+    bench_json_double(json, "peak_gflops", group->gflops);
+    bench_json_double(json, "ridge_flop_per_byte", group->gflops / group->gbps[STREAM_TRIAD]);
+}
+
+// Write the JSON record of this run (rank 0 only)
+void write_json_record(const stream_config_t *config, int world_size, int threads,
+                       const char *hosts, size_t n, int nontemporal, stream_isa_t isa,
+                       const stream_group_t *job, const bench_stats_t *rank_triad,
+                       const stream_group_t *nodes, const char *node_hosts, int num_nodes,
+                       const stream_group_t *domains, const char *domain_hosts,
+                       int num_domains, double numa_local, double huge_share, int valid) {
+    bench_json_t json;
+    double median_triad = median_of(nodes, num_nodes, 1);
+    double median_gflops = median_of(nodes, num_nodes, 0);
+
+    if (bench_json_open(&json, config->json_path) != 0) {
+        printf("Warning: could not write JSON record\n");
+        return;
+    }
+    bench_json_begin_object(&json, NULL);
+    bench_json_header(&json, "stream", world_size, threads, hosts);
+
+    bench_json_begin_object(&json, "config");
+    bench_json_int(&json, "elements", (long long)n);
+    bench_json_int(&json, "array_bytes", (long long)(n * sizeof(double)));
+    bench_json_int(&json, "iterations", config->iterations);
+    bench_json_string(&json, "stores", nontemporal ? "nt" : "regular");
+    bench_json_string(&json, "isa", stream_isa_name(isa));
+    bench_json_double(&json, "peak_time", config->peak_time);
+    bench_json_double(&json, "threshold", config->threshold);
+    bench_json_string(&json, "hugepages", bench_pages_name(bench_alloc_policy()));
+    bench_json_end_object(&json);
+
+    bench_json_begin_object(&json, "metrics");
+    json_group(&json, job);
+    bench_json_stats(&json, "rank_triad_gbps", rank_triad);
+    bench_json_double(&json, "median_node_triad_gbps", median_triad);
+    bench_json_double(&json, "median_node_peak_gflops", median_gflops);
+    if (numa_local >= 0.0) {
+        bench_json_double(&json, "numa_local_fraction", numa_local);
+    }
+    bench_json_double(&json, "huge_page_fraction", huge_share);
+    bench_json_bool(&json, "validated", valid);
+    bench_json_end_object(&json);
+
+    bench_json_begin_array(&json, "nodes");
+    for (int i = 0; i < num_nodes; i++) {
+        const char *host = node_hosts + (size_t)i * MPI_MAX_PROCESSOR_NAME;
+        int flags = node_flags(&nodes[i], median_triad, median_gflops, config->threshold);
+        bench_json_begin_object(&json, NULL);
+        bench_json_string(&json, "host", host);
+        bench_json_int(&json, "ranks", (long long)nodes[i].ranks);
+        json_group(&json, &nodes[i]);
+        bench_json_bool(&json, "memory_degraded", flags & 1);
+        bench_json_bool(&json, "fp_degraded", (flags & 2) != 0);
+        bench_json_begin_array(&json, "numa_domains");
+        for (int d = 0; d < num_domains; d++) {
+            if (strcmp(domain_hosts + (size_t)d * MPI_MAX_PROCESSOR_NAME, host) != 0) {
+                continue;
+            }
+            char mask[64];
+            format_nodes((unsigned long)domains[d].nodes, mask, sizeof(mask));
+            bench_json_begin_object(&json, NULL);
+            bench_json_string(&json, "threads_on", mask);
+            bench_json_int(&json, "ranks", (long long)domains[d].ranks);
+            json_group(&json, &domains[d]);
+            bench_json_end_object(&json);
+        }
+        bench_json_end_array(&json);
+        bench_json_end_object(&json);
+    }
+    bench_json_end_array(&json);
+    bench_json_end_object(&json);
+
+    if (bench_json_close(&json) != 0) {
+        printf("Warning: error writing JSON record\n");
+    } else if (config->json_path) {
+        printf("JSON record written to %s\n", config->json_path);
+    }
+}
+
+int main(int argc, char **argv) {
+    int world_rank, world_size;
+    stream_config_t config;
+
+    // Initialize MPI (only the main thread makes MPI calls)
+    int thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    const char *thread_source;
+    int threads = bench_threads_init(&thread_source);
+
+    if (parse_args(argc, argv, &config, world_rank) != 0) {
+        if (world_rank == 0) {
+            print_usage(argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    size_t rows = (size_t)((config.elements + STREAM_ROW - 1) / STREAM_ROW);
+    size_t n = rows * STREAM_ROW;
+    size_t bytes = n * sizeof(double);
+    stream_isa_t isa = stream_detect_isa();
+    int nontemporal = config.nontemporal && stream_nt_supported();
+
+    double *a = bench_alloc(bytes);
+    double *b = bench_alloc(bytes);
+    double *c = bench_alloc(bytes);
+    double *times = malloc((size_t)config.iterations * STREAM_KERNEL_COUNT * sizeof(double));
+    if (!a || !b || !c || !times) {
+        printf("Rank %d: Memory allocation failed (%zu bytes per array)\n", world_rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // First touch by the threads that stream through each row
+    bench_numa_touch_rows(a, (int)rows, STREAM_ROW);
+    bench_numa_touch_rows(b, (int)rows, STREAM_ROW);
+    bench_numa_touch_rows(c, (int)rows, STREAM_ROW);
+    init_arrays(a, b, c, rows);
+    char backing[32];
+    bench_alloc_describe(a, backing, sizeof(backing));
+
+    // Ranks of a node, then of a NUMA domain within it (same thread nodes)
+    MPI_Comm node_comm, domain_comm;
+    int node_rank, domain_rank, num_nodes, num_domains;
+    unsigned long thread_nodes = bench_numa_thread_nodes();
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL,
+                        &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_split(node_comm, (int)(thread_nodes & 0x7fffffff), world_rank, &domain_comm);
+    MPI_Comm_rank(domain_comm, &domain_rank);
+    int leads[2] = {node_rank == 0, domain_rank == 0};
+    int counts[2];
+    MPI_Allreduce(leads, counts, 2, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    num_nodes = counts[0];
+    num_domains = counts[1];
+
+    if (world_rank == 0) {
+        printf("========================================\n");
+        printf("STREAM Memory Bandwidth and Roofline\n");
+        printf("========================================\n");
+        printf("Processes: %d\n", world_size);
+        printf("Nodes: %d, NUMA domains in use: %d\n", num_nodes, num_domains);
+        printf("Threads per process: %d (%s)\n", threads, thread_source);
+        if (threads > 1 && thread_support < MPI_THREAD_FUNNELED) {
+            printf("Warning: MPI library lacks MPI_THREAD_FUNNELED support\n");
+        }
+        printf("Array size: %zu elements per rank (%.1f MB per array, %.1f MB per rank)\n", n,
+               bytes / 1e6, 3.0 * bytes / 1e6);
+        printf("Iterations: %d (best of %d, the first untimed)\n", config.iterations,
+               config.iterations - 1);
+        printf("Stores: %s\n", nontemporal ? "nontemporal"
+               : config.nontemporal ? "regular (no streaming stores on this CPU)" : "regular");
+        printf("ISA: %s (kernels and peak FP chains)\n", stream_isa_name(isa));
+        printf("Array pages: %s (%s requested)\n", backing, bench_pages_name(bench_alloc_policy()));
+        printf("========================================\n");
+    }
+
+    bench_numa_buffer_t buffers[3] = {
+        {"a", a, bytes}, {"b", b, bytes}, {"c", c, bytes}
+    };
+    double numa_local = bench_numa_report(buffers, 3);
+    double huge_share = bench_alloc_report(buffers, 3, -1);
+
+    // All ranks run each kernel together
+    double start_time = MPI_Wtime();
+    for (int it = 0; it < config.iterations; it++) {
+        for (int k = 0; k < STREAM_KERNEL_COUNT; k++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            double t0 = MPI_Wtime();
+            stream_run((stream_kernel_t)k, a, b, c, rows, STREAM_SCALAR, nontemporal, isa);
+            times[it * STREAM_KERNEL_COUNT + k] = MPI_Wtime() - t0;
+        }
+    }
+    double stream_time = MPI_Wtime() - start_time;
+
+    int local_valid = check_arrays(a, b, c, n, config.iterations);
+    int valid;
+    MPI_Allreduce(&local_valid, &valid, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    if (!local_valid) {
+        printf("Rank %d: STREAM results differ from the expected values\n", world_rank);
+    }
+
+    double peak = measure_peak(config.peak_time, isa) / 1e9;
+
+    stream_group_t self, node, domain, job;
+    group_results(MPI_COMM_SELF, times, config.iterations, n, peak, thread_nodes, &self);
+    group_results(node_comm, times, config.iterations, n, peak, thread_nodes, &node);
+    group_results(domain_comm, times, config.iterations, n, peak, thread_nodes, &domain);
+    group_results(MPI_COMM_WORLD, times, config.iterations, n, peak, thread_nodes, &job);
+    bench_stats_t rank_triad = bench_reduce_stats(self.gbps[STREAM_TRIAD]);
+    bench_stats_t rank_gflops = bench_reduce_stats(self.gflops);
+
+    stream_group_t *nodes, *domains;
+    char *node_hosts, *domain_hosts;
+    gather_groups(&node, node_rank == 0, &nodes, &node_hosts);
+    gather_groups(&domain, domain_rank == 0, &domains, &domain_hosts);
+    char *hosts = config.json ? bench_gather_hosts() : NULL;
+    double elapsed = MPI_Wtime() - start_time;
+
+    if (world_rank == 0) {
+        print_groups("Node Bandwidth (GB/s; GFLOPS = peak FP; Ridge = FLOP/byte)", nodes,
+                     node_hosts, num_nodes, 0);
+        if (num_domains > num_nodes) {
+            print_groups("NUMA Domain Bandwidth (ranks grouped by their threads' nodes)",
+                         domains, domain_hosts, num_domains, 1);
+        }
+
+        double median_triad = median_of(nodes, num_nodes, 1);
+        double median_gflops = median_of(nodes, num_nodes, 0);
+
+        printf("\nResults:\n");
+        printf("  Validation: %s\n", valid ? "passed on all ranks" : "FAILED");
+        printf("  Copy: %.2f GB/s, Scale: %.2f GB/s, Add: %.2f GB/s, Triad: %.2f GB/s (all nodes)\n",
+               job.gbps[STREAM_COPY], job.gbps[STREAM_SCALE], job.gbps[STREAM_ADD],
+               job.gbps[STREAM_TRIAD]);
+        printf("  Peak FP: %.2f GFLOPS (all nodes)\n", job.gflops);
+
+        printf("\n========================================\n");
+        printf("Performance:\n");
+        printf("  Triad per rank: min %.2f / avg %.2f / max %.2f GB/s\n", rank_triad.min,
+               rank_triad.avg, rank_triad.max);
+        printf("  Peak FP per rank: min %.2f / avg %.2f / max %.2f GFLOPS\n", rank_gflops.min,
+               rank_gflops.avg, rank_gflops.max);
+        printf("  Median node: triad %.2f GB/s, peak %.2f GFLOPS, ridge point %.2f FLOP/byte\n",
+               median_triad, median_gflops, median_gflops / median_triad);
+        printf("  Roofline: attainable GFLOPS = min(%.2f, %.2f x FLOP/byte) per node\n",
+               median_gflops, median_triad);
+        int flagged = 0;
+        for (int i = 0; i < num_nodes; i++) {
+            int flags = node_flags(&nodes[i], median_triad, median_gflops, config.threshold);
+            if (flags) {
+                printf("  %s %-16s triad %.0f%%, peak FP %.0f%% of the median node\n",
+                       flagged++ ? "                 " : "Below threshold:",
+                       node_hosts + (size_t)i * MPI_MAX_PROCESSOR_NAME,
+                       100.0 * nodes[i].gbps[STREAM_TRIAD] / median_triad,
+                       100.0 * nodes[i].gflops / median_gflops);
+            }
+        }
+        if (!flagged) {
+            printf("  Below threshold: none (every node at >= %.0f%% of the median)\n",
+                   100.0 * config.threshold);
+        }
+        printf("  STREAM time: %.2f seconds\n", stream_time);
+        printf("  Total time: %.2f seconds\n", elapsed);
+        printf("========================================\n");
+
+        if (config.json) {
+            write_json_record(&config, world_size, threads, hosts, n, nontemporal, isa, &job,
+                              &rank_triad, nodes, node_hosts, num_nodes, domains, domain_hosts,
+                              num_domains, numa_local, huge_share, valid);
+        }
+    }
+
+    free(hosts);
+    free(nodes);
+    free(node_hosts);
+    free(domains);
+    free(domain_hosts);
+    free(times);
+    MPI_Comm_free(&domain_comm);
+    MPI_Comm_free(&node_comm);
+    bench_free(a);
+    bench_free(b);
+    bench_free(c);
+    MPI_Finalize();
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*
+ * STREAM kernels and peak floating-point kernel of the stream-bench example
+ *
+ * Every path processes one row (STREAM_ROW doubles, 64-byte aligned because
+ * the arrays come from bench_alloc()) per call. The generic path is plain C
+ * the compiler vectorizes for the baseline ISA; on x86 its nontemporal form
+ * uses SSE2 streaming stores, which every x86-64 CPU has.
+ *
+ * The peak kernel keeps enough independent FMA chains in registers to cover
+ * the FMA latency on two FMA ports (4 cycles x 2 ports = at least 8 vectors
+ * in flight), so it runs at the core's FP issue rate and never touches
+ * memory. Each chain converges to PEAK_ADD / (1 - PEAK_MUL) = 1 and stays
+ * clear of overflow and denormals however long it runs.
+ */
+
+#include "stream-kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STREAM_X86 1
+#endif
+
+#define PEAK_MUL 0.999999
+#define PEAK_ADD 0.000001
+
+#define GENERIC_CHAINS 16
+#define AVX2_CHAINS 12      // of 16 ymm registers
+#define AVX512_CHAINS 16    // of 32 zmm registers
+
+// Keeps the peak kernel's results alive
+static volatile double peak_sink;
+
+const char *stream_kernel_name(stream_kernel_t kernel) {
+    static const char *names[STREAM_KERNEL_COUNT] = {"copy", "scale", "add", "triad"};
+    return kernel < STREAM_KERNEL_COUNT ? names[kernel] : "unknown";
+}
+
+size_t stream_kernel_bytes(stream_kernel_t kernel) {
+    return (kernel == STREAM_ADD || kernel == STREAM_TRIAD ? 3 : 2) * sizeof(double);
+}
+
+const char *stream_isa_name(stream_isa_t isa) {
+    switch (isa) {
+    case STREAM_ISA_AVX2:
+        return "avx2";
+    case STREAM_ISA_AVX512:
+        return "avx512";
+    default:
+        return "generic";
+    }
+}
+
+stream_isa_t stream_detect_isa(void) {
+#ifdef STREAM_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        return STREAM_ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return STREAM_ISA_AVX2;
+    }
+#endif
+    return STREAM_ISA_GENERIC;
+}
+
+int stream_nt_supported(void) {
+#ifdef STREAM_X86
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+#ifdef STREAM_X86
+
+static void row_sse2_nt(stream_kernel_t kernel, double *restrict a, double *restrict b,
+                        double *restrict c, double scalar) {
+    const __m128d s = _mm_set1_pd(scalar);
+
+    switch (kernel) {
+    case STREAM_COPY:
+        for (int i = 0; i < STREAM_ROW; i += 2) {
+            _mm_stream_pd(c + i, _mm_load_pd(a + i));
+        }
+        break;
+    case STREAM_SCALE:
+        for (int i = 0; i < STREAM_ROW; i += 2) {
+            _mm_stream_pd(b + i, _mm_mul_pd(s, _mm_load_pd(c + i)));
+        }
+        break;
+    case STREAM_ADD:
+        for (int i = 0; i < STREAM_ROW; i += 2) {
+            _mm_stream_pd(c + i, _mm_add_pd(_mm_load_pd(a + i), _mm_load_pd(b + i)));
+        }
+        break;
+    default:
+        for (int i = 0; i < STREAM_ROW; i += 2) {
+            _mm_stream_pd(a + i, _mm_add_pd(_mm_load_pd(b + i),
+                                            _mm_mul_pd(s, _mm_load_pd(c + i))));
+        }
+        break;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void row_avx2(stream_kernel_t kernel, double *restrict a, double *restrict b,
+                     double *restrict c, double scalar, int nontemporal) {
+    const __m256d s = _mm256_set1_pd(scalar);
+
+    for (int i = 0; i < STREAM_ROW; i += 4) {
+        double *dst;
+        __m256d v;
+        switch (kernel) {
+        case STREAM_COPY:
+            dst = c;
+            v = _mm256_load_pd(a + i);
+            break;
+        case STREAM_SCALE:
+            dst = b;
+            v = _mm256_mul_pd(s, _mm256_load_pd(c + i));
+            break;
+        case STREAM_ADD:
+            dst = c;
+            v = _mm256_add_pd(_mm256_load_pd(a + i), _mm256_load_pd(b + i));
+            break;
+        default:
+            dst = a;
+            v = _mm256_fmadd_pd(s, _mm256_load_pd(c + i), _mm256_load_pd(b + i));
+            break;
+        }
+        if (nontemporal) {
+            _mm256_stream_pd(dst + i, v);
+        } else {
+            _mm256_store_pd(dst + i, v);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void row_avx512(stream_kernel_t kernel, double *restrict a, double *restrict b,
+                       double *restrict c, double scalar, int nontemporal) {
+    const __m512d s = _mm512_set1_pd(scalar);
+
+    for (int i = 0; i < STREAM_ROW; i += 8) {
+        double *dst;
+        __m512d v;
+        switch (kernel) {
+        case STREAM_COPY:
+            dst = c;
+            v = _mm512_load_pd(a + i);
+            break;
+        case STREAM_SCALE:
+            dst = b;
+            v = _mm512_mul_pd(s, _mm512_load_pd(c + i));
+            break;
+        case STREAM_ADD:
+            dst = c;
+            v = _mm512_add_pd(_mm512_load_pd(a + i), _mm512_load_pd(b + i));
+            break;
+        default:
+            dst = a;
+            v = _mm512_fmadd_pd(s, _mm512_load_pd(c + i), _mm512_load_pd(b + i));
+            break;
+        }
+        if (nontemporal) {
+            _mm512_stream_pd(dst + i, v);
+        } else {
+            _mm512_store_pd(dst + i, v);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static double peak_avx2(long repeats) {
+    const __m256d mul = _mm256_set1_pd(PEAK_MUL);
+    const __m256d add = _mm256_set1_pd(PEAK_ADD);
+    __m256d acc[AVX2_CHAINS];
+    double lanes[4];
+
+    for (int j = 0; j < AVX2_CHAINS; j++) {
+        acc[j] = _mm256_set1_pd(1.0);
+    }
+    for (long r = 0; r < repeats; r++) {
+        for (int j = 0; j < AVX2_CHAINS; j++) {
+            acc[j] = _mm256_fmadd_pd(acc[j], mul, add);
+        }
+    }
+    for (int j = 1; j < AVX2_CHAINS; j++) {
+        acc[0] = _mm256_add_pd(acc[0], acc[j]);
+    }
+    _mm256_storeu_pd(lanes, acc[0]);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx512f")))
+static double peak_avx512(long repeats) {
+    const __m512d mul = _mm512_set1_pd(PEAK_MUL);
+    const __m512d add = _mm512_set1_pd(PEAK_ADD);
+    __m512d acc[AVX512_CHAINS];
+
+    for (int j = 0; j < AVX512_CHAINS; j++) {
+        acc[j] = _mm512_set1_pd(1.0);
+    }
+    for (long r = 0; r < repeats; r++) {
+        for (int j = 0; j < AVX512_CHAINS; j++) {
+            acc[j] = _mm512_fmadd_pd(acc[j], mul, add);
+        }
+    }
+    for (int j = 1; j < AVX512_CHAINS; j++) {
+        acc[0] = _mm512_add_pd(acc[0], acc[j]);
+    }
+    return _mm512_reduce_add_pd(acc[0]);
+}
+
+#endif /* STREAM_X86 */
+
+static void row_generic(stream_kernel_t kernel, double *restrict a, double *restrict b,
+                        double *restrict c, double scalar, int nontemporal) {
+#ifdef STREAM_X86
+    if (nontemporal) {
+        row_sse2_nt(kernel, a, b, c, scalar);
+        return;
+    }
+#else
+    (void)nontemporal;
+#endif
+    switch (kernel) {
+    case STREAM_COPY:
+        for (int i = 0; i < STREAM_ROW; i++) {
+            c[i] = a[i];
+        }
+        break;
+    case STREAM_SCALE:
+        for (int i = 0; i < STREAM_ROW; i++) {
+            b[i] = scalar * c[i];
+        }
+        break;
+    case STREAM_ADD:
+        for (int i = 0; i < STREAM_ROW; i++) {
+            c[i] = a[i] + b[i];
+        }
+        break;
+    default:
+        for (int i = 0; i < STREAM_ROW; i++) {
+            a[i] = b[i] + scalar * c[i];
+        }
+        break;
+    }
+}
+
+// Multiply-add chains the compiler vectorizes (and contracts to FMA where
+// the baseline ISA has it)
+static double peak_generic(long repeats) {
+    double acc[GENERIC_CHAINS];
+    double sum = 0.0;
+
+    for (int j = 0; j < GENERIC_CHAINS; j++) {
+        acc[j] = 1.0;
+    }
+    for (long r = 0; r < repeats; r++) {
+        for (int j = 0; j < GENERIC_CHAINS; j++) {
+            acc[j] = acc[j] * PEAK_MUL + PEAK_ADD;
+        }
+    }
+    for (int j = 0; j < GENERIC_CHAINS; j++) {
+        sum += acc[j];
+    }
+    return sum;
+}
+
+void stream_run(stream_kernel_t kernel, double *a, double *b, double *c, size_t rows,
+                double scalar, int nontemporal, stream_isa_t isa) {
+    nontemporal = nontemporal && stream_nt_supported();
+
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static) nowait
+        for (size_t r = 0; r < rows; r++) {
+            size_t offset = r * STREAM_ROW;
+            switch (isa) {
+#ifdef STREAM_X86
+            case STREAM_ISA_AVX512:
+                row_avx512(kernel, a + offset, b + offset, c + offset, scalar, nontemporal);
+                break;
+            case STREAM_ISA_AVX2:
+                row_avx2(kernel, a + offset, b + offset, c + offset, scalar, nontemporal);
+                break;
+#endif
+            default:
+                row_generic(kernel, a + offset, b + offset, c + offset, scalar, nontemporal);
+                break;
+            }
+        }
+#ifdef STREAM_X86
+        // Streaming stores are weakly ordered: drain them before the timer stops
+        if (nontemporal) {
+            _mm_sfence();
+        }
+#endif
+    }
+}
+
+double stream_peak_run(long repeats, stream_isa_t isa) {
+    double flops = 0.0;
+    double sum = 0.0;
+
+    #pragma omp parallel reduction(+:flops, sum)
+    {
+        switch (isa) {
+#ifdef STREAM_X86
+        case STREAM_ISA_AVX512:
+            sum += peak_avx512(repeats);
+            flops += 2.0 * 8 * AVX512_CHAINS * repeats;
+            break;
+        case STREAM_ISA_AVX2:
+            sum += peak_avx2(repeats);
+            flops += 2.0 * 4 * AVX2_CHAINS * repeats;
+            break;
+#endif
+        default:
+            sum += peak_generic(repeats);
+            flops += 2.0 * GENERIC_CHAINS * repeats;
+            break;
+        }
+    }
+    peak_sink = sum;
+    return flops;
+}
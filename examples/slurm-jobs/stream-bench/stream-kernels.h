@@ -0,0 +1,66 @@
+/*
+ * STREAM kernels and peak floating-point kernel of the stream-bench example
+ *
+ * The four STREAM kernels (McCalpin) over rank-local arrays of doubles:
+ *   copy:  c = a            16 bytes per element
+ *   scale: b = s * c        16 bytes per element
+ *   add:   c = a + b        24 bytes per element
+ *   triad: a = b + s * c    24 bytes per element
+ * Byte counts follow STREAM: reads plus writes, without the write-allocate
+ * read a regular store causes. Nontemporal (streaming) stores bypass the
+ * caches and avoid it, so with them the counted bytes are the DRAM traffic.
+ *
+ * The arrays are split into rows of STREAM_ROW doubles handed to the
+ * OpenMP threads with schedule(static), the split bench_numa_touch_rows()
+ * uses, so every thread streams through the pages it touched first.
+ *
+ * Like the GEMM micro-kernels, the x86 paths are compiled with per-function
+ * target attributes and chosen at run time, so the portable binary uses
+ * AVX-512 or AVX2 where the node has it.
+ */
+
+#ifndef STREAM_KERNELS_H
+#define STREAM_KERNELS_H
+
+#include <stddef.h>
+
+// Doubles per row (8 KB: a whole number of cache lines and vectors)
+#define STREAM_ROW 1024
+
+typedef enum {
+    STREAM_COPY = 0,
+    STREAM_SCALE,
+    STREAM_ADD,
+    STREAM_TRIAD,
+    STREAM_KERNEL_COUNT
+} stream_kernel_t;
+
+typedef enum {
+    STREAM_ISA_GENERIC = 0,     // Compiler-vectorized C (SSE2 / NEON)
+    STREAM_ISA_AVX2,
+    STREAM_ISA_AVX512
+} stream_isa_t;
+
+// "copy", "scale", "add", "triad"
+const char *stream_kernel_name(stream_kernel_t kernel);
+
+// Bytes one element moves in the kernel (STREAM convention)
+size_t stream_kernel_bytes(stream_kernel_t kernel);
+
+// Widest ISA of this CPU, and its name ("avx512", "avx2", "generic")
+stream_isa_t stream_detect_isa(void);
+const char *stream_isa_name(stream_isa_t isa);
+
+// 1 if nontemporal stores are available (x86)
+int stream_nt_supported(void);
+
+// Run one kernel over rows × STREAM_ROW elements on the OpenMP threads;
+// nontemporal is ignored where unsupported
+void stream_run(stream_kernel_t kernel, double *a, double *b, double *c, size_t rows,
+                double scalar, int nontemporal, stream_isa_t isa);
+
+// Independent FMA chains on every OpenMP thread, `repeats` times; returns
+// the floating-point operations executed by the rank
+double stream_peak_run(long repeats, stream_isa_t isa);
+
+#endif /* STREAM_KERNELS_H */
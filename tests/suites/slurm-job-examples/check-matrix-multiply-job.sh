@@ -197,7 +197,7 @@ verify_matrix_multiply_output() {
         # Verify output contains expected elements
         if ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
             "${SSH_USER}@${CONTROLLER_IP}" \
-            "grep -q 'Matrix Multiplication' $output_file && grep -q 'Completed' $output_file" 2>&1; then
+            "grep -q 'Matrix Multiplication' $output_file && grep -q 'Verification: PASSED' $output_file && grep -q 'Completed' $output_file" 2>&1; then
             log_info "✓ Job output contains expected matrix multiplication results"
 
             # Show excerpt of output
@@ -219,6 +219,69 @@ verify_matrix_multiply_output() {
     fi
 }
 
+# The low-precision check must still catch a wrong element: submit f32 and
+# bf16 runs with one element of C negated and expect them to fail
+verify_fault_injection() {
+    log_info "Checking that verification catches an injected error (f32, bf16)..."
+
+    if [ -z "${CONTROLLER_IP:-}" ] || [ -z "${SSH_KEY_PATH:-}" ]; then
+        log_error "CONTROLLER_IP and SSH_KEY_PATH not set - cannot submit job via SSH"
+        return 1
+    fi
+
+    local dtype
+    for dtype in f32 bf16; do
+        local output_file="$JOB_EXAMPLES_DIR/inject-${dtype}.out"
+        local submit_cmd="cd $JOB_EXAMPLES_DIR && rm -f $output_file && sbatch --export=ALL,MATRIX_SIZE=500,MATRIX_DTYPE=${dtype},MATRIX_INJECT_ERROR=1 --output=$output_file --error=$output_file --parsable matrix.sbatch"
+        local job_id
+
+        if ! job_id=$(ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
+            "${SSH_USER}@${CONTROLLER_IP}" "$submit_cmd" 2>&1); then
+            log_error "Failed to submit $dtype fault-injection job: $job_id"
+            return 1
+        fi
+        log_info "$dtype fault-injection job submitted with ID: $job_id"
+
+        local timeout=600
+        local elapsed=0
+        local poll_interval=5
+        while [ $elapsed -lt $timeout ]; do
+            local job_status
+            job_status=$(ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
+                "${SSH_USER}@${CONTROLLER_IP}" "squeue -j $job_id -h 2>/dev/null" || true)
+            if [ -z "$job_status" ]; then
+                break
+            fi
+            sleep $poll_interval
+            elapsed=$((elapsed + poll_interval))
+        done
+        if [ $elapsed -ge $timeout ]; then
+            log_error "$dtype fault-injection job timeout after ${timeout}s"
+            return 1
+        fi
+
+        if ! ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
+            "${SSH_USER}@${CONTROLLER_IP}" "grep -q 'Verification: FAILED' $output_file" 2>&1; then
+            log_error "$dtype run with an injected error was not reported as FAILED"
+            ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
+                "${SSH_USER}@${CONTROLLER_IP}" "grep -E 'Verification|Error' $output_file" 2>&1 \
+                | sed 's/^/  /' || true
+            return 1
+        fi
+
+        local state
+        state=$(ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no \
+            "${SSH_USER}@${CONTROLLER_IP}" "sacct -j $job_id --format=State -n -X | head -1" \
+            2>/dev/null | tr -d ' ' || true)
+        if [ "$state" = "COMPLETED" ]; then
+            log_error "$dtype run with an injected error exited with status 0"
+            return 1
+        fi
+        log_info "✓ $dtype: injected error detected (Verification: FAILED, job ${state:-ended})"
+    done
+    return 0
+}
+
 # Main test execution
 main() {
     log ""
@@ -261,6 +324,11 @@ main() {
         return 1
     fi
 
+    if ! verify_fault_injection; then
+        log_error "Verification did not catch an injected error"
+        return 1
+    fi
+
     log ""
     log_info "🎉 Matrix-multiply memory-intensive job test passed!"
     log ""
@@ -0,0 +1,255 @@
+#!/bin/bash
+#
+# SLURM Job Examples: Performance Regression Gate
+# Runs fixed-size benchmark jobs that write JSON records, then compares their
+# GFLOPS, samples/s, latency and bandwidth against the cluster's baseline
+# (perf-gate.py). Baseline and history live on BeeGFS, so regressions after
+# image rebuilds or role changes (slurm-compute, nvidia-gpu-drivers, ...)
+# show up as a failed test.
+#
+
+set -euo pipefail
+
+PS4='+ [$(basename ${BASH_SOURCE[0]}):L${LINENO}] ${FUNCNAME[0]:+${FUNCNAME[0]}(): }'
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+COMMON_DIR="$(cd "$SCRIPT_DIR/../common" && pwd)"
+
+# Source shared utilities
+# shellcheck source=/dev/null
+source "$COMMON_DIR/suite-utils.sh"
+# shellcheck source=/dev/null
+source "$COMMON_DIR/suite-logging.sh"
+
+# Note: Logging functions now provided by suite-logging.sh
+
+TEST_NAME="Performance Regression Gate"
+BEEGFS_MOUNT="/mnt/beegfs"
+JOB_EXAMPLES_DIR="${BEEGFS_MOUNT}/slurm-jobs"
+PERF_GATE="$SCRIPT_DIR/perf-gate.py"
+
+# Gate configuration
+# PERF_CLUSTER: baseline name (default: Slurm ClusterName)
+# PERF_HISTORY_DIR: baseline.json, history.jsonl and runs/ on BeeGFS
+# PERF_TOLERANCE: allowed relative loss for every figure (default: 10%
+#   throughput, 25% latency)
+# PERF_UPDATE_BASELINE=1: accept this run as the new baseline
+# PERF_GPU=1: also gate matrix-gpu.sbatch (GPU partition)
+PERF_CLUSTER="${PERF_CLUSTER:-}"
+PERF_HISTORY_DIR="${PERF_HISTORY_DIR:-}"
+PERF_TOLERANCE="${PERF_TOLERANCE:-}"
+PERF_UPDATE_BASELINE="${PERF_UPDATE_BASELINE:-0}"
+PERF_GPU="${PERF_GPU:-0}"
+PERF_JOB_TIMEOUT="${PERF_JOB_TIMEOUT:-900}"
+RUN_ID="$(date -u '+%Y-%m-%dT%H-%M-%SZ')"
+
+# Benchmarks: directory|sbatch script|exported variables|record name. Sizes
+# are fixed: a figure is only compared with runs of the same configuration.
+# Values must not contain commas (sbatch --export splits on them); list
+# collectives with ':' instead.
+PERF_JOBS=(
+    "matrix-multiply|matrix.sbatch|MATRIX_SIZE=2000|matrix"
+    "pi-calculation|pi.sbatch|NUM_SAMPLES=2000000000,PI_SEED=42,PI_SCHEDULE=static|pi"
+    "stream-bench|stream-bench.sbatch|STREAM_ELEMENTS=32M,STREAM_ITERATIONS=10|stream"
+    "collectives-bench|coll-bench.sbatch|COLL_OPS=barrier:bcast:allreduce:alltoall,COLL_MAX_BYTES=1M,COLL_ITERATIONS=50|coll"
+)
+if [ "$PERF_GPU" = "1" ]; then
+    PERF_JOBS+=("matrix-multiply|matrix-gpu.sbatch|MATRIX_SIZE=8000|matrix-gpu")
+fi
+
+# Execute command on controller via SSH
+run_ssh() {
+    local cmd="$1"
+    ssh -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no -o ConnectTimeout=5 \
+        "${SSH_USER}@${CONTROLLER_IP}" "$cmd"
+}
+
+# Resolve the cluster name and the history directory on BeeGFS
+prepare_history_dir() {
+    log_info "Preparing performance history on BeeGFS..."
+
+    if [ -z "$PERF_CLUSTER" ]; then
+        PERF_CLUSTER=$(run_ssh "scontrol show config 2>/dev/null | awk '/^ClusterName/ {print \$3}'" \
+            2>/dev/null || true)
+        PERF_CLUSTER="${PERF_CLUSTER:-default}"
+    fi
+    PERF_HISTORY_DIR="${PERF_HISTORY_DIR:-${BEEGFS_MOUNT}/perf-history/${PERF_CLUSTER}}"
+    RUN_DIR="${PERF_HISTORY_DIR}/runs/${RUN_ID}"
+
+    if ! run_ssh "mkdir -p $RUN_DIR"; then
+        log_error "Failed to create $RUN_DIR on the controller"
+        return 1
+    fi
+
+    # The gate runs next to the records, with the current script
+    if ! scp -i "$SSH_KEY_PATH" -o StrictHostKeyChecking=no "$PERF_GATE" \
+        "${SSH_USER}@${CONTROLLER_IP}:${PERF_HISTORY_DIR}/perf-gate.py" 2>/dev/null; then
+        log_error "Failed to copy perf-gate.py to the controller"
+        return 1
+    fi
+
+    log_info "✓ Cluster: $PERF_CLUSTER, records in $RUN_DIR"
+    return 0
+}
+
+# Check the example binaries copied by the earlier job tests
+check_benchmarks_present() {
+    log_info "Checking benchmark jobs on BeeGFS..."
+
+    local job dir script
+    for job in "${PERF_JOBS[@]}"; do
+        IFS='|' read -r dir script _ _ <<< "$job"
+        if ! run_ssh "test -f $JOB_EXAMPLES_DIR/$dir/$script"; then
+            log_error "$JOB_EXAMPLES_DIR/$dir/$script not found (run the job tests first)"
+            return 1
+        fi
+    done
+
+    log_info "✓ All benchmark jobs present"
+    return 0
+}
+
+# Wait for a job to leave the queue and check that it completed
+wait_for_job() {
+    local job_id="$1"
+    local elapsed=0
+    local poll_interval=5
+
+    while [ $elapsed -lt "$PERF_JOB_TIMEOUT" ]; do
+        local job_status
+        job_status=$(run_ssh "squeue -j $job_id -h 2>/dev/null" || true)
+        if [ -z "$job_status" ]; then
+            break
+        fi
+        log_debug "Job status: $job_status"
+        sleep $poll_interval
+        elapsed=$((elapsed + poll_interval))
+    done
+
+    if [ $elapsed -ge "$PERF_JOB_TIMEOUT" ]; then
+        log_error "Job $job_id timeout after ${PERF_JOB_TIMEOUT}s"
+        return 1
+    fi
+
+    local state
+    state=$(run_ssh "sacct -j $job_id --format=State -n -X | head -1" 2>/dev/null | tr -d ' ' || true)
+    if [ "$state" != "COMPLETED" ]; then
+        log_error "Job $job_id ended in state ${state:-unknown}"
+        return 1
+    fi
+    return 0
+}
+
+# Run the benchmarks one after another: concurrent jobs would share nodes
+# and links and skew each other's figures
+run_benchmark_jobs() {
+    log_info "Running benchmark jobs (sequentially)..."
+
+    local job dir script exports name job_id
+    for job in "${PERF_JOBS[@]}"; do
+        IFS='|' read -r dir script exports name <<< "$job"
+        local record="$RUN_DIR/${name}.json"
+        local submit_cmd="cd $JOB_EXAMPLES_DIR/$dir && sbatch --export=ALL,${exports},BENCH_JSON=${record} --parsable $script"
+
+        if ! job_id=$(run_ssh "$submit_cmd" 2>&1); then
+            log_error "Failed to submit $script: $job_id"
+            return 1
+        fi
+        log_info "$name: job $job_id ($script, $exports)"
+
+        if ! wait_for_job "$job_id"; then
+            log_error "$name benchmark job failed"
+            return 1
+        fi
+        if ! run_ssh "test -s $record"; then
+            log_error "$name job wrote no JSON record to $record"
+            return 1
+        fi
+    done
+
+    log_info "✓ All benchmark jobs completed"
+    return 0
+}
+
+# Compare the records against the baseline; fails on regressions
+run_perf_gate() {
+    log_info "Comparing against the $PERF_CLUSTER baseline..."
+
+    local gate_args="--baseline=$PERF_HISTORY_DIR/baseline.json --history=$PERF_HISTORY_DIR/history.jsonl --run-id=$RUN_ID"
+    if [ -n "$PERF_TOLERANCE" ]; then
+        gate_args="$gate_args --tolerance=$PERF_TOLERANCE"
+    fi
+    if [ "$PERF_UPDATE_BASELINE" = "1" ]; then
+        gate_args="$gate_args --update-baseline"
+    fi
+    # Every collective the job was asked for must show up in its record
+    local job exports ops
+    for job in "${PERF_JOBS[@]}"; do
+        IFS='|' read -r _ _ exports _ <<< "$job"
+        if [[ ",$exports" == *",COLL_OPS="* ]]; then
+            ops="${exports#*COLL_OPS=}"
+            gate_args="$gate_args --expect-ops=${ops%%,*}"
+        fi
+    done
+
+    local output exit_code=0
+    output=$(run_ssh "python3 $PERF_HISTORY_DIR/perf-gate.py $gate_args $RUN_DIR" 2>&1) \
+        || exit_code=$?
+    echo "$output" | sed 's/^/  /'
+
+    if [ "$exit_code" -eq 1 ]; then
+        log_error "Performance regressions or missing figures (records: $RUN_DIR)"
+        log_error "If the change is intended, rerun with PERF_UPDATE_BASELINE=1"
+        return 1
+    elif [ "$exit_code" -ne 0 ]; then
+        log_error "Performance gate failed to run (exit code $exit_code)"
+        return 1
+    fi
+
+    log_info "✓ All figures within tolerance of the baseline"
+    return 0
+}
+
+# Main test execution
+main() {
+    log ""
+    log "${BLUE}=====================================${NC}"
+    log "${BLUE}  $TEST_NAME${NC}"
+    log "${BLUE}=====================================${NC}"
+    log ""
+
+    if [ -z "${CONTROLLER_IP:-}" ] || [ -z "${SSH_KEY_PATH:-}" ] || [ -z "${SSH_USER:-}" ]; then
+        log_error "CONTROLLER_IP, SSH_KEY_PATH and SSH_USER must be set to submit benchmark jobs"
+        return 1
+    fi
+    log_info "Operating in remote mode: $CONTROLLER_IP"
+    log ""
+
+    if ! prepare_history_dir; then
+        log_error "Failed to prepare the performance history"
+        return 1
+    fi
+
+    if ! check_benchmarks_present; then
+        log_error "Benchmark jobs missing on BeeGFS"
+        return 1
+    fi
+
+    if ! run_benchmark_jobs; then
+        log_error "Failed to run the benchmark jobs"
+        return 1
+    fi
+
+    if ! run_perf_gate; then
+        log_error "Performance regression gate failed"
+        return 1
+    fi
+
+    log ""
+    log_info "🎉 Performance regression gate passed!"
+    log ""
+    return 0
+}
+
+# Execute main
+main "$@"
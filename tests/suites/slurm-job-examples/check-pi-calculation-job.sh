@@ -123,7 +123,8 @@ submit_pi_calculation_job() {
     # Submit job via SSH if controller IP is provided
     if [ -n "${CONTROLLER_IP:-}" ] && [ -n "${SSH_KEY_PATH:-}" ]; then
         # Use smaller sample size for testing (10 million instead of 100 million)
-        local submit_cmd="cd $JOB_EXAMPLES_DIR && sbatch --export=ALL,NUM_SAMPLES=10000000 --parsable pi.sbatch"
+        # and stop early once the standard error is below 1e-3 (~3M samples)
+        local submit_cmd="cd $JOB_EXAMPLES_DIR && sbatch --export=ALL,NUM_SAMPLES=10000000,PI_TARGET_ERROR=1e-3 --parsable pi.sbatch"
         local job_id
 
         log_debug "Submitting via SSH to $CONTROLLER_IP..."
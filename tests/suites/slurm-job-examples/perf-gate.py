@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""Performance gate: compare benchmark JSON records against a cluster baseline.
+
+Reads the JSON records of the slurm-jobs examples (--json / BENCH_JSON) and
+extracts the throughput and latency figures that matter for each benchmark:
+
+  matrix-mult       end-to-end and compute-only GFLOPS
+  pi-monte-carlo    samples/second
+  stream            median per-node triad bandwidth and peak GFLOPS
+  mpi-collectives   p50 latency of the smallest message and bandwidth
+                    (bytes / p50) of the largest, per collective, at the
+                    largest rank count
+
+Each figure is keyed by the benchmark and the configuration that decides
+its value (problem size, ranks, threads, build, ...), so a run with a
+different configuration gets its own baseline instead of a false alarm.
+A figure regresses when it is worse than the baseline by more than its
+tolerance (10% for throughput, 25% for latency, or --tolerance for all).
+
+Figures without a baseline are added to it and pass; --update-baseline
+replaces the baseline with the current figures (after an intended
+change: new hardware, a deliberate configuration change). Every
+comparison is appended to the history file (JSON lines), so trends across
+image rebuilds and role changes can be followed.
+
+--expect-ops lists the collectives every mpi-collectives record must have
+figures for; a missing one fails the gate (a job that silently ran fewer
+collectives than asked for would otherwise pass).
+
+Exit status: 0 all figures within tolerance, 1 regression or missing
+figure, 2 bad input.
+
+Usage: perf-gate.py --baseline=PATH [--history=PATH] [--tolerance=F]
+                    [--update-baseline] [--run-id=ID] [--expect-ops=OP,...]
+                    RECORD|DIR...
+"""
+
+import argparse
+import datetime
+import json
+import os
+import sys
+
+THROUGHPUT_TOLERANCE = 0.10
+LATENCY_TOLERANCE = 0.25
+
+# Configuration fields that identify a run, per benchmark
+CONFIG_KEYS = {
+    "matrix-mult": ["n", "algo", "device", "kernel", "dtype", "batch", "iterations"],
+    "pi-monte-carlo": ["total_samples", "schedule"],
+    "stream": ["elements", "stores", "isa"],
+    "mpi-collectives": [],
+}
+
+
+def fingerprint(record, extra=()):
+    """benchmark[key=value,...] from the record's header and config."""
+    benchmark = record.get("benchmark", "unknown")
+    config = record.get("config", {})
+    parts = [f"ranks={record.get('ranks')}", f"threads={record.get('threads_per_rank')}",
+             f"build={record.get('build')}"]
+    for key in CONFIG_KEYS.get(benchmark, []):
+        if key in config:
+            parts.append(f"{key}={config[key]}")
+    parts.extend(extra)
+    return f"{benchmark}[{','.join(parts)}]"
+
+
+def positive(value):
+    return isinstance(value, (int, float)) and value > 0
+
+
+def collective_metrics(record):
+    """Smallest-message latency and largest-message bandwidth per collective."""
+    results = [r for r in record.get("results", []) if "blocking_us" in r]
+    if not results:
+        return
+    max_ranks = max(r["ranks"] for r in results)
+    by_op = {}
+    for r in results:
+        if r["ranks"] == max_ranks and positive(r["blocking_us"].get("p50")):
+            by_op.setdefault(r["collective"], []).append(r)
+    for op, rows in sorted(by_op.items()):
+        rows.sort(key=lambda r: r["bytes"])
+        small, large = rows[0], rows[-1]
+        yield (fingerprint(record, [f"op={op}", f"bytes={small['bytes']}"]) + "/latency_p50_us",
+               small["blocking_us"]["p50"], "lower", LATENCY_TOLERANCE)
+        if large["bytes"] > small["bytes"]:
+            gbps = large["bytes"] / (large["blocking_us"]["p50"] * 1e-6) / 1e9
+            yield (fingerprint(record, [f"op={op}", f"bytes={large['bytes']}"]) + "/gbps",
+                   gbps, "higher", THROUGHPUT_TOLERANCE)
+
+
+def extract_metrics(record):
+    """Yield (key, value, better, tolerance) for every gated figure."""
+    benchmark = record.get("benchmark")
+    metrics = record.get("metrics", {})
+    if benchmark == "mpi-collectives":
+        yield from collective_metrics(record)
+        return
+    names = {
+        "matrix-mult": ["gflops", "compute_gflops"],
+        "pi-monte-carlo": ["samples_per_second"],
+        "stream": ["median_node_triad_gbps", "median_node_peak_gflops"],
+    }.get(benchmark, [])
+    for name in names:
+        if positive(metrics.get(name)):
+            yield (f"{fingerprint(record)}/{name}", metrics[name], "higher",
+                   THROUGHPUT_TOLERANCE)
+
+
+def record_paths(paths):
+    """JSON files given directly or found (non-recursively) in directories."""
+    for path in paths:
+        if os.path.isdir(path):
+            for name in sorted(os.listdir(path)):
+                if name.endswith(".json"):
+                    yield os.path.join(path, name)
+        else:
+            yield path
+
+
+def load_json(path, default=None):
+    if default is not None and not os.path.exists(path):
+        return default
+    with open(path) as f:
+        return json.load(f)
+
+
+def compare(value, entry, better, tolerance):
+    """(status, relative change in the good direction)."""
+    base = entry["value"]
+    change = (value - base) / base if better == "higher" else (base - value) / base
+    if change < -tolerance:
+        return "REGRESSION", change
+    if change > tolerance:
+        return "improved", change
+    return "ok", change
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("records", nargs="+", help="JSON records or directories of them")
+    parser.add_argument("--baseline", required=True, help="baseline file (created if missing)")
+    parser.add_argument("--history", help="JSON-lines file the comparisons are appended to")
+    parser.add_argument("--tolerance", type=float,
+                        help="allowed relative loss for every figure (default: 0.10 "
+                             "throughput, 0.25 latency)")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="replace the baseline with the current figures")
+    parser.add_argument("--run-id", default=datetime.datetime.now(datetime.timezone.utc)
+                        .strftime("%Y-%m-%dT%H:%M:%SZ"), help="label of this run in the history")
+    parser.add_argument("--expect-ops", default="",
+                        help="comma-separated collectives every mpi-collectives record must "
+                             "have figures for")
+    args = parser.parse_args()
+    expected_ops = [op for op in args.expect_ops.replace(":", ",").split(",") if op]
+
+    try:
+        baseline = load_json(args.baseline, default={"schema": 1, "metrics": {}})
+    except (OSError, ValueError) as err:
+        print(f"Error: cannot read baseline {args.baseline}: {err}", file=sys.stderr)
+        return 2
+
+    rows = []
+    missing = []
+    for path in record_paths(args.records):
+        try:
+            record = load_json(path)
+        except (OSError, ValueError) as err:
+            print(f"Error: cannot read record {path}: {err}", file=sys.stderr)
+            return 2
+        metrics = list(extract_metrics(record))
+        if record.get("benchmark") == "mpi-collectives":
+            found = {key.split("op=")[1].split(",")[0] for key, _, _, _ in metrics}
+            missing.extend(f"{os.path.basename(path)}: {op}" for op in expected_ops
+                           if op not in found)
+        for key, value, better, tolerance in metrics:
+            if args.tolerance is not None:
+                tolerance = args.tolerance
+            rows.append({"key": key, "value": value, "better": better,
+                         "tolerance": tolerance, "record": os.path.basename(path),
+                         "job_id": record.get("job_id"),
+                         "mpi_library": record.get("mpi_library"),
+                         "hosts": sorted(set(record.get("hosts", [])))})
+    if not rows:
+        print("Error: no gated figures in the records", file=sys.stderr)
+        return 2
+
+    stored = baseline.setdefault("metrics", {})
+    regressions = 0
+    changed = False
+    print(f"{'Status':<10} {'Baseline':>11} {'Current':>11} {'Change':>8}  Figure")
+    for row in rows:
+        entry = stored.get(row["key"])
+        if entry is None or args.update_baseline:
+            status, change = ("new" if entry is None else "rebased"), None
+        else:
+            status, change = compare(row["value"], entry, row["better"], row["tolerance"])
+            regressions += status == "REGRESSION"
+        base_text = f"{entry['value']:.4g}" if entry else "-"
+        change_text = f"{100 * change:+.1f}%" if change is not None else "-"
+        print(f"{status:<10} {base_text:>11} {row['value']:>11.4g} {change_text:>8}  "
+              f"{row['key']}" + (f" (tolerance {100 * row['tolerance']:.0f}%)"
+                                 if status == "REGRESSION" else ""))
+        row.update(status=status, baseline=entry["value"] if entry else None, change=change)
+        if status in ("new", "rebased"):
+            stored[row["key"]] = {"value": row["value"], "better": row["better"],
+                                  "run_id": args.run_id, "job_id": row["job_id"],
+                                  "mpi_library": row["mpi_library"]}
+            changed = True
+
+    if args.history:
+        with open(args.history, "a") as f:
+            for row in rows:
+                f.write(json.dumps(dict(row, run_id=args.run_id), sort_keys=True) + "\n")
+    if changed:
+        baseline["updated"] = args.run_id
+        tmp = args.baseline + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        os.replace(tmp, args.baseline)
+
+    for entry in missing:
+        print(f"{'MISSING':<10} {'-':>11} {'-':>11} {'-':>8}  {entry} (expected collective)")
+
+    checked = sum(row["status"] not in ("new", "rebased") for row in rows)
+    print(f"Performance gate: {regressions} regressions in {checked} figures compared "
+          f"({len(rows) - checked} baselined), {len(missing)} expected figures missing")
+    return 1 if regressions or missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
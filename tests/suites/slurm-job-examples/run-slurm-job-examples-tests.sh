@@ -48,6 +48,9 @@ TEST_SCRIPTS=(
     "check-hello-world-job.sh"          # Test basic multi-node MPI job
     "check-pi-calculation-job.sh"       # Test computational parallelism
     "check-matrix-multiply-job.sh"      # Test memory-intensive parallel job
+    "check-mpi-collectives-bench-job.sh"  # Time collectives across nodes
+    "check-stream-bench-job.sh"         # Per-node memory bandwidth and roofline
+    "check-performance-regression.sh"   # Compare benchmark figures with the baseline
 )
 
 # Logging helpers
@@ -302,6 +305,9 @@ while [[ $# -gt 0 ]]; do
             echo ""
             echo "Environment Variables:"
             echo "  LOG_DIR         Directory for test logs (default: ./logs/run-YYYY-MM-DD_HH-MM-SS)"
+            echo "  PERF_TOLERANCE  Allowed relative loss per figure (default: 0.10 throughput, 0.25 latency)"
+            echo "  PERF_UPDATE_BASELINE=1  Accept this run's figures as the new baseline"
+            echo "  PERF_GPU=1      Also gate the GPU matrix job"
             echo ""
             echo "Pre-Test Health Check:"
             echo "  - $HEALTH_CHECK_SCRIPT (runs automatically before all tests)"